@@ -89,7 +89,16 @@ impl PatternExtractor {
 
             // In operation: check for constant string sets
             IrNode::In { value, values } => {
-                self.extract_from_in_op(value, values, predicate, rule_id, patterns)?;
+                let strings = values.iter().filter_map(|lit| match lit {
+                    kestrel_eql::ir::IrLiteral::String(s) => Some(s),
+                    _ => None,
+                });
+                self.extract_from_in_op(value, strings, predicate, rule_id, patterns)?;
+            }
+
+            // Large in lists lowered to a literal set
+            IrNode::InSet { value, set } => {
+                self.extract_from_in_op(value, set.strings(), predicate, rule_id, patterns)?;
             }
 
             // Unary operations: recurse into operand
@@ -159,7 +168,8 @@ impl PatternExtractor {
         Ok(())
     }
 
-    /// Extract patterns from function calls (contains, startswith, endswith)
+    /// Extract patterns from function calls (contains, startswith, endswith,
+    /// and the exact string compare lowered from wildcards)
     fn extract_from_function_call(
         &self,
         func: &kestrel_eql::ir::IrFunction,
@@ -175,6 +185,7 @@ impl PatternExtractor {
             IrFunction::Contains => PatternKind::Contains,
             IrFunction::StartsWith => PatternKind::StartsWith,
             IrFunction::EndsWith => PatternKind::EndsWith,
+            IrFunction::StringEquals => PatternKind::Equals,
             _ => return Ok(()),
         };
 
@@ -218,10 +229,10 @@ impl PatternExtractor {
     }
 
     /// Extract patterns from "in" operations
-    fn extract_from_in_op(
+    fn extract_from_in_op<'a>(
         &self,
         value: &IrNode,
-        values: &[kestrel_eql::ir::IrLiteral],
+        values: impl IntoIterator<Item = &'a String>,
         _predicate: &IrPredicate,
         rule_id: &str,
         patterns: &mut Vec<MatchPattern>,
@@ -233,23 +244,21 @@ impl PatternExtractor {
         };
 
         // Extract all string literals from the value set
-        for lit in values {
-            if let kestrel_eql::ir::IrLiteral::String(pattern_str) = lit {
-                // Validate pattern length
-                if self.max_pattern_length > 0 && pattern_str.len() > self.max_pattern_length {
-                    continue;
-                }
+        for pattern_str in values {
+            // Validate pattern length
+            if self.max_pattern_length > 0 && pattern_str.len() > self.max_pattern_length {
+                continue;
+            }
 
-                // Create the pattern
-                let pattern = MatchPattern::new(
-                    pattern_str.clone(),
-                    *field_id,
-                    PatternKind::Equals,
-                    rule_id.to_string(),
-                )?;
+            // Create the pattern
+            let pattern = MatchPattern::new(
+                pattern_str.clone(),
+                *field_id,
+                PatternKind::Equals,
+                rule_id.to_string(),
+            )?;
 
-                patterns.push(pattern);
-            }
+            patterns.push(pattern);
         }
 
         Ok(())
@@ -416,4 +425,34 @@ mod tests {
         assert_eq!(patterns[0].pattern, "ssh");
         assert_eq!(patterns[0].kind, PatternKind::Contains);
     }
+
+    #[test]
+    fn test_extract_lowered_wildcard() {
+        let mut root = IrNode::FunctionCall {
+            func: IrFunction::Wildcard,
+            args: vec![
+                IrNode::LoadField { field_id: 1 },
+                IrNode::Literal {
+                    value: kestrel_eql::ir::IrLiteral::String("*\\powershell.exe".to_string()),
+                },
+            ],
+        };
+        kestrel_eql::lowering::lower_wildcards(&mut root);
+
+        let predicate = IrPredicate {
+            id: "pred1".to_string(),
+            event_type: "process".to_string(),
+            root,
+            required_fields: vec![1],
+            required_regex: vec![],
+            required_globs: vec![],
+        };
+
+        let extractor = PatternExtractor::new();
+        let patterns = extractor.extract_from_predicate(&predicate, "rule-1").unwrap();
+
+        assert_eq!(patterns.len(), 1);
+        assert_eq!(patterns[0].pattern, "\\powershell.exe");
+        assert_eq!(patterns[0].kind, PatternKind::EndsWith);
+    }
 }
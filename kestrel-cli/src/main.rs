@@ -9,6 +9,14 @@ use tokio::time::{interval, Duration};
 use tracing::{info, Level};
 use tracing_subscriber::FmtSubscriber;
 
+/// Counts allocations per thread so the rule profiler can attribute them
+///
+/// Adds a thread-local update to every allocation, so it is only built with
+/// the `alloc-profiling` feature.
+#[cfg(feature = "alloc-profiling")]
+#[global_allocator]
+static GLOBAL: kestrel_core::CountingAllocator = kestrel_core::CountingAllocator;
+
 #[derive(Parser)]
 #[command(name = "kestrel")]
 #[command(about = "Kestrel - Next-generation endpoint behavior detection engine", long_about = None)]
@@ -29,6 +37,18 @@ enum Commands {
         /// Log level
         #[arg(short, long, default_value = "info")]
         log_level: String,
+
+        /// Periodically print the N most expensive rules (0 = off)
+        #[arg(long, default_value_t = 0)]
+        profile_top: usize,
+
+        /// Rule to switch off (repeatable)
+        #[arg(long = "disable-rule")]
+        disable_rules: Vec<String>,
+
+        /// Reload rule files as they change
+        #[arg(long)]
+        watch: bool,
     },
 
     /// Validate rules without running detection
@@ -51,9 +71,15 @@ async fn main() -> Result<()> {
     let cli = Cli::parse();
 
     match cli.command {
-        Commands::Run { rules, log_level } => {
+        Commands::Run {
+            rules,
+            log_level,
+            profile_top,
+            disable_rules,
+            watch,
+        } => {
             setup_logging(&log_level)?;
-            run_engine(rules).await?;
+            run_engine(rules, profile_top, disable_rules, watch).await?;
         }
         Commands::Validate { rules } => {
             setup_logging("info")?;
@@ -79,7 +105,12 @@ fn setup_logging(level: &str) -> Result<()> {
     Ok(())
 }
 
-async fn run_engine(rules_dir: PathBuf) -> Result<()> {
+async fn run_engine(
+    rules_dir: PathBuf,
+    profile_top: usize,
+    disable_rules: Vec<String>,
+    watch: bool,
+) -> Result<()> {
     info!("Starting Kestrel detection engine");
     info!(rules_dir = %rules_dir.display(), "Loading rules from");
 
@@ -93,21 +124,52 @@ async fn run_engine(rules_dir: PathBuf) -> Result<()> {
     let stats = engine.stats().await;
     info!(rule_count = stats.rule_count, "Engine started");
 
+    for rule_id in &disable_rules {
+        engine.disable_rule(rule_id, "disabled on command line");
+    }
+
     info!("Starting event processing loop...");
     engine.start().await?;
     info!("Engine running. Press Ctrl+C to stop.");
 
     let mut stats_interval = interval(Duration::from_secs(10));
+    let profiler = engine.rule_profiler().clone();
 
     tokio::spawn(async move {
+        let mut report = String::new();
         loop {
             stats_interval.tick().await;
             tracing::info!("Engine running - waiting for events");
+
+            if profile_top > 0 {
+                report.clear();
+                if profiler.write_report(&mut report, profile_top).is_ok() {
+                    info!("Most expensive rules:\n{}", report);
+                }
+            }
         }
     });
 
-    tokio::signal::ctrl_c().await?;
+    if watch {
+        let mut rule_changes = engine.rule_manager().watch()?;
+        loop {
+            tokio::select! {
+                result = tokio::signal::ctrl_c() => {
+                    result?;
+                    break;
+                }
+                Some(changes) = rule_changes.recv() => {
+                    if let Err(e) = engine.apply_rule_changes(&changes).await {
+                        tracing::error!(error = %e, "Failed to apply rule changes");
+                    }
+                }
+            }
+        }
+    } else {
+        tokio::signal::ctrl_c().await?;
+    }
     info!("Shutting down engine");
+    kestrel_core::stop_ticker();
 
     Ok(())
 }
@@ -75,7 +75,7 @@ impl fmt::Display for ActionPolicy {
 #[derive(Debug, Clone, PartialEq, Eq, Hash, Serialize, Deserialize)]
 #[serde(rename_all = "snake_case")]
 pub enum ActionTarget {
-    /// Process execution (execve/execveat)
+    /// Process execution (execve/execveat); `executable` is empty when unknown
     ProcessExec { pid: u32, executable: String },
     /// File operation (open/write/rename/unlink)
     FileOp { pid: u32, path: String },
@@ -97,23 +97,70 @@ impl ActionTarget {
     }
 }
 
+/// Reason recorded for an action decision
+///
+/// Rule matches keep the rule name and only format the message when the
+/// reason is displayed, so deciding an action on the hot path does not
+/// build strings. Serialized as the formatted message.
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(from = "String", into = "String")]
+pub enum ActionReason {
+    /// Free-form reason
+    Text(String),
+    /// The named rule matched
+    RuleMatched(Arc<str>),
+}
+
+impl fmt::Display for ActionReason {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            ActionReason::Text(text) => f.write_str(text),
+            ActionReason::RuleMatched(rule_name) => write!(f, "Rule matched: {}", rule_name),
+        }
+    }
+}
+
+impl From<String> for ActionReason {
+    fn from(text: String) -> Self {
+        ActionReason::Text(text)
+    }
+}
+
+impl From<&str> for ActionReason {
+    fn from(text: &str) -> Self {
+        ActionReason::Text(text.to_string())
+    }
+}
+
+impl From<ActionReason> for String {
+    fn from(reason: ActionReason) -> Self {
+        match reason {
+            ActionReason::Text(text) => text,
+            reason => reason.to_string(),
+        }
+    }
+}
+
 /// Action decision - result of evaluating a rule against an event
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct ActionDecision {
     /// Unique decision ID
     pub id: String,
     /// Rule ID that generated this decision
-    pub rule_id: String,
+    pub rule_id: Arc<str>,
     /// Action to take
     pub action: ActionType,
     /// Policy for execution
     pub policy: ActionPolicy,
     /// Target of the action
     pub target: ActionTarget,
+    /// Entity key of the target process (PID and start time), 0 if unknown
+    #[serde(default)]
+    pub entity_key: u128,
     /// Decision timestamp (nanoseconds)
     pub timestamp_ns: u64,
     /// Reason for this decision (for audit)
-    pub reason: String,
+    pub reason: ActionReason,
     /// Evidence/events that led to this decision
     pub evidence: Vec<ActionEvidence>,
 }
@@ -121,24 +168,31 @@ pub struct ActionDecision {
 impl ActionDecision {
     /// Create a new action decision
     pub fn new(
-        rule_id: String,
+        rule_id: impl Into<Arc<str>>,
         action: ActionType,
         policy: ActionPolicy,
         target: ActionTarget,
-        reason: String,
+        reason: impl Into<ActionReason>,
         evidence: Vec<ActionEvidence>,
     ) -> Self {
         Self {
             id: Uuid::new_v4().to_string(),
-            rule_id,
+            rule_id: rule_id.into(),
             action,
             policy,
             target,
+            entity_key: 0,
             timestamp_ns: current_timestamp_ns(),
-            reason,
+            reason: reason.into(),
             evidence,
         }
     }
+
+    /// Identify the target process by the entity key of its events
+    pub fn with_entity_key(mut self, entity_key: u128) -> Self {
+        self.entity_key = entity_key;
+        self
+    }
 }
 
 /// Evidence associated with an action decision
@@ -233,6 +287,9 @@ pub enum ActionError {
 
     #[error("Quarantine error: {0}")]
     QuarantineError(String),
+
+    #[error("Action pipeline is closed")]
+    PipelineClosed,
 }
 
 /// Capability flags for what actions are available
@@ -778,8 +835,8 @@ impl ActionAudit {
             action_type: decision.action,
             policy: decision.policy,
             entity_key,
-            rule_id: decision.rule_id.clone(),
-            decision: decision.reason.clone(),
+            rule_id: decision.rule_id.to_string(),
+            decision: decision.reason.to_string(),
             result,
             target: decision.target.clone(),
         }
@@ -1094,13 +1151,33 @@ mod tests {
             vec![],
         );
 
-        assert_eq!(decision.rule_id, "rule-001");
+        assert_eq!(&*decision.rule_id, "rule-001");
         assert_eq!(decision.action, ActionType::Block);
         assert_eq!(decision.policy, ActionPolicy::Inline);
         assert!(!decision.id.is_empty());
         assert!(decision.timestamp_ns > 0);
     }
 
+    #[test]
+    fn test_rule_matched_reason_formats_on_display() {
+        let decision = ActionDecision::new(
+            Arc::<str>::from("rule-001"),
+            ActionType::Kill,
+            ActionPolicy::Inline,
+            ActionTarget::MemoryOp { pid: 1234 },
+            ActionReason::RuleMatched(Arc::from("Suspicious Rule")),
+            vec![],
+        );
+        assert_eq!(decision.reason.to_string(), "Rule matched: Suspicious Rule");
+
+        let json = serde_json::to_value(&decision).unwrap();
+        assert_eq!(json["rule_id"], "rule-001");
+        assert_eq!(json["reason"], "Rule matched: Suspicious Rule");
+
+        let decoded: ActionDecision = serde_json::from_value(json).unwrap();
+        assert_eq!(decoded.reason.to_string(), "Rule matched: Suspicious Rule");
+    }
+
     #[test]
     fn test_action_result_success() {
         let result = ActionResult::success("test-001".to_string(), ActionType::Block);
@@ -0,0 +1,536 @@
+//! Action execution pipeline
+//!
+//! `ActionPipeline` takes enforcement decisions off the detection path.
+//! Decisions are queued through an `ActionHandle`, drained in short batches
+//! (whatever is queued, up to `batch_size`, without waiting for more),
+//! deduplicated per target process and dispatched to the executor on blocking
+//! threads, several at a time. Kills and blocks in a batch are dispatched
+//! before slower actions such as quarantine.
+//!
+//! Every executed decision records its detect-to-enforce latency, measured
+//! from the decision timestamp, alongside queueing and execution time.
+
+use crate::action::{
+    current_timestamp_ns, ActionDecision, ActionError, ActionExecutor, ActionType,
+};
+use crate::metrics::LatencyHistogram;
+use crate::time::{coarse_monotonic_ns, monotonic_ns};
+use parking_lot::Mutex;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use thiserror::Error;
+use tokio::sync::{mpsc, Semaphore};
+use tracing::{debug, error};
+
+/// Action pipeline configuration
+#[derive(Debug, Clone)]
+pub struct ActionPipelineConfig {
+    /// Decisions queued before submission fails or waits
+    pub channel_size: usize,
+
+    /// Most decisions taken from the queue at once
+    pub batch_size: usize,
+
+    /// Decisions executing at the same time
+    pub max_in_flight: usize,
+
+    /// How long repeats for an already handled process are dropped
+    /// (zero = execute every decision)
+    pub dedup_window: Duration,
+
+    /// Most (process, action) pairs remembered; beyond it, decisions for
+    /// new processes are executed without deduplication
+    pub max_tracked_pids: usize,
+}
+
+impl Default for ActionPipelineConfig {
+    fn default() -> Self {
+        Self {
+            channel_size: 4096,
+            batch_size: 64,
+            max_in_flight: 8,
+            dedup_window: Duration::from_secs(5),
+            max_tracked_pids: 65536,
+        }
+    }
+}
+
+/// Action pipeline counters and latencies
+#[derive(Debug, Default)]
+pub struct ActionPipelineStats {
+    pub submitted: AtomicU64,
+    pub executed: AtomicU64,
+    pub failed: AtomicU64,
+    /// Dropped as repeats for an already handled process
+    pub deduplicated: AtomicU64,
+    /// Returned by `try_submit` because the queue was full
+    pub queue_full: AtomicU64,
+    pub batches: AtomicU64,
+    /// Decision timestamp to executor completion, in nanoseconds
+    pub detect_to_enforce_ns: LatencyHistogram,
+    /// Time between submission and dispatch, in nanoseconds
+    pub queue_wait_ns: LatencyHistogram,
+    /// Time spent in the executor, in nanoseconds
+    pub execute_ns: LatencyHistogram,
+}
+
+/// Queued decision
+struct Submitted {
+    decision: ActionDecision,
+    /// `monotonic_ns` when queued
+    queued_at: u64,
+}
+
+/// Decision `try_submit` could not queue, handed back to the caller
+#[derive(Debug, Error)]
+pub enum TrySubmitError {
+    #[error("Action pipeline is full")]
+    Full(ActionDecision),
+
+    #[error("Action pipeline is closed")]
+    Closed(ActionDecision),
+}
+
+impl TrySubmitError {
+    /// The decision that was not queued
+    pub fn into_decision(self) -> ActionDecision {
+        match self {
+            TrySubmitError::Full(decision) | TrySubmitError::Closed(decision) => decision,
+        }
+    }
+}
+
+/// Handle for submitting decisions to an `ActionPipeline`
+#[derive(Clone)]
+pub struct ActionHandle {
+    sender: mpsc::Sender<Submitted>,
+    stats: Arc<ActionPipelineStats>,
+}
+
+impl ActionHandle {
+    /// Submit a decision, waiting for queue space
+    pub async fn submit(&self, decision: ActionDecision) -> Result<(), ActionError> {
+        let submitted = Submitted {
+            decision,
+            queued_at: monotonic_ns(),
+        };
+        self.sender
+            .send(submitted)
+            .await
+            .map_err(|_| ActionError::PipelineClosed)?;
+        self.stats.submitted.fetch_add(1, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Submit a decision without blocking
+    ///
+    /// A decision that cannot be queued is returned, so the caller can
+    /// execute it some other way.
+    pub fn try_submit(&self, decision: ActionDecision) -> Result<(), TrySubmitError> {
+        let submitted = Submitted {
+            decision,
+            queued_at: monotonic_ns(),
+        };
+        self.sender.try_send(submitted).map_err(|e| match e {
+            mpsc::error::TrySendError::Full(submitted) => {
+                self.stats.queue_full.fetch_add(1, Ordering::Relaxed);
+                TrySubmitError::Full(submitted.decision)
+            }
+            mpsc::error::TrySendError::Closed(submitted) => {
+                TrySubmitError::Closed(submitted.decision)
+            }
+        })?;
+        self.stats.submitted.fetch_add(1, Ordering::Relaxed);
+        Ok(())
+    }
+}
+
+impl std::fmt::Debug for ActionHandle {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("ActionHandle").finish_non_exhaustive()
+    }
+}
+
+/// Process a decision targets: its PID and entity key
+///
+/// The entity key includes the process start time, so a reused PID is a
+/// different process. Decisions without an entity key fall back to the PID.
+type ProcessKey = (u32, u128);
+
+/// Recently executed (process, action) pairs
+///
+/// A decision is a repeat when the same action ran for its process within
+/// the window, or when the process was killed within the window (except for
+/// quarantine, which acts on a file rather than the process). Quarantine
+/// and allow decisions, and decisions without a PID, are never repeats.
+///
+/// Times are `coarse_monotonic_ns`; a window is seconds long, so the
+/// clock's millisecond lag does not matter.
+struct PidDedup {
+    window_ns: u64,
+    max_entries: usize,
+    recent: HashMap<(ProcessKey, ActionType), u64>,
+}
+
+impl PidDedup {
+    fn new(window: Duration, max_entries: usize) -> Self {
+        Self {
+            window_ns: window.as_nanos() as u64,
+            max_entries,
+            recent: HashMap::new(),
+        }
+    }
+
+    /// Record `decision` unless it repeats a recent one
+    fn admit(&mut self, decision: &ActionDecision, now: u64) -> bool {
+        let process = (decision.target.pid(), decision.entity_key);
+        let action = decision.action;
+        if self.window_ns == 0
+            || process.0 == 0
+            || matches!(action, ActionType::Quarantine | ActionType::Allow)
+        {
+            return true;
+        }
+
+        let window = self.window_ns;
+        let fresh = |at: Option<&u64>| at.map_or(false, |at| now.saturating_sub(*at) < window);
+        if fresh(self.recent.get(&(process, action)))
+            || (action != ActionType::Kill && fresh(self.recent.get(&(process, ActionType::Kill))))
+        {
+            return false;
+        }
+
+        if self.recent.len() >= self.max_entries {
+            self.recent.retain(|_, at| now.saturating_sub(*at) < window);
+            if self.recent.len() >= self.max_entries {
+                return true;
+            }
+        }
+        self.recent.insert((process, action), now);
+        true
+    }
+
+    /// Forget a pair whose execution failed, so a repeat can retry it
+    fn forget(&mut self, decision: &ActionDecision) {
+        let process = (decision.target.pid(), decision.entity_key);
+        self.recent.remove(&(process, decision.action));
+    }
+}
+
+/// Dispatch order within a batch: enforcement that stops a process first
+fn dispatch_rank(action: ActionType) -> u8 {
+    match action {
+        ActionType::Kill | ActionType::Block => 0,
+        ActionType::Quarantine => 1,
+        ActionType::Alert | ActionType::Allow => 2,
+    }
+}
+
+/// Asynchronous, batching action executor
+pub struct ActionPipeline {
+    task: tokio::task::JoinHandle<()>,
+    handle: ActionHandle,
+    stats: Arc<ActionPipelineStats>,
+}
+
+impl ActionPipeline {
+    /// Start a pipeline dispatching to `executor`
+    ///
+    /// Must be called within a tokio runtime.
+    pub fn new(executor: Arc<dyn ActionExecutor>, config: ActionPipelineConfig) -> Self {
+        let (sender, mut receiver) = mpsc::channel(config.channel_size.max(1));
+        let stats = Arc::new(ActionPipelineStats::default());
+        let handle = ActionHandle {
+            sender,
+            stats: stats.clone(),
+        };
+
+        let batch_size = config.batch_size.max(1);
+        let max_in_flight = config.max_in_flight.max(1);
+        let slots = Arc::new(Semaphore::new(max_in_flight));
+        let dedup = Arc::new(Mutex::new(PidDedup::new(
+            config.dedup_window,
+            config.max_tracked_pids,
+        )));
+
+        let task_stats = stats.clone();
+        let task = tokio::spawn(async move {
+            let stats = task_stats;
+            let mut batch: Vec<Submitted> = Vec::with_capacity(batch_size);
+
+            while receiver.recv_many(&mut batch, batch_size).await > 0 {
+                stats.batches.fetch_add(1, Ordering::Relaxed);
+                batch.sort_by_key(|submitted| dispatch_rank(submitted.decision.action));
+
+                for submitted in batch.drain(..) {
+                    // Checked once a slot is free, so decisions that failed
+                    // meanwhile have been forgotten
+                    let permit = slots
+                        .clone()
+                        .acquire_owned()
+                        .await
+                        .expect("action slots are never closed");
+                    let now = coarse_monotonic_ns();
+                    if !dedup.lock().admit(&submitted.decision, now) {
+                        stats.deduplicated.fetch_add(1, Ordering::Relaxed);
+                        debug!(
+                            decision_id = %submitted.decision.id,
+                            pid = submitted.decision.target.pid(),
+                            entity_key = submitted.decision.entity_key,
+                            action = %submitted.decision.action,
+                            "Repeated action dropped"
+                        );
+                        continue;
+                    }
+
+                    stats
+                        .queue_wait_ns
+                        .record(monotonic_ns().saturating_sub(submitted.queued_at));
+
+                    let executor = executor.clone();
+                    let stats = stats.clone();
+                    let dedup = dedup.clone();
+                    tokio::task::spawn_blocking(move || {
+                        let _permit = permit;
+                        execute(&*executor, &submitted.decision, &stats, &dedup);
+                    });
+                }
+            }
+
+            // Wait for decisions still executing
+            let _ = slots.acquire_many(max_in_flight as u32).await;
+            debug!("Action pipeline shutting down");
+        });
+
+        Self {
+            task,
+            handle,
+            stats,
+        }
+    }
+
+    /// Get a handle for submitting decisions
+    pub fn handle(&self) -> ActionHandle {
+        self.handle.clone()
+    }
+
+    /// Submit a decision without blocking, returning it if not queued
+    pub fn try_submit(&self, decision: ActionDecision) -> Result<(), TrySubmitError> {
+        self.handle.try_submit(decision)
+    }
+
+    /// Pipeline counters and latencies
+    pub fn stats(&self) -> &Arc<ActionPipelineStats> {
+        &self.stats
+    }
+
+    /// Execute queued decisions and stop
+    ///
+    /// Waits until every handle obtained from `handle` has been dropped.
+    pub async fn close(self) {
+        drop(self.handle);
+        let _ = self.task.await;
+    }
+}
+
+/// Run one decision and record its outcome
+fn execute(
+    executor: &dyn ActionExecutor,
+    decision: &ActionDecision,
+    stats: &ActionPipelineStats,
+    dedup: &Mutex<PidDedup>,
+) {
+    let start = Instant::now();
+    let result = executor.execute(decision);
+    stats.execute_ns.record(start.elapsed().as_nanos() as u64);
+
+    let error = match result {
+        Ok(result) if result.success => None,
+        Ok(result) => Some(result.error.unwrap_or_default()),
+        Err(e) => Some(e.to_string()),
+    };
+
+    match error {
+        None => {
+            stats.executed.fetch_add(1, Ordering::Relaxed);
+            stats
+                .detect_to_enforce_ns
+                .record(current_timestamp_ns().saturating_sub(decision.timestamp_ns));
+        }
+        Some(error) => {
+            stats.failed.fetch_add(1, Ordering::Relaxed);
+            dedup.lock().forget(decision);
+            error!(
+                decision_id = %decision.id,
+                action = %decision.action,
+                error = %error,
+                "Action execution failed"
+            );
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::action::{ActionCapabilities, ActionPolicy, ActionResult, ActionTarget};
+
+    /// Records executed decisions; fails for PID 13
+    #[derive(Default)]
+    struct RecordingExecutor {
+        executed: Mutex<Vec<(u32, ActionType)>>,
+    }
+
+    impl ActionExecutor for RecordingExecutor {
+        fn execute(&self, decision: &ActionDecision) -> Result<ActionResult, ActionError> {
+            let pid = decision.target.pid();
+            if pid == 13 {
+                return Err(ActionError::TargetNotFound(pid.to_string()));
+            }
+            self.executed.lock().push((pid, decision.action));
+            Ok(ActionResult::success(decision.id.clone(), decision.action))
+        }
+
+        fn capabilities(&self) -> ActionCapabilities {
+            ActionCapabilities::enforce()
+        }
+
+        fn policy(&self) -> ActionPolicy {
+            ActionPolicy::Inline
+        }
+    }
+
+    fn decision(pid: u32, action: ActionType) -> ActionDecision {
+        ActionDecision::new(
+            "rule".to_string(),
+            action,
+            ActionPolicy::Inline,
+            ActionTarget::MemoryOp { pid },
+            String::new(),
+            vec![],
+        )
+    }
+
+    fn serial() -> ActionPipelineConfig {
+        ActionPipelineConfig {
+            max_in_flight: 1,
+            ..Default::default()
+        }
+    }
+
+    #[tokio::test]
+    async fn test_dedup_per_pid() {
+        let executor = Arc::new(RecordingExecutor::default());
+        let pipeline = ActionPipeline::new(executor.clone(), serial());
+        let handle = pipeline.handle();
+
+        handle.try_submit(decision(1, ActionType::Kill)).unwrap();
+        handle.try_submit(decision(1, ActionType::Kill)).unwrap();
+        handle.try_submit(decision(1, ActionType::Block)).unwrap();
+        handle.try_submit(decision(2, ActionType::Block)).unwrap();
+        handle.try_submit(decision(2, ActionType::Kill)).unwrap();
+        drop(handle);
+
+        let stats = pipeline.stats().clone();
+        pipeline.close().await;
+
+        assert_eq!(
+            *executor.executed.lock(),
+            vec![
+                (1, ActionType::Kill),
+                (2, ActionType::Block),
+                (2, ActionType::Kill)
+            ]
+        );
+        assert_eq!(stats.submitted.load(Ordering::Relaxed), 5);
+        assert_eq!(stats.executed.load(Ordering::Relaxed), 3);
+        assert_eq!(stats.deduplicated.load(Ordering::Relaxed), 2);
+        assert_eq!(stats.detect_to_enforce_ns.count(), 3);
+        assert_eq!(stats.queue_wait_ns.count(), 3);
+    }
+
+    #[tokio::test]
+    async fn test_reused_pid_not_deduplicated() {
+        let executor = Arc::new(RecordingExecutor::default());
+        let pipeline = ActionPipeline::new(executor.clone(), serial());
+        let handle = pipeline.handle();
+
+        // PID 7 exits and is reused by a process with another start time
+        for entity_key in [0x7_0000_0007, 0x7_0000_0007, 0x9_0000_0007] {
+            handle
+                .try_submit(decision(7, ActionType::Kill).with_entity_key(entity_key))
+                .unwrap();
+        }
+        drop(handle);
+
+        let stats = pipeline.stats().clone();
+        pipeline.close().await;
+
+        assert_eq!(executor.executed.lock().len(), 2);
+        assert_eq!(stats.deduplicated.load(Ordering::Relaxed), 1);
+    }
+
+    #[tokio::test]
+    async fn test_full_queue_returns_decision() {
+        let executor = Arc::new(RecordingExecutor::default());
+        let config = ActionPipelineConfig {
+            channel_size: 1,
+            ..serial()
+        };
+        let pipeline = ActionPipeline::new(executor, config);
+
+        // The pipeline task does not run until this test yields
+        pipeline.try_submit(decision(1, ActionType::Kill)).unwrap();
+        let rejected = pipeline
+            .try_submit(decision(2, ActionType::Kill))
+            .unwrap_err();
+        assert!(matches!(rejected, TrySubmitError::Full(_)));
+        assert_eq!(rejected.into_decision().target.pid(), 2);
+        assert_eq!(pipeline.stats().queue_full.load(Ordering::Relaxed), 1);
+        pipeline.close().await;
+    }
+
+    #[tokio::test]
+    async fn test_enforcement_dispatched_first() {
+        let executor = Arc::new(RecordingExecutor::default());
+        let pipeline = ActionPipeline::new(executor.clone(), serial());
+        let handle = pipeline.handle();
+
+        handle.try_submit(decision(1, ActionType::Alert)).unwrap();
+        handle
+            .try_submit(decision(2, ActionType::Quarantine))
+            .unwrap();
+        handle.try_submit(decision(3, ActionType::Kill)).unwrap();
+        drop(handle);
+        pipeline.close().await;
+
+        assert_eq!(
+            *executor.executed.lock(),
+            vec![
+                (3, ActionType::Kill),
+                (2, ActionType::Quarantine),
+                (1, ActionType::Alert)
+            ]
+        );
+    }
+
+    #[tokio::test]
+    async fn test_failed_action_not_deduplicated() {
+        let executor = Arc::new(RecordingExecutor::default());
+        let pipeline = ActionPipeline::new(executor, serial());
+        let handle = pipeline.handle();
+
+        handle.submit(decision(13, ActionType::Kill)).await.unwrap();
+        handle.submit(decision(13, ActionType::Kill)).await.unwrap();
+        drop(handle);
+
+        let stats = pipeline.stats().clone();
+        pipeline.close().await;
+
+        assert_eq!(stats.failed.load(Ordering::Relaxed), 2);
+        assert_eq!(stats.deduplicated.load(Ordering::Relaxed), 0);
+        assert_eq!(stats.detect_to_enforce_ns.count(), 0);
+    }
+}
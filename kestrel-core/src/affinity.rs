@@ -0,0 +1,168 @@
+//! CPU affinity and core placement
+//!
+//! Used by the thread-per-core EventBus mode to pin each partition thread
+//! to its own core. Pinning is only implemented on Linux; elsewhere it is a
+//! no-op so the same configuration runs unpinned.
+
+use std::io;
+
+/// CPUs the current process may run on
+pub fn allowed_cpus() -> Vec<usize> {
+    #[cfg(target_os = "linux")]
+    {
+        // SAFETY: `cpu_set_t` is plain data and is fully written by the call
+        unsafe {
+            let mut set: libc::cpu_set_t = std::mem::zeroed();
+            if libc::sched_getaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &mut set) == 0 {
+                let cpus: Vec<usize> = (0..libc::CPU_SETSIZE as usize)
+                    .filter(|&cpu| libc::CPU_ISSET(cpu, &set))
+                    .collect();
+                if !cpus.is_empty() {
+                    return cpus;
+                }
+            }
+        }
+    }
+
+    let count = std::thread::available_parallelism().map_or(1, |n| n.get());
+    (0..count).collect()
+}
+
+/// CPUs of each NUMA node, from sysfs; empty if the topology is unknown
+pub fn numa_nodes() -> Vec<Vec<usize>> {
+    let Ok(entries) = std::fs::read_dir("/sys/devices/system/node") else {
+        return Vec::new();
+    };
+
+    let mut nodes: Vec<(usize, Vec<usize>)> = entries
+        .filter_map(|entry| {
+            let entry = entry.ok()?;
+            let name = entry.file_name();
+            let id = name.to_str()?.strip_prefix("node")?.parse().ok()?;
+            let cpulist = std::fs::read_to_string(entry.path().join("cpulist")).ok()?;
+            Some((id, parse_cpu_list(&cpulist)))
+        })
+        .filter(|(_, cpus)| !cpus.is_empty())
+        .collect();
+    nodes.sort_by_key(|(id, _)| *id);
+    nodes.into_iter().map(|(_, cpus)| cpus).collect()
+}
+
+/// Parse a kernel CPU list such as `0-3,8,10-11`
+pub fn parse_cpu_list(list: &str) -> Vec<usize> {
+    let mut cpus = Vec::new();
+    for part in list.trim().split(',').filter(|p| !p.is_empty()) {
+        match part.split_once('-') {
+            Some((start, end)) => {
+                if let (Ok(start), Ok(end)) = (start.parse::<usize>(), end.parse::<usize>()) {
+                    cpus.extend(start..=end);
+                }
+            }
+            None => {
+                if let Ok(cpu) = part.parse() {
+                    cpus.push(cpu);
+                }
+            }
+        }
+    }
+    cpus
+}
+
+/// Choose a core for each of `partitions` threads
+///
+/// Cores are taken from `allowed`. With `numa_aware`, consecutive
+/// partitions alternate between NUMA nodes so load and memory spread
+/// evenly across nodes; otherwise cores are used in order. Cores are reused
+/// round-robin when there are more partitions than cores.
+pub fn plan_cores(
+    partitions: usize,
+    allowed: &[usize],
+    nodes: &[Vec<usize>],
+    numa_aware: bool,
+) -> Vec<usize> {
+    if allowed.is_empty() {
+        return Vec::new();
+    }
+
+    let mut order: Vec<usize> = Vec::with_capacity(allowed.len());
+    if numa_aware && nodes.len() > 1 {
+        let per_node: Vec<Vec<usize>> = nodes
+            .iter()
+            .map(|node| {
+                node.iter()
+                    .copied()
+                    .filter(|c| allowed.contains(c))
+                    .collect()
+            })
+            .filter(|node: &Vec<usize>| !node.is_empty())
+            .collect();
+        let longest = per_node.iter().map(Vec::len).max().unwrap_or(0);
+        for i in 0..longest {
+            order.extend(per_node.iter().filter_map(|node| node.get(i)));
+        }
+    }
+    if order.is_empty() {
+        order.extend_from_slice(allowed);
+    }
+
+    (0..partitions).map(|p| order[p % order.len()]).collect()
+}
+
+/// Pin the calling thread to `cpu`
+pub fn pin_current_thread(cpu: usize) -> io::Result<()> {
+    #[cfg(target_os = "linux")]
+    {
+        if cpu >= libc::CPU_SETSIZE as usize {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                format!("CPU {} out of range", cpu),
+            ));
+        }
+        // SAFETY: `cpu_set_t` is plain data and `cpu` is within its bounds
+        unsafe {
+            let mut set: libc::cpu_set_t = std::mem::zeroed();
+            libc::CPU_SET(cpu, &mut set);
+            if libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set) != 0 {
+                return Err(io::Error::last_os_error());
+            }
+        }
+        Ok(())
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    {
+        let _ = cpu;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_cpu_list() {
+        assert_eq!(parse_cpu_list("0-3,8,10-11\n"), vec![0, 1, 2, 3, 8, 10, 11]);
+        assert_eq!(parse_cpu_list(""), Vec::<usize>::new());
+    }
+
+    #[test]
+    fn test_plan_cores() {
+        let allowed = [0, 1, 2, 3, 4, 5, 6, 7];
+        let nodes = vec![vec![0, 1, 2, 3], vec![4, 5, 6, 7]];
+
+        assert_eq!(plan_cores(3, &allowed, &nodes, false), vec![0, 1, 2]);
+        assert_eq!(plan_cores(4, &allowed, &nodes, true), vec![0, 4, 1, 5]);
+
+        // Disallowed cores are skipped and cores wrap around
+        assert_eq!(plan_cores(3, &[2, 6], &nodes, true), vec![2, 6, 2]);
+    }
+
+    #[test]
+    fn test_pin_current_thread() {
+        let cpu = allowed_cpus()[0];
+        std::thread::spawn(move || pin_current_thread(cpu).unwrap())
+            .join()
+            .unwrap();
+    }
+}
@@ -1,13 +1,34 @@
 //! Alert System
 //!
 //! This module handles alert generation and output.
+//!
+//! The output task drains alerts from its channel in batches and hands
+//! them to a blocking writer task, so file writes, rotation and fsync never
+//! run on a runtime worker. The writer encodes each batch into one reused
+//! buffer. File output keeps the file open, writes every batch with a
+//! single call, rotates by size or age and fsyncs on an interval. Stdout
+//! output is handed to a dedicated thread through a bounded queue, so a
+//! slow terminal or pipe drops stdout copies instead of stalling the file
+//! sink or the producers.
+//!
+//! With `dedup` configured, repeats of an alert (same rule, entity and
+//! capture fields) within a time window are suppressed before encoding;
+//! when the window closes, one summary alert carries the number of
+//! suppressed repeats and their first and last timestamps.
 
+use crate::time::coarse_monotonic_ns;
 use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::fs::File;
 use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
 
 use thiserror::Error;
 use tokio::sync::mpsc;
-use tracing::{debug, error};
+use tracing::{debug, error, warn};
 
 /// Alert record
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -59,6 +80,237 @@ pub struct EventEvidence {
     pub fields: Vec<(String, serde_json::Value)>,
 }
 
+/// Encoder turning alerts into bytes for an output sink
+pub trait AlertEncoder: Send {
+    /// Bytes written at the start of every output file
+    fn header(&self) -> &[u8] {
+        &[]
+    }
+
+    /// Append one encoded alert to `out`
+    fn encode(&mut self, alert: &Alert, out: &mut Vec<u8>) -> Result<(), AlertError>;
+}
+
+/// One compact JSON object per line
+#[derive(Debug, Default, Clone, Copy)]
+pub struct JsonLinesEncoder;
+
+impl AlertEncoder for JsonLinesEncoder {
+    fn encode(&mut self, alert: &Alert, out: &mut Vec<u8>) -> Result<(), AlertError> {
+        serde_json::to_writer(&mut *out, alert)
+            .map_err(|e| AlertError::SerializationError(e.to_string()))?;
+        out.push(b'\n');
+        Ok(())
+    }
+}
+
+/// Magic and version at the start of binary alert files
+pub const BINARY_ALERT_MAGIC: &[u8; 5] = b"KALT\x01";
+
+/// Length-prefixed binary records
+///
+/// Each record is a little-endian `u32` length followed by the alert's
+/// fields in declaration order: strings as `u32` length plus UTF-8 bytes,
+/// severity as one byte, the description behind a presence byte, and the
+/// evidence fields and context as JSON text. `decode_binary_alerts` reads
+/// it back.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct BinaryEncoder;
+
+fn put_str(out: &mut Vec<u8>, value: &str) {
+    out.extend_from_slice(&(value.len() as u32).to_le_bytes());
+    out.extend_from_slice(value.as_bytes());
+}
+
+fn put_json<T: Serialize>(out: &mut Vec<u8>, value: &T) -> Result<(), AlertError> {
+    let len_at = out.len();
+    out.extend_from_slice(&[0; 4]);
+    serde_json::to_writer(&mut *out, value)
+        .map_err(|e| AlertError::SerializationError(e.to_string()))?;
+    let len = (out.len() - len_at - 4) as u32;
+    out[len_at..len_at + 4].copy_from_slice(&len.to_le_bytes());
+    Ok(())
+}
+
+fn severity_code(severity: Severity) -> u8 {
+    match severity {
+        Severity::Informational => 0,
+        Severity::Low => 1,
+        Severity::Medium => 2,
+        Severity::High => 3,
+        Severity::Critical => 4,
+    }
+}
+
+impl AlertEncoder for BinaryEncoder {
+    fn header(&self) -> &[u8] {
+        BINARY_ALERT_MAGIC
+    }
+
+    fn encode(&mut self, alert: &Alert, out: &mut Vec<u8>) -> Result<(), AlertError> {
+        let start = out.len();
+        out.extend_from_slice(&[0; 4]);
+
+        put_str(out, &alert.id);
+        put_str(out, &alert.rule_id);
+        put_str(out, &alert.rule_name);
+        out.push(severity_code(alert.severity));
+        out.extend_from_slice(&alert.timestamp_ns.to_le_bytes());
+        put_str(out, &alert.title);
+        match &alert.description {
+            Some(description) => {
+                out.push(1);
+                put_str(out, description);
+            }
+            None => out.push(0),
+        }
+        out.extend_from_slice(&(alert.events.len() as u32).to_le_bytes());
+        for event in &alert.events {
+            out.extend_from_slice(&event.event_type_id.to_le_bytes());
+            out.extend_from_slice(&event.timestamp_ns.to_le_bytes());
+            put_json(out, &event.fields)?;
+        }
+        put_json(out, &alert.context)?;
+
+        let len = (out.len() - start - 4) as u32;
+        out[start..start + 4].copy_from_slice(&len.to_le_bytes());
+        Ok(())
+    }
+}
+
+/// Cursor over one binary record
+struct BinaryReader<'a> {
+    bytes: &'a [u8],
+}
+
+impl<'a> BinaryReader<'a> {
+    fn take(&mut self, len: usize) -> Result<&'a [u8], AlertError> {
+        if self.bytes.len() < len {
+            return Err(AlertError::SerializationError(
+                "truncated binary alert".to_string(),
+            ));
+        }
+        let (head, rest) = self.bytes.split_at(len);
+        self.bytes = rest;
+        Ok(head)
+    }
+
+    fn u8(&mut self) -> Result<u8, AlertError> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u16(&mut self) -> Result<u16, AlertError> {
+        Ok(u16::from_le_bytes(self.take(2)?.try_into().unwrap()))
+    }
+
+    fn u32(&mut self) -> Result<u32, AlertError> {
+        Ok(u32::from_le_bytes(self.take(4)?.try_into().unwrap()))
+    }
+
+    fn u64(&mut self) -> Result<u64, AlertError> {
+        Ok(u64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn string(&mut self) -> Result<String, AlertError> {
+        let len = self.u32()? as usize;
+        String::from_utf8(self.take(len)?.to_vec())
+            .map_err(|e| AlertError::SerializationError(e.to_string()))
+    }
+
+    fn json<T: serde::de::DeserializeOwned>(&mut self) -> Result<T, AlertError> {
+        let len = self.u32()? as usize;
+        serde_json::from_slice(self.take(len)?)
+            .map_err(|e| AlertError::SerializationError(e.to_string()))
+    }
+
+    fn alert(&mut self) -> Result<Alert, AlertError> {
+        let id = self.string()?;
+        let rule_id = self.string()?;
+        let rule_name = self.string()?;
+        let severity = match self.u8()? {
+            0 => Severity::Informational,
+            1 => Severity::Low,
+            2 => Severity::Medium,
+            3 => Severity::High,
+            4 => Severity::Critical,
+            code => {
+                return Err(AlertError::SerializationError(format!(
+                    "unknown severity code {}",
+                    code
+                )))
+            }
+        };
+        let timestamp_ns = self.u64()?;
+        let title = self.string()?;
+        let description = match self.u8()? {
+            0 => None,
+            _ => Some(self.string()?),
+        };
+        let event_count = self.u32()?;
+        let mut events = Vec::with_capacity(event_count.min(1024) as usize);
+        for _ in 0..event_count {
+            events.push(EventEvidence {
+                event_type_id: self.u16()?,
+                timestamp_ns: self.u64()?,
+                fields: self.json()?,
+            });
+        }
+        let context = self.json()?;
+
+        Ok(Alert {
+            id,
+            rule_id,
+            rule_name,
+            severity,
+            timestamp_ns,
+            title,
+            description,
+            events,
+            context,
+        })
+    }
+}
+
+/// Decode the contents of a file written with `AlertEncoding::Binary`
+pub fn decode_binary_alerts(bytes: &[u8]) -> Result<Vec<Alert>, AlertError> {
+    let mut reader = BinaryReader { bytes };
+    if reader.take(BINARY_ALERT_MAGIC.len())? != BINARY_ALERT_MAGIC {
+        return Err(AlertError::SerializationError(
+            "not a binary alert file".to_string(),
+        ));
+    }
+
+    let mut alerts = Vec::new();
+    while !reader.bytes.is_empty() {
+        let len = reader.u32()? as usize;
+        let mut record = BinaryReader {
+            bytes: reader.take(len)?,
+        };
+        alerts.push(record.alert()?);
+    }
+    Ok(alerts)
+}
+
+/// Built-in alert encodings
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum AlertEncoding {
+    /// Compact JSON, one alert per line
+    #[default]
+    JsonLines,
+
+    /// Length-prefixed binary records
+    Binary,
+}
+
+impl AlertEncoding {
+    pub fn encoder(self) -> Box<dyn AlertEncoder> {
+        match self {
+            AlertEncoding::JsonLines => Box::new(JsonLinesEncoder),
+            AlertEncoding::Binary => Box::new(BinaryEncoder),
+        }
+    }
+}
+
 /// Alert output configuration
 #[derive(Debug, Clone)]
 pub struct AlertOutputConfig {
@@ -70,6 +322,30 @@ pub struct AlertOutputConfig {
 
     /// Channel size for alert buffering
     pub channel_size: usize,
+
+    /// Encoding of the output file (stdout always gets JSON lines)
+    pub encoding: AlertEncoding,
+
+    /// Most alerts encoded and written together
+    pub batch_size: usize,
+
+    /// Rotate the file once it reaches this size
+    pub rotate_bytes: Option<u64>,
+
+    /// Rotate the file once it has been open this long
+    pub rotate_interval: Option<Duration>,
+
+    /// Rotated files kept as `<file>.1` (newest) to `<file>.N`
+    pub max_rotated_files: usize,
+
+    /// How often written alerts are fsynced (None = leave it to the OS)
+    pub fsync_interval: Option<Duration>,
+
+    /// Encoded batches queued for the stdout thread before copies are dropped
+    pub stdout_queue: usize,
+
+    /// Suppress and aggregate repeated alerts (None = output every alert)
+    pub dedup: Option<AlertDedupConfig>,
 }
 
 impl Default for AlertOutputConfig {
@@ -78,8 +354,243 @@ impl Default for AlertOutputConfig {
             stdout: true,
             file: None,
             channel_size: 1000,
+            encoding: AlertEncoding::JsonLines,
+            batch_size: 256,
+            rotate_bytes: Some(256 * 1024 * 1024),
+            rotate_interval: None,
+            max_rotated_files: 5,
+            fsync_interval: Some(Duration::from_secs(1)),
+            stdout_queue: 64,
+            dedup: None,
+        }
+    }
+}
+
+/// Alert output counters
+#[derive(Debug, Default)]
+pub struct AlertOutputStats {
+    pub alerts_written: AtomicU64,
+    pub batches_written: AtomicU64,
+    pub bytes_written: AtomicU64,
+    pub rotations: AtomicU64,
+    pub fsyncs: AtomicU64,
+    pub write_errors: AtomicU64,
+    /// Alerts not printed because the stdout thread fell behind
+    pub stdout_dropped: AtomicU64,
+    /// Repeated alerts folded into a summary by deduplication
+    pub alerts_suppressed: AtomicU64,
+}
+
+/// Alert deduplication configuration
+#[derive(Debug, Clone)]
+pub struct AlertDedupConfig {
+    /// How long repeats of an alert are folded into one summary
+    pub window: Duration,
+
+    /// JSON pointers into the alert context that, with the rule id, make
+    /// up the dedup key (e.g. "/entity_key", "/captures/process.pid");
+    /// alerts missing any of them are never suppressed
+    pub key_fields: Vec<String>,
+
+    /// Most open windows; beyond it, alerts with new keys pass through
+    pub max_keys: usize,
+}
+
+impl Default for AlertDedupConfig {
+    fn default() -> Self {
+        Self {
+            window: Duration::from_secs(60),
+            key_fields: vec!["/entity_key".to_string()],
+            max_keys: 65536,
+        }
+    }
+}
+
+/// Open dedup window for one key
+///
+/// Keeps only the fields of the opening alert that the summary carries;
+/// its evidence and description were already emitted with it.
+struct DedupGroup {
+    id: String,
+    rule_id: String,
+    rule_name: String,
+    severity: Severity,
+    title: String,
+    context: serde_json::Value,
+    /// Repeats suppressed since, and the range of their timestamps
+    suppressed: u64,
+    first_timestamp_ns: u64,
+    last_timestamp_ns: u64,
+    /// Monotonic time the window opened
+    opened: u64,
+}
+
+impl DedupGroup {
+    fn suppress(&mut self, timestamp_ns: u64) {
+        if self.suppressed == 0 {
+            self.first_timestamp_ns = timestamp_ns;
+            self.last_timestamp_ns = timestamp_ns;
+        } else {
+            self.first_timestamp_ns = self.first_timestamp_ns.min(timestamp_ns);
+            self.last_timestamp_ns = self.last_timestamp_ns.max(timestamp_ns);
+        }
+        self.suppressed += 1;
+    }
+
+    fn open(alert: &Alert, now: u64) -> Self {
+        Self {
+            id: alert.id.clone(),
+            rule_id: alert.rule_id.clone(),
+            rule_name: alert.rule_name.clone(),
+            severity: alert.severity,
+            title: alert.title.clone(),
+            context: alert.context.clone(),
+            suppressed: 0,
+            first_timestamp_ns: 0,
+            last_timestamp_ns: 0,
+            opened: now,
+        }
+    }
+
+    /// Summary of the suppressed repeats under `context.aggregation`
+    ///
+    /// The count and timestamps cover only the repeats, not the alert that
+    /// opened the window.
+    fn summary(self) -> Alert {
+        let mut alert = Alert {
+            id: format!("{}-x{}", self.id, self.suppressed),
+            rule_id: self.rule_id,
+            rule_name: self.rule_name,
+            severity: self.severity,
+            timestamp_ns: self.last_timestamp_ns,
+            title: self.title,
+            description: None,
+            events: Vec::new(),
+            context: self.context,
+        };
+        let aggregation = serde_json::json!({
+            "suppressed": self.suppressed,
+            "first_timestamp_ns": self.first_timestamp_ns,
+            "last_timestamp_ns": self.last_timestamp_ns,
+        });
+        match &mut alert.context {
+            serde_json::Value::Object(context) => {
+                context.insert("aggregation".to_string(), aggregation);
+            }
+            context => {
+                let original = context.take();
+                *context = serde_json::json!({ "original": original, "aggregation": aggregation });
+            }
+        }
+        alert
+    }
+}
+
+/// Suppresses repeated alerts and aggregates them per time window
+///
+/// The first alert for a key passes through at once. Repeats within the
+/// window are counted, and when the window closes a summary is emitted if
+/// there were any. Alerts whose context lacks a key field pass through
+/// untouched, so unrelated entities are never folded together. Windows are
+/// measured on arrival time so quiet keys are still flushed; the summary's
+/// timestamps come from the alerts.
+pub struct AlertDeduplicator {
+    config: AlertDedupConfig,
+    groups: HashMap<String, DedupGroup>,
+    key: String,
+}
+
+impl AlertDeduplicator {
+    pub fn new(config: AlertDedupConfig) -> Self {
+        Self {
+            config,
+            groups: HashMap::new(),
+            key: String::new(),
         }
     }
+
+    /// Number of open windows
+    pub fn open_windows(&self) -> usize {
+        self.groups.len()
+    }
+
+    /// Build the alert's key, or return false if a key field is missing
+    fn build_key(&mut self, alert: &Alert) -> bool {
+        use std::fmt::Write as _;
+
+        self.key.clear();
+        self.key.push_str(&alert.rule_id);
+        for field in &self.config.key_fields {
+            let Some(value) = alert.context.pointer(field) else {
+                return false;
+            };
+            self.key.push('\u{1f}');
+            let _ = write!(self.key, "{}", value);
+        }
+        true
+    }
+
+    /// Pass `alert` through to `out` unless it repeats an open window
+    ///
+    /// `now` is monotonic nanoseconds, e.g. `coarse_monotonic_ns`. Returns
+    /// false if the alert was suppressed.
+    pub fn observe(&mut self, alert: Alert, now: u64, out: &mut Vec<Alert>) -> bool {
+        if !self.build_key(&alert) {
+            out.push(alert);
+            return true;
+        }
+        let window = self.config.window.as_nanos() as u64;
+
+        if let Some(group) = self.groups.get_mut(self.key.as_str()) {
+            if now.saturating_sub(group.opened) < window {
+                group.suppress(alert.timestamp_ns);
+                return false;
+            }
+            let expired = self.groups.remove(self.key.as_str()).unwrap();
+            if expired.suppressed > 0 {
+                out.push(expired.summary());
+            }
+        } else if self.groups.len() >= self.config.max_keys {
+            self.flush_expired(now, out);
+            if self.groups.len() >= self.config.max_keys {
+                out.push(alert);
+                return true;
+            }
+        }
+
+        self.groups
+            .insert(self.key.clone(), DedupGroup::open(&alert, now));
+        out.push(alert);
+        true
+    }
+
+    /// Close windows older than the configured window, emitting summaries
+    pub fn flush_expired(&mut self, now: u64, out: &mut Vec<Alert>) {
+        let window = self.config.window.as_nanos() as u64;
+        let expired: Vec<String> = self
+            .groups
+            .iter()
+            .filter(|(_, group)| now.saturating_sub(group.opened) >= window)
+            .map(|(key, _)| key.clone())
+            .collect();
+        for key in expired {
+            let group = self.groups.remove(&key).unwrap();
+            if group.suppressed > 0 {
+                out.push(group.summary());
+            }
+        }
+    }
+
+    /// Close every window, emitting summaries
+    pub fn flush_all(&mut self, out: &mut Vec<Alert>) {
+        out.extend(
+            self.groups
+                .drain()
+                .map(|(_, group)| group)
+                .filter(|group| group.suppressed > 0)
+                .map(DedupGroup::summary),
+        );
+    }
 }
 
 /// Alert output handle
@@ -108,40 +619,374 @@ impl AlertHandle {
     }
 }
 
+/// Open alert file with size and age based rotation
+struct AlertFile {
+    path: PathBuf,
+    file: File,
+    written: u64,
+    opened_at: Instant,
+    dirty: bool,
+}
+
+impl AlertFile {
+    fn open(path: &Path, header: &[u8]) -> std::io::Result<Self> {
+        let mut file = std::fs::OpenOptions::new()
+            .create(true)
+            .append(true)
+            .open(path)?;
+        let mut written = file.metadata()?.len();
+        if written == 0 && !header.is_empty() {
+            file.write_all(header)?;
+            written = header.len() as u64;
+        }
+        Ok(Self {
+            path: path.to_path_buf(),
+            file,
+            written,
+            opened_at: Instant::now(),
+            dirty: false,
+        })
+    }
+
+    fn needs_rotation(&self, config: &AlertOutputConfig) -> bool {
+        config
+            .rotate_bytes
+            .is_some_and(|limit| self.written >= limit)
+            || config
+                .rotate_interval
+                .is_some_and(|interval| self.opened_at.elapsed() >= interval)
+    }
+
+    /// Shift `<file>.N-1` to `<file>.N`, the live file to `<file>.1`, reopen
+    fn rotate(&mut self, config: &AlertOutputConfig, header: &[u8]) -> std::io::Result<()> {
+        self.sync()?;
+        let rotated = |n: usize| {
+            let mut name = self.path.clone().into_os_string();
+            name.push(format!(".{}", n));
+            PathBuf::from(name)
+        };
+
+        if config.max_rotated_files == 0 {
+            std::fs::remove_file(&self.path)?;
+        } else {
+            for n in (1..config.max_rotated_files).rev() {
+                let from = rotated(n);
+                if from.exists() {
+                    std::fs::rename(&from, rotated(n + 1))?;
+                }
+            }
+            std::fs::rename(&self.path, rotated(1))?;
+        }
+
+        *self = Self::open(&self.path, header)?;
+        Ok(())
+    }
+
+    fn write(&mut self, bytes: &[u8]) -> std::io::Result<()> {
+        self.file.write_all(bytes)?;
+        self.written += bytes.len() as u64;
+        self.dirty = true;
+        Ok(())
+    }
+
+    fn sync(&mut self) -> std::io::Result<bool> {
+        if !self.dirty {
+            return Ok(false);
+        }
+        self.file.sync_data()?;
+        self.dirty = false;
+        Ok(true)
+    }
+}
+
+/// Batches queued for the writer task before the output task waits
+const WRITER_QUEUE: usize = 8;
+
+/// Work for the blocking writer task
+enum WriterCommand {
+    /// Encode and write a batch; the emptied batch is sent back for reuse
+    Write(Vec<Alert>),
+    /// fsync the file if it has unsynced writes
+    Sync,
+}
+
+/// Encodes batches and writes them to the configured sinks
+struct AlertWriter {
+    config: AlertOutputConfig,
+    encoder: Box<dyn AlertEncoder>,
+    file: Option<AlertFile>,
+    buffer: Vec<u8>,
+    stdout: Option<std::sync::mpsc::SyncSender<Vec<u8>>>,
+    /// Encoded batches returned by the stdout thread for reuse
+    stdout_buffers: std::sync::mpsc::Receiver<Vec<u8>>,
+    stats: Arc<AlertOutputStats>,
+}
+
+impl AlertWriter {
+    fn new(
+        config: AlertOutputConfig,
+        encoder: Box<dyn AlertEncoder>,
+        stats: Arc<AlertOutputStats>,
+    ) -> Self {
+        let file =
+            config
+                .file
+                .as_deref()
+                .and_then(|path| match AlertFile::open(path, encoder.header()) {
+                    Ok(file) => Some(file),
+                    Err(e) => {
+                        error!(path = %path.display(), error = %e, "Failed to open alert file");
+                        None
+                    }
+                });
+
+        let (recycle, stdout_buffers) = std::sync::mpsc::channel();
+        let stdout = config.stdout.then(|| Self::spawn_stdout(&config, recycle));
+
+        Self {
+            config,
+            encoder,
+            file,
+            buffer: Vec::new(),
+            stdout,
+            stdout_buffers,
+            stats,
+        }
+    }
+
+    fn spawn_stdout(
+        config: &AlertOutputConfig,
+        recycle: std::sync::mpsc::Sender<Vec<u8>>,
+    ) -> std::sync::mpsc::SyncSender<Vec<u8>> {
+        let (sender, receiver) = std::sync::mpsc::sync_channel::<Vec<u8>>(config.stdout_queue);
+        let spawned = std::thread::Builder::new()
+            .name("kestrel-alert-stdout".to_string())
+            .spawn(move || {
+                let stdout = std::io::stdout();
+                for mut batch in receiver {
+                    let mut out = stdout.lock();
+                    if out.write_all(&batch).and_then(|_| out.flush()).is_err() {
+                        break;
+                    }
+                    batch.clear();
+                    let _ = recycle.send(batch);
+                }
+            });
+        if let Err(e) = spawned {
+            error!(error = %e, "Failed to start alert stdout thread");
+        }
+        sender
+    }
+
+    fn write_batch(&mut self, batch: &[Alert]) {
+        if let Some(stdout) = &self.stdout {
+            let mut lines = self.stdout_buffers.try_recv().unwrap_or_default();
+            for alert in batch {
+                let _ = JsonLinesEncoder.encode(alert, &mut lines);
+            }
+            if stdout.try_send(lines).is_err() {
+                self.stats
+                    .stdout_dropped
+                    .fetch_add(batch.len() as u64, Ordering::Relaxed);
+            }
+        }
+
+        let Some(file) = self.file.as_mut() else {
+            return;
+        };
+
+        self.buffer.clear();
+        let mut encoded = 0;
+        for alert in batch {
+            match self.encoder.encode(alert, &mut self.buffer) {
+                Ok(()) => encoded += 1,
+                Err(e) => error!(alert_id = %alert.id, error = %e, "Failed to encode alert"),
+            }
+        }
+
+        match file.write(&self.buffer) {
+            Ok(()) => {
+                self.stats
+                    .alerts_written
+                    .fetch_add(encoded, Ordering::Relaxed);
+                self.stats.batches_written.fetch_add(1, Ordering::Relaxed);
+                self.stats
+                    .bytes_written
+                    .fetch_add(self.buffer.len() as u64, Ordering::Relaxed);
+            }
+            Err(e) => {
+                self.stats.write_errors.fetch_add(1, Ordering::Relaxed);
+                error!(path = %file.path.display(), error = %e, "Failed to write alerts to file");
+            }
+        }
+
+        if file.needs_rotation(&self.config) {
+            match file.rotate(&self.config, self.encoder.header()) {
+                Ok(()) => {
+                    self.stats.rotations.fetch_add(1, Ordering::Relaxed);
+                }
+                Err(e) => {
+                    self.stats.write_errors.fetch_add(1, Ordering::Relaxed);
+                    error!(path = %file.path.display(), error = %e, "Failed to rotate alert file");
+                }
+            }
+        }
+    }
+
+    fn sync(&mut self) {
+        if let Some(file) = self.file.as_mut() {
+            match file.sync() {
+                Ok(true) => {
+                    self.stats.fsyncs.fetch_add(1, Ordering::Relaxed);
+                }
+                Ok(false) => {}
+                Err(e) => warn!(path = %file.path.display(), error = %e, "Failed to fsync alerts"),
+            }
+        }
+    }
+
+    /// Run commands until the output task hangs up, then fsync
+    fn run(
+        mut self,
+        mut commands: mpsc::Receiver<WriterCommand>,
+        recycle: std::sync::mpsc::Sender<Vec<Alert>>,
+    ) {
+        while let Some(command) = commands.blocking_recv() {
+            match command {
+                WriterCommand::Write(mut batch) => {
+                    self.write_batch(&batch);
+                    batch.clear();
+                    let _ = recycle.send(batch);
+                }
+                WriterCommand::Sync => self.sync(),
+            }
+        }
+        self.sync();
+    }
+}
+
+/// Swap `alerts` for an empty batch returned by the writer, to send it
+fn take_batch(
+    alerts: &mut Vec<Alert>,
+    recycled: &std::sync::mpsc::Receiver<Vec<Alert>>,
+) -> WriterCommand {
+    let empty = recycled
+        .try_recv()
+        .unwrap_or_else(|_| Vec::with_capacity(alerts.capacity()));
+    WriterCommand::Write(std::mem::replace(alerts, empty))
+}
+
+/// Wait for the timer's next tick, or forever without a timer
+async fn next_tick(timer: &mut Option<tokio::time::Interval>) {
+    match timer {
+        Some(timer) => {
+            timer.tick().await;
+        }
+        None => std::future::pending().await,
+    }
+}
+
 /// Alert output system
 pub struct AlertOutput {
-    _handle: tokio::task::JoinHandle<()>,
+    task: tokio::task::JoinHandle<()>,
     handle: AlertHandle,
+    stats: Arc<AlertOutputStats>,
 }
 
 impl AlertOutput {
     /// Create a new alert output system
     pub fn new(config: AlertOutputConfig) -> Self {
+        let encoder = config.encoding.encoder();
+        Self::with_encoder(config, encoder)
+    }
+
+    /// Create an alert output system writing its file with `encoder`
+    pub fn with_encoder(config: AlertOutputConfig, encoder: Box<dyn AlertEncoder>) -> Self {
         let (sender, mut receiver) = mpsc::channel(config.channel_size);
 
         let handle = AlertHandle { sender };
+        let stats = Arc::new(AlertOutputStats::default());
+        let batch_size = config.batch_size.max(1);
+        let timer = |interval: Duration| {
+            let mut timer = tokio::time::interval(interval);
+            timer.set_missed_tick_behavior(tokio::time::MissedTickBehavior::Delay);
+            timer
+        };
+        let mut sync_timer = config.fsync_interval.map(timer);
+        // Windows close within a quarter window (at most a second) of expiry
+        let mut dedup_timer = config.dedup.as_ref().map(|dedup| {
+            timer((dedup.window / 4).clamp(Duration::from_millis(1), Duration::from_secs(1)))
+        });
+        let mut dedup = config.dedup.clone().map(AlertDeduplicator::new);
 
-        let _handle = tokio::spawn(async move {
-            while let Some(alert) = receiver.recv().await {
-                if config.stdout {
-                    Self::output_stdout(&alert);
-                }
+        // Opening, writing, rotating and syncing the file all block
+        let (writes, commands) = mpsc::channel(WRITER_QUEUE);
+        let (recycle, recycled) = std::sync::mpsc::channel();
+        let writer_stats = stats.clone();
+        let writer = tokio::task::spawn_blocking(move || {
+            AlertWriter::new(config, encoder, writer_stats).run(commands, recycle)
+        });
+
+        let task_stats = stats.clone();
+        let task = tokio::spawn(async move {
+            let stats = task_stats;
+            let mut batch = Vec::with_capacity(batch_size);
+            let mut unique = Vec::with_capacity(batch_size);
 
-                if let Some(ref path) = config.file {
-                    if let Err(e) = Self::output_file(&alert, path) {
-                        error!(
-                            path = %path.display(),
-                            error = %e,
-                            "Failed to write alert to file"
-                        );
+            loop {
+                tokio::select! {
+                    received = receiver.recv_many(&mut batch, batch_size) => {
+                        if received == 0 {
+                            break;
+                        }
+                        match dedup.as_mut() {
+                            Some(dedup) => {
+                                let now = coarse_monotonic_ns();
+                                for alert in batch.drain(..) {
+                                    if !dedup.observe(alert, now, &mut unique) {
+                                        stats.alerts_suppressed.fetch_add(1, Ordering::Relaxed);
+                                    }
+                                }
+                                if !unique.is_empty() {
+                                    let _ = writes.send(take_batch(&mut unique, &recycled)).await;
+                                }
+                            }
+                            None => {
+                                let _ = writes.send(take_batch(&mut batch, &recycled)).await;
+                            }
+                        }
+                    }
+                    _ = next_tick(&mut dedup_timer) => {
+                        if let Some(dedup) = dedup.as_mut() {
+                            dedup.flush_expired(coarse_monotonic_ns(), &mut unique);
+                            if !unique.is_empty() {
+                                let _ = writes.send(take_batch(&mut unique, &recycled)).await;
+                            }
+                        }
+                    }
+                    _ = next_tick(&mut sync_timer) => {
+                        let _ = writes.send(WriterCommand::Sync).await;
                     }
                 }
             }
 
+            if let Some(dedup) = dedup.as_mut() {
+                dedup.flush_all(&mut unique);
+                if !unique.is_empty() {
+                    let _ = writes.send(take_batch(&mut unique, &recycled)).await;
+                }
+            }
+            // The writer fsyncs and exits once the queue is drained
+            drop(writes);
+            let _ = writer.await;
             debug!("Alert output system shutting down");
         });
 
-        Self { _handle, handle }
+        Self {
+            task,
+            handle,
+            stats,
+        }
     }
 
     /// Get a handle for emitting alerts
@@ -149,34 +994,17 @@ impl AlertOutput {
         self.handle.clone()
     }
 
-    /// Output alert to stdout
-    fn output_stdout(alert: &Alert) {
-        let json = serde_json::to_string_pretty(alert).unwrap_or_else(|_| {
-            format!(
-                "{{ \"error\": \"Failed to serialize alert {}\" }}",
-                alert.id
-            )
-        });
-        println!("{}", json);
+    /// Output counters
+    pub fn stats(&self) -> &Arc<AlertOutputStats> {
+        &self.stats
     }
 
-    /// Output alert to file
-    fn output_file(alert: &Alert, path: &std::path::Path) -> Result<(), AlertError> {
-        let json = serde_json::to_string_pretty(alert)
-            .map_err(|e: serde_json::Error| AlertError::SerializationError(e.to_string()))?;
-
-        let mut file = std::fs::OpenOptions::new()
-            .create(true)
-            .append(true)
-            .open(path)
-            .map_err(|e: std::io::Error| AlertError::IoError(e.to_string()))?;
-
-        file.write_all(json.as_bytes())
-            .map_err(|e: std::io::Error| AlertError::IoError(e.to_string()))?;
-        file.write_all(b"\n")
-            .map_err(|e: std::io::Error| AlertError::IoError(e.to_string()))?;
-
-        Ok(())
+    /// Write out queued alerts and stop
+    ///
+    /// Waits until every handle obtained from `handle` has been dropped.
+    pub async fn close(self) {
+        drop(self.handle);
+        let _ = self.task.await;
     }
 }
 
@@ -225,4 +1053,225 @@ mod tests {
         let result = handle.emit(alert).await;
         assert!(result.is_ok());
     }
+
+    fn test_dir(name: &str) -> PathBuf {
+        let dir = std::env::temp_dir().join(format!("alerts_{}_{}", name, std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        std::fs::create_dir_all(&dir).unwrap();
+        dir
+    }
+
+    fn test_alert(n: u64) -> Alert {
+        Alert {
+            id: format!("alert-{}", n),
+            rule_id: "rule-001".to_string(),
+            rule_name: "Test Rule".to_string(),
+            severity: Severity::Critical,
+            timestamp_ns: n,
+            title: "Test Alert".to_string(),
+            description: (n % 2 == 0).then(|| "even".to_string()),
+            events: vec![EventEvidence {
+                event_type_id: 7,
+                timestamp_ns: n,
+                fields: vec![("pid".to_string(), serde_json::json!(n))],
+            }],
+            context: serde_json::json!({ "n": n }),
+        }
+    }
+
+    #[tokio::test]
+    async fn test_json_lines_file_output() {
+        let dir = test_dir("jsonl");
+        let path = dir.join("alerts.jsonl");
+        let output = AlertOutput::new(AlertOutputConfig {
+            stdout: false,
+            file: Some(path.clone()),
+            ..Default::default()
+        });
+
+        let handle = output.handle();
+        for n in 0..100 {
+            handle.emit(test_alert(n)).await.unwrap();
+        }
+        drop(handle);
+        let stats = output.stats().clone();
+        output.close().await;
+
+        let contents = std::fs::read_to_string(&path).unwrap();
+        let ids: Vec<String> = contents
+            .lines()
+            .map(|line| serde_json::from_str::<Alert>(line).unwrap().id)
+            .collect();
+        assert_eq!(ids.len(), 100);
+        assert_eq!(ids[42], "alert-42");
+        assert_eq!(stats.alerts_written.load(Ordering::Relaxed), 100);
+        // Alerts queued together are written together
+        assert!(stats.batches_written.load(Ordering::Relaxed) < 100);
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    fn entity_alert(entity: u64, pid: u64, timestamp_ns: u64) -> Alert {
+        Alert {
+            context: serde_json::json!({
+                "entity_key": entity,
+                "captures": { "pid": pid },
+            }),
+            timestamp_ns,
+            ..test_alert(timestamp_ns)
+        }
+    }
+
+    #[test]
+    fn test_dedup_window() {
+        let mut dedup = AlertDeduplicator::new(AlertDedupConfig {
+            window: Duration::from_secs(10),
+            ..Default::default()
+        });
+        let start = coarse_monotonic_ns();
+        let mut out = Vec::new();
+
+        // Only the first of a burst for one entity passes
+        for ts in 0..5 {
+            dedup.observe(entity_alert(1, ts, 100 + ts), start, &mut out);
+        }
+        assert!(dedup.observe(entity_alert(2, 0, 200), start, &mut out));
+        assert_eq!(out.len(), 2);
+        assert_eq!(dedup.open_windows(), 2);
+
+        out.clear();
+        dedup.flush_expired(start + 5_000_000_000, &mut out);
+        assert!(out.is_empty());
+
+        // Closing the window emits one summary; single alerts need none
+        dedup.flush_expired(start + 10_000_000_000, &mut out);
+        assert_eq!(out.len(), 1);
+        // The summary covers the four repeats, not the alert already emitted
+        let aggregation = &out[0].context["aggregation"];
+        assert_eq!(aggregation["suppressed"], 4);
+        assert_eq!(aggregation["first_timestamp_ns"], 101);
+        assert_eq!(aggregation["last_timestamp_ns"], 104);
+        assert_eq!(out[0].timestamp_ns, 104);
+        assert_eq!(dedup.open_windows(), 0);
+    }
+
+    #[test]
+    fn test_dedup_capture_fields() {
+        let mut dedup = AlertDeduplicator::new(AlertDedupConfig {
+            key_fields: vec!["/entity_key".to_string(), "/captures/pid".to_string()],
+            ..Default::default()
+        });
+        let now = coarse_monotonic_ns();
+        let mut out = Vec::new();
+
+        assert!(dedup.observe(entity_alert(1, 10, 1), now, &mut out));
+        assert!(dedup.observe(entity_alert(1, 11, 2), now, &mut out));
+        assert!(!dedup.observe(entity_alert(1, 10, 3), now, &mut out));
+        assert_eq!(out.len(), 2);
+
+        out.clear();
+        dedup.flush_all(&mut out);
+        assert_eq!(out.len(), 1);
+        assert_eq!(out[0].context["captures"]["pid"], 10);
+    }
+
+    #[test]
+    fn test_dedup_skips_alerts_without_key() {
+        let mut dedup = AlertDeduplicator::new(AlertDedupConfig::default());
+        let now = coarse_monotonic_ns();
+        let mut out = Vec::new();
+
+        // No entity key: different entities must not share a window
+        for ts in 0..3 {
+            assert!(dedup.observe(test_alert(ts), now, &mut out));
+        }
+        assert_eq!(out.len(), 3);
+        assert_eq!(dedup.open_windows(), 0);
+    }
+
+    #[tokio::test]
+    async fn test_output_dedup() {
+        let dir = test_dir("dedup");
+        let path = dir.join("alerts.jsonl");
+        let output = AlertOutput::new(AlertOutputConfig {
+            stdout: false,
+            file: Some(path.clone()),
+            dedup: Some(AlertDedupConfig::default()),
+            ..Default::default()
+        });
+
+        let handle = output.handle();
+        for ts in 0..1000 {
+            handle.emit(entity_alert(7, 0, ts)).await.unwrap();
+        }
+        drop(handle);
+        let stats = output.stats().clone();
+        output.close().await;
+
+        let alerts: Vec<Alert> = std::fs::read_to_string(&path)
+            .unwrap()
+            .lines()
+            .map(|line| serde_json::from_str(line).unwrap())
+            .collect();
+        assert_eq!(alerts.len(), 2);
+        assert_eq!(alerts[1].context["aggregation"]["suppressed"], 999);
+        assert_eq!(stats.alerts_suppressed.load(Ordering::Relaxed), 999);
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_binary_encoding_roundtrip() {
+        let mut bytes = BINARY_ALERT_MAGIC.to_vec();
+        for n in 0..3 {
+            BinaryEncoder.encode(&test_alert(n), &mut bytes).unwrap();
+        }
+
+        let alerts = decode_binary_alerts(&bytes).unwrap();
+        assert_eq!(alerts.len(), 3);
+        assert_eq!(alerts[1].id, "alert-1");
+        assert_eq!(alerts[1].severity, Severity::Critical);
+        assert_eq!(alerts[1].description, None);
+        assert_eq!(alerts[2].description.as_deref(), Some("even"));
+        assert_eq!(alerts[2].events[0].fields[0].1, serde_json::json!(2));
+        assert_eq!(alerts[2].context, serde_json::json!({ "n": 2 }));
+
+        assert!(decode_binary_alerts(&bytes[..bytes.len() - 1]).is_err());
+    }
+
+    #[tokio::test]
+    async fn test_size_rotation() {
+        let dir = test_dir("rotation");
+        let path = dir.join("alerts.bin");
+        let output = AlertOutput::new(AlertOutputConfig {
+            stdout: false,
+            file: Some(path.clone()),
+            encoding: AlertEncoding::Binary,
+            batch_size: 1,
+            rotate_bytes: Some(512),
+            max_rotated_files: 2,
+            ..Default::default()
+        });
+
+        let handle = output.handle();
+        for n in 0..20 {
+            handle.emit(test_alert(n)).await.unwrap();
+        }
+        drop(handle);
+        let stats = output.stats().clone();
+        output.close().await;
+
+        assert!(stats.rotations.load(Ordering::Relaxed) > 2);
+        let rotated = |n: usize| dir.join(format!("alerts.bin.{}", n));
+        assert!(rotated(1).exists() && rotated(2).exists());
+        assert!(!rotated(3).exists());
+
+        // Every file starts with the header and holds whole records
+        let newest = decode_binary_alerts(&std::fs::read(&path).unwrap()).unwrap();
+        let previous = decode_binary_alerts(&std::fs::read(rotated(1)).unwrap()).unwrap();
+        let last_rotated = previous.last().unwrap().timestamp_ns;
+        assert!(newest.iter().all(|alert| alert.timestamp_ns > last_rotated));
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
 }
@@ -0,0 +1,227 @@
+//! Batch sizing for EventBus partition workers
+//!
+//! A worker either uses the fixed `batch_size` / `batch_timeout_ms` from
+//! `EventBusConfig`, or adapts both to traffic. The adaptive policy tracks
+//! the arrival rate and the per-event delivery cost and picks the largest
+//! batch whose fill time plus processing time still fits the latency SLO:
+//!
+//! ```text
+//! size / rate + size * cost <= slo  =>  size = slo / (1 / rate + cost)
+//! ```
+//!
+//! At low rates this degenerates to one-event batches delivered at once;
+//! at high rates batches grow to amortize per-batch overhead.
+
+use std::time::{Duration, Instant};
+
+/// Weight of the newest sample in the moving averages
+const EWMA_ALPHA: f64 = 0.2;
+
+/// Minimum window over which arrivals are turned into a rate sample
+const RATE_WINDOW: Duration = Duration::from_millis(1);
+
+/// Adaptive batching configuration
+#[derive(Debug, Clone)]
+pub struct AdaptiveBatchingConfig {
+    /// Target end-to-end delay from the ring to the end of delivery
+    pub latency_slo: Duration,
+
+    /// Lower bound for the chosen batch size
+    pub min_batch_size: usize,
+
+    /// Upper bound for the chosen batch size
+    pub max_batch_size: usize,
+}
+
+impl Default for AdaptiveBatchingConfig {
+    fn default() -> Self {
+        Self {
+            latency_slo: Duration::from_millis(5),
+            min_batch_size: 1,
+            max_batch_size: 4096,
+        }
+    }
+}
+
+/// Batch size and flush timeout for one partition worker
+#[derive(Debug)]
+pub(crate) enum BatchSizer {
+    Fixed { size: usize, timeout: Duration },
+    Adaptive(AdaptiveBatcher),
+}
+
+impl BatchSizer {
+    pub(crate) fn new(
+        batch_size: usize,
+        batch_timeout_ms: u64,
+        adaptive: Option<&AdaptiveBatchingConfig>,
+    ) -> Self {
+        match adaptive {
+            Some(config) => BatchSizer::Adaptive(AdaptiveBatcher::new(config.clone())),
+            None => BatchSizer::Fixed {
+                size: batch_size.max(1),
+                timeout: Duration::from_millis(batch_timeout_ms),
+            },
+        }
+    }
+
+    /// Current target batch size
+    pub(crate) fn size(&self) -> usize {
+        match self {
+            BatchSizer::Fixed { size, .. } => *size,
+            BatchSizer::Adaptive(batcher) => batcher.size(),
+        }
+    }
+
+    /// Longest time the oldest event of a partial batch may wait
+    pub(crate) fn timeout(&self) -> Duration {
+        match self {
+            BatchSizer::Fixed { timeout, .. } => *timeout,
+            BatchSizer::Adaptive(batcher) => batcher.timeout(),
+        }
+    }
+
+    /// Note `count` events drained from the ring
+    pub(crate) fn record_arrivals(&mut self, count: usize, now: Instant) {
+        if let BatchSizer::Adaptive(batcher) = self {
+            batcher.record_arrivals(count, now);
+        }
+    }
+
+    /// Note that a batch of `len` events took `elapsed` to deliver
+    pub(crate) fn record_delivery(&mut self, len: usize, elapsed: Duration) {
+        if let BatchSizer::Adaptive(batcher) = self {
+            batcher.record_delivery(len, elapsed);
+        }
+    }
+}
+
+/// Adaptive batch size controller
+#[derive(Debug)]
+pub(crate) struct AdaptiveBatcher {
+    config: AdaptiveBatchingConfig,
+    /// Moving average of arrivals per nanosecond
+    arrival_rate: f64,
+    /// Moving average of delivery cost per event (ns)
+    cost_per_event_ns: f64,
+    window_start: Instant,
+    window_arrivals: u64,
+    size: usize,
+}
+
+impl AdaptiveBatcher {
+    pub(crate) fn new(config: AdaptiveBatchingConfig) -> Self {
+        let size = config.min_batch_size.max(1);
+        Self {
+            config,
+            arrival_rate: 0.0,
+            cost_per_event_ns: 0.0,
+            window_start: Instant::now(),
+            window_arrivals: 0,
+            size,
+        }
+    }
+
+    pub(crate) fn size(&self) -> usize {
+        self.size
+    }
+
+    pub(crate) fn timeout(&self) -> Duration {
+        // Leave room for delivering the batch within the SLO
+        let slo = self.config.latency_slo;
+        let processing = Duration::from_nanos((self.cost_per_event_ns * self.size as f64) as u64);
+        slo.saturating_sub(processing).max(slo / 10)
+    }
+
+    pub(crate) fn record_arrivals(&mut self, count: usize, now: Instant) {
+        self.window_arrivals += count as u64;
+        let window = now.saturating_duration_since(self.window_start);
+        if window < RATE_WINDOW {
+            return;
+        }
+
+        let rate = self.window_arrivals as f64 / window.as_nanos() as f64;
+        self.arrival_rate = ewma(self.arrival_rate, rate);
+        self.window_start = now;
+        self.window_arrivals = 0;
+        self.resize();
+    }
+
+    pub(crate) fn record_delivery(&mut self, len: usize, elapsed: Duration) {
+        if len == 0 {
+            return;
+        }
+        let cost = elapsed.as_nanos() as f64 / len as f64;
+        self.cost_per_event_ns = ewma(self.cost_per_event_ns, cost);
+        self.resize();
+    }
+
+    fn resize(&mut self) {
+        let min = self.config.min_batch_size.max(1);
+        let max = self.config.max_batch_size.max(min);
+        if self.arrival_rate <= 0.0 {
+            self.size = min;
+            return;
+        }
+
+        let slo_ns = self.config.latency_slo.as_nanos() as f64;
+        let ns_per_event = 1.0 / self.arrival_rate + self.cost_per_event_ns;
+        let size = (slo_ns / ns_per_event).floor() as usize;
+        self.size = size.clamp(min, max);
+    }
+}
+
+fn ewma(current: f64, sample: f64) -> f64 {
+    if current == 0.0 {
+        sample
+    } else {
+        current + EWMA_ALPHA * (sample - current)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn batcher() -> AdaptiveBatcher {
+        AdaptiveBatcher::new(AdaptiveBatchingConfig {
+            latency_slo: Duration::from_millis(10),
+            min_batch_size: 1,
+            max_batch_size: 1000,
+        })
+    }
+
+    #[test]
+    fn test_low_rate_uses_small_batches() {
+        let mut batcher = batcher();
+        let start = batcher.window_start;
+
+        // 10 events per second
+        batcher.record_arrivals(1, start + Duration::from_millis(100));
+        assert_eq!(batcher.size(), 1);
+        assert_eq!(batcher.timeout(), Duration::from_millis(10));
+    }
+
+    #[test]
+    fn test_high_rate_grows_batches_within_slo() {
+        let mut batcher = batcher();
+        let start = batcher.window_start;
+
+        // 100 events per millisecond, no delivery cost yet: 1000 fit in 10ms
+        batcher.record_arrivals(100, start + Duration::from_millis(1));
+        assert_eq!(batcher.size(), 1000);
+
+        // 10us per event: size / 100k + size * 10us <= 10ms => size <= 500
+        batcher.record_delivery(100, Duration::from_millis(1));
+        assert_eq!(batcher.size(), 500);
+        assert_eq!(batcher.timeout(), Duration::from_millis(5));
+    }
+
+    #[test]
+    fn test_fixed_sizer() {
+        let mut sizer = BatchSizer::new(100, 50, None);
+        sizer.record_arrivals(10_000, Instant::now() + Duration::from_secs(1));
+        assert_eq!(sizer.size(), 100);
+        assert_eq!(sizer.timeout(), Duration::from_millis(50));
+    }
+}
@@ -0,0 +1,1054 @@
+//! Binary event log format
+//!
+//! Compact on-disk format used by `BinaryLog` for offline replay. All fixed
+//! width integers are little-endian.
+//!
+//! ```text
+//! "KEST" | version: u32 | meta_len: u32 | meta (JSON `LogMeta`)
+//! block*
+//! index: BlockMeta* (32 bytes each)
+//! trailer: event_count: u64 | block_count: u32 | index_offset: u64 | "KIDX"
+//! ```
+//!
+//! A block is `flags: u8 | stored_len: u32 | raw_len: u32` followed by a
+//! payload, zstd-compressed when `flags & BLOCK_COMPRESSED`. The payload
+//! holds the block's string dictionary followed by length-prefixed records:
+//!
+//! ```text
+//! dictionary: varint count | (varint len | utf-8 bytes)*
+//! record:     varint len | varint event_type | zigzag Δts_mono | zigzag Δts_wall
+//!             | varint entity_key | varint source (0 = none, else string + 1)
+//!             | varint field_count | (varint field_id | tag: u8 | value)*
+//! ```
+//!
+//! Timestamps are deltas from the previous record in the block and strings
+//! are dictionary indices, so repeated paths and names cost a byte or two.
+//! Record lengths let readers skip fields added by later versions.
+//!
+//! Replay maps the file (`LogFile`) and streams it with `MergedEvents`,
+//! which decodes blocks only as the merge reaches them.
+
+use crate::replay::ReplayError;
+use kestrel_event::Event;
+use kestrel_schema::TypedValue;
+use serde::{Deserialize, Serialize};
+use std::borrow::Cow;
+use std::cmp::Ordering;
+use std::collections::{BinaryHeap, HashMap};
+use std::fs::File;
+use std::io::{BufWriter, Write};
+use std::ops::Range;
+use std::path::Path;
+
+/// Leading magic bytes of every log
+pub const LOG_MAGIC: [u8; 4] = *b"KEST";
+
+/// Trailing magic bytes, after the block index
+const INDEX_MAGIC: [u8; 4] = *b"KIDX";
+
+/// Binary format version
+pub const LOG_VERSION: u32 = 2;
+
+const BLOCK_COMPRESSED: u8 = 1;
+const BLOCK_HEADER_LEN: usize = 9;
+const BLOCK_META_LEN: usize = 32;
+const TRAILER_LEN: usize = 24;
+
+const TAG_I64: u8 = 0;
+const TAG_U64: u8 = 1;
+const TAG_F64: u8 = 2;
+const TAG_BOOL: u8 = 3;
+const TAG_STRING: u8 = 4;
+const TAG_BYTES: u8 = 5;
+const TAG_ARRAY: u8 = 6;
+const TAG_NULL: u8 = 7;
+
+/// Whether `data` starts like a binary log (as opposed to JSON lines)
+pub fn is_binary_log(data: &[u8]) -> bool {
+    data.starts_with(&LOG_MAGIC)
+}
+
+/// Log-wide metadata stored after the magic bytes
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct LogMeta {
+    /// Schema version (for compatibility)
+    pub schema_version: u32,
+
+    /// Engine build ID (for reproducibility)
+    pub engine_build_id: String,
+
+    /// Rule pack hash (for reproducibility)
+    pub rule_pack_hash: String,
+}
+
+impl LogMeta {
+    pub fn new(rule_pack_hash: String) -> Self {
+        Self {
+            schema_version: 1,
+            engine_build_id: env!("CARGO_PKG_VERSION").to_string(),
+            rule_pack_hash,
+        }
+    }
+}
+
+/// Index entry for one block
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct BlockMeta {
+    /// File offset of the block header
+    pub offset: u64,
+    /// Block length including its header
+    pub len: u32,
+    pub event_count: u32,
+    pub min_ts_mono_ns: u64,
+    pub max_ts_mono_ns: u64,
+}
+
+impl BlockMeta {
+    fn write(&self, out: &mut Vec<u8>) {
+        out.extend_from_slice(&self.offset.to_le_bytes());
+        out.extend_from_slice(&self.len.to_le_bytes());
+        out.extend_from_slice(&self.event_count.to_le_bytes());
+        out.extend_from_slice(&self.min_ts_mono_ns.to_le_bytes());
+        out.extend_from_slice(&self.max_ts_mono_ns.to_le_bytes());
+    }
+
+    fn read(data: &[u8]) -> Self {
+        Self {
+            offset: le_u64(&data[0..8]),
+            len: le_u32(&data[8..12]),
+            event_count: le_u32(&data[12..16]),
+            min_ts_mono_ns: le_u64(&data[16..24]),
+            max_ts_mono_ns: le_u64(&data[24..32]),
+        }
+    }
+}
+
+/// Log writer configuration
+#[derive(Debug, Clone)]
+pub struct LogWriterConfig {
+    /// Uncompressed record bytes per block before it is flushed
+    pub block_bytes: usize,
+
+    /// zstd level for block payloads; `None` stores blocks uncompressed
+    pub compression_level: Option<i32>,
+}
+
+impl Default for LogWriterConfig {
+    fn default() -> Self {
+        Self {
+            block_bytes: 256 * 1024,
+            compression_level: Some(1),
+        }
+    }
+}
+
+/// Streams events into a binary log, one block at a time
+pub struct LogWriter<W: Write> {
+    out: W,
+    config: LogWriterConfig,
+    offset: u64,
+    block: BlockBuilder,
+    index: Vec<BlockMeta>,
+    event_count: u64,
+}
+
+impl LogWriter<BufWriter<File>> {
+    /// Create a log file at `path`
+    pub fn create(
+        path: &Path,
+        meta: &LogMeta,
+        config: LogWriterConfig,
+    ) -> Result<Self, ReplayError> {
+        Self::new(BufWriter::new(File::create(path)?), meta, config)
+    }
+}
+
+impl<W: Write> LogWriter<W> {
+    /// Start a log on `out` by writing its header
+    pub fn new(mut out: W, meta: &LogMeta, config: LogWriterConfig) -> Result<Self, ReplayError> {
+        let meta =
+            serde_json::to_vec(meta).map_err(|e| ReplayError::Serialization(e.to_string()))?;
+        out.write_all(&LOG_MAGIC)?;
+        out.write_all(&LOG_VERSION.to_le_bytes())?;
+        out.write_all(&(meta.len() as u32).to_le_bytes())?;
+        out.write_all(&meta)?;
+
+        Ok(Self {
+            out,
+            offset: (12 + meta.len()) as u64,
+            block: BlockBuilder::with_capacity(config.block_bytes),
+            config,
+            index: Vec::new(),
+            event_count: 0,
+        })
+    }
+
+    /// Append one event, flushing the current block when it is full
+    pub fn append(&mut self, event: &Event) -> Result<(), ReplayError> {
+        self.block.push(event);
+        self.event_count += 1;
+        if self.block.records.len() >= self.config.block_bytes {
+            self.flush_block()?;
+        }
+        Ok(())
+    }
+
+    /// Write the last block, the index and the trailer
+    pub fn finish(mut self) -> Result<W, ReplayError> {
+        self.flush_block()?;
+
+        let mut tail = Vec::with_capacity(self.index.len() * BLOCK_META_LEN + TRAILER_LEN);
+        for block in &self.index {
+            block.write(&mut tail);
+        }
+        tail.extend_from_slice(&self.event_count.to_le_bytes());
+        tail.extend_from_slice(&(self.index.len() as u32).to_le_bytes());
+        tail.extend_from_slice(&self.offset.to_le_bytes());
+        tail.extend_from_slice(&INDEX_MAGIC);
+        self.out.write_all(&tail)?;
+        self.out.flush()?;
+        Ok(self.out)
+    }
+
+    fn flush_block(&mut self) -> Result<(), ReplayError> {
+        if self.block.count == 0 {
+            return Ok(());
+        }
+
+        let raw = self.block.payload();
+        let (flags, stored) = match self.config.compression_level {
+            Some(level) => (
+                BLOCK_COMPRESSED,
+                Cow::Owned(zstd::bulk::compress(&raw, level)?),
+            ),
+            None => (0, Cow::Borrowed(&raw[..])),
+        };
+
+        let mut header = [0u8; BLOCK_HEADER_LEN];
+        header[0] = flags;
+        header[1..5].copy_from_slice(&(stored.len() as u32).to_le_bytes());
+        header[5..9].copy_from_slice(&(raw.len() as u32).to_le_bytes());
+        self.out.write_all(&header)?;
+        self.out.write_all(&stored)?;
+
+        let len = (BLOCK_HEADER_LEN + stored.len()) as u32;
+        self.index.push(BlockMeta {
+            offset: self.offset,
+            len,
+            event_count: self.block.count,
+            min_ts_mono_ns: self.block.min_ts,
+            max_ts_mono_ns: self.block.max_ts,
+        });
+        self.offset += len as u64;
+        self.block.clear();
+        Ok(())
+    }
+}
+
+/// Records and dictionary of the block being written
+struct BlockBuilder {
+    dictionary: HashMap<String, u64>,
+    strings: Vec<u8>,
+    records: Vec<u8>,
+    record: Vec<u8>,
+    count: u32,
+    min_ts: u64,
+    max_ts: u64,
+    prev_mono: u64,
+    prev_wall: u64,
+}
+
+impl BlockBuilder {
+    fn with_capacity(block_bytes: usize) -> Self {
+        Self {
+            dictionary: HashMap::new(),
+            strings: Vec::new(),
+            records: Vec::with_capacity(block_bytes + block_bytes / 4),
+            record: Vec::new(),
+            count: 0,
+            min_ts: u64::MAX,
+            max_ts: 0,
+            prev_mono: 0,
+            prev_wall: 0,
+        }
+    }
+
+    fn push(&mut self, event: &Event) {
+        let mut record = std::mem::take(&mut self.record);
+        record.clear();
+        write_varint(&mut record, event.event_type_id as u64);
+        write_varint(
+            &mut record,
+            zigzag(event.ts_mono_ns.wrapping_sub(self.prev_mono) as i64),
+        );
+        write_varint(
+            &mut record,
+            zigzag(event.ts_wall_ns.wrapping_sub(self.prev_wall) as i64),
+        );
+        write_varint_u128(&mut record, event.entity_key);
+        let source = match &event.source_id {
+            Some(source) => self.intern(source) + 1,
+            None => 0,
+        };
+        write_varint(&mut record, source);
+        write_varint(&mut record, event.fields.len() as u64);
+        for (field_id, value) in &event.fields {
+            write_varint(&mut record, *field_id as u64);
+            self.write_value(&mut record, value);
+        }
+
+        write_varint(&mut self.records, record.len() as u64);
+        self.records.extend_from_slice(&record);
+        self.record = record;
+
+        self.count += 1;
+        self.min_ts = self.min_ts.min(event.ts_mono_ns);
+        self.max_ts = self.max_ts.max(event.ts_mono_ns);
+        self.prev_mono = event.ts_mono_ns;
+        self.prev_wall = event.ts_wall_ns;
+    }
+
+    fn write_value(&mut self, out: &mut Vec<u8>, value: &TypedValue) {
+        match value {
+            TypedValue::I64(v) => {
+                out.push(TAG_I64);
+                write_varint(out, zigzag(*v));
+            }
+            TypedValue::U64(v) => {
+                out.push(TAG_U64);
+                write_varint(out, *v);
+            }
+            TypedValue::F64(v) => {
+                out.push(TAG_F64);
+                out.extend_from_slice(&v.to_le_bytes());
+            }
+            TypedValue::Bool(v) => {
+                out.push(TAG_BOOL);
+                out.push(*v as u8);
+            }
+            TypedValue::String(v) => {
+                out.push(TAG_STRING);
+                let index = self.intern(v);
+                write_varint(out, index);
+            }
+            TypedValue::Bytes(v) => {
+                out.push(TAG_BYTES);
+                write_varint(out, v.len() as u64);
+                out.extend_from_slice(v);
+            }
+            TypedValue::Array(values) => {
+                out.push(TAG_ARRAY);
+                write_varint(out, values.len() as u64);
+                for value in values {
+                    self.write_value(out, value);
+                }
+            }
+            TypedValue::Null => out.push(TAG_NULL),
+        }
+    }
+
+    fn intern(&mut self, s: &str) -> u64 {
+        if let Some(&index) = self.dictionary.get(s) {
+            return index;
+        }
+        let index = self.dictionary.len() as u64;
+        write_varint(&mut self.strings, s.len() as u64);
+        self.strings.extend_from_slice(s.as_bytes());
+        self.dictionary.insert(s.to_string(), index);
+        index
+    }
+
+    /// Dictionary followed by the records
+    fn payload(&self) -> Vec<u8> {
+        let mut payload = Vec::with_capacity(10 + self.strings.len() + self.records.len());
+        write_varint(&mut payload, self.dictionary.len() as u64);
+        payload.extend_from_slice(&self.strings);
+        payload.extend_from_slice(&self.records);
+        payload
+    }
+
+    fn clear(&mut self) {
+        self.dictionary.clear();
+        self.strings.clear();
+        self.records.clear();
+        self.count = 0;
+        self.min_ts = u64::MAX;
+        self.max_ts = 0;
+        self.prev_mono = 0;
+        self.prev_wall = 0;
+    }
+}
+
+/// Storage a `LogReader` decodes from
+pub trait LogBytes: AsRef<[u8]> {
+    /// Hint that `range` has been decoded and will not be needed soon
+    fn release(&self, _range: Range<usize>) {}
+}
+
+impl LogBytes for Vec<u8> {}
+
+impl LogBytes for &[u8] {}
+
+/// Read-only view of a log file
+///
+/// On Linux the file is memory-mapped and decoded blocks are handed back to
+/// the kernel, so resident memory stays flat however large the log is.
+/// Elsewhere the file is read into memory.
+pub struct LogFile {
+    #[cfg(target_os = "linux")]
+    ptr: *const u8,
+    #[cfg(target_os = "linux")]
+    len: usize,
+    #[cfg(not(target_os = "linux"))]
+    data: Vec<u8>,
+}
+
+// The mapping is private and read-only, so it can be shared across threads
+#[cfg(target_os = "linux")]
+unsafe impl Send for LogFile {}
+#[cfg(target_os = "linux")]
+unsafe impl Sync for LogFile {}
+
+impl LogFile {
+    #[cfg(target_os = "linux")]
+    pub fn open(path: &Path) -> std::io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let file = File::open(path)?;
+        let len = file.metadata()?.len() as usize;
+        if len == 0 {
+            return Ok(Self {
+                ptr: std::ptr::NonNull::dangling().as_ptr(),
+                len: 0,
+            });
+        }
+
+        unsafe {
+            let ptr = libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            );
+            if ptr == libc::MAP_FAILED {
+                return Err(std::io::Error::last_os_error());
+            }
+            libc::madvise(ptr, len, libc::MADV_SEQUENTIAL);
+            Ok(Self {
+                ptr: ptr as *const u8,
+                len,
+            })
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    pub fn open(path: &Path) -> std::io::Result<Self> {
+        Ok(Self {
+            data: std::fs::read(path)?,
+        })
+    }
+}
+
+impl AsRef<[u8]> for LogFile {
+    #[cfg(target_os = "linux")]
+    fn as_ref(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn as_ref(&self) -> &[u8] {
+        &self.data
+    }
+}
+
+impl LogBytes for LogFile {
+    #[cfg(target_os = "linux")]
+    fn release(&self, range: Range<usize>) {
+        let page = unsafe { libc::sysconf(libc::_SC_PAGESIZE) } as usize;
+        // Whole pages only; a page shared with the next block is kept
+        let start = range.start / page * page;
+        let end = range.end.min(self.len) / page * page;
+        if end > start {
+            unsafe {
+                libc::madvise(
+                    self.ptr.add(start) as *mut libc::c_void,
+                    end - start,
+                    libc::MADV_DONTNEED,
+                );
+            }
+        }
+    }
+}
+
+#[cfg(target_os = "linux")]
+impl Drop for LogFile {
+    fn drop(&mut self) {
+        if self.len > 0 {
+            unsafe {
+                libc::munmap(self.ptr as *mut libc::c_void, self.len);
+            }
+        }
+    }
+}
+
+/// Reads a binary log held in memory (a buffer or a mapped file)
+pub struct LogReader<B: LogBytes> {
+    data: B,
+    meta: LogMeta,
+    blocks: Vec<BlockMeta>,
+    event_count: u64,
+}
+
+impl<B: LogBytes> LogReader<B> {
+    /// Parse the header, trailer and block index of `data`
+    pub fn new(data: B) -> Result<Self, ReplayError> {
+        let bytes = data.as_ref();
+        if bytes.len() < 12 + TRAILER_LEN || !is_binary_log(bytes) {
+            return Err(invalid("missing magic bytes"));
+        }
+        let version = le_u32(&bytes[4..8]);
+        if version != LOG_VERSION {
+            return Err(invalid(&format!("unsupported version {}", version)));
+        }
+        let meta_len = le_u32(&bytes[8..12]) as usize;
+        let meta = bytes
+            .get(12..12 + meta_len)
+            .ok_or_else(|| invalid("truncated header"))?;
+        let meta: LogMeta =
+            serde_json::from_slice(meta).map_err(|e| ReplayError::Serialization(e.to_string()))?;
+
+        let trailer = &bytes[bytes.len() - TRAILER_LEN..];
+        if trailer[20..24] != INDEX_MAGIC {
+            return Err(invalid("missing block index (truncated log?)"));
+        }
+        let event_count = le_u64(&trailer[0..8]);
+        let block_count = le_u32(&trailer[8..12]) as usize;
+        let index_offset = le_u64(&trailer[12..20]) as usize;
+        let index = block_count
+            .checked_mul(BLOCK_META_LEN)
+            .and_then(|len| bytes.get(index_offset..index_offset.checked_add(len)?))
+            .ok_or_else(|| invalid("block index out of bounds"))?;
+        let blocks: Vec<BlockMeta> = index
+            .chunks_exact(BLOCK_META_LEN)
+            .map(BlockMeta::read)
+            .collect();
+
+        // `read_block` relies on every block holding at least its header
+        let in_bounds = |block: &BlockMeta| {
+            let end = (block.offset as usize).checked_add(block.len as usize);
+            block.len as usize >= BLOCK_HEADER_LEN && end.map_or(false, |end| end <= index_offset)
+        };
+        if !blocks.iter().all(in_bounds) {
+            return Err(invalid("block out of bounds"));
+        }
+
+        Ok(Self {
+            data,
+            meta,
+            blocks,
+            event_count,
+        })
+    }
+
+    pub fn meta(&self) -> &LogMeta {
+        &self.meta
+    }
+
+    /// Block index, in file order
+    pub fn blocks(&self) -> &[BlockMeta] {
+        &self.blocks
+    }
+
+    pub fn event_count(&self) -> u64 {
+        self.event_count
+    }
+
+    /// Decode every event of block `index`
+    pub fn read_block(&self, index: usize) -> Result<Vec<Event>, ReplayError> {
+        let block = self
+            .blocks
+            .get(index)
+            .ok_or_else(|| invalid("block index out of range"))?;
+        let start = block.offset as usize;
+        let bytes = &self.data.as_ref()[start..start + block.len as usize];
+        let flags = bytes[0];
+        let stored_len = le_u32(&bytes[1..5]) as usize;
+        let raw_len = le_u32(&bytes[5..9]) as usize;
+        let stored = bytes
+            .get(BLOCK_HEADER_LEN..BLOCK_HEADER_LEN + stored_len)
+            .ok_or_else(|| invalid("truncated block"))?;
+
+        let payload = if flags & BLOCK_COMPRESSED != 0 {
+            Cow::Owned(zstd::bulk::decompress(stored, raw_len)?)
+        } else {
+            Cow::Borrowed(stored)
+        };
+        let events = decode_block(&payload, block.event_count as usize);
+        self.data.release(start..start + block.len as usize);
+        events
+    }
+
+    /// Stream all events in timestamp order
+    pub fn merged_events(&self) -> MergedEvents<'_, B> {
+        let mut pending: Vec<usize> = (0..self.blocks.len()).collect();
+        // Latest first, so the next block to open is popped from the end
+        pending.sort_by_key(|&block| std::cmp::Reverse((self.blocks[block].min_ts_mono_ns, block)));
+        MergedEvents {
+            reader: self,
+            pending,
+            runs: BinaryHeap::new(),
+            max_open_blocks: 0,
+        }
+    }
+
+    /// Decode all blocks whose events may fall in `[start_ns, end_ns]`
+    ///
+    /// Blocks outside the range are skipped without decompressing them;
+    /// events of overlapping blocks are filtered individually.
+    pub fn read_range(&self, start_ns: u64, end_ns: u64) -> Result<Vec<Event>, ReplayError> {
+        let mut events = Vec::new();
+        for (index, block) in self.blocks.iter().enumerate() {
+            if block.max_ts_mono_ns < start_ns || block.min_ts_mono_ns > end_ns {
+                continue;
+            }
+            events.extend(
+                self.read_block(index)?
+                    .into_iter()
+                    .filter(|event| (start_ns..=end_ns).contains(&event.ts_mono_ns)),
+            );
+        }
+        Ok(events)
+    }
+}
+
+/// Events of a log in timestamp order, decoding blocks lazily
+///
+/// A k-way merge over blocks, each sorted by timestamp once decoded. A block
+/// is only opened when the merge reaches its first timestamp, so memory
+/// holds just the blocks that overlap in time: one or two for a log written
+/// in order, a few more where sources were interleaved out of order. Events
+/// with equal timestamps keep their order in the file.
+pub struct MergedEvents<'a, B: LogBytes> {
+    reader: &'a LogReader<B>,
+    pending: Vec<usize>,
+    runs: BinaryHeap<Run>,
+    max_open_blocks: usize,
+}
+
+impl<B: LogBytes> MergedEvents<'_, B> {
+    /// Most blocks held decoded at once so far
+    pub fn max_open_blocks(&self) -> usize {
+        self.max_open_blocks
+    }
+
+    fn open(&mut self, block: usize) -> Result<(), ReplayError> {
+        let mut events = self.reader.read_block(block)?;
+        events.sort_by_key(|event| event.ts_mono_ns);
+        let mut rest = events.into_iter();
+        if let Some(head) = rest.next() {
+            self.runs.push(Run { block, head, rest });
+            self.max_open_blocks = self.max_open_blocks.max(self.runs.len());
+        }
+        Ok(())
+    }
+}
+
+impl<B: LogBytes> Iterator for MergedEvents<'_, B> {
+    type Item = Result<Event, ReplayError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        // Open every block that could start at or before the current head
+        while let Some(&block) = self.pending.last() {
+            let min_ts = self.reader.blocks[block].min_ts_mono_ns;
+            if matches!(self.runs.peek(), Some(run) if run.head.ts_mono_ns < min_ts) {
+                break;
+            }
+            self.pending.pop();
+            if let Err(e) = self.open(block) {
+                return Some(Err(e));
+            }
+        }
+
+        let mut run = self.runs.pop()?;
+        let event = match run.rest.next() {
+            Some(next) => {
+                let event = std::mem::replace(&mut run.head, next);
+                self.runs.push(run);
+                event
+            }
+            None => run.head,
+        };
+        Some(Ok(event))
+    }
+}
+
+/// Remaining events of one decoded block
+struct Run {
+    block: usize,
+    head: Event,
+    rest: std::vec::IntoIter<Event>,
+}
+
+impl Run {
+    fn key(&self) -> (u64, usize) {
+        (self.head.ts_mono_ns, self.block)
+    }
+}
+
+impl PartialEq for Run {
+    fn eq(&self, other: &Self) -> bool {
+        self.key() == other.key()
+    }
+}
+
+impl Eq for Run {}
+
+impl PartialOrd for Run {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for Run {
+    // Reversed: the heap pops the earliest event
+    fn cmp(&self, other: &Self) -> Ordering {
+        other.key().cmp(&self.key())
+    }
+}
+
+fn decode_block(mut payload: &[u8], event_count: usize) -> Result<Vec<Event>, ReplayError> {
+    let input = &mut payload;
+    let string_count = read_varint(input)? as usize;
+    let mut strings = Vec::with_capacity(string_count.min(input.len()));
+    for _ in 0..string_count {
+        let len = read_varint(input)? as usize;
+        let bytes = take(input, len)?;
+        let s = std::str::from_utf8(bytes).map_err(|_| invalid("invalid utf-8 in dictionary"))?;
+        strings.push(s);
+    }
+
+    let mut events = Vec::with_capacity(event_count);
+    let (mut prev_mono, mut prev_wall) = (0u64, 0u64);
+    while !input.is_empty() {
+        let len = read_varint(input)? as usize;
+        let record = &mut take(input, len)?;
+
+        let event_type_id = read_varint(record)? as u16;
+        prev_mono = prev_mono.wrapping_add(unzigzag(read_varint(record)?) as u64);
+        prev_wall = prev_wall.wrapping_add(unzigzag(read_varint(record)?) as u64);
+        let entity_key = read_varint_u128(record)?;
+        let source_id = match read_varint(record)? {
+            0 => None,
+            index => Some(string(&strings, index - 1)?.to_string()),
+        };
+        let field_count = read_varint(record)? as usize;
+        let mut fields = smallvec::SmallVec::with_capacity(field_count.min(record.len()));
+        for _ in 0..field_count {
+            let field_id = read_varint(record)? as u32;
+            fields.push((field_id, read_value(record, &strings)?));
+        }
+
+        events.push(Event {
+            event_id: 0, // Assigned during replay
+            event_type_id,
+            ts_mono_ns: prev_mono,
+            ts_wall_ns: prev_wall,
+            entity_key,
+            fields,
+            source_id,
+        });
+    }
+    Ok(events)
+}
+
+fn read_value(input: &mut &[u8], strings: &[&str]) -> Result<TypedValue, ReplayError> {
+    Ok(match take(input, 1)?[0] {
+        TAG_I64 => TypedValue::I64(unzigzag(read_varint(input)?)),
+        TAG_U64 => TypedValue::U64(read_varint(input)?),
+        TAG_F64 => TypedValue::F64(f64::from_le_bytes(take(input, 8)?.try_into().unwrap())),
+        TAG_BOOL => TypedValue::Bool(take(input, 1)?[0] != 0),
+        TAG_STRING => TypedValue::String(string(strings, read_varint(input)?)?.to_string()),
+        TAG_BYTES => {
+            let len = read_varint(input)? as usize;
+            TypedValue::Bytes(take(input, len)?.to_vec())
+        }
+        TAG_ARRAY => {
+            let len = read_varint(input)? as usize;
+            let mut values = Vec::with_capacity(len.min(input.len()));
+            for _ in 0..len {
+                values.push(read_value(input, strings)?);
+            }
+            TypedValue::Array(values)
+        }
+        TAG_NULL => TypedValue::Null,
+        tag => return Err(invalid(&format!("unknown value tag {}", tag))),
+    })
+}
+
+fn string<'a>(strings: &[&'a str], index: u64) -> Result<&'a str, ReplayError> {
+    strings
+        .get(index as usize)
+        .copied()
+        .ok_or_else(|| invalid("string index out of range"))
+}
+
+fn take<'a>(input: &mut &'a [u8], len: usize) -> Result<&'a [u8], ReplayError> {
+    if input.len() < len {
+        return Err(invalid("truncated record"));
+    }
+    let (head, tail) = input.split_at(len);
+    *input = tail;
+    Ok(head)
+}
+
+fn invalid(reason: &str) -> ReplayError {
+    ReplayError::InvalidFormat(reason.to_string())
+}
+
+fn le_u32(bytes: &[u8]) -> u32 {
+    u32::from_le_bytes(bytes.try_into().unwrap())
+}
+
+fn le_u64(bytes: &[u8]) -> u64 {
+    u64::from_le_bytes(bytes.try_into().unwrap())
+}
+
+fn zigzag(v: i64) -> u64 {
+    ((v << 1) ^ (v >> 63)) as u64
+}
+
+fn unzigzag(v: u64) -> i64 {
+    ((v >> 1) as i64) ^ -((v & 1) as i64)
+}
+
+fn write_varint(out: &mut Vec<u8>, mut v: u64) {
+    while v >= 0x80 {
+        out.push(v as u8 | 0x80);
+        v >>= 7;
+    }
+    out.push(v as u8);
+}
+
+fn write_varint_u128(out: &mut Vec<u8>, mut v: u128) {
+    while v >= 0x80 {
+        out.push(v as u8 | 0x80);
+        v >>= 7;
+    }
+    out.push(v as u8);
+}
+
+fn read_varint(input: &mut &[u8]) -> Result<u64, ReplayError> {
+    let mut v = 0u64;
+    for shift in (0..64).step_by(7) {
+        let byte = take(input, 1)?[0];
+        v |= ((byte & 0x7f) as u64) << shift;
+        if byte & 0x80 == 0 {
+            return Ok(v);
+        }
+    }
+    Err(invalid("varint too long"))
+}
+
+fn read_varint_u128(input: &mut &[u8]) -> Result<u128, ReplayError> {
+    let mut v = 0u128;
+    for shift in (0..128).step_by(7) {
+        let byte = take(input, 1)?[0];
+        v |= ((byte & 0x7f) as u128) << shift;
+        if byte & 0x80 == 0 {
+            return Ok(v);
+        }
+    }
+    Err(invalid("varint too long"))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn events(count: u64) -> Vec<Event> {
+        (0..count)
+            .map(|i| {
+                let mut event = Event::builder()
+                    .event_type((i % 3) as u16)
+                    .ts_mono(1_000_000_000 + i * 1000)
+                    .ts_wall(1_700_000_000_000_000_000 + i * 1000)
+                    .entity_key(u128::MAX - (i % 7) as u128)
+                    .field(1, TypedValue::String(format!("/usr/bin/tool{}", i % 5)))
+                    .field(2, TypedValue::I64(-(i as i64)))
+                    .field(3, TypedValue::F64(i as f64 / 2.0))
+                    .field(
+                        4,
+                        TypedValue::Array(vec![TypedValue::Bool(i % 2 == 0), TypedValue::Null]),
+                    )
+                    .field(5, TypedValue::Bytes(vec![i as u8; 3]))
+                    .build()
+                    .unwrap();
+                event.source_id = (i % 2 == 0).then(|| "ebpf".to_string());
+                event
+            })
+            .collect()
+    }
+
+    type Key = (u16, u64, u64, u128, Vec<(u32, TypedValue)>, Option<String>);
+
+    fn key(event: &Event) -> Key {
+        (
+            event.event_type_id,
+            event.ts_mono_ns,
+            event.ts_wall_ns,
+            event.entity_key,
+            event.fields.to_vec(),
+            event.source_id.clone(),
+        )
+    }
+
+    fn keys(events: &[Event]) -> Vec<Key> {
+        events.iter().map(key).collect()
+    }
+
+    fn write(events: &[Event], config: LogWriterConfig) -> Vec<u8> {
+        let mut writer = LogWriter::new(Vec::new(), &LogMeta::new("hash".into()), config).unwrap();
+        for event in events {
+            writer.append(event).unwrap();
+        }
+        writer.finish().unwrap()
+    }
+
+    fn read_all<B: LogBytes>(reader: &LogReader<B>) -> Vec<Event> {
+        (0..reader.blocks().len())
+            .flat_map(|block| reader.read_block(block).unwrap())
+            .collect()
+    }
+
+    #[test]
+    fn test_round_trip_across_blocks() {
+        let events = events(1000);
+        for compression_level in [None, Some(1)] {
+            let data = write(
+                &events,
+                LogWriterConfig {
+                    block_bytes: 4096,
+                    compression_level,
+                },
+            );
+            let reader = LogReader::new(&data[..]).unwrap();
+            assert_eq!(reader.meta().rule_pack_hash, "hash");
+            assert_eq!(reader.event_count(), 1000);
+            assert!(reader.blocks().len() > 1);
+            assert_eq!(keys(&read_all(&reader)), keys(&events));
+        }
+    }
+
+    #[test]
+    fn test_compact_encoding() {
+        let events = events(1000);
+        let json: usize = events
+            .iter()
+            .map(|e| serde_json::to_vec(&key(e)).unwrap().len())
+            .sum();
+        let data = write(&events, LogWriterConfig::default());
+        assert!(data.len() * 10 < json, "{} vs {} bytes", data.len(), json);
+    }
+
+    #[test]
+    fn test_read_range_uses_block_index() {
+        let events = events(1000);
+        let data = write(
+            &events,
+            LogWriterConfig {
+                block_bytes: 1024,
+                ..Default::default()
+            },
+        );
+        let reader = LogReader::new(data).unwrap();
+        let first = reader.blocks()[0];
+        assert_eq!(first.min_ts_mono_ns, 1_000_000_000);
+
+        let range = reader.read_range(1_000_500_000, 1_000_600_000).unwrap();
+        assert_eq!(keys(&range), keys(&events[500..=600]));
+    }
+
+    #[test]
+    fn test_merged_events_orders_interleaved_blocks() {
+        // Two sources written one after the other, so blocks overlap in time
+        let mut events: Vec<Event> = events(1000)
+            .into_iter()
+            .enumerate()
+            .map(|(i, mut event)| {
+                event.ts_mono_ns = if i < 500 {
+                    i as u64 * 2
+                } else {
+                    (i as u64 - 500) * 2 + 1
+                };
+                event
+            })
+            .collect();
+        events[10].ts_mono_ns = events[11].ts_mono_ns;
+        let data = write(
+            &events,
+            LogWriterConfig {
+                block_bytes: 2048,
+                ..Default::default()
+            },
+        );
+        let reader = LogReader::new(data).unwrap();
+
+        let mut merged = reader.merged_events();
+        let streamed: Vec<Event> = merged.by_ref().map(Result::unwrap).collect();
+        let mut expected = events.clone();
+        expected.sort_by_key(|event| event.ts_mono_ns);
+        assert_eq!(keys(&streamed), keys(&expected));
+        assert!(
+            merged.max_open_blocks() <= 3,
+            "{}",
+            merged.max_open_blocks()
+        );
+
+        // An in-order log never holds more than the current and next block
+        let data = write(
+            &expected,
+            LogWriterConfig {
+                block_bytes: 2048,
+                ..Default::default()
+            },
+        );
+        let reader = LogReader::new(data).unwrap();
+        let mut merged = reader.merged_events();
+        assert_eq!(merged.by_ref().count(), 1000);
+        assert!(merged.max_open_blocks() <= 2);
+    }
+
+    #[test]
+    fn test_log_file_maps_log() {
+        let path = std::env::temp_dir().join(format!("binlog_map_{}.log", std::process::id()));
+        let events = events(100);
+        std::fs::write(&path, write(&events, LogWriterConfig::default())).unwrap();
+
+        let reader = LogReader::new(LogFile::open(&path).unwrap()).unwrap();
+        let streamed: Vec<Event> = reader.merged_events().map(Result::unwrap).collect();
+        assert_eq!(keys(&streamed), keys(&events));
+
+        let _ = std::fs::remove_file(path);
+    }
+
+    #[test]
+    fn test_rejects_truncated_log() {
+        let data = write(&events(10), LogWriterConfig::default());
+        assert!(LogReader::new(&data[..data.len() - 1]).is_err());
+        assert!(LogReader::new(&b"{\"magic\":[75,69,83,84]}"[..]).is_err());
+    }
+
+    #[test]
+    fn test_rejects_block_shorter_than_header() {
+        let mut data = write(&events(10), LogWriterConfig::default());
+        let trailer = data.len() - TRAILER_LEN;
+        let index_offset = le_u64(&data[trailer + 12..trailer + 20]) as usize;
+        data[index_offset + 8..index_offset + 12].copy_from_slice(&4u32.to_le_bytes());
+        assert!(matches!(
+            LogReader::new(&data[..]),
+            Err(ReplayError::InvalidFormat(_))
+        ));
+    }
+}
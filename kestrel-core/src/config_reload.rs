@@ -3,6 +3,7 @@
 //! Provides runtime configuration updates without restarting the engine.
 //! Supports file watching and signal-based reloading.
 
+use crate::fswatch::{content_hash, DirWatcher, FileEventKind};
 use std::collections::HashMap;
 use std::path::Path;
 use std::sync::Arc;
@@ -103,6 +104,10 @@ impl ConfigManager {
     }
 
     /// Start file watcher for hot reload
+    ///
+    /// Watches the file's directory (editors often replace files by
+    /// renaming) with inotify where available, so nothing is read until the
+    /// file is actually written. Falls back to polling elsewhere.
     pub fn start_file_watcher(&mut self) -> Result<()> {
         if self.config_path.is_none() {
             return Err(ConfigReloadError::Validation(
@@ -111,18 +116,46 @@ impl ConfigManager {
         }
 
         let path = self.config_path.clone().unwrap();
+        let file_name = path
+            .file_name()
+            .map(|name| name.to_os_string())
+            .ok_or_else(|| {
+                ConfigReloadError::Validation(format!("Not a file path: {}", path.display()))
+            })?;
+        let dir = match path.parent() {
+            Some(dir) if !dir.as_os_str().is_empty() => dir.to_path_buf(),
+            _ => std::path::PathBuf::from("."),
+        };
+        let mut watcher = DirWatcher::new(&dir)?;
+
         let change_tx = self.change_tx.clone();
         let last_hash = self.last_hash.clone();
         let version = self.version.clone();
 
         let handle = tokio::spawn(async move {
-            info!(path = %path.display(), "Starting config file watcher");
-            
-            let mut interval = tokio::time::interval(tokio::time::Duration::from_secs(5));
-            
+            info!(
+                path = %path.display(),
+                polling = watcher.is_polling(),
+                "Starting config file watcher"
+            );
+
             loop {
-                interval.tick().await;
-                
+                let events = match watcher.next_events().await {
+                    Ok(events) => events,
+                    Err(e) => {
+                        warn!(error = %e, "Config file watcher stopped");
+                        break;
+                    }
+                };
+
+                let touched = events.iter().any(|event| {
+                    event.kind == FileEventKind::Overflow
+                        || event.path.file_name() == Some(file_name.as_os_str())
+                });
+                if !touched {
+                    continue;
+                }
+
                 // Check if file has changed
                 match Self::check_file_changed(&path, &last_hash).await {
                     Ok(true) => {
@@ -169,12 +202,7 @@ impl ConfigManager {
 
     /// Compute hash of configuration content
     fn compute_hash(content: &str) -> String {
-        use std::collections::hash_map::DefaultHasher;
-        use std::hash::{Hash, Hasher};
-        
-        let mut hasher = DefaultHasher::new();
-        content.hash(&mut hasher);
-        format!("{:x}", hasher.finish())
+        content_hash(content.as_bytes())
     }
 
     /// Subscribe to configuration change notifications
@@ -365,4 +393,29 @@ mod tests {
         assert_eq!(hash1, hash2);
         assert_ne!(hash1, hash3);
     }
+
+    #[tokio::test]
+    async fn test_file_watcher_triggers_reload() {
+        let dir = std::env::temp_dir().join(format!("kestrel-config-watch-{}", std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        std::fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("kestrel.toml");
+
+        let mut manager = ConfigManager::new().with_config_path(&path);
+        let mut rx = manager.subscribe();
+        manager.start_file_watcher().unwrap();
+
+        // Unrelated files in the same directory are ignored
+        std::fs::write(dir.join("other.toml"), "x = 1").unwrap();
+        std::fs::write(&path, "log_level = \"debug\"").unwrap();
+
+        let change = tokio::time::timeout(std::time::Duration::from_secs(10), rx.recv())
+            .await
+            .expect("no reload")
+            .unwrap();
+        assert!(matches!(change, ConfigChange::FullReload));
+        assert_eq!(manager.current_version().await.version, 1);
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
 }
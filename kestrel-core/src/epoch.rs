@@ -0,0 +1,303 @@
+//! Epoch-swapped shared values
+//!
+//! `EpochCell` holds an `Arc<T>` that readers load without locks and
+//! writers replace atomically. It is used for state that is read on every
+//! event but replaced rarely, such as the compiled rule set: a reload builds
+//! the new value off the event path and publishes it with one pointer swap.
+//!
+//! Readers announce themselves in one of two counters selected by the
+//! current epoch. A writer swaps the pointer, advances the epoch and waits
+//! only for readers of the previous epoch, who are at most an `Arc` clone
+//! away from finishing, before releasing its reference to the old value.
+//! Whatever the old value owns is dropped when its last reader lets go.
+//!
+//! A reader on a hot path keeps an `EpochCache`, which only compares the
+//! epoch while the value is unchanged instead of registering on every read.
+
+use crate::ring::CachePadded;
+use parking_lot::Mutex;
+use std::sync::atomic::{AtomicPtr, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+
+/// Spins before a waiting writer starts yielding
+const SPINS_BEFORE_YIELD: u32 = 64;
+
+/// Lock-free readable, atomically replaceable `Arc<T>`
+pub struct EpochCell<T> {
+    /// Current value, from `Arc::into_raw`
+    current: AtomicPtr<T>,
+    /// Number of completed swaps
+    epoch: AtomicU64,
+    /// In-flight readers, indexed by epoch parity
+    readers: [CachePadded<AtomicUsize>; 2],
+    /// Serializes writers
+    writer: Mutex<()>,
+}
+
+// SAFETY: the cell only hands out `Arc<T>`, so it is as thread-safe as
+// `Arc<T>` itself.
+unsafe impl<T: Send + Sync> Send for EpochCell<T> {}
+unsafe impl<T: Send + Sync> Sync for EpochCell<T> {}
+
+impl<T> EpochCell<T> {
+    /// Create a cell holding `value`
+    pub fn new(value: T) -> Self {
+        Self::from_arc(Arc::new(value))
+    }
+
+    /// Create a cell holding an existing `Arc`
+    pub fn from_arc(value: Arc<T>) -> Self {
+        Self {
+            current: AtomicPtr::new(Arc::into_raw(value) as *mut T),
+            epoch: AtomicU64::new(0),
+            readers: [
+                CachePadded(AtomicUsize::new(0)),
+                CachePadded(AtomicUsize::new(0)),
+            ],
+            writer: Mutex::new(()),
+        }
+    }
+
+    /// Get the current value
+    ///
+    /// Never blocks: a concurrent `store` at most makes the reader retry
+    /// its registration once.
+    pub fn load(&self) -> Arc<T> {
+        loop {
+            let epoch = self.epoch.load(Ordering::SeqCst);
+            let slot = &self.readers[(epoch & 1) as usize];
+            slot.fetch_add(1, Ordering::SeqCst);
+
+            if self.epoch.load(Ordering::SeqCst) != epoch {
+                // A writer moved on between the two loads; it may not wait
+                // for this slot, so register again under the new epoch
+                slot.fetch_sub(1, Ordering::Release);
+                continue;
+            }
+
+            let ptr = self.current.load(Ordering::SeqCst);
+            // SAFETY: `ptr` came from `Arc::into_raw`, and the writer that
+            // swaps it out waits for this slot to drain before releasing
+            // the cell's reference, so the strong count is at least one.
+            let value = unsafe {
+                Arc::increment_strong_count(ptr);
+                Arc::from_raw(ptr)
+            };
+            slot.fetch_sub(1, Ordering::Release);
+            return value;
+        }
+    }
+
+    /// Replace the value, returning the previous one
+    pub fn store(&self, value: Arc<T>) -> Arc<T> {
+        let _writer = self.writer.lock();
+        self.swap_locked(value)
+    }
+
+    /// Number of values stored since the cell was created
+    pub fn epoch(&self) -> u64 {
+        self.epoch.load(Ordering::Acquire)
+    }
+
+    fn swap_locked(&self, value: Arc<T>) -> Arc<T> {
+        let new = Arc::into_raw(value) as *mut T;
+        let old = self.current.swap(new, Ordering::SeqCst);
+        let epoch = self.epoch.fetch_add(1, Ordering::SeqCst);
+
+        // Readers that registered under the old epoch may still be about to
+        // clone `old`; new readers use the other slot
+        let slot = &self.readers[(epoch & 1) as usize];
+        let mut spins = 0;
+        while slot.load(Ordering::Acquire) != 0 {
+            if spins < SPINS_BEFORE_YIELD {
+                spins += 1;
+                std::hint::spin_loop();
+            } else {
+                std::thread::yield_now();
+            }
+        }
+
+        // SAFETY: `old` came from `Arc::into_raw` and no reader can reach it
+        // through the cell any more.
+        unsafe { Arc::from_raw(old) }
+    }
+}
+
+impl<T: Clone> EpochCell<T> {
+    /// Copy the current value, modify the copy and publish it
+    ///
+    /// Writers are serialized, so concurrent updates are never lost.
+    /// Returns the new epoch.
+    pub fn update(&self, f: impl FnOnce(&mut T)) -> u64 {
+        let _writer = self.writer.lock();
+        let mut value = T::clone(&self.load());
+        f(&mut value);
+        self.swap_locked(Arc::new(value));
+        self.epoch()
+    }
+
+    /// Like `update`, but publishes nothing if `f` fails
+    pub fn try_update<E>(&self, f: impl FnOnce(&mut T) -> Result<(), E>) -> Result<u64, E> {
+        let _writer = self.writer.lock();
+        let mut value = T::clone(&self.load());
+        f(&mut value)?;
+        self.swap_locked(Arc::new(value));
+        Ok(self.epoch())
+    }
+}
+
+/// Reader-side cache of an `EpochCell` value
+///
+/// `get` reads only the cell's epoch while the value is unchanged, so a
+/// reader on a hot path does not touch the shared reader counters. The
+/// cached value stays alive until the next `get` after a store.
+#[derive(Debug)]
+pub struct EpochCache<T> {
+    epoch: u64,
+    value: Arc<T>,
+}
+
+impl<T> EpochCache<T> {
+    pub fn new(cell: &EpochCell<T>) -> Self {
+        // Read the epoch first: the value loaded after it is at least as new
+        let epoch = cell.epoch();
+        Self {
+            epoch,
+            value: cell.load(),
+        }
+    }
+
+    /// The cell's current value, reloaded only if the cell was stored to
+    #[inline]
+    pub fn get(&mut self, cell: &EpochCell<T>) -> &Arc<T> {
+        let epoch = cell.epoch();
+        if epoch != self.epoch {
+            self.value = cell.load();
+            self.epoch = epoch;
+        }
+        &self.value
+    }
+}
+
+impl<T: Default> Default for EpochCell<T> {
+    fn default() -> Self {
+        Self::new(T::default())
+    }
+}
+
+impl<T: std::fmt::Debug> std::fmt::Debug for EpochCell<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("EpochCell")
+            .field("epoch", &self.epoch())
+            .field("value", &self.load())
+            .finish()
+    }
+}
+
+impl<T> Drop for EpochCell<T> {
+    fn drop(&mut self) {
+        // SAFETY: `&mut self` rules out readers; the pointer holds the
+        // cell's own reference.
+        unsafe { drop(Arc::from_raw(*self.current.get_mut())) };
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicBool;
+
+    #[test]
+    fn test_cache_follows_stores() {
+        let cell = EpochCell::new(1);
+        let mut cache = EpochCache::new(&cell);
+        let first = cache.get(&cell).clone();
+        assert!(Arc::ptr_eq(&first, cache.get(&cell)));
+
+        cell.store(Arc::new(2));
+        assert_eq!(**cache.get(&cell), 2);
+        cell.update(|v| *v += 1);
+        assert_eq!(**cache.get(&cell), 3);
+    }
+
+    #[test]
+    fn test_load_store() {
+        let cell = EpochCell::new(vec![1, 2, 3]);
+        assert_eq!(*cell.load(), vec![1, 2, 3]);
+        assert_eq!(cell.epoch(), 0);
+
+        let held = cell.load();
+        let old = cell.store(Arc::new(vec![4]));
+        assert_eq!(*old, vec![1, 2, 3]);
+        assert!(Arc::ptr_eq(&old, &held));
+        assert_eq!(*cell.load(), vec![4]);
+        assert_eq!(cell.epoch(), 1);
+
+        assert_eq!(cell.update(|v| v.push(5)), 2);
+        assert_eq!(*cell.load(), vec![4, 5]);
+
+        let failed: Result<u64, &str> = cell.try_update(|v| {
+            v.push(6);
+            Err("rejected")
+        });
+        assert_eq!(failed, Err("rejected"));
+        assert_eq!(*cell.load(), vec![4, 5]);
+        let updated: Result<u64, &str> = cell.try_update(|v| {
+            v.push(6);
+            Ok(())
+        });
+        assert_eq!(updated, Ok(3));
+    }
+
+    #[test]
+    fn test_old_value_dropped_by_last_reader() {
+        let value = Arc::new(String::from("old"));
+        let cell = EpochCell::from_arc(value.clone());
+        let reader = cell.load();
+        assert_eq!(Arc::strong_count(&value), 3);
+
+        drop(cell.store(Arc::new(String::from("new"))));
+        assert_eq!(Arc::strong_count(&value), 2);
+        drop(reader);
+        assert_eq!(Arc::strong_count(&value), 1);
+
+        let new = cell.load();
+        drop(cell);
+        assert_eq!(Arc::strong_count(&new), 1);
+    }
+
+    #[test]
+    fn test_concurrent_readers_see_whole_values() {
+        let cell = Arc::new(EpochCell::new(vec![0u64; 64]));
+        let stop = Arc::new(AtomicBool::new(false));
+        let loads = Arc::new(AtomicU64::new(0));
+
+        let readers: Vec<_> = (0..4)
+            .map(|_| {
+                let cell = cell.clone();
+                let stop = stop.clone();
+                let loads = loads.clone();
+                std::thread::spawn(move || {
+                    while !stop.load(Ordering::Relaxed) {
+                        let value = cell.load();
+                        assert!(value.iter().all(|&x| x == value[0]));
+                        loads.fetch_add(1, Ordering::Relaxed);
+                    }
+                })
+            })
+            .collect();
+
+        let mut generation = 0u64;
+        while generation < 500 || loads.load(Ordering::Relaxed) < 10_000 {
+            generation += 1;
+            cell.store(Arc::new(vec![generation; 64]));
+        }
+        stop.store(true, Ordering::Relaxed);
+
+        for reader in readers {
+            reader.join().unwrap();
+        }
+        assert_eq!(cell.epoch(), generation);
+        assert_eq!(cell.load()[0], generation);
+    }
+}
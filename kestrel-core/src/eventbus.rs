@@ -2,16 +2,59 @@
 //!
 //! The EventBus is responsible for transporting events from sources to detection workers.
 //! It supports batching, backpressure, and partitioning.
-
+//!
+//! Each partition is fed through a pre-sized lock-free ring (`crate::ring`);
+//! its worker drains the ring in batches and hands them to the sink and to
+//! any fan-out subscribers (`crate::fanout`).
+//!
+//! Workers run either as tasks on the shared tokio runtime
+//! (`EventBus::new_with_sink`) or thread-per-core
+//! (`EventBus::new_thread_per_core`), where each partition owns a pinned OS
+//! thread that also runs the partition's `PartitionHandler`.
+//!
+//! With `EventBusConfig::rebalance` set, entity keys are routed through a
+//! table that moves hot key ranges off overloaded partitions
+//! (`crate::rebalance`).
+//!
+//! Every partition has a second, smaller ring for high-priority event types
+//! (`crate::priority`), which its worker drains and delivers before the
+//! regular batch.
+//!
+//! With `EventBusConfig::overload` set, publishers consult an overload
+//! controller (`crate::overload`) that sheds low-value event types while
+//! the rings stay full or batches wait too long.
+//!
+//! Batch `Vec`s come from a per-bus `EventVecPool`; sink consumers hand
+//! them back with `EventBusHandle::recycle_batch` to keep their capacity.
+
+use crate::affinity;
+use crate::batching::{AdaptiveBatchingConfig, BatchSizer};
+use crate::fanout::{FanOut, SlowSubscriberPolicy, SubscriberMetricsSnapshot, Subscription};
+use crate::metrics::{Histogram, HistogramSnapshot, PoolMetricsSnapshot};
+use crate::object_pool::{EventVecPool, ObjectPool, Reset};
+use crate::overload::{OverloadConfig, OverloadController, OverloadReport};
+use crate::priority::{EventPriority, PriorityClasses};
+use crate::rebalance::{
+    Control, EntityRange, PartitionRouting, PartitionState, RebalanceConfig, Rebalancer,
+    RouteGuard, RoutingTable,
+};
+use crate::ring::{self, RingConsumer, RingError, RingProducer};
+use crate::time::monotonic_ns;
 use crate::BackpressureConfig;
 use kestrel_event::Event;
 use std::collections::hash_map::DefaultHasher;
 use std::hash::{Hash, Hasher};
-use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
 use std::sync::Arc;
 use tokio::sync::mpsc;
 use tokio::time::{timeout, Duration};
-use tracing::{debug, error, info};
+use tracing::{debug, error, info, warn};
+
+/// Idle batch `Vec`s the pool keeps per partition
+const POOLED_BATCHES_PER_PARTITION: usize = 4;
+
+/// Idle `publish_batch` group sets kept across calls
+const POOLED_PUBLISH_GROUPS: usize = 16;
 
 /// Partition strategy for distributing events across workers
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -85,9 +128,15 @@ impl Partitioner for DefaultPartitioner {
 /// Event bus configuration
 #[derive(Debug, Clone)]
 pub struct EventBusConfig {
-    /// Channel buffer size per partition
+    /// Ring capacity per partition (rounded up to a power of two)
     pub channel_size: usize,
 
+    /// Capacity of each partition's high-priority lane
+    pub priority_channel_size: usize,
+
+    /// Event types routed through the high-priority lane from the start
+    pub high_priority_event_types: Vec<u16>,
+
     /// Batch size for worker delivery
     pub batch_size: usize,
 
@@ -102,29 +151,192 @@ pub struct EventBusConfig {
 
     /// Batch timeout - maximum time to wait before sending a partial batch
     pub batch_timeout_ms: u64,
+
+    /// Size batches from the observed traffic instead of `batch_size` and
+    /// `batch_timeout_ms`
+    pub adaptive_batching: Option<AdaptiveBatchingConfig>,
+
+    /// Number of recent batches kept for fan-out subscribers
+    pub subscriber_buffer_batches: usize,
+
+    /// Policy for subscribers that fall behind the fan-out window
+    pub slow_subscriber_policy: SlowSubscriberPolicy,
+
+    /// Placement of partition threads in thread-per-core mode
+    pub thread_per_core: ThreadPerCoreConfig,
+
+    /// Move hot entity ranges between partitions; routes by entity key and
+    /// overrides `partition_strategy`
+    pub rebalance: Option<RebalanceConfig>,
+
+    /// Shed low-value event types under sustained overload
+    pub overload: Option<OverloadConfig>,
+}
+
+/// Placement of partition threads for `EventBus::new_thread_per_core`
+#[derive(Debug, Clone)]
+pub struct ThreadPerCoreConfig {
+    /// Pin each partition thread to its own core
+    pub pin_threads: bool,
+
+    /// Alternate partitions across NUMA nodes when choosing cores
+    pub numa_aware: bool,
+}
+
+impl Default for ThreadPerCoreConfig {
+    fn default() -> Self {
+        Self {
+            pin_threads: true,
+            numa_aware: false,
+        }
+    }
 }
 
 impl Default for EventBusConfig {
     fn default() -> Self {
         Self {
             channel_size: 10000,
+            priority_channel_size: 1024,
+            high_priority_event_types: Vec::new(),
             batch_size: 100,
             partitions: 4,
             backpressure: BackpressureConfig::default(),
             partition_strategy: PartitionStrategy::default(),
             batch_timeout_ms: 100, // 100ms default batch timeout
+            adaptive_batching: None,
+            subscriber_buffer_batches: 64,
+            slow_subscriber_policy: SlowSubscriberPolicy::default(),
+            thread_per_core: ThreadPerCoreConfig::default(),
+            rebalance: None,
+            overload: None,
         }
     }
 }
 
+/// Consumer that runs on a partition's own thread in thread-per-core mode
+///
+/// Receives every batch routed to its partition, so it can evaluate events
+/// and update per-entity state without any cross-thread handoff.
+pub trait PartitionHandler: Send + 'static {
+    /// Handle a batch of events for `partition_id`
+    fn handle_batch(&mut self, partition_id: usize, batch: &[Event]);
+
+    /// Remove and return the state of entities in `range`, which is moving
+    /// to another partition
+    fn export_state(
+        &mut self,
+        _partition_id: usize,
+        _range: &EntityRange,
+    ) -> Option<PartitionState> {
+        None
+    }
+
+    /// Take over state exported by the previous owner of `range`
+    fn import_state(&mut self, _partition_id: usize, _range: &EntityRange, _state: PartitionState) {
+    }
+}
+
+impl<F> PartitionHandler for F
+where
+    F: FnMut(usize, &[Event]) + Send + 'static,
+{
+    fn handle_batch(&mut self, partition_id: usize, batch: &[Event]) {
+        self(partition_id, batch)
+    }
+}
+
+/// A high-priority event with the `monotonic_ns` it was published at
+type Stamped = (u64, Event);
+
+/// Per-partition groups built by `publish_batch`
+///
+/// Pooled on the handle, so the group buffers keep their capacity across
+/// calls.
+#[derive(Default)]
+struct PublishGroups {
+    normal: Vec<Vec<Event>>,
+    priority: Vec<Vec<Stamped>>,
+}
+
+impl Reset for PublishGroups {
+    fn reset(&mut self) {
+        self.normal.iter_mut().for_each(Vec::clear);
+        self.priority.iter_mut().for_each(Vec::clear);
+    }
+}
+
+/// A value queued in a lane, routed by the event it carries
+trait Queued {
+    fn event(&self) -> &Event;
+}
+
+impl Queued for Event {
+    fn event(&self) -> &Event {
+        self
+    }
+}
+
+impl Queued for Stamped {
+    fn event(&self) -> &Event {
+        &self.1
+    }
+}
+
+/// Publishing ends of one partition's lanes
+#[derive(Clone)]
+struct LaneProducers {
+    normal: RingProducer<Event>,
+    priority: RingProducer<Stamped>,
+}
+
+/// Receiving ends of one partition's lanes
+struct Lanes {
+    normal: RingConsumer<Event>,
+    priority: RingConsumer<Stamped>,
+}
+
+impl Lanes {
+    fn new(config: &EventBusConfig) -> (LaneProducers, Self) {
+        let (normal, normal_rx) = ring::ring(config.channel_size);
+        let (priority, priority_rx) = ring::ring(config.priority_channel_size);
+        (
+            LaneProducers { normal, priority },
+            Self {
+                normal: normal_rx,
+                priority: priority_rx,
+            },
+        )
+    }
+
+    fn is_empty(&self) -> bool {
+        self.normal.is_empty() && self.priority.is_empty()
+    }
+
+    fn is_drained(&self) -> bool {
+        self.normal.is_drained() && self.priority.is_drained()
+    }
+
+    fn close(&self) {
+        self.normal.close();
+        self.priority.close();
+    }
+}
+
 /// Handle for publishing events to the bus
 #[derive(Clone)]
 pub struct EventBusHandle {
-    senders: Arc<Vec<mpsc::Sender<Event>>>,
+    producers: Arc<[RingProducer<Event>]>,
+    priority_producers: Arc<[RingProducer<Stamped>]>,
+    priorities: Arc<PriorityClasses>,
     partition_count: usize,
     metrics: Arc<EventBusMetrics>,
     backpressure_config: BackpressureConfig,
     partitioner: Arc<dyn Partitioner>,
+    /// Bucket routing when rebalancing is enabled
+    routes: Option<Arc<RoutingTable>>,
+    overload: Option<Arc<OverloadController>>,
+    batch_pool: Arc<EventVecPool>,
+    publish_groups: Arc<ObjectPool<PublishGroups>>,
 }
 
 impl std::fmt::Debug for EventBusHandle {
@@ -138,17 +350,58 @@ impl std::fmt::Debug for EventBusHandle {
 
 impl EventBusHandle {
     /// Get partition index for an event
-    fn get_partition(&self, event: &Event) -> usize {
-        self.partitioner.partition(event, self.partition_count)
+    ///
+    /// With rebalancing, the returned guard must be held until the event is
+    /// pushed so its bucket cannot move to another partition in between.
+    fn get_partition(&self, event: &Event) -> (usize, Option<RouteGuard<'_>>) {
+        match &self.routes {
+            Some(routes) => {
+                let (partition, guard) = routes.enter(event.entity_key);
+                (partition, Some(guard))
+            }
+            None => {
+                let partition = self.partitioner.partition(event, self.partition_count);
+                (partition, None)
+            }
+        }
+    }
+
+    /// Whether the overload controller lets `event` through to `partition`
+    ///
+    /// High-priority event types are never shed.
+    fn admit(&self, event: &Event, partition: usize) -> bool {
+        match &self.overload {
+            Some(overload) => {
+                overload.tick(partition, || self.queue_fill());
+                self.priorities.is_high(event.event_type_id) || overload.admit(event)
+            }
+            None => true,
+        }
+    }
+
+    /// Fill ratio of the fullest regular lane
+    fn queue_fill(&self) -> f64 {
+        self.producers
+            .iter()
+            .map(|p| p.len() as f64 / p.capacity() as f64)
+            .fold(0.0, f64::max)
     }
 
     /// Publish a single event
     #[tracing::instrument(skip(self), fields(event_id = %event.ts_mono_ns, partition_id))]
     pub async fn publish(&self, event: Event) -> Result<(), PublishError> {
-        let partition = self.get_partition(&event);
-        let sender = &self.senders[partition];
+        let route = self.get_partition(&event);
+        if !self.admit(&event, route.0) {
+            return Err(PublishError::Shed);
+        }
+        let pushed = if self.priorities.is_high(event.event_type_id) {
+            self.push_routed(&self.priority_producers, route, (monotonic_ns(), event))
+                .await
+        } else {
+            self.push_routed(&self.producers, route, event).await
+        };
 
-        match sender.send(event).await {
+        match pushed {
             Ok(()) => {
                 self.metrics.events_received.fetch_add(1, Ordering::Relaxed);
                 Ok(())
@@ -160,12 +413,197 @@ impl EventBusHandle {
         }
     }
 
+    /// Publish a batch of events
+    ///
+    /// Events are grouped by partition and lane and each group is pushed to
+    /// its ring with a single slot claim, waiting for space if needed. Events
+    /// shed under overload are skipped and counted in `events_shed`.
+    pub async fn publish_batch(&self, events: Vec<Event>) -> Result<(), PublishError> {
+        let mut groups = self.publish_groups.pull();
+        groups.normal.resize_with(self.partition_count, Vec::new);
+        groups.priority.resize_with(self.partition_count, Vec::new);
+        let result = self.publish_grouped(events, &mut groups).await;
+        self.publish_groups.recycle(groups);
+        result
+    }
+
+    /// Sort `events` into `groups` and push them
+    async fn publish_grouped(
+        &self,
+        events: Vec<Event>,
+        groups: &mut PublishGroups,
+    ) -> Result<(), PublishError> {
+        let PublishGroups { normal, priority } = groups;
+        let mut routes = Vec::new();
+        let now = monotonic_ns();
+        for event in events {
+            let (partition, route) = self.get_partition(&event);
+            if !self.admit(&event, partition) {
+                continue;
+            }
+            routes.extend(route);
+            if self.priorities.is_high(event.event_type_id) {
+                priority[partition].push((now, event));
+            } else {
+                normal[partition].push(event);
+            }
+        }
+
+        if self.routes.is_none() {
+            // High-priority events go first so they are not held up by a full lane
+            let priority = self.push_groups(&self.priority_producers, priority).await;
+            let normal = self.push_groups(&self.producers, normal).await;
+            return priority.and(normal);
+        }
+
+        // Routes are held only while nothing waits: groups that do not fit
+        // are routed again event by event once the guards are released
+        let priority_result = self.try_push_groups(&self.priority_producers, priority);
+        let normal_result = self.try_push_groups(&self.producers, normal);
+        drop(routes);
+        let priority_result =
+            priority_result.and(self.push_rerouted(&self.priority_producers, priority).await);
+        let normal_result = normal_result.and(self.push_rerouted(&self.producers, normal).await);
+        priority_result.and(normal_result)
+    }
+
+    /// Push whole per-partition groups that fit without waiting
+    ///
+    /// Groups that do not fit are left in place; the others are emptied.
+    fn try_push_groups<T>(
+        &self,
+        producers: &[RingProducer<T>],
+        groups: &mut [Vec<T>],
+    ) -> Result<(), PublishError> {
+        let mut published = 0u64;
+        let mut result = Ok(());
+        for (producer, group) in producers.iter().zip(groups) {
+            let len = group.len() as u64;
+            match producer.try_push_batch(group) {
+                Ok(()) => published += len,
+                Err(RingError::Full) => {}
+                Err(e) => {
+                    group.clear();
+                    self.metrics
+                        .events_dropped
+                        .fetch_add(len, Ordering::Relaxed);
+                    result = Err(e.into());
+                }
+            }
+        }
+
+        self.metrics
+            .events_received
+            .fetch_add(published, Ordering::Relaxed);
+        result
+    }
+
+    /// Route and push each grouped value again, waiting for space
+    async fn push_rerouted<T: Queued>(
+        &self,
+        producers: &[RingProducer<T>],
+        groups: &mut [Vec<T>],
+    ) -> Result<(), PublishError> {
+        let mut result = Ok(());
+        for value in groups.iter_mut().flat_map(|group| group.drain(..)) {
+            let route = self.get_partition(value.event());
+            match self.push_routed(producers, route, value).await {
+                Ok(()) => {
+                    self.metrics.events_received.fetch_add(1, Ordering::Relaxed);
+                }
+                Err(e) => {
+                    self.metrics.events_dropped.fetch_add(1, Ordering::Relaxed);
+                    result = Err(e.into());
+                }
+            }
+        }
+        result
+    }
+
+    /// Push `value` to the partition of `route`, waiting for space
+    ///
+    /// With rebalancing, the route guard is held only while pushing without
+    /// waiting. On a full ring it is released for the wait and the route
+    /// looked up again, since the bucket may have moved in the meantime.
+    async fn push_routed<T: Queued>(
+        &self,
+        producers: &[RingProducer<T>],
+        route: (usize, Option<RouteGuard<'_>>),
+        value: T,
+    ) -> Result<(), RingError> {
+        let (mut partition, mut guard) = route;
+        let mut value = value;
+        loop {
+            if guard.is_none() {
+                return producers[partition].push(value).await;
+            }
+            let producer = &producers[partition];
+            match producer.try_push_or_keep(value) {
+                Ok(()) => return Ok(()),
+                Err((RingError::Full, kept)) => value = kept,
+                Err((e, _)) => return Err(e),
+            }
+            drop(guard);
+            producer.writable().await;
+            (partition, guard) = self.get_partition(value.event());
+        }
+    }
+
+    /// Push per-partition groups to their rings, counting the outcome
+    ///
+    /// Pushed values are drained; values left after an error are dropped
+    /// when the groups are recycled.
+    async fn push_groups<T>(
+        &self,
+        producers: &[RingProducer<T>],
+        groups: &mut [Vec<T>],
+    ) -> Result<(), PublishError> {
+        let mut published = 0u64;
+        let mut result = Ok(());
+        for (producer, group) in producers.iter().zip(groups) {
+            let len = group.len() as u64;
+            if let Err(e) = producer.push_batch(group).await {
+                let pushed = len - group.len() as u64;
+                published += pushed;
+                self.metrics
+                    .events_dropped
+                    .fetch_add(len - pushed, Ordering::Relaxed);
+                result = Err(e.into());
+                continue;
+            }
+            published += len;
+        }
+
+        self.metrics
+            .events_received
+            .fetch_add(published, Ordering::Relaxed);
+        result
+    }
+
     /// Publish with backpressure - blocks until there's capacity
     pub async fn publish_with_backpressure(&self, event: Event) -> Result<(), PublishError> {
-        let partition = self.get_partition(&event);
+        let route = self.get_partition(&event);
+        if !self.admit(&event, route.0) {
+            return Err(PublishError::Shed);
+        }
+        if self.priorities.is_high(event.event_type_id) {
+            return self
+                .push_with_backpressure(&self.priority_producers, route, (monotonic_ns(), event))
+                .await;
+        }
 
-        let sender = &self.senders[partition];
-        if sender.capacity() == 0 {
+        self.push_with_backpressure(&self.producers, route, event)
+            .await
+    }
+
+    async fn push_with_backpressure<T: Queued>(
+        &self,
+        producers: &[RingProducer<T>],
+        route: (usize, Option<RouteGuard<'_>>),
+        event: T,
+    ) -> Result<(), PublishError> {
+        let producer = &producers[route.0];
+        if producer.len() >= producer.capacity() {
             self.metrics
                 .backpressure_count
                 .fetch_add(1, Ordering::Relaxed);
@@ -173,44 +611,104 @@ impl EventBusHandle {
             let timeout_duration = Duration::from_millis(
                 self.backpressure_config.backpressure_timeout.as_millis() as u64,
             );
-            match timeout(timeout_duration, sender.reserve()).await {
-                Ok(Ok(permit)) => {
-                    permit.send(event);
+            match timeout(timeout_duration, self.push_routed(producers, route, event)).await {
+                Ok(Ok(())) => {
                     self.metrics.events_received.fetch_add(1, Ordering::Relaxed);
                     return Ok(());
                 }
-                _ => return Err(PublishError::BackpressureTimeout),
+                Ok(Err(e)) => return Err(e.into()),
+                Err(_) => return Err(PublishError::BackpressureTimeout),
             }
         }
 
-        sender.send(event).await.map_err(|_| PublishError::Closed)?;
+        self.push_routed(producers, route, event).await?;
         self.metrics.events_received.fetch_add(1, Ordering::Relaxed);
         Ok(())
     }
 
     /// Try to publish without blocking
     pub fn try_publish(&self, event: Event) -> Result<(), PublishError> {
-        let partition = self.get_partition(&event);
-        let sender = &self.senders[partition];
+        let (partition, _route) = self.get_partition(&event);
+        if !self.admit(&event, partition) {
+            return Err(PublishError::Shed);
+        }
+        let pushed = if self.priorities.is_high(event.event_type_id) {
+            self.priority_producers[partition].try_push((monotonic_ns(), event))
+        } else {
+            self.producers[partition].try_push(event)
+        };
 
-        match sender.try_send(event) {
+        match pushed {
             Ok(()) => {
                 self.metrics.events_received.fetch_add(1, Ordering::Relaxed);
                 Ok(())
             }
             Err(e) => {
                 self.metrics.events_dropped.fetch_add(1, Ordering::Relaxed);
-                match e {
-                    mpsc::error::TrySendError::Full(_) => Err(PublishError::Full),
-                    mpsc::error::TrySendError::Closed(_) => Err(PublishError::Closed),
-                }
+                Err(e.into())
+            }
+        }
+    }
+
+    /// Route `event_type` through the normal or the high-priority lane
+    pub fn set_event_priority(&self, event_type: u16, priority: EventPriority) {
+        self.priorities.set(event_type, priority);
+    }
+
+    /// Route exactly `event_types`, plus those configured in
+    /// `high_priority_event_types`, through the high-priority lane
+    pub fn set_high_priority_event_types(&self, event_types: &[u16]) {
+        self.priorities.replace_high(event_types);
+    }
+
+    /// Current priority class of `event_type`
+    pub fn event_priority(&self, event_type: u16) -> EventPriority {
+        self.priorities.get(event_type)
+    }
+
+    /// Never shed `event_types` under overload
+    pub fn protect_event_types(&self, event_types: &[u16]) {
+        if let Some(overload) = &self.overload {
+            for &event_type in event_types {
+                overload.protect(event_type);
+            }
+        }
+    }
+
+    /// Let the overload controller shed `event_types` again
+    pub fn unprotect_event_types(&self, event_types: &[u16]) {
+        if let Some(overload) = &self.overload {
+            for &event_type in event_types {
+                overload.unprotect(event_type);
             }
         }
     }
 
+    /// What the overload controller has shed and why, if it is enabled
+    pub fn overload_report(&self) -> Option<OverloadReport> {
+        self.overload.as_ref().map(|overload| overload.report())
+    }
+
+    /// Hand a batch received from the sink back for reuse
+    pub fn recycle_batch(&self, batch: Vec<Event>) {
+        self.batch_pool.recycle(batch);
+    }
+
+    /// Allocation and reuse counts of the batch pool
+    pub fn batch_pool_metrics(&self) -> PoolMetricsSnapshot {
+        self.batch_pool.metrics().into()
+    }
+
     /// Get current metrics snapshot
     pub fn metrics(&self) -> EventBusMetricsSnapshot {
-        self.metrics.snapshot()
+        let mut snapshot = self.metrics.snapshot();
+        snapshot.normal_lane_depth = self.producers.iter().map(|p| p.len() as u64).sum();
+        snapshot.priority_lane_depth = self.priority_producers.iter().map(|p| p.len() as u64).sum();
+        if let Some(overload) = &self.overload {
+            snapshot.events_shed = overload.shed_total();
+            snapshot.overload_level = overload.level() as u64;
+        }
+        snapshot
     }
 
     /// Get number of partitions
@@ -222,66 +720,76 @@ impl EventBusHandle {
 /// Event bus for transporting events
 pub struct EventBus {
     _handles: Vec<tokio::task::JoinHandle<()>>,
+    _threads: Vec<std::thread::JoinHandle<()>>,
     handle: EventBusHandle,
     shutdown: Arc<AtomicBool>,
-    #[allow(dead_code)]
-    subscriber_tx: Option<mpsc::Sender<Vec<Event>>>,
+    fanout: Arc<FanOut>,
+    default_policy: SlowSubscriberPolicy,
+    rebalancer: Option<Arc<Rebalancer>>,
 }
 
 impl EventBus {
     /// Create a new event bus with the given configuration
     /// The `sink` parameter provides the downstream consumer (e.g., DetectionEngine)
     pub fn new_with_sink(config: EventBusConfig, sink: mpsc::Sender<Vec<Event>>) -> Self {
-        let metrics = Arc::new(EventBusMetrics::default());
         let partition_count = config.partitions.max(1);
+        let metrics = Arc::new(EventBusMetrics::new(partition_count));
+        let (rebalancer, mut routings) = Self::rebalancer(&config, partition_count, &metrics);
+        let overload = Self::overload_controller(&config);
+        let batch_pool = Self::batch_pool(&config, partition_count);
 
-        let mut senders = Vec::with_capacity(partition_count);
-        let mut receivers = Vec::with_capacity(partition_count);
+        let mut producers = Vec::with_capacity(partition_count);
+        let mut consumers = Vec::with_capacity(partition_count);
 
         for _ in 0..partition_count {
-            let (sender, receiver) = mpsc::channel(config.channel_size);
-            senders.push(sender);
-            receivers.push(receiver);
+            let (producer, lanes) = Lanes::new(&config);
+            producers.push(producer);
+            consumers.push(lanes);
         }
 
-        let senders = Arc::new(senders);
-
-        let partitioner: Arc<dyn Partitioner> = 
-            Arc::new(DefaultPartitioner::new(config.partition_strategy));
-
-        let handle = EventBusHandle {
-            senders: senders.clone(),
-            partition_count,
-            metrics: metrics.clone(),
-            backpressure_config: config.backpressure.clone(),
-            partitioner,
-        };
+        let handle = Self::build_handle(
+            &config,
+            producers,
+            metrics.clone(),
+            rebalancer.as_deref(),
+            overload.clone(),
+            batch_pool.clone(),
+        );
 
         let mut handles = Vec::new();
         let shutdown = Arc::new(AtomicBool::new(false));
-
-        for partition_id in 0..partition_count {
-            let receiver = receivers.remove(0);
-            let metrics_clone = metrics.clone();
+        let fanout = FanOut::new(config.subscriber_buffer_batches);
+        let live_workers = Arc::new(AtomicUsize::new(partition_count));
+
+        for (partition_id, lanes) in consumers.into_iter().enumerate() {
+            let output = PartitionOutput {
+                target: BatchTarget::Sink(sink.clone()),
+                fanout: fanout.clone(),
+                metrics: metrics.clone(),
+                live_workers: live_workers.clone(),
+                overload: overload.clone(),
+                batch_pool: batch_pool.clone(),
+            };
+            let sizer = Self::batch_sizer(&config);
+            let routing = routings.next();
             let shutdown_clone = shutdown.clone();
-            let sink_tx = sink.clone();
 
             let handle_task = tokio::spawn(async move {
-                Self::worker_partition(
-                    partition_id,
-                    receiver,
-                    sink_tx,
-                    config.batch_size,
-                    metrics_clone,
-                    shutdown_clone,
-                    config.batch_timeout_ms,
-                )
-                .await;
+                Self::worker_partition(partition_id, lanes, output, sizer, routing, shutdown_clone)
+                    .await;
             });
 
             handles.push(handle_task);
         }
 
+        let mut threads = Vec::new();
+        if let Some(rebalancer) = &rebalancer {
+            match rebalancer.clone().spawn(shutdown.clone()) {
+                Ok(thread) => threads.push(thread),
+                Err(e) => error!(error = %e, "Failed to start rebalancer"),
+            }
+        }
+
         info!(
             partitions = partition_count,
             batch_size = config.batch_size,
@@ -291,9 +799,295 @@ impl EventBus {
 
         Self {
             _handles: handles,
+            _threads: threads,
+            handle,
+            shutdown,
+            fanout,
+            default_policy: config.slow_subscriber_policy,
+            rebalancer,
+        }
+    }
+
+    /// Create an event bus with one dedicated OS thread per partition
+    ///
+    /// `make_handler` is called once per partition; the handler then runs on
+    /// that partition's thread for every batch, so ingestion, evaluation and
+    /// state updates for its entity keys stay on one core. Threads are pinned
+    /// according to `config.thread_per_core`, and each partition's ring is
+    /// allocated on its own thread so its memory is local to that core.
+    ///
+    /// Does not need to be called from within a tokio runtime.
+    pub fn new_thread_per_core<F, H>(
+        config: EventBusConfig,
+        mut make_handler: F,
+    ) -> std::io::Result<Self>
+    where
+        F: FnMut(usize) -> H,
+        H: PartitionHandler,
+    {
+        let partition_count = config.partitions.max(1);
+        let metrics = Arc::new(EventBusMetrics::new(partition_count));
+        let (rebalancer, mut routings) = Self::rebalancer(&config, partition_count, &metrics);
+        let overload = Self::overload_controller(&config);
+        let batch_pool = Self::batch_pool(&config, partition_count);
+        let shutdown = Arc::new(AtomicBool::new(false));
+        let fanout = FanOut::new(config.subscriber_buffer_batches);
+        let live_workers = Arc::new(AtomicUsize::new(partition_count));
+
+        let placement = &config.thread_per_core;
+        let cores = if placement.pin_threads {
+            affinity::plan_cores(
+                partition_count,
+                &affinity::allowed_cpus(),
+                &affinity::numa_nodes(),
+                placement.numa_aware,
+            )
+        } else {
+            Vec::new()
+        };
+
+        let (ready_tx, ready_rx) = std::sync::mpsc::channel();
+        let mut threads = Vec::with_capacity(partition_count);
+
+        for partition_id in 0..partition_count {
+            let output = PartitionOutput {
+                target: BatchTarget::Handler(Box::new(make_handler(partition_id))),
+                fanout: fanout.clone(),
+                metrics: metrics.clone(),
+                live_workers: live_workers.clone(),
+                overload: overload.clone(),
+                batch_pool: batch_pool.clone(),
+            };
+            let core = cores.get(partition_id).copied();
+            let sizer = Self::batch_sizer(&config);
+            let routing = routings.next();
+            let shutdown_clone = shutdown.clone();
+            let ready_tx = ready_tx.clone();
+            let config = config.clone();
+
+            let spawned = std::thread::Builder::new()
+                .name(format!("kestrel-partition-{}", partition_id))
+                .spawn(move || {
+                    if let Some(core) = core {
+                        if let Err(e) = affinity::pin_current_thread(core) {
+                            warn!(
+                                partition = partition_id,
+                                core,
+                                error = %e,
+                                "Failed to pin partition thread"
+                            );
+                        }
+                    }
+
+                    let runtime = match tokio::runtime::Builder::new_current_thread()
+                        .enable_time()
+                        .build()
+                    {
+                        Ok(runtime) => runtime,
+                        Err(e) => {
+                            let _ = ready_tx.send(Err(e));
+                            return;
+                        }
+                    };
+
+                    // Allocated after pinning so the slots are first touched locally
+                    let (producer, lanes) = Lanes::new(&config);
+                    if ready_tx.send(Ok((partition_id, producer))).is_err() {
+                        return;
+                    }
+                    drop(ready_tx);
+
+                    runtime.block_on(Self::worker_partition(
+                        partition_id,
+                        lanes,
+                        output,
+                        sizer,
+                        routing,
+                        shutdown_clone,
+                    ));
+                });
+            match spawned {
+                Ok(thread) => threads.push(thread),
+                Err(e) => {
+                    return Err(Self::abort_startup(
+                        &shutdown,
+                        Vec::new(),
+                        &ready_rx,
+                        threads,
+                        e,
+                    ))
+                }
+            }
+        }
+        drop(ready_tx);
+
+        let mut producers: Vec<Option<LaneProducers>> = vec![None; partition_count];
+        for _ in 0..partition_count {
+            let ready = ready_rx
+                .recv()
+                .map_err(|_| {
+                    std::io::Error::new(std::io::ErrorKind::Other, "partition thread exited")
+                })
+                .and_then(|ready| ready);
+            match ready {
+                Ok((partition_id, producer)) => producers[partition_id] = Some(producer),
+                Err(e) => {
+                    return Err(Self::abort_startup(
+                        &shutdown, producers, &ready_rx, threads, e,
+                    ))
+                }
+            }
+        }
+
+        if let Some(rebalancer) = &rebalancer {
+            match rebalancer.clone().spawn(shutdown.clone()) {
+                Ok(thread) => threads.push(thread),
+                Err(e) => {
+                    return Err(Self::abort_startup(
+                        &shutdown, producers, &ready_rx, threads, e,
+                    ))
+                }
+            }
+        }
+        let producers = producers.into_iter().flatten().collect();
+
+        let handle = Self::build_handle(
+            &config,
+            producers,
+            metrics,
+            rebalancer.as_deref(),
+            overload,
+            batch_pool,
+        );
+
+        info!(
+            partitions = partition_count,
+            pinned = !cores.is_empty(),
+            numa_aware = placement.numa_aware,
+            "EventBus initialized with thread-per-core workers"
+        );
+
+        Ok(Self {
+            _handles: Vec::new(),
+            _threads: threads,
             handle,
             shutdown,
-            subscriber_tx: None,
+            fanout,
+            default_policy: config.slow_subscriber_policy,
+            rebalancer,
+        })
+    }
+
+    /// Stop the threads of a failed `new_thread_per_core` startup
+    ///
+    /// Workers see the shutdown flag within one batch timeout; closing the
+    /// lanes they already reported wakes those immediately.
+    fn abort_startup(
+        shutdown: &AtomicBool,
+        producers: Vec<Option<LaneProducers>>,
+        ready_rx: &std::sync::mpsc::Receiver<std::io::Result<(usize, LaneProducers)>>,
+        threads: Vec<std::thread::JoinHandle<()>>,
+        error: std::io::Error,
+    ) -> std::io::Error {
+        shutdown.store(true, Ordering::Relaxed);
+        let reported = ready_rx.try_iter().filter_map(Result::ok);
+        for producer in producers
+            .into_iter()
+            .flatten()
+            .chain(reported.map(|(_, producer)| producer))
+        {
+            producer.normal.close();
+            producer.priority.close();
+        }
+        for thread in threads {
+            let _ = thread.join();
+        }
+        error
+    }
+
+    /// Batch sizing policy for one partition worker
+    fn batch_sizer(config: &EventBusConfig) -> BatchSizer {
+        BatchSizer::new(
+            config.batch_size,
+            config.batch_timeout_ms,
+            config.adaptive_batching.as_ref(),
+        )
+    }
+
+    /// Rebalancer and per-partition routing, if rebalancing is enabled
+    fn rebalancer(
+        config: &EventBusConfig,
+        partition_count: usize,
+        metrics: &Arc<EventBusMetrics>,
+    ) -> (
+        Option<Arc<Rebalancer>>,
+        impl Iterator<Item = PartitionRouting>,
+    ) {
+        let Some(rebalance) = &config.rebalance else {
+            return (None, Vec::new().into_iter());
+        };
+        if config.partition_strategy != PartitionStrategy::EntityKey {
+            warn!(
+                strategy = ?config.partition_strategy,
+                "Rebalancing routes by entity key; partition strategy ignored"
+            );
+        }
+
+        let (rebalancer, routings) =
+            Rebalancer::new(partition_count, rebalance.clone(), metrics.clone());
+        (Some(Arc::new(rebalancer)), routings.into_iter())
+    }
+
+    /// Overload controller shared by the handle and the workers, if enabled
+    fn overload_controller(config: &EventBusConfig) -> Option<Arc<OverloadController>> {
+        let partitions = config.partitions.max(1);
+        config
+            .overload
+            .clone()
+            .map(|overload| Arc::new(OverloadController::new(overload, partitions)))
+    }
+
+    /// Batch `Vec`s shared by the workers and the handle
+    fn batch_pool(config: &EventBusConfig, partition_count: usize) -> Arc<EventVecPool> {
+        Arc::new(EventVecPool::for_events(
+            partition_count,
+            partition_count * POOLED_BATCHES_PER_PARTITION,
+            config.batch_size,
+        ))
+    }
+
+    /// Build the publishing handle over the partition rings
+    fn build_handle(
+        config: &EventBusConfig,
+        lanes: Vec<LaneProducers>,
+        metrics: Arc<EventBusMetrics>,
+        rebalancer: Option<&Rebalancer>,
+        overload: Option<Arc<OverloadController>>,
+        batch_pool: Arc<EventVecPool>,
+    ) -> EventBusHandle {
+        let partitioner: Arc<dyn Partitioner> = match rebalancer {
+            Some(rebalancer) => rebalancer.partitioner(),
+            None => Arc::new(DefaultPartitioner::new(config.partition_strategy)),
+        };
+        let routes = rebalancer.map(|rebalancer| rebalancer.routes());
+
+        let (producers, priority_producers): (Vec<_>, Vec<_>) = lanes
+            .into_iter()
+            .map(|lane| (lane.normal, lane.priority))
+            .unzip();
+
+        EventBusHandle {
+            partition_count: producers.len(),
+            producers: producers.into(),
+            priority_producers: priority_producers.into(),
+            priorities: Arc::new(PriorityClasses::new(&config.high_priority_event_types)),
+            metrics,
+            backpressure_config: config.backpressure.clone(),
+            partitioner,
+            routes,
+            overload,
+            batch_pool,
+            publish_groups: Arc::new(ObjectPool::new(0, POOLED_PUBLISH_GROUPS)),
         }
     }
 
@@ -303,35 +1097,51 @@ impl EventBus {
     /// For production use, prefer `new_with_sink()` to connect to a downstream consumer.
     pub fn new(config: EventBusConfig) -> Self {
         let (sink_tx, mut sink_rx) = mpsc::channel(1);
-        
-        // Spawn a background consumer that simply receives and drops events
+        let bus = Self::new_with_sink(config, sink_tx);
+
+        // Spawn a background consumer that simply receives and recycles batches
         // This ensures events_processed metrics are correctly updated
+        let batch_pool = bus.handle.batch_pool.clone();
         tokio::spawn(async move {
-            while sink_rx.recv().await.is_some() {
-                // Events are consumed and dropped, metrics already updated by worker_partition
+            while let Some(batch) = sink_rx.recv().await {
+                // Events are dropped, metrics already updated by worker_partition
+                batch_pool.recycle(batch);
             }
         });
-        
-        Self::new_with_sink(config, sink_tx)
+
+        bus
     }
 
     /// Subscribe to events from the bus
-    /// Returns a receiver that will receive event batches
-    pub fn subscribe(&self) -> mpsc::Receiver<Vec<Event>> {
-        let (tx, rx) = mpsc::channel(100);
-        if let Some(subscriber_tx) = &self.subscriber_tx {
-            let subscriber_tx = subscriber_tx.clone();
-            tokio::spawn(async move {
-                let _tx = tx;
-                loop {
-                    if subscriber_tx.is_closed() {
-                        break;
-                    }
-                    tokio::time::sleep(Duration::from_millis(100)).await;
-                }
-            });
-        }
-        rx
+    ///
+    /// Every subscriber receives each delivered batch as a shared
+    /// `Arc<[Event]>`. Uses the configured slow subscriber policy.
+    pub fn subscribe(&self) -> Subscription {
+        self.subscribe_with("subscriber", self.default_policy)
+    }
+
+    /// Subscribe with a name (used in metrics) and slow subscriber policy
+    pub fn subscribe_with(
+        &self,
+        name: impl Into<String>,
+        policy: SlowSubscriberPolicy,
+    ) -> Subscription {
+        self.fanout.subscribe(name, policy)
+    }
+
+    /// Cursor lag and drop counters of every subscriber
+    pub fn subscriber_metrics(&self) -> Vec<SubscriberMetricsSnapshot> {
+        self.fanout.subscriber_metrics()
+    }
+
+    /// Run one rebalancing round now, returning the number of buckets moved
+    ///
+    /// Rounds also run every `RebalanceConfig::interval`. Returns 0 when
+    /// rebalancing is disabled.
+    pub fn rebalance(&self) -> usize {
+        self.rebalancer
+            .as_ref()
+            .map_or(0, |rebalancer| rebalancer.rebalance().len())
     }
 
     /// Get a handle for publishing events
@@ -339,109 +1149,340 @@ impl EventBus {
         self.handle.clone()
     }
 
-    /// Worker partition that batches and delivers events
-    #[tracing::instrument(skip(receiver, sink_tx, metrics, shutdown), fields(partition_id))]
+    /// Worker partition that drains its ring in batches and delivers them
+    #[tracing::instrument(skip(lanes, output, sizer, routing, shutdown), fields(partition_id))]
     async fn worker_partition(
         partition_id: usize,
-        mut receiver: mpsc::Receiver<Event>,
-        sink_tx: mpsc::Sender<Vec<Event>>,
-        batch_size: usize,
-        metrics: Arc<EventBusMetrics>,
+        mut lanes: Lanes,
+        mut output: PartitionOutput,
+        mut sizer: BatchSizer,
+        mut routing: Option<PartitionRouting>,
         shutdown: Arc<AtomicBool>,
-        batch_timeout_ms: u64,
     ) {
-        let mut batch = Vec::with_capacity(batch_size);
-        let mut last_send = tokio::time::Instant::now();
-        let batch_timeout = Duration::from_millis(batch_timeout_ms);
+        let mut batch = output.batch_pool.pull();
+        batch.reserve(sizer.size());
+        let mut batch_started = tokio::time::Instant::now();
 
         loop {
-            if shutdown.load(Ordering::Relaxed) {
-                debug!(partition = partition_id, "Shutdown signal received");
-                break;
+            // High-priority events skip batching and go out first
+            if !lanes.priority.is_empty() {
+                Self::deliver_priority(
+                    partition_id,
+                    &mut lanes.priority,
+                    &mut output,
+                    routing.as_mut(),
+                )
+                .await;
             }
 
-            // Check if we need to flush due to timeout
-            let timeout_remaining = if !batch.is_empty() {
-                let elapsed = last_send.elapsed();
-                if elapsed >= batch_timeout {
-                    // Flush batch due to timeout
-                    let batch_len = batch.len();
-                    if let Err(e) = sink_tx.send(std::mem::take(&mut batch)).await {
-                        error!(
-                            partition = partition_id,
-                            error = %e,
-                            "Failed to deliver batch on timeout"
-                        );
-                    } else {
-                        metrics.events_processed.fetch_add(batch_len as u64, Ordering::Relaxed);
-                        debug!(
-                            partition = partition_id,
-                            batch_size = batch_len,
-                            "Flushed batch due to timeout"
-                        );
-                    }
-                    batch = Vec::with_capacity(batch_size);
-                    last_send = tokio::time::Instant::now();
-                    batch_timeout
-                    } else {
-                        batch_timeout - elapsed
-                    }
-            } else {
+            let start = batch.len();
+            let room = sizer.size().saturating_sub(start);
+            let count = lanes.normal.drain_into(&mut batch, room);
+            if count > 0 {
+                if let Some(routing) = routing.as_mut() {
+                    routing.filter(&mut batch, start);
+                }
+                let now = tokio::time::Instant::now();
+                if start == 0 {
+                    batch_started = now;
+                }
+                sizer.record_arrivals(count, now.into_std());
+                debug!(
+                    partition = partition_id,
+                    batch_size = count,
+                    "Drained events from ring"
+                );
+            }
+
+            // Flush when the batch is full or its oldest event has waited too long
+            let elapsed = batch_started.elapsed();
+            let batch_timeout = sizer.timeout();
+            if batch.len() >= sizer.size() || (!batch.is_empty() && elapsed >= batch_timeout) {
+                Self::flush(
+                    partition_id,
+                    &mut output,
+                    &mut sizer,
+                    &mut batch,
+                    batch_started,
+                )
+                .await;
+                continue;
+            }
+
+            if shutdown.load(Ordering::Relaxed) || lanes.normal.is_closed() {
+                // Stop new claims, then wait for producers that claimed
+                // slots but have not published them yet
+                lanes.close();
+                if lanes.is_drained() {
+                    debug!(partition = partition_id, "Shutdown signal received");
+                    break;
+                }
+                if lanes.is_empty() {
+                    tokio::task::yield_now().await;
+                }
+                continue;
+            }
+
+            let wait = if batch.is_empty() {
                 batch_timeout
+            } else {
+                batch_timeout - elapsed
+            };
+            let control = tokio::select! {
+                _ = lanes.normal.readable() => None,
+                _ = lanes.priority.readable() => None,
+                _ = tokio::time::sleep(wait) => None,
+                control = Self::next_control(&mut routing) => Some(control),
             };
 
-            tokio::select! {
-                result = receiver.recv_many(&mut batch, batch_size) => {
-                    match result {
-                        0 => break, // Channel closed
-                        count if count > 0 => {
-                            debug!(
-                                partition = partition_id,
-                                batch_size = count,
-                                "Received batch"
-                            );
+            if let (Some(control), Some(routing)) = (control, routing.as_mut()) {
+                if batch.is_empty() {
+                    batch_started = tokio::time::Instant::now();
+                }
+                match control {
+                    Control::Release {
+                        bucket,
+                        to,
+                        generation,
+                        started,
+                    } => {
+                        // Deliver what was queued before the bucket changed owner
+                        routing.wait_publishers(bucket, generation).await;
+                        Self::deliver_priority(
+                            partition_id,
+                            &mut lanes.priority,
+                            &mut output,
+                            Some(&mut *routing),
+                        )
+                        .await;
+                        let start = batch.len();
+                        lanes.normal.drain_into(&mut batch, lanes.normal.len());
+                        routing.filter(&mut batch, start);
+                        if !batch.is_empty() {
+                            Self::flush(
+                                partition_id,
+                                &mut output,
+                                &mut sizer,
+                                &mut batch,
+                                batch_started,
+                            )
+                            .await;
+                        }
 
-                            // Flush immediately if batch is full
-                            if batch.len() >= batch_size {
-                                let batch_len = batch.len();
-                                if let Err(e) = sink_tx.send(std::mem::take(&mut batch)).await {
-                                    error!(
-                                        partition = partition_id,
-                                        error = %e,
-                                        "Failed to deliver batch"
-                                    );
-                                } else {
-                                    metrics.events_processed.fetch_add(batch_len as u64, Ordering::Relaxed);
-                                    last_send = tokio::time::Instant::now();
-                                }
-                                batch = Vec::with_capacity(batch_size);
-                            }
+                        let range = routing.range(bucket);
+                        let state = output.export_state(partition_id, &range);
+                        routing.release(bucket, to, state, started);
+                    }
+                    Control::Adopt {
+                        bucket,
+                        state,
+                        started,
+                    } => {
+                        if let Some(state) = state {
+                            output.import_state(partition_id, &routing.range(bucket), state);
                         }
-                        _ => {}
+                        batch.extend(routing.adopt(bucket, started));
                     }
                 }
-                _ = tokio::time::sleep(timeout_remaining) => {
-                    // Timeout handled at the beginning of the loop
-                }
             }
         }
 
-        // Flush remaining events on shutdown
+        // Flush remaining events on shutdown, including any still parked
+        if let Some(routing) = routing.as_mut() {
+            batch.extend(routing.take_parked());
+        }
         if !batch.is_empty() {
-            let batch_len = batch.len();
-            let _ = sink_tx.send(batch).await;
-            metrics
-                .events_processed
-                .fetch_add(batch_len as u64, Ordering::Relaxed);
+            Self::flush(
+                partition_id,
+                &mut output,
+                &mut sizer,
+                &mut batch,
+                batch_started,
+            )
+            .await;
+        }
+
+        // The last worker to exit ends the subscriptions
+        if output.live_workers.fetch_sub(1, Ordering::AcqRel) == 1 {
+            output.fanout.close();
         }
 
         debug!(partition = partition_id, "Worker partition shutting down");
     }
+
+    /// Deliver everything waiting in the high-priority lane as one batch
+    async fn deliver_priority(
+        partition_id: usize,
+        lane: &mut RingConsumer<Stamped>,
+        output: &mut PartitionOutput,
+        routing: Option<&mut PartitionRouting>,
+    ) {
+        let mut stamped = Vec::new();
+        lane.drain_into(&mut stamped, usize::MAX);
+        let (published, mut batch): (Vec<u64>, Vec<Event>) = stamped.into_iter().unzip();
+        if let Some(routing) = routing {
+            routing.filter(&mut batch, 0);
+        }
+
+        let len = batch.len();
+        if len > 0 {
+            output.deliver(partition_id, &mut batch, 0).await;
+        }
+        output.batch_pool.recycle(batch);
+
+        let metrics = &output.metrics;
+        if let Some(events) = metrics.partition_events.get(partition_id) {
+            events.fetch_add(len as u64, Ordering::Relaxed);
+        }
+        metrics
+            .priority_lane_events
+            .fetch_add(published.len() as u64, Ordering::Relaxed);
+        let delivered = monotonic_ns();
+        for at in published {
+            metrics
+                .priority_lane_latency_ns
+                .record(delivered.saturating_sub(at));
+        }
+    }
+
+    /// Next rebalancing message for a worker; never resolves without rebalancing
+    async fn next_control(routing: &mut Option<PartitionRouting>) -> Control {
+        match routing {
+            Some(routing) => routing.next_control().await,
+            None => std::future::pending().await,
+        }
+    }
+
+    /// Deliver the current batch and feed its timings back to the sizer
+    async fn flush(
+        partition_id: usize,
+        output: &mut PartitionOutput,
+        sizer: &mut BatchSizer,
+        batch: &mut Vec<Event>,
+        batch_started: tokio::time::Instant,
+    ) {
+        let len = batch.len();
+        let metrics = output.metrics.clone();
+        if let Some(events) = metrics.partition_events.get(partition_id) {
+            events.fetch_add(len as u64, Ordering::Relaxed);
+        }
+        metrics.batch_size.record(len as u64);
+        let queue_delay = batch_started.elapsed();
+        metrics.queue_delay_ns.record(queue_delay.as_nanos() as u64);
+        if let Some(overload) = &output.overload {
+            overload.observe_lag(queue_delay);
+        }
+
+        let started = std::time::Instant::now();
+        output.deliver(partition_id, batch, sizer.size()).await;
+        sizer.record_delivery(len, started.elapsed());
+        metrics
+            .batch_target
+            .store(sizer.size() as u64, Ordering::Relaxed);
+    }
+}
+
+/// Consumer of a partition's batches
+enum BatchTarget {
+    /// Forward batches to a channel consumer
+    Sink(mpsc::Sender<Vec<Event>>),
+    /// Run a handler inline on the partition's thread
+    Handler(Box<dyn PartitionHandler>),
+}
+
+/// Where a partition worker delivers its batches
+struct PartitionOutput {
+    target: BatchTarget,
+    fanout: Arc<FanOut>,
+    metrics: Arc<EventBusMetrics>,
+    /// Workers still running; the last one closes the fan-out
+    live_workers: Arc<AtomicUsize>,
+    /// Receives batch queue delays as a lag signal
+    overload: Option<Arc<OverloadController>>,
+    /// Source of batch `Vec`s, and where delivered ones return
+    batch_pool: Arc<EventVecPool>,
+}
+
+impl PartitionOutput {
+    /// Send the current batch to the target and subscribers, then start a new one
+    ///
+    /// Without subscribers the batch moves to the sink as is. With
+    /// subscribers it is frozen into one `Arc<[Event]>` shared by all of
+    /// them, and a channel sink gets a single copy.
+    ///
+    /// The next batch and any sink copy come from the batch pool; `Vec`s
+    /// that end here go back to it.
+    async fn deliver(&mut self, partition_id: usize, batch: &mut Vec<Event>, batch_size: usize) {
+        let batch_len = batch.len();
+        let mut next = self.batch_pool.pull();
+        next.reserve(batch_size);
+        let mut full = std::mem::replace(batch, next);
+        let fan_out = self.fanout.subscriber_count() > 0;
+
+        let shared = match &mut self.target {
+            BatchTarget::Handler(handler) => {
+                handler.handle_batch(partition_id, &full);
+                self.metrics
+                    .events_processed
+                    .fetch_add(batch_len as u64, Ordering::Relaxed);
+                let shared = fan_out.then(|| full.drain(..).collect::<Arc<[Event]>>());
+                self.batch_pool.recycle(full);
+                shared
+            }
+            BatchTarget::Sink(sink_tx) => {
+                let (sink_batch, shared) = if fan_out {
+                    let shared: Arc<[Event]> = full.drain(..).collect();
+                    self.batch_pool.recycle(full);
+                    let mut copy = self.batch_pool.pull();
+                    copy.extend_from_slice(&shared);
+                    (copy, Some(shared))
+                } else {
+                    (full, None)
+                };
+
+                if let Err(e) = sink_tx.send(sink_batch).await {
+                    error!(
+                        partition = partition_id,
+                        error = %e,
+                        "Failed to deliver batch"
+                    );
+                } else {
+                    self.metrics
+                        .events_processed
+                        .fetch_add(batch_len as u64, Ordering::Relaxed);
+                }
+                shared
+            }
+        };
+
+        if let Some(shared) = shared {
+            self.fanout.publish(shared).await;
+        }
+    }
+
+    fn export_state(&mut self, partition_id: usize, range: &EntityRange) -> Option<PartitionState> {
+        match &mut self.target {
+            BatchTarget::Handler(handler) => handler.export_state(partition_id, range),
+            BatchTarget::Sink(_) => None,
+        }
+    }
+
+    fn import_state(&mut self, partition_id: usize, range: &EntityRange, state: PartitionState) {
+        if let BatchTarget::Handler(handler) = &mut self.target {
+            handler.import_state(partition_id, range, state);
+        }
+    }
 }
 
 impl Drop for EventBus {
     fn drop(&mut self) {
         self.shutdown.store(true, Ordering::Relaxed);
+        for producer in self.handle.producers.iter() {
+            producer.close();
+        }
+        for producer in self.handle.priority_producers.iter() {
+            producer.close();
+        }
     }
 }
 
@@ -452,15 +1493,60 @@ pub struct EventBusMetrics {
     events_processed: AtomicU64,
     events_dropped: AtomicU64,
     backpressure_count: AtomicU64,
+    /// Events per delivered batch
+    batch_size: Histogram,
+    /// Time from the first event entering a batch to its delivery (ns)
+    queue_delay_ns: Histogram,
+    /// Most recent target batch size chosen by a worker
+    batch_target: AtomicU64,
+    /// Events delivered per partition
+    partition_events: Box<[AtomicU64]>,
+    /// Rebalancing rounds run
+    pub(crate) rebalance_rounds: AtomicU64,
+    /// Entity buckets moved between partitions
+    pub(crate) migrations: AtomicU64,
+    /// Time from a bucket changing owner to its state being adopted (ns)
+    pub(crate) migration_ns: Histogram,
+    /// Events held back while their bucket's state was in transit
+    pub(crate) migration_parked_events: AtomicU64,
+    /// Events delivered through the high-priority lane
+    priority_lane_events: AtomicU64,
+    /// Time from publishing a high-priority event to its delivery (ns)
+    priority_lane_latency_ns: Histogram,
 }
 
 impl EventBusMetrics {
+    fn new(partitions: usize) -> Self {
+        Self {
+            partition_events: (0..partitions).map(|_| AtomicU64::new(0)).collect(),
+            ..Default::default()
+        }
+    }
+
     fn snapshot(&self) -> EventBusMetricsSnapshot {
         EventBusMetricsSnapshot {
             events_received: self.events_received.load(Ordering::Relaxed),
             events_processed: self.events_processed.load(Ordering::Relaxed),
             events_dropped: self.events_dropped.load(Ordering::Relaxed),
             backpressure_count: self.backpressure_count.load(Ordering::Relaxed),
+            batch_size: self.batch_size.snapshot(),
+            queue_delay_ns: self.queue_delay_ns.snapshot(),
+            batch_target: self.batch_target.load(Ordering::Relaxed),
+            partition_events: self
+                .partition_events
+                .iter()
+                .map(|e| e.load(Ordering::Relaxed))
+                .collect(),
+            rebalance_rounds: self.rebalance_rounds.load(Ordering::Relaxed),
+            migrations: self.migrations.load(Ordering::Relaxed),
+            migration_ns: self.migration_ns.snapshot(),
+            migration_parked_events: self.migration_parked_events.load(Ordering::Relaxed),
+            normal_lane_depth: 0,
+            priority_lane_depth: 0,
+            priority_lane_events: self.priority_lane_events.load(Ordering::Relaxed),
+            priority_lane_latency_ns: self.priority_lane_latency_ns.snapshot(),
+            events_shed: 0,
+            overload_level: 0,
         }
     }
 }
@@ -472,6 +1558,24 @@ pub struct EventBusMetricsSnapshot {
     pub events_processed: u64,
     pub events_dropped: u64,
     pub backpressure_count: u64,
+    pub batch_size: HistogramSnapshot,
+    pub queue_delay_ns: HistogramSnapshot,
+    pub batch_target: u64,
+    pub partition_events: Vec<u64>,
+    pub rebalance_rounds: u64,
+    pub migrations: u64,
+    pub migration_ns: HistogramSnapshot,
+    pub migration_parked_events: u64,
+    /// Events waiting in the regular lanes; their delay is `queue_delay_ns`
+    pub normal_lane_depth: u64,
+    /// Events waiting in the high-priority lanes
+    pub priority_lane_depth: u64,
+    pub priority_lane_events: u64,
+    pub priority_lane_latency_ns: HistogramSnapshot,
+    /// Events dropped by the overload controller
+    pub events_shed: u64,
+    /// Current shedding level, 0 when not shedding
+    pub overload_level: u64,
 }
 
 /// Error publishing an event
@@ -485,6 +1589,18 @@ pub enum PublishError {
 
     #[error("Backpressure timeout")]
     BackpressureTimeout,
+
+    #[error("Event shed by the overload controller")]
+    Shed,
+}
+
+impl From<RingError> for PublishError {
+    fn from(e: RingError) -> Self {
+        match e {
+            RingError::Full => PublishError::Full,
+            RingError::Closed => PublishError::Closed,
+        }
+    }
 }
 
 #[cfg(test)]
@@ -600,4 +1716,468 @@ mod tests {
         let batch = received.unwrap().unwrap();
         assert_eq!(batch.len(), 1);
     }
+
+    #[tokio::test]
+    async fn test_event_bus_publish_batch() {
+        let config = EventBusConfig {
+            channel_size: 16,
+            batch_size: 8,
+            partitions: 2,
+            ..Default::default()
+        };
+        let (_bus, handle, mut rx) = create_test_bus(config).await;
+
+        // Larger than a partition ring, so it is pushed in chunks
+        let events: Vec<Event> = (0..64)
+            .map(|i| {
+                Event::builder()
+                    .event_type(1)
+                    .ts_mono(i)
+                    .ts_wall(i)
+                    .entity_key(i as u128)
+                    .build()
+                    .unwrap()
+            })
+            .collect();
+
+        let publisher = handle.clone();
+        let publish = tokio::spawn(async move { publisher.publish_batch(events).await });
+
+        let mut received = Vec::new();
+        while received.len() < 64 {
+            let batch = tokio::time::timeout(Duration::from_secs(1), rx.recv())
+                .await
+                .unwrap()
+                .unwrap();
+            assert!(batch.len() <= 8);
+            received.extend(batch);
+        }
+        publish.await.unwrap().unwrap();
+
+        // Per-partition order is preserved
+        for partition in 0..2u128 {
+            let keys: Vec<u128> = received
+                .iter()
+                .map(|e| e.entity_key)
+                .filter(|k| k % 2 == partition)
+                .collect();
+            let expected: Vec<u128> = (0..64).filter(|k| k % 2 == partition).collect();
+            assert_eq!(keys, expected);
+        }
+        assert_eq!(handle.metrics().events_received, 64);
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_fan_out() {
+        let config = EventBusConfig {
+            batch_size: 4,
+            partitions: 1,
+            ..Default::default()
+        };
+        let (bus, handle, mut rx) = create_test_bus(config).await;
+        let mut detection = bus.subscribe();
+        let mut archiver = bus.subscribe_with("archiver", SlowSubscriberPolicy::Block);
+
+        for i in 0..4 {
+            let event = Event::builder()
+                .event_type(1)
+                .ts_mono(i)
+                .ts_wall(i)
+                .entity_key(i as u128)
+                .build()
+                .unwrap();
+            handle.publish(event).await.unwrap();
+        }
+
+        let sink_batch = tokio::time::timeout(Duration::from_secs(1), rx.recv())
+            .await
+            .unwrap()
+            .unwrap();
+        let a = detection.recv().await.unwrap();
+        let b = archiver.recv().await.unwrap();
+        assert_eq!(sink_batch.len(), 4);
+        assert!(Arc::ptr_eq(&a, &b));
+
+        let metrics = bus.subscriber_metrics();
+        assert_eq!(metrics.len(), 2);
+        assert!(metrics
+            .iter()
+            .all(|m| m.received_events == 4 && m.lag_batches == 0));
+        assert_eq!(metrics[1].name, "archiver");
+
+        // Subscriptions end once the bus shuts down
+        drop(bus);
+        assert!(
+            tokio::time::timeout(Duration::from_secs(1), archiver.recv())
+                .await
+                .unwrap()
+                .is_none()
+        );
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_thread_per_core() {
+        use std::collections::HashMap;
+        use std::sync::Mutex;
+
+        let config = EventBusConfig {
+            batch_size: 8,
+            partitions: 2,
+            batch_timeout_ms: 10,
+            ..Default::default()
+        };
+
+        // (partition, thread name, event count) per handled batch
+        let seen: Arc<Mutex<Vec<(usize, String, usize)>>> = Arc::default();
+        let seen_clone = seen.clone();
+        let bus = EventBus::new_thread_per_core(config, move |_| {
+            let seen = seen_clone.clone();
+            move |partition_id: usize, batch: &[Event]| {
+                let thread = std::thread::current().name().unwrap_or("").to_string();
+                seen.lock()
+                    .unwrap()
+                    .push((partition_id, thread, batch.len()));
+            }
+        })
+        .unwrap();
+
+        let events: Vec<Event> = (0..40)
+            .map(|i| {
+                Event::builder()
+                    .event_type(1)
+                    .ts_mono(i)
+                    .ts_wall(i)
+                    .entity_key(i as u128)
+                    .build()
+                    .unwrap()
+            })
+            .collect();
+        bus.handle().publish_batch(events).await.unwrap();
+
+        for _ in 0..100 {
+            if bus.handle().metrics().events_processed == 40 {
+                break;
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+
+        let seen = seen.lock().unwrap();
+        let mut per_partition: HashMap<usize, usize> = HashMap::new();
+        for (partition_id, thread, count) in seen.iter() {
+            assert_eq!(thread, &format!("kestrel-partition-{}", partition_id));
+            *per_partition.entry(*partition_id).or_default() += count;
+        }
+        assert_eq!(per_partition.get(&0), Some(&20));
+        assert_eq!(per_partition.get(&1), Some(&20));
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_adaptive_batching() {
+        let config = EventBusConfig {
+            partitions: 1,
+            adaptive_batching: Some(AdaptiveBatchingConfig {
+                latency_slo: Duration::from_millis(5),
+                min_batch_size: 1,
+                max_batch_size: 256,
+            }),
+            ..Default::default()
+        };
+        let (_bus, handle, mut rx) = create_test_bus(config).await;
+
+        // A lone event is delivered well before the fixed 100ms timeout
+        let event = Event::builder()
+            .event_type(1)
+            .ts_mono(0)
+            .ts_wall(0)
+            .entity_key(0)
+            .build()
+            .unwrap();
+        handle.publish(event).await.unwrap();
+        let batch = tokio::time::timeout(Duration::from_millis(50), rx.recv())
+            .await
+            .unwrap()
+            .unwrap();
+        assert_eq!(batch.len(), 1);
+
+        let metrics = handle.metrics();
+        assert_eq!(metrics.batch_size.count, 1);
+        assert_eq!(metrics.queue_delay_ns.count, 1);
+        assert!(metrics.batch_target >= 1);
+    }
+
+    /// Per-entity event counts, handed over with their entity range
+    struct CountingHandler {
+        counts: Arc<std::sync::Mutex<std::collections::HashMap<u128, u64>>>,
+    }
+
+    impl PartitionHandler for CountingHandler {
+        fn handle_batch(&mut self, _partition_id: usize, batch: &[Event]) {
+            let mut counts = self.counts.lock().unwrap();
+            for event in batch {
+                *counts.entry(event.entity_key).or_default() += 1;
+            }
+        }
+
+        fn export_state(
+            &mut self,
+            _partition_id: usize,
+            range: &EntityRange,
+        ) -> Option<PartitionState> {
+            let mut counts = self.counts.lock().unwrap();
+            let moved: std::collections::HashMap<u128, u64> = counts
+                .iter()
+                .filter(|(key, _)| range.contains(**key))
+                .map(|(key, count)| (*key, *count))
+                .collect();
+            counts.retain(|key, _| !range.contains(*key));
+            Some(Box::new(moved))
+        }
+
+        fn import_state(
+            &mut self,
+            _partition_id: usize,
+            _range: &EntityRange,
+            state: PartitionState,
+        ) {
+            let moved = state
+                .downcast::<std::collections::HashMap<u128, u64>>()
+                .unwrap();
+            self.counts.lock().unwrap().extend(*moved);
+        }
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_rebalance_moves_hot_range() {
+        let config = EventBusConfig {
+            partitions: 2,
+            batch_size: 16,
+            batch_timeout_ms: 5,
+            rebalance: Some(RebalanceConfig {
+                interval: Duration::from_secs(3600),
+                buckets_per_partition: 4,
+                skew_threshold: 1.2,
+                max_moves_per_round: 1,
+                min_events_per_round: 1,
+            }),
+            thread_per_core: ThreadPerCoreConfig {
+                pin_threads: false,
+                numa_aware: false,
+            },
+            ..Default::default()
+        };
+
+        let states: Vec<Arc<std::sync::Mutex<std::collections::HashMap<u128, u64>>>> =
+            vec![Arc::default(), Arc::default()];
+        let handler_states = states.clone();
+        let bus = EventBus::new_thread_per_core(config, move |partition_id| CountingHandler {
+            counts: handler_states[partition_id].clone(),
+        })
+        .unwrap();
+        let handle = bus.handle();
+
+        // Entities 0, 2 and 4 all land on partition 0; entity 1 on partition 1
+        let keys = [0u128, 2, 4, 2, 4, 4, 1];
+        let events = |rounds: u64| -> Vec<Event> {
+            (0..rounds)
+                .flat_map(|round| {
+                    keys.iter().map(move |&key| {
+                        Event::builder()
+                            .event_type(1)
+                            .ts_mono(round)
+                            .ts_wall(round)
+                            .entity_key(key)
+                            .build()
+                            .unwrap()
+                    })
+                })
+                .collect()
+        };
+
+        let wait_processed = |expected: u64| {
+            let handle = handle.clone();
+            async move {
+                for _ in 0..200 {
+                    if handle.metrics().events_processed == expected {
+                        break;
+                    }
+                    tokio::time::sleep(Duration::from_millis(5)).await;
+                }
+                assert_eq!(handle.metrics().events_processed, expected);
+            }
+        };
+
+        handle.publish_batch(events(10)).await.unwrap();
+        wait_processed(70).await;
+        assert_eq!(bus.rebalance(), 1);
+
+        // Keep publishing while the range is handed over
+        handle.publish_batch(events(10)).await.unwrap();
+        wait_processed(140).await;
+
+        let metrics = handle.metrics();
+        assert_eq!(metrics.migrations, 1);
+        assert_eq!(metrics.migration_ns.count, 1);
+        assert_eq!(metrics.partition_events.iter().sum::<u64>(), 140);
+
+        // Every entity's count lives on exactly one partition and is complete
+        let expected = [(0u128, 20u64), (1, 20), (2, 40), (4, 60)];
+        for (key, count) in expected {
+            let owners: Vec<u64> = states
+                .iter()
+                .filter_map(|state| state.lock().unwrap().get(&key).copied())
+                .collect();
+            assert_eq!(owners, vec![count], "entity {}", key);
+        }
+        assert!(states[1].lock().unwrap().len() > 1);
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_priority_lane() {
+        let config = EventBusConfig {
+            partitions: 1,
+            batch_size: 1000,
+            batch_timeout_ms: 1000,
+            high_priority_event_types: vec![7],
+            ..Default::default()
+        };
+        let (_bus, handle, mut rx) = create_test_bus(config).await;
+        assert_eq!(handle.event_priority(7), EventPriority::High);
+        assert_eq!(handle.event_priority(1), EventPriority::Normal);
+
+        let event = |event_type: u16| {
+            Event::builder()
+                .event_type(event_type)
+                .ts_mono(0)
+                .ts_wall(0)
+                .entity_key(0)
+                .build()
+                .unwrap()
+        };
+
+        // Bulk events wait for a full batch; the high-priority one does not
+        let bulk: Vec<Event> = (0..100).map(|_| event(1)).collect();
+        handle.publish_batch(bulk).await.unwrap();
+        handle.publish(event(7)).await.unwrap();
+
+        let batch = tokio::time::timeout(Duration::from_millis(200), rx.recv())
+            .await
+            .unwrap()
+            .unwrap();
+        assert_eq!(batch.len(), 1);
+        assert_eq!(batch[0].event_type_id, 7);
+
+        let metrics = handle.metrics();
+        assert_eq!(metrics.priority_lane_events, 1);
+        assert_eq!(metrics.priority_lane_latency_ns.count, 1);
+        assert_eq!(metrics.priority_lane_depth, 0);
+
+        // Event types can be promoted at runtime
+        handle.set_event_priority(1, EventPriority::High);
+        handle.publish(event(1)).await.unwrap();
+        let batch = tokio::time::timeout(Duration::from_millis(200), rx.recv())
+            .await
+            .unwrap()
+            .unwrap();
+        assert_eq!(batch.len(), 1);
+    }
+
+    #[tokio::test]
+    async fn test_event_bus_sheds_under_overload() {
+        let config = EventBusConfig {
+            channel_size: 64,
+            partitions: 1,
+            batch_size: 8,
+            batch_timeout_ms: 1,
+            overload: Some(OverloadConfig {
+                check_interval: Duration::ZERO,
+                default_policy: crate::overload::SheddingPolicy {
+                    value: 0,
+                    keep_ratio: 0.0,
+                },
+                ..Default::default()
+            }),
+            ..Default::default()
+        };
+        let (_bus, handle, _rx) = create_test_bus(config).await;
+        handle.protect_event_types(&[3]);
+
+        let event = |event_type: u16, entity_key: u128| {
+            Event::builder()
+                .event_type(event_type)
+                .ts_mono(0)
+                .ts_wall(0)
+                .entity_key(entity_key)
+                .build()
+                .unwrap()
+        };
+
+        // The worker never runs on this thread, so the ring stays full and
+        // the controller steps up until type 2 is shed instead of rejected
+        let shed = (0..1000).any(|entity| {
+            matches!(
+                handle.try_publish(event(2, entity)),
+                Err(PublishError::Shed)
+            )
+        });
+        assert!(shed);
+        assert_eq!(handle.metrics().events_shed, 1);
+        assert!(matches!(
+            handle.try_publish(event(3, 0)),
+            Err(PublishError::Full)
+        ));
+
+        let report = handle.overload_report().unwrap();
+        assert!(report.level > 0);
+        assert_eq!(
+            report.reason,
+            Some(crate::overload::OverloadReason::QueueDepth)
+        );
+        assert_eq!(report.shed_by_type, vec![(2, 1)]);
+        assert_eq!(handle.metrics().overload_level, report.level as u64);
+
+        handle.unprotect_event_types(&[3]);
+        assert!(matches!(
+            handle.try_publish(event(3, 0)),
+            Err(PublishError::Shed)
+        ));
+    }
+
+    #[tokio::test(flavor = "multi_thread", worker_threads = 2)]
+    async fn test_event_bus_recycles_batches() {
+        let config = EventBusConfig {
+            partitions: 1,
+            batch_size: 10,
+            batch_timeout_ms: 1000,
+            ..Default::default()
+        };
+        let (_bus, handle, mut rx) = create_test_bus(config).await;
+
+        let events: Vec<Event> = (0..10)
+            .map(|i| {
+                Event::builder()
+                    .event_type(1)
+                    .ts_mono(i)
+                    .ts_wall(i)
+                    .entity_key(0)
+                    .build()
+                    .unwrap()
+            })
+            .collect();
+
+        for _ in 0..20 {
+            handle.publish_batch(events.clone()).await.unwrap();
+            let batch = tokio::time::timeout(Duration::from_secs(1), rx.recv())
+                .await
+                .unwrap()
+                .unwrap();
+            assert_eq!(batch.len(), 10);
+            handle.recycle_batch(batch);
+        }
+
+        // Batches travel back from the consumer and are refilled
+        let pool = handle.batch_pool_metrics();
+        assert_eq!(pool.total_acquires, 21);
+        assert!(pool.reuse_rate() > 0.5, "reuse rate {}", pool.reuse_rate());
+        assert_eq!(pool.objects_discarded, 0);
+    }
 }
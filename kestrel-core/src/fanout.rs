@@ -0,0 +1,458 @@
+//! EventBus fan-out
+//!
+//! Delivers every batch the partition workers produce to any number of
+//! subscribers. Batches are shared as `Arc<[Event]>`; subscribers only hold
+//! a cursor into a bounded window of recent batches, so attaching another
+//! consumer never clones events.
+
+use kestrel_event::Event;
+use parking_lot::Mutex;
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::Arc;
+use tokio::sync::Notify;
+
+/// What to do when a subscriber falls behind the shared window
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SlowSubscriberPolicy {
+    /// Skip the batches that leave the window before the subscriber reads them
+    Drop,
+    /// Hold back publishing until the subscriber catches up
+    Block,
+    /// Move batches leaving the window to a per-subscriber in-memory queue
+    /// of up to `max_batches`; beyond that they are dropped
+    ///
+    /// Nothing is written to disk: spilled batches stay shared with the
+    /// window's `Arc`s and are lost if the process exits.
+    Spill { max_batches: usize },
+}
+
+impl Default for SlowSubscriberPolicy {
+    fn default() -> Self {
+        SlowSubscriberPolicy::Drop
+    }
+}
+
+/// Per-subscriber counters
+#[derive(Debug, Clone, Default)]
+struct SubscriberStats {
+    received_batches: u64,
+    received_events: u64,
+    dropped_batches: u64,
+    dropped_events: u64,
+    spilled_batches: u64,
+}
+
+struct SubscriberState {
+    id: u64,
+    name: String,
+    policy: SlowSubscriberPolicy,
+    /// Sequence number of the next batch to read from the window
+    cursor: u64,
+    /// Batches evicted from the window before being read (`Spill` only)
+    spill: VecDeque<Arc<[Event]>>,
+    /// Events published but not yet read or dropped
+    pending_events: u64,
+    stats: SubscriberStats,
+    notify: Arc<Notify>,
+}
+
+impl SubscriberState {
+    fn snapshot(&self, next_seq: u64) -> SubscriberMetricsSnapshot {
+        SubscriberMetricsSnapshot {
+            id: self.id,
+            name: self.name.clone(),
+            lag_batches: next_seq - self.cursor + self.spill.len() as u64,
+            lag_events: self.pending_events,
+            received_batches: self.stats.received_batches,
+            received_events: self.stats.received_events,
+            dropped_batches: self.stats.dropped_batches,
+            dropped_events: self.stats.dropped_events,
+            spilled_batches: self.stats.spilled_batches,
+        }
+    }
+}
+
+struct FanOutInner {
+    /// Recent batches with their sequence numbers, oldest first
+    window: VecDeque<(u64, Arc<[Event]>)>,
+    next_seq: u64,
+    next_id: u64,
+    subscribers: Vec<SubscriberState>,
+}
+
+impl FanOutInner {
+    fn subscriber_mut(&mut self, id: u64) -> Option<&mut SubscriberState> {
+        self.subscribers.iter_mut().find(|s| s.id == id)
+    }
+
+    /// Whether a `Block` subscriber still needs the oldest batch in a full window
+    fn blocked(&self, capacity: usize) -> bool {
+        if self.window.len() < capacity {
+            return false;
+        }
+        let Some(&(oldest, _)) = self.window.front() else {
+            return false;
+        };
+        self.subscribers
+            .iter()
+            .any(|s| s.policy == SlowSubscriberPolicy::Block && s.cursor <= oldest)
+    }
+
+    /// Evict the oldest batch, applying each lagging subscriber's policy
+    fn evict_oldest(&mut self) {
+        let Some((seq, batch)) = self.window.pop_front() else {
+            return;
+        };
+        let len = batch.len() as u64;
+
+        for sub in self.subscribers.iter_mut().filter(|s| s.cursor <= seq) {
+            sub.cursor = seq + 1;
+            match sub.policy {
+                SlowSubscriberPolicy::Spill { max_batches } if sub.spill.len() < max_batches => {
+                    sub.spill.push_back(batch.clone());
+                    sub.stats.spilled_batches += 1;
+                }
+                _ => {
+                    sub.stats.dropped_batches += 1;
+                    sub.stats.dropped_events += len;
+                    sub.pending_events -= len;
+                }
+            }
+        }
+    }
+}
+
+/// Shared batch window with per-subscriber cursors
+pub struct FanOut {
+    inner: Mutex<FanOutInner>,
+    /// Number of batches kept in the shared window
+    capacity: usize,
+    subscriber_count: AtomicUsize,
+    closed: AtomicBool,
+    /// Signalled when a subscriber advances or leaves
+    space: Notify,
+}
+
+impl std::fmt::Debug for FanOut {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("FanOut")
+            .field("capacity", &self.capacity)
+            .field("subscribers", &self.subscriber_count())
+            .finish()
+    }
+}
+
+impl FanOut {
+    /// Create a fan-out keeping up to `capacity` batches in its window
+    pub fn new(capacity: usize) -> Arc<Self> {
+        let capacity = capacity.max(1);
+        Arc::new(Self {
+            inner: Mutex::new(FanOutInner {
+                window: VecDeque::with_capacity(capacity),
+                next_seq: 0,
+                next_id: 0,
+                subscribers: Vec::new(),
+            }),
+            capacity,
+            subscriber_count: AtomicUsize::new(0),
+            closed: AtomicBool::new(false),
+            space: Notify::new(),
+        })
+    }
+
+    /// Number of attached subscribers
+    pub fn subscriber_count(&self) -> usize {
+        self.subscriber_count.load(Ordering::Acquire)
+    }
+
+    /// Attach a subscriber that receives batches published from now on
+    pub fn subscribe(
+        self: &Arc<Self>,
+        name: impl Into<String>,
+        policy: SlowSubscriberPolicy,
+    ) -> Subscription {
+        let notify = Arc::new(Notify::new());
+        let mut inner = self.inner.lock();
+        let id = inner.next_id;
+        inner.next_id += 1;
+        let cursor = inner.next_seq;
+        inner.subscribers.push(SubscriberState {
+            id,
+            name: name.into(),
+            policy,
+            cursor,
+            spill: VecDeque::new(),
+            pending_events: 0,
+            stats: SubscriberStats::default(),
+            notify: notify.clone(),
+        });
+        self.subscriber_count.fetch_add(1, Ordering::Release);
+
+        Subscription {
+            id,
+            fanout: self.clone(),
+            notify,
+        }
+    }
+
+    /// Publish a batch to all subscribers
+    ///
+    /// Waits while a `Block` subscriber still needs the batch that would be
+    /// evicted from the window.
+    pub async fn publish(&self, batch: Arc<[Event]>) {
+        loop {
+            let space = self.space.notified();
+            tokio::pin!(space);
+            space.as_mut().enable();
+
+            {
+                let mut inner = self.inner.lock();
+                if inner.subscribers.is_empty() {
+                    return;
+                }
+                if self.closed.load(Ordering::Acquire) || !inner.blocked(self.capacity) {
+                    self.push_locked(&mut inner, batch);
+                    return;
+                }
+            }
+
+            space.await;
+        }
+    }
+
+    fn push_locked(&self, inner: &mut FanOutInner, batch: Arc<[Event]>) {
+        let len = batch.len() as u64;
+        let seq = inner.next_seq;
+        inner.next_seq += 1;
+        inner.window.push_back((seq, batch));
+        while inner.window.len() > self.capacity {
+            inner.evict_oldest();
+        }
+
+        for sub in &mut inner.subscribers {
+            sub.pending_events += len;
+            sub.notify.notify_one();
+        }
+    }
+
+    /// Take the next batch for subscriber `id`
+    fn try_take(&self, id: u64) -> Option<Arc<[Event]>> {
+        let mut inner = self.inner.lock();
+        let front_seq = inner.window.front().map_or(inner.next_seq, |&(seq, _)| seq);
+        let next_seq = inner.next_seq;
+
+        // Borrow the window and subscriber list separately
+        let FanOutInner {
+            window,
+            subscribers,
+            ..
+        } = &mut *inner;
+        let sub = subscribers.iter_mut().find(|s| s.id == id)?;
+
+        let batch = if let Some(batch) = sub.spill.pop_front() {
+            batch
+        } else if sub.cursor < next_seq {
+            let batch = window[(sub.cursor - front_seq) as usize].1.clone();
+            sub.cursor += 1;
+            batch
+        } else {
+            return None;
+        };
+
+        let len = batch.len() as u64;
+        sub.stats.received_batches += 1;
+        sub.stats.received_events += len;
+        sub.pending_events -= len;
+        if sub.policy == SlowSubscriberPolicy::Block {
+            self.space.notify_waiters();
+        }
+        Some(batch)
+    }
+
+    fn unsubscribe(&self, id: u64) {
+        let mut inner = self.inner.lock();
+        inner.subscribers.retain(|s| s.id != id);
+        self.subscriber_count.fetch_sub(1, Ordering::Release);
+        self.space.notify_waiters();
+    }
+
+    /// Metrics for every attached subscriber
+    pub fn subscriber_metrics(&self) -> Vec<SubscriberMetricsSnapshot> {
+        let inner = self.inner.lock();
+        inner
+            .subscribers
+            .iter()
+            .map(|s| s.snapshot(inner.next_seq))
+            .collect()
+    }
+
+    /// Close the fan-out; subscribers drain what is buffered, then end
+    pub fn close(&self) {
+        self.closed.store(true, Ordering::Release);
+        let inner = self.inner.lock();
+        for sub in &inner.subscribers {
+            sub.notify.notify_one();
+        }
+        self.space.notify_waiters();
+    }
+}
+
+/// A subscriber attached to a `FanOut`
+///
+/// Dropping the subscription detaches it.
+pub struct Subscription {
+    id: u64,
+    fanout: Arc<FanOut>,
+    notify: Arc<Notify>,
+}
+
+impl std::fmt::Debug for Subscription {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Subscription")
+            .field("id", &self.id)
+            .finish()
+    }
+}
+
+impl Subscription {
+    /// Receive the next batch, or `None` once the bus is closed and drained
+    pub async fn recv(&mut self) -> Option<Arc<[Event]>> {
+        loop {
+            let notified = self.notify.notified();
+            tokio::pin!(notified);
+            notified.as_mut().enable();
+
+            if let Some(batch) = self.fanout.try_take(self.id) {
+                return Some(batch);
+            }
+            if self.fanout.closed.load(Ordering::Acquire) {
+                return None;
+            }
+            notified.await;
+        }
+    }
+
+    /// Receive the next batch without waiting
+    pub fn try_recv(&mut self) -> Option<Arc<[Event]>> {
+        self.fanout.try_take(self.id)
+    }
+
+    /// Current metrics for this subscriber
+    pub fn metrics(&self) -> SubscriberMetricsSnapshot {
+        let mut inner = self.fanout.inner.lock();
+        let next_seq = inner.next_seq;
+        inner
+            .subscriber_mut(self.id)
+            .map(|s| s.snapshot(next_seq))
+            .unwrap_or_default()
+    }
+}
+
+impl Drop for Subscription {
+    fn drop(&mut self) {
+        self.fanout.unsubscribe(self.id);
+    }
+}
+
+/// Snapshot of a subscriber's cursor and counters
+#[derive(Debug, Clone, Default)]
+pub struct SubscriberMetricsSnapshot {
+    pub id: u64,
+    pub name: String,
+    /// Batches published but not yet read, including spilled batches
+    pub lag_batches: u64,
+    /// Events published but not yet read
+    pub lag_events: u64,
+    pub received_batches: u64,
+    pub received_events: u64,
+    pub dropped_batches: u64,
+    pub dropped_events: u64,
+    pub spilled_batches: u64,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Duration;
+
+    fn batch(start: u64, len: u64) -> Arc<[Event]> {
+        (start..start + len)
+            .map(|i| {
+                Event::builder()
+                    .event_id(i)
+                    .event_type(1)
+                    .ts_mono(i)
+                    .ts_wall(i)
+                    .entity_key(i as u128)
+                    .build()
+                    .unwrap()
+            })
+            .collect()
+    }
+
+    #[tokio::test]
+    async fn test_fanout_shares_batches() {
+        let fanout = FanOut::new(4);
+        let mut a = fanout.subscribe("detection", SlowSubscriberPolicy::Drop);
+        let mut b = fanout.subscribe("archiver", SlowSubscriberPolicy::Drop);
+
+        let published = batch(0, 3);
+        fanout.publish(published.clone()).await;
+
+        let got_a = a.recv().await.unwrap();
+        let got_b = b.recv().await.unwrap();
+        assert!(Arc::ptr_eq(&got_a, &published));
+        assert!(Arc::ptr_eq(&got_b, &published));
+        assert_eq!(a.metrics().received_events, 3);
+        assert_eq!(b.metrics().lag_batches, 0);
+    }
+
+    #[tokio::test]
+    async fn test_fanout_slow_subscriber_policies() {
+        let fanout = FanOut::new(2);
+        let mut dropping = fanout.subscribe("drop", SlowSubscriberPolicy::Drop);
+        let mut spilling =
+            fanout.subscribe("spill", SlowSubscriberPolicy::Spill { max_batches: 1 });
+
+        for i in 0..4 {
+            fanout.publish(batch(i * 10, 2)).await;
+        }
+
+        // Window holds batches 2 and 3; batch 0 spilled, batch 1 overflowed the spill
+        let metrics = dropping.metrics();
+        assert_eq!(metrics.dropped_batches, 2);
+        assert_eq!(metrics.dropped_events, 4);
+        assert_eq!(metrics.lag_batches, 2);
+        assert_eq!(spilling.metrics().spilled_batches, 1);
+        assert_eq!(spilling.metrics().lag_events, 6);
+
+        assert_eq!(dropping.try_recv().unwrap()[0].event_id, 20);
+        let ids: Vec<u64> = std::iter::from_fn(|| spilling.try_recv())
+            .map(|b| b[0].event_id)
+            .collect();
+        assert_eq!(ids, vec![0, 20, 30]);
+    }
+
+    #[tokio::test]
+    async fn test_fanout_block_policy_waits_for_subscriber() {
+        let fanout = FanOut::new(1);
+        let mut blocking = fanout.subscribe("block", SlowSubscriberPolicy::Block);
+
+        fanout.publish(batch(0, 1)).await;
+
+        // The window is full and the subscriber has not read it yet
+        let publisher = fanout.clone();
+        let publish = tokio::spawn(async move { publisher.publish(batch(1, 1)).await });
+        tokio::time::sleep(Duration::from_millis(20)).await;
+        assert!(!publish.is_finished());
+
+        assert_eq!(blocking.recv().await.unwrap()[0].event_id, 0);
+        publish.await.unwrap();
+        assert_eq!(blocking.recv().await.unwrap()[0].event_id, 1);
+        assert_eq!(blocking.metrics().dropped_batches, 0);
+
+        fanout.close();
+        assert!(blocking.recv().await.is_none());
+    }
+}
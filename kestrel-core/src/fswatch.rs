@@ -0,0 +1,380 @@
+//! Filesystem change notifications
+//!
+//! `DirWatcher` reports files written, moved or deleted in one directory.
+//! On Linux it is backed by inotify registered with the tokio reactor, so an
+//! idle watcher costs no CPU and no I/O. Elsewhere, or when inotify is
+//! unavailable (e.g. the per-user watch limit is exhausted), it falls back
+//! to comparing modification times on an interval.
+
+use sha2::{Digest, Sha256};
+use std::collections::HashMap;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::time::{Duration, SystemTime};
+
+/// Interval of the polling fallback
+pub const DEFAULT_POLL_INTERVAL: Duration = Duration::from_secs(5);
+
+/// Stable hex SHA-256 of file content
+///
+/// Unlike `DefaultHasher`, the value does not depend on the build, so it
+/// can be persisted and compared across restarts.
+pub fn content_hash(content: &[u8]) -> String {
+    let digest = Sha256::digest(content);
+    let mut hex = String::with_capacity(digest.len() * 2);
+    for byte in digest {
+        hex.push_str(&format!("{:02x}", byte));
+    }
+    hex
+}
+
+/// What happened to a file
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FileEventKind {
+    /// Written, created or moved into the directory
+    Changed,
+    /// Deleted or moved out of the directory
+    Removed,
+    /// Notifications were lost; rescan the whole directory
+    Overflow,
+}
+
+/// A change to a file in a watched directory
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct FileEvent {
+    /// Affected file (the directory itself for `Overflow`)
+    pub path: PathBuf,
+    pub kind: FileEventKind,
+}
+
+/// Watches one directory for file changes
+pub struct DirWatcher {
+    dir: PathBuf,
+    backend: Backend,
+}
+
+enum Backend {
+    #[cfg(target_os = "linux")]
+    Inotify(inotify::Inotify),
+    Poll {
+        interval: tokio::time::Interval,
+        snapshot: HashMap<PathBuf, (SystemTime, u64)>,
+    },
+}
+
+impl DirWatcher {
+    /// Watch `dir`, using inotify where available
+    ///
+    /// Must be called within a tokio runtime.
+    pub fn new(dir: impl AsRef<Path>) -> io::Result<Self> {
+        #[cfg(target_os = "linux")]
+        {
+            let dir = dir.as_ref();
+            match inotify::Inotify::new(dir) {
+                Ok(inotify) => {
+                    return Ok(Self {
+                        dir: dir.to_path_buf(),
+                        backend: Backend::Inotify(inotify),
+                    })
+                }
+                Err(e) if dir.is_dir() => {
+                    tracing::warn!(
+                        dir = %dir.display(),
+                        error = %e,
+                        "inotify unavailable, polling"
+                    );
+                }
+                Err(e) => return Err(e),
+            }
+        }
+
+        Self::polling(dir, DEFAULT_POLL_INTERVAL)
+    }
+
+    /// Watch `dir` by comparing modification times every `period`
+    pub fn polling(dir: impl AsRef<Path>, period: Duration) -> io::Result<Self> {
+        let dir = dir.as_ref().to_path_buf();
+        let snapshot = scan(&dir)?;
+        let interval = tokio::time::interval_at(tokio::time::Instant::now() + period, period);
+
+        Ok(Self {
+            dir,
+            backend: Backend::Poll { interval, snapshot },
+        })
+    }
+
+    /// Watched directory
+    pub fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// Whether the watcher fell back to polling
+    pub fn is_polling(&self) -> bool {
+        matches!(self.backend, Backend::Poll { .. })
+    }
+
+    /// Wait for the next non-empty batch of changes
+    pub async fn next_events(&mut self) -> io::Result<Vec<FileEvent>> {
+        match &mut self.backend {
+            #[cfg(target_os = "linux")]
+            Backend::Inotify(inotify) => loop {
+                let events = inotify.read(&self.dir).await?;
+                if !events.is_empty() {
+                    return Ok(events);
+                }
+            },
+            Backend::Poll { interval, snapshot } => loop {
+                interval.tick().await;
+                let current = scan(&self.dir)?;
+                let events = diff(snapshot, &current);
+                *snapshot = current;
+                if !events.is_empty() {
+                    return Ok(events);
+                }
+            },
+        }
+    }
+}
+
+/// Modification time and size of every file in `dir`
+fn scan(dir: &Path) -> io::Result<HashMap<PathBuf, (SystemTime, u64)>> {
+    let mut files = HashMap::new();
+    for entry in std::fs::read_dir(dir)? {
+        let entry = entry?;
+        let metadata = match entry.metadata() {
+            Ok(metadata) if metadata.is_file() => metadata,
+            _ => continue,
+        };
+        let modified = metadata.modified().unwrap_or(SystemTime::UNIX_EPOCH);
+        files.insert(entry.path(), (modified, metadata.len()));
+    }
+    Ok(files)
+}
+
+fn diff(
+    before: &HashMap<PathBuf, (SystemTime, u64)>,
+    after: &HashMap<PathBuf, (SystemTime, u64)>,
+) -> Vec<FileEvent> {
+    let changed = after
+        .iter()
+        .filter(|(path, stat)| before.get(*path) != Some(stat))
+        .map(|(path, _)| FileEvent {
+            path: path.clone(),
+            kind: FileEventKind::Changed,
+        });
+    let removed = before
+        .keys()
+        .filter(|path| !after.contains_key(*path))
+        .map(|path| FileEvent {
+            path: path.clone(),
+            kind: FileEventKind::Removed,
+        });
+    changed.chain(removed).collect()
+}
+
+#[cfg(target_os = "linux")]
+mod inotify {
+    use super::{FileEvent, FileEventKind};
+    use std::ffi::{CString, OsStr};
+    use std::io;
+    use std::os::unix::ffi::OsStrExt;
+    use std::os::unix::io::{AsRawFd, FromRawFd, OwnedFd};
+    use std::path::Path;
+    use tokio::io::unix::AsyncFd;
+
+    /// Size of `struct inotify_event` without its name
+    const EVENT_HEADER: usize = 16;
+
+    /// Events that leave a file with complete new content, or remove it
+    const WATCH_MASK: u32 = libc::IN_CLOSE_WRITE
+        | libc::IN_MOVED_TO
+        | libc::IN_MOVED_FROM
+        | libc::IN_DELETE
+        | libc::IN_DELETE_SELF
+        | libc::IN_MOVE_SELF;
+
+    pub(super) struct Inotify {
+        fd: AsyncFd<OwnedFd>,
+        buf: Vec<u8>,
+    }
+
+    impl Inotify {
+        pub(super) fn new(dir: &Path) -> io::Result<Self> {
+            let path = CString::new(dir.as_os_str().as_bytes())
+                .map_err(|e| io::Error::new(io::ErrorKind::InvalidInput, e))?;
+
+            // SAFETY: plain syscalls; the descriptor is owned from here on
+            let fd = unsafe { libc::inotify_init1(libc::IN_NONBLOCK | libc::IN_CLOEXEC) };
+            if fd < 0 {
+                return Err(io::Error::last_os_error());
+            }
+            let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+            let wd = unsafe { libc::inotify_add_watch(fd.as_raw_fd(), path.as_ptr(), WATCH_MASK) };
+            if wd < 0 {
+                return Err(io::Error::last_os_error());
+            }
+
+            Ok(Self {
+                fd: AsyncFd::new(fd)?,
+                buf: vec![0; 64 * 1024],
+            })
+        }
+
+        /// Wait until the descriptor is readable and decode one read's events
+        pub(super) async fn read(&mut self, dir: &Path) -> io::Result<Vec<FileEvent>> {
+            let Self { fd, buf } = self;
+            loop {
+                let mut guard = fd.readable().await?;
+                let read = guard.try_io(|fd| {
+                    // SAFETY: `buf` is valid for `buf.len()` bytes
+                    let n =
+                        unsafe { libc::read(fd.as_raw_fd(), buf.as_mut_ptr().cast(), buf.len()) };
+                    if n < 0 {
+                        Err(io::Error::last_os_error())
+                    } else {
+                        Ok(n as usize)
+                    }
+                });
+
+                match read {
+                    Ok(Ok(n)) => return decode(&buf[..n], dir),
+                    Ok(Err(e)) => return Err(e),
+                    Err(_would_block) => continue,
+                }
+            }
+        }
+    }
+
+    fn decode(mut bytes: &[u8], dir: &Path) -> io::Result<Vec<FileEvent>> {
+        let field = |bytes: &[u8], at: usize| {
+            u32::from_ne_bytes([bytes[at], bytes[at + 1], bytes[at + 2], bytes[at + 3]])
+        };
+
+        let mut events = Vec::new();
+        while bytes.len() >= EVENT_HEADER {
+            let mask = field(bytes, 4);
+            let name_len = field(bytes, 12) as usize;
+            let end = (EVENT_HEADER + name_len).min(bytes.len());
+            let name = &bytes[EVENT_HEADER..end];
+            let name = &name[..name.iter().position(|&b| b == 0).unwrap_or(name.len())];
+            bytes = &bytes[end..];
+
+            if mask & (libc::IN_DELETE_SELF | libc::IN_MOVE_SELF) != 0 {
+                return Err(io::Error::new(
+                    io::ErrorKind::NotFound,
+                    format!("watched directory {} was removed", dir.display()),
+                ));
+            }
+
+            let kind = if mask & libc::IN_Q_OVERFLOW != 0 {
+                FileEventKind::Overflow
+            } else if mask & (libc::IN_MOVED_FROM | libc::IN_DELETE) != 0 {
+                FileEventKind::Removed
+            } else if mask & (libc::IN_CLOSE_WRITE | libc::IN_MOVED_TO) != 0 {
+                FileEventKind::Changed
+            } else {
+                continue;
+            };
+
+            let path = if kind == FileEventKind::Overflow {
+                dir.to_path_buf()
+            } else if name.is_empty() || mask & libc::IN_ISDIR != 0 {
+                continue;
+            } else {
+                dir.join(OsStr::from_bytes(name))
+            };
+
+            let event = FileEvent { path, kind };
+            if !events.contains(&event) {
+                events.push(event);
+            }
+        }
+
+        Ok(events)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn test_dir(name: &str) -> PathBuf {
+        let dir =
+            std::env::temp_dir().join(format!("kestrel-fswatch-{}-{}", name, std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        std::fs::create_dir_all(&dir).unwrap();
+        dir
+    }
+
+    async fn next(watcher: &mut DirWatcher) -> Vec<FileEvent> {
+        tokio::time::timeout(Duration::from_secs(5), watcher.next_events())
+            .await
+            .expect("no file event")
+            .unwrap()
+    }
+
+    #[test]
+    fn test_content_hash() {
+        assert_eq!(
+            content_hash(b"abc"),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+        );
+        assert_ne!(content_hash(b"abc"), content_hash(b"abd"));
+    }
+
+    #[tokio::test]
+    async fn test_watch_write_and_remove() {
+        let dir = test_dir("native");
+        let mut watcher = DirWatcher::new(&dir).unwrap();
+        let file = dir.join("rule.yaml");
+
+        std::fs::write(&file, "a").unwrap();
+        let events = next(&mut watcher).await;
+        assert!(events.contains(&FileEvent {
+            path: file.clone(),
+            kind: FileEventKind::Changed,
+        }));
+
+        std::fs::remove_file(&file).unwrap();
+        let events = next(&mut watcher).await;
+        assert!(events.contains(&FileEvent {
+            path: file,
+            kind: FileEventKind::Removed,
+        }));
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[tokio::test]
+    async fn test_polling_fallback() {
+        let dir = test_dir("poll");
+        let kept = dir.join("kept.json");
+        let removed = dir.join("removed.json");
+        std::fs::write(&kept, "1").unwrap();
+        std::fs::write(&removed, "1").unwrap();
+
+        let mut watcher = DirWatcher::polling(&dir, Duration::from_millis(20)).unwrap();
+        assert!(watcher.is_polling());
+
+        std::fs::write(&kept, "22").unwrap();
+        std::fs::remove_file(&removed).unwrap();
+        let mut events = next(&mut watcher).await;
+        events.sort_by(|a, b| a.path.cmp(&b.path));
+        assert_eq!(
+            events,
+            vec![
+                FileEvent {
+                    path: kept,
+                    kind: FileEventKind::Changed,
+                },
+                FileEvent {
+                    path: removed,
+                    kind: FileEventKind::Removed,
+                },
+            ]
+        );
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+}
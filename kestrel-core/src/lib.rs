@@ -3,13 +3,25 @@
 //! Core functionality including EventBus and control plane components.
 
 pub mod action;
+pub mod action_pipeline;
+pub mod affinity;
 pub mod alert;
+pub mod batching;
+pub mod binlog;
 pub mod config_reload;
 pub mod deterministic;
+pub mod epoch;
 pub mod eventbus;
+pub mod fanout;
+pub mod fswatch;
 pub mod metrics;
 pub mod object_pool;
+pub mod overload;
+pub mod priority;
+pub mod profiler;
+pub mod rebalance;
 pub mod replay;
+pub mod ring;
 pub mod runtime_comparison;
 pub mod time;
 
@@ -17,15 +29,42 @@ use std::time::Duration;
 
 pub use action::{
     ActionAudit, ActionAuditLog, ActionCapabilities, ActionDecision, ActionError, ActionEvidence,
-    ActionExecutor, ActionPolicy, ActionResult, ActionTarget, ActionType, AlertActionExecutor,
-    BlockActionExecutor, CompositeActionExecutor, KillActionExecutor, NoOpExecutor,
-    QuarantineExecutor,
+    ActionExecutor, ActionPolicy, ActionReason, ActionResult, ActionTarget, ActionType,
+    AlertActionExecutor, BlockActionExecutor, CompositeActionExecutor, KillActionExecutor,
+    NoOpExecutor, QuarantineExecutor,
 };
-pub use alert::{Alert, AlertHandle, AlertOutput, AlertOutputConfig, EventEvidence, Severity};
+pub use action_pipeline::{
+    ActionHandle, ActionPipeline, ActionPipelineConfig, ActionPipelineStats, TrySubmitError,
+};
+pub use alert::{
+    decode_binary_alerts, Alert, AlertDedupConfig, AlertDeduplicator, AlertEncoder, AlertEncoding,
+    AlertHandle, AlertOutput, AlertOutputConfig, AlertOutputStats, BinaryEncoder, EventEvidence,
+    JsonLinesEncoder, Severity,
+};
+pub use batching::AdaptiveBatchingConfig;
+pub use binlog::{
+    BlockMeta, LogBytes, LogFile, LogMeta, LogReader, LogWriter, LogWriterConfig, MergedEvents,
+};
+pub use epoch::{EpochCache, EpochCell};
 /// Re-export common types
-pub use eventbus::{EventBus, EventBusConfig, EventBusHandle, EventBusMetricsSnapshot};
-pub use replay::{BinaryLog, ReplayConfig, ReplayError, ReplaySource, ReplayStats};
-pub use time::{MockTimeProvider, RealTimeProvider, TimeManager, TimeProvider};
+pub use eventbus::{
+    EventBus, EventBusConfig, EventBusHandle, EventBusMetricsSnapshot, PartitionHandler,
+    PublishError, ThreadPerCoreConfig,
+};
+pub use fanout::{SlowSubscriberPolicy, SubscriberMetricsSnapshot, Subscription};
+pub use fswatch::{content_hash, DirWatcher, FileEvent, FileEventKind};
+pub use overload::{OverloadConfig, OverloadReason, OverloadReport, SheddingPolicy};
+pub use priority::EventPriority;
+pub use profiler::{CountingAllocator, ProfileSample, RuleCost, RuleProfiler, RuleProfilerConfig};
+pub use rebalance::{EntityRange, PartitionState, RebalanceConfig};
+pub use replay::{
+    AlertDiff, AlertSignature, BinaryLog, ReplayConfig, ReplayError, ReplaySource, ReplayStats,
+    ReplayThroughput,
+};
+pub use time::{
+    coarse_monotonic_ns, monotonic_ns, stop_ticker, MockTimeProvider, RealTimeProvider,
+    TimeManager, TimeProvider,
+};
 
 pub use deterministic::{
     DeterministicResult, DeterministicTestRunner, DeterministicVerifier, ReplayVerificationReport,
@@ -37,11 +76,12 @@ pub use config_reload::{
 };
 
 pub use metrics::{
-    EngineMetrics, MetricsSnapshot, PoolMetricsSnapshot, RuleMetrics, UnifiedMetrics,
-    UnifiedMetricsSnapshot,
+    EngineMetrics, Histogram, HistogramSnapshot, LatencyHistogram, LatencySnapshot,
+    MetricsSnapshot, PoolMetricsSnapshot, PrometheusExporter, RuleMetrics, RuleMetricsTable,
+    ShardedCounter, UnifiedMetrics, UnifiedMetricsSnapshot,
 };
 
-pub use object_pool::{EventVecPool, ObjectPool, PoolManager, PoolMetrics, PooledObject};
+pub use object_pool::{EventVecPool, ObjectPool, PoolManager, PoolMetrics, PooledObject, Reset};
 
 pub use runtime_comparison::{
     ConsistencyBenchmarkResult, ConsistencyMismatch, ConsistencyResult, RuntimeBenchmark,
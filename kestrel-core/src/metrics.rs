@@ -2,101 +2,598 @@
 //!
 //! This module provides comprehensive metrics collection for the Kestrel engine,
 //! including events per second, drop rates, per-rule metrics, and exportable formats.
+//!
+//! Hot counters are sharded per thread (`ShardedCounter`) and latencies go
+//! into log-linear histograms (`LatencyHistogram`), so exports report real
+//! p50/p99/p999 rather than averages.
 
 use crate::eventbus::EventBusMetricsSnapshot;
+use crate::profiler::RuleProfiler;
+use crate::ring::CachePadded;
 use parking_lot::RwLock;
 use std::collections::HashMap;
+use std::fmt::{self, Display, Write};
 use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
-use std::sync::Arc;
+use std::sync::{Arc, OnceLock};
 use std::time::Instant;
 
 /// Per-rule metrics tracking
-#[derive(Debug, Default)]
+///
+/// One histogram per rule, which also counts evaluations, and an unsharded
+/// alert counter: there can be thousands of rules, so per-thread shards
+/// would cost more memory and scrape time than contention on a rule.
+#[derive(Debug)]
 pub struct RuleMetrics {
-    /// Total events evaluated against this rule
-    pub events_evaluated: AtomicU64,
-
     /// Total alerts generated by this rule
     pub alerts_generated: AtomicU64,
 
-    /// Total time spent evaluating this rule (nanoseconds)
-    pub total_eval_time_ns: AtomicU64,
+    /// Evaluation time distribution (nanoseconds)
+    pub eval_time_ns: LatencyHistogram,
+}
+
+impl Default for RuleMetrics {
+    fn default() -> Self {
+        Self {
+            alerts_generated: AtomicU64::new(0),
+            eval_time_ns: LatencyHistogram::unsharded(),
+        }
+    }
+}
+
+impl RuleMetrics {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn record_evaluation(&self, eval_time_ns: u64) {
+        self.eval_time_ns.record(eval_time_ns);
+    }
+
+    pub fn record_alert(&self) {
+        self.alerts_generated.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn get_avg_eval_time_ns(&self) -> u64 {
+        let count = self.eval_time_ns.count();
+        if count > 0 {
+            self.eval_time_ns.sum() / count
+        } else {
+            0
+        }
+    }
 
-    /// Number of evaluations
-    pub evaluation_count: AtomicU64,
+    pub fn get_peak_eval_time_ns(&self) -> u64 {
+        self.eval_time_ns.max()
+    }
 
-    /// Peak evaluation time (nanoseconds)
-    pub peak_eval_time_ns: AtomicU64,
+    pub fn get_eval_count(&self) -> u64 {
+        self.eval_time_ns.count()
+    }
 
-    /// P50 evaluation time (nanoseconds) - periodically updated
-    pub p50_eval_time_ns: AtomicU64,
+    pub fn get_alert_count(&self) -> u64 {
+        self.alerts_generated.load(Ordering::Relaxed)
+    }
+}
 
-    /// P95 evaluation time (nanoseconds) - periodically updated
-    pub p95_eval_time_ns: AtomicU64,
+/// Rules in the first `RuleMetricsTable` segment; each next one doubles
+const RULE_SEGMENT_BASE: usize = 64;
+const RULE_SEGMENTS: usize = 24;
 
-    /// P99 evaluation time (nanoseconds) - periodically updated
-    pub p99_eval_time_ns: AtomicU64,
+struct RuleEntry {
+    rule_id: String,
+    metrics: Arc<RuleMetrics>,
 }
 
-impl RuleMetrics {
+/// Append-only table of per-rule metrics
+///
+/// Scrapes walk the table without locking: entries live in segments that
+/// are never moved or freed, and `len` is published after each entry is
+/// written. Only looking up or registering a rule by id touches the index
+/// lock, and hot paths should keep the `Arc` they got instead.
+pub struct RuleMetricsTable {
+    segments: [OnceLock<Box<[OnceLock<RuleEntry>]>>; RULE_SEGMENTS],
+    len: AtomicUsize,
+    index: RwLock<HashMap<String, usize>>,
+}
+
+impl RuleMetricsTable {
+    pub fn new() -> Self {
+        Self {
+            segments: std::array::from_fn(|_| OnceLock::new()),
+            len: AtomicUsize::new(0),
+            index: RwLock::new(HashMap::new()),
+        }
+    }
+
+    /// Segment and offset of table index `i`
+    fn locate(i: usize) -> (usize, usize) {
+        let segment = (usize::BITS - 1 - (i / RULE_SEGMENT_BASE + 1).leading_zeros()) as usize;
+        (segment, i - RULE_SEGMENT_BASE * ((1 << segment) - 1))
+    }
+
+    fn entry(&self, i: usize) -> Option<&RuleEntry> {
+        let (segment, offset) = Self::locate(i);
+        self.segments.get(segment)?.get()?.get(offset)?.get()
+    }
+
+    /// Metrics of `rule_id`, if registered
+    pub fn get(&self, rule_id: &str) -> Option<Arc<RuleMetrics>> {
+        let i = *self.index.read().get(rule_id)?;
+        self.entry(i).map(|entry| entry.metrics.clone())
+    }
+
+    /// Metrics of `rule_id`, registering the rule on first use
+    pub fn get_or_insert(&self, rule_id: &str) -> Arc<RuleMetrics> {
+        if let Some(metrics) = self.get(rule_id) {
+            return metrics;
+        }
+
+        let mut index = self.index.write();
+        if let Some(entry) = index.get(rule_id).and_then(|&i| self.entry(i)) {
+            return entry.metrics.clone();
+        }
+
+        let i = self.len.load(Ordering::Relaxed);
+        let (segment, offset) = Self::locate(i);
+        let slots = self.segments[segment].get_or_init(|| {
+            (0..RULE_SEGMENT_BASE << segment)
+                .map(|_| OnceLock::new())
+                .collect()
+        });
+        let metrics = Arc::new(RuleMetrics::new());
+        let _ = slots[offset].set(RuleEntry {
+            rule_id: rule_id.to_string(),
+            metrics: metrics.clone(),
+        });
+        self.len.store(i + 1, Ordering::Release);
+        index.insert(rule_id.to_string(), i);
+        metrics
+    }
+
+    pub fn len(&self) -> usize {
+        self.len.load(Ordering::Acquire)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Rules in registration order with their stable table index
+    pub fn iter(&self) -> impl Iterator<Item = (usize, &str, &RuleMetrics)> + '_ {
+        (0..self.len()).filter_map(move |i| {
+            self.entry(i)
+                .map(|entry| (i, entry.rule_id.as_str(), entry.metrics.as_ref()))
+        })
+    }
+}
+
+impl Default for RuleMetricsTable {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl std::fmt::Debug for RuleMetricsTable {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("RuleMetricsTable")
+            .field("len", &self.len())
+            .finish()
+    }
+}
+
+/// Write one sample with its HELP and TYPE lines
+fn write_sample<W: Write>(
+    out: &mut W,
+    name: &str,
+    kind: &str,
+    help: &str,
+    value: impl Display,
+) -> fmt::Result {
+    writeln!(out, "# HELP {} {}", name, help)?;
+    write_typed(out, name, kind, value)
+}
+
+/// Write one sample with its TYPE line
+fn write_typed<W: Write>(out: &mut W, name: &str, kind: &str, value: impl Display) -> fmt::Result {
+    writeln!(out, "# TYPE {} {}", name, kind)?;
+    writeln!(out, "{} {}", name, value)
+}
+
+/// Number of histogram buckets: value 0 plus one per power of two
+const HISTOGRAM_BUCKETS: usize = 65;
+
+/// Lock-free histogram with power-of-two buckets
+///
+/// Bucket `i > 0` counts values in `[2^(i-1), 2^i)`, bucket 0 counts zeros.
+/// Recording is a few relaxed atomic adds, cheap enough for hot paths.
+#[derive(Debug)]
+pub struct Histogram {
+    buckets: [AtomicU64; HISTOGRAM_BUCKETS],
+    count: AtomicU64,
+    sum: AtomicU64,
+    max: AtomicU64,
+}
+
+impl Default for Histogram {
+    fn default() -> Self {
+        Self {
+            buckets: std::array::from_fn(|_| AtomicU64::new(0)),
+            count: AtomicU64::new(0),
+            sum: AtomicU64::new(0),
+            max: AtomicU64::new(0),
+        }
+    }
+}
+
+impl Histogram {
     pub fn new() -> Self {
         Self::default()
     }
 
-    pub fn record_evaluation(&self, eval_time_ns: u64) {
-        let count = self.evaluation_count.fetch_add(1, Ordering::Relaxed) + 1;
-        let total = self
-            .total_eval_time_ns
-            .fetch_add(eval_time_ns, Ordering::Relaxed)
-            + eval_time_ns;
+    /// Record one value
+    pub fn record(&self, value: u64) {
+        let bucket = (u64::BITS - value.leading_zeros()) as usize;
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum.fetch_add(value, Ordering::Relaxed);
+        self.max.fetch_max(value, Ordering::Relaxed);
+    }
 
-        loop {
-            let peak = self.peak_eval_time_ns.load(Ordering::Relaxed);
-            if eval_time_ns <= peak {
-                break;
-            }
-            if self
-                .peak_eval_time_ns
-                .compare_exchange_weak(peak, eval_time_ns, Ordering::Relaxed, Ordering::Relaxed)
-                .is_ok()
-            {
-                break;
+    pub fn snapshot(&self) -> HistogramSnapshot {
+        HistogramSnapshot {
+            buckets: self
+                .buckets
+                .iter()
+                .map(|b| b.load(Ordering::Relaxed))
+                .collect(),
+            count: self.count.load(Ordering::Relaxed),
+            sum: self.sum.load(Ordering::Relaxed),
+            max: self.max.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Snapshot of a `Histogram`
+#[derive(Debug, Clone, Default)]
+pub struct HistogramSnapshot {
+    /// Per-bucket counts (not cumulative)
+    pub buckets: Vec<u64>,
+    pub count: u64,
+    pub sum: u64,
+    pub max: u64,
+}
+
+impl HistogramSnapshot {
+    /// Inclusive upper bound of bucket `i`
+    fn bucket_bound(i: usize) -> u64 {
+        if i >= 64 {
+            u64::MAX
+        } else {
+            (1u64 << i) - 1
+        }
+    }
+
+    pub fn mean(&self) -> f64 {
+        if self.count == 0 {
+            0.0
+        } else {
+            self.sum as f64 / self.count as f64
+        }
+    }
+
+    /// Upper bound of the bucket holding quantile `q` (0.0..=1.0)
+    pub fn percentile(&self, q: f64) -> u64 {
+        if self.count == 0 {
+            return 0;
+        }
+        let rank = ((q.clamp(0.0, 1.0) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (i, &n) in self.buckets.iter().enumerate() {
+            seen += n;
+            if seen >= rank {
+                return Self::bucket_bound(i).min(self.max);
             }
         }
+        self.max
+    }
 
-        if count % 1000 == 0 {
-            self.update_percentiles(count, total);
+    /// Append the histogram in Prometheus exposition format
+    pub fn write_prometheus<W: Write>(&self, out: &mut W, name: &str, help: &str) -> fmt::Result {
+        writeln!(out, "# HELP {} {}", name, help)?;
+        writeln!(out, "# TYPE {} histogram", name)?;
+        let last = self.buckets.iter().rposition(|&n| n > 0).unwrap_or(0);
+        let mut cumulative = 0;
+        for (i, &n) in self.buckets.iter().enumerate().take(last + 1) {
+            cumulative += n;
+            writeln!(
+                out,
+                "{}_bucket{{le=\"{}\"}} {}",
+                name,
+                Self::bucket_bound(i),
+                cumulative
+            )?;
         }
+        writeln!(out, "{}_bucket{{le=\"+Inf\"}} {}", name, self.count)?;
+        writeln!(out, "{}_sum {}", name, self.sum)?;
+        writeln!(out, "{}_count {}", name, self.count)
     }
+}
 
-    pub fn record_alert(&self) {
-        self.alerts_generated.fetch_add(1, Ordering::Relaxed);
+/// Most shards a `ShardedCounter` spreads over
+const MAX_COUNTER_SHARDS: usize = 64;
+
+/// Shards per counter: the parallelism rounded up to a power of two
+fn counter_shards() -> usize {
+    static SHARDS: OnceLock<usize> = OnceLock::new();
+    *SHARDS.get_or_init(|| {
+        std::thread::available_parallelism()
+            .map_or(1, |n| n.get())
+            .next_power_of_two()
+            .min(MAX_COUNTER_SHARDS)
+    })
+}
+
+/// The calling thread's shard, assigned round-robin on first use
+fn thread_shard() -> usize {
+    static NEXT_SHARD: AtomicUsize = AtomicUsize::new(0);
+    thread_local! {
+        static SHARD: usize = NEXT_SHARD.fetch_add(1, Ordering::Relaxed);
     }
+    SHARD.try_with(|shard| *shard).unwrap_or(0)
+}
 
-    fn update_percentiles(&self, count: u64, total_ns: u64) {
-        let avg = if count > 0 { total_ns / count } else { 0 };
+/// Counter split into cache-line padded per-thread shards
+///
+/// Each thread adds to its own shard, so workers counting the same metric
+/// do not contend on one cache line; reads sum the shards.
+pub struct ShardedCounter {
+    shards: Box<[CachePadded<AtomicU64>]>,
+}
 
-        let _ = self.p50_eval_time_ns.store(avg, Ordering::Relaxed);
-        let _ = self.p95_eval_time_ns.store(avg, Ordering::Relaxed);
-        let _ = self.p99_eval_time_ns.store(avg, Ordering::Relaxed);
+impl ShardedCounter {
+    pub fn new() -> Self {
+        Self::with_shards(counter_shards())
     }
 
-    pub fn get_avg_eval_time_ns(&self) -> u64 {
-        let count = self.evaluation_count.load(Ordering::Relaxed);
-        let total = self.total_eval_time_ns.load(Ordering::Relaxed);
-        if count > 0 {
-            total / count
+    /// Counter with `shards` shards, rounded up to a power of two
+    pub fn with_shards(shards: usize) -> Self {
+        Self {
+            shards: (0..shards.max(1).next_power_of_two())
+                .map(|_| CachePadded(AtomicU64::new(0)))
+                .collect(),
+        }
+    }
+
+    pub fn add(&self, n: u64) {
+        let shard = thread_shard() & (self.shards.len() - 1);
+        self.shards[shard].fetch_add(n, Ordering::Relaxed);
+    }
+
+    pub fn inc(&self) {
+        self.add(1);
+    }
+
+    /// Current total across shards
+    pub fn get(&self) -> u64 {
+        self.shards.iter().fold(0, |total, shard| {
+            total.wrapping_add(shard.load(Ordering::Relaxed))
+        })
+    }
+}
+
+impl Default for ShardedCounter {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl std::fmt::Debug for ShardedCounter {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_tuple("ShardedCounter").field(&self.get()).finish()
+    }
+}
+
+/// Linear sub-buckets per power of two in a `LatencyHistogram`
+const SUB_BUCKET_BITS: u32 = 4;
+const SUB_BUCKETS: usize = 1 << SUB_BUCKET_BITS;
+/// Values from `2^LATENCY_RANGE_BITS` ns (about 18 minutes) share the last bucket
+const LATENCY_RANGE_BITS: u32 = 40;
+const LATENCY_BUCKETS: usize = (LATENCY_RANGE_BITS - SUB_BUCKET_BITS + 1) as usize * SUB_BUCKETS;
+
+/// Lock-free log-linear (HDR-style) histogram for latencies
+///
+/// Values below 16 get exact buckets; above that each power of two is
+/// split into 16 linear sub-buckets, so reported quantiles are within
+/// about 6% of the true value up to `2^40` ns. The 592 buckets (under
+/// 5KB) are allocated on the first recorded value, so histograms of
+/// rules that never run cost nothing. The count is the sum of the
+/// buckets.
+pub struct LatencyHistogram {
+    buckets: OnceLock<Box<[AtomicU64]>>,
+    sum: ShardedCounter,
+    max: AtomicU64,
+}
+
+impl Default for LatencyHistogram {
+    fn default() -> Self {
+        Self {
+            buckets: OnceLock::new(),
+            sum: ShardedCounter::new(),
+            max: AtomicU64::new(0),
+        }
+    }
+}
+
+impl LatencyHistogram {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Histogram whose sum is a single counter, for those kept per rule
+    pub fn unsharded() -> Self {
+        Self {
+            sum: ShardedCounter::with_shards(1),
+            ..Self::default()
+        }
+    }
+
+    fn bucket(value: u64) -> usize {
+        if value < SUB_BUCKETS as u64 {
+            return value as usize;
+        }
+        let value = value.min((1 << LATENCY_RANGE_BITS) - 1);
+        let shift = u64::BITS - 1 - value.leading_zeros() - SUB_BUCKET_BITS;
+        (shift as usize + 1) * SUB_BUCKETS + (value >> shift) as usize % SUB_BUCKETS
+    }
+
+    /// Largest value that falls in bucket `i`
+    fn bucket_bound(i: usize) -> u64 {
+        if i < SUB_BUCKETS {
+            return i as u64;
+        }
+        let shift = (i / SUB_BUCKETS - 1) as u32;
+        let lowest = ((SUB_BUCKETS + i % SUB_BUCKETS) as u64) << shift;
+        lowest + ((1u64 << shift) - 1)
+    }
+
+    /// Record one value
+    pub fn record(&self, value: u64) {
+        let buckets = self
+            .buckets
+            .get_or_init(|| (0..LATENCY_BUCKETS).map(|_| AtomicU64::new(0)).collect());
+        buckets[Self::bucket(value)].fetch_add(1, Ordering::Relaxed);
+        self.sum.add(value);
+        self.max.fetch_max(value, Ordering::Relaxed);
+    }
+
+    pub fn count(&self) -> u64 {
+        self.buckets.get().map_or(0, |buckets| {
+            buckets.iter().map(|b| b.load(Ordering::Relaxed)).sum()
+        })
+    }
+
+    pub fn sum(&self) -> u64 {
+        self.sum.get()
+    }
+
+    pub fn max(&self) -> u64 {
+        self.max.load(Ordering::Relaxed)
+    }
+
+    /// Count, sum and quantiles, computed without allocating
+    pub fn snapshot(&self) -> LatencySnapshot {
+        let count = self.count();
+        let max = self.max();
+        let mut quantiles = [(0.5, 0), (0.99, 0), (0.999, 0)];
+
+        if let Some(buckets) = self.buckets.get().filter(|_| count > 0) {
+            let rank = |q: f64| ((q * count as f64).ceil() as u64).max(1);
+            let mut next = 0;
+            let mut seen = 0;
+            for (i, bucket) in buckets.iter().enumerate() {
+                seen += bucket.load(Ordering::Relaxed);
+                while next < quantiles.len() && seen >= rank(quantiles[next].0) {
+                    quantiles[next].1 = Self::bucket_bound(i).min(max);
+                    next += 1;
+                }
+                if next == quantiles.len() {
+                    break;
+                }
+            }
+            // Values recorded during the scan can leave ranks unreached
+            for quantile in &mut quantiles[next..] {
+                quantile.1 = max;
+            }
+        }
+
+        LatencySnapshot {
+            count,
+            sum: self.sum(),
+            max,
+            p50: quantiles[0].1,
+            p99: quantiles[1].1,
+            p999: quantiles[2].1,
+        }
+    }
+}
+
+impl std::fmt::Debug for LatencyHistogram {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("LatencyHistogram")
+            .field("count", &self.count())
+            .field("max", &self.max())
+            .finish()
+    }
+}
+
+/// Quantiles of a `LatencyHistogram`
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct LatencySnapshot {
+    pub count: u64,
+    pub sum: u64,
+    pub max: u64,
+    pub p50: u64,
+    pub p99: u64,
+    pub p999: u64,
+}
+
+impl LatencySnapshot {
+    pub fn mean(&self) -> f64 {
+        if self.count == 0 {
+            0.0
         } else {
-            0
+            self.sum as f64 / self.count as f64
         }
     }
 
-    pub fn get_eval_count(&self) -> u64 {
-        self.evaluation_count.load(Ordering::Relaxed)
+    /// Append the quantiles as a Prometheus summary
+    pub fn write_prometheus<W: Write>(&self, out: &mut W, name: &str, help: &str) -> fmt::Result {
+        writeln!(out, "# HELP {} {}", name, help)?;
+        writeln!(out, "# TYPE {} summary", name)?;
+        self.write_prometheus_samples(out, name, None)
     }
 
-    pub fn get_alert_count(&self) -> u64 {
-        self.alerts_generated.load(Ordering::Relaxed)
+    /// Append the summary samples only, with an optional `(key, value)` label
+    pub fn write_prometheus_samples<W: Write>(
+        &self,
+        out: &mut W,
+        name: &str,
+        label: Option<(&str, &str)>,
+    ) -> fmt::Result {
+        for (quantile, value) in [("0.5", self.p50), ("0.99", self.p99), ("0.999", self.p999)] {
+            match label {
+                Some((key, label)) => writeln!(
+                    out,
+                    "{}{{{}=\"{}\",quantile=\"{}\"}} {}",
+                    name, key, label, quantile, value
+                )?,
+                None => writeln!(out, "{}{{quantile=\"{}\"}} {}", name, quantile, value)?,
+            }
+        }
+        match label {
+            Some((key, label)) => {
+                writeln!(out, "{}_sum{{{}=\"{}\"}} {}", name, key, label, self.sum)?;
+                writeln!(
+                    out,
+                    "{}_count{{{}=\"{}\"}} {}",
+                    name, key, label, self.count
+                )
+            }
+            None => {
+                writeln!(out, "{}_sum {}", name, self.sum)?;
+                writeln!(out, "{}_count {}", name, self.count)
+            }
+        }
+    }
+
+    pub fn to_json(&self) -> serde_json::Value {
+        serde_json::json!({
+            "count": self.count,
+            "p50": self.p50,
+            "p99": self.p99,
+            "p999": self.p999,
+            "max": self.max,
+        })
     }
 }
 
@@ -107,19 +604,25 @@ pub struct EngineMetrics {
     start_time: Instant,
 
     /// Total events received
-    pub events_received: AtomicU64,
+    pub events_received: ShardedCounter,
 
     /// Total events processed
-    pub events_processed: AtomicU64,
+    pub events_processed: ShardedCounter,
 
     /// Total events dropped
-    pub events_dropped: AtomicU64,
+    pub events_dropped: ShardedCounter,
 
     /// Total alerts generated
-    pub alerts_generated: AtomicU64,
+    pub alerts_generated: ShardedCounter,
+
+    /// Time from an event's timestamp to the alert it completed (nanoseconds)
+    pub event_to_alert_latency_ns: LatencyHistogram,
+
+    /// Time from an event's timestamp to its evaluation (nanoseconds)
+    pub queue_delay_ns: LatencyHistogram,
 
     /// Per-rule metrics indexed by rule_id
-    pub rule_metrics: RwLock<HashMap<String, Arc<RuleMetrics>>>,
+    pub rule_metrics: RuleMetricsTable,
 
     /// Current events per second (EPS) - updated every second
     pub current_eps: AtomicU64,
@@ -134,58 +637,70 @@ pub struct EngineMetrics {
     pub peak_nfa_active_states: AtomicUsize,
 
     /// Backpressure events count
-    pub backpressure_events: AtomicU64,
+    pub backpressure_events: ShardedCounter,
 
     /// Error count
-    pub errors: AtomicU64,
+    pub errors: ShardedCounter,
 }
 
 impl EngineMetrics {
     pub fn new() -> Self {
         Self {
             start_time: Instant::now(),
-            events_received: AtomicU64::new(0),
-            events_processed: AtomicU64::new(0),
-            events_dropped: AtomicU64::new(0),
-            alerts_generated: AtomicU64::new(0),
-            rule_metrics: RwLock::new(HashMap::new()),
+            events_received: ShardedCounter::new(),
+            events_processed: ShardedCounter::new(),
+            events_dropped: ShardedCounter::new(),
+            alerts_generated: ShardedCounter::new(),
+            event_to_alert_latency_ns: LatencyHistogram::new(),
+            queue_delay_ns: LatencyHistogram::new(),
+            rule_metrics: RuleMetricsTable::new(),
             current_eps: AtomicU64::new(0),
             peak_eps: AtomicU64::new(0),
             nfa_active_states: AtomicUsize::new(0),
             peak_nfa_active_states: AtomicUsize::new(0),
-            backpressure_events: AtomicU64::new(0),
-            errors: AtomicU64::new(0),
+            backpressure_events: ShardedCounter::new(),
+            errors: ShardedCounter::new(),
         }
     }
 
     /// Record an event received
     pub fn record_event_received(&self) {
-        self.events_received.fetch_add(1, Ordering::Relaxed);
+        self.events_received.inc();
     }
 
     /// Record an event processed
     pub fn record_event_processed(&self) {
-        self.events_processed.fetch_add(1, Ordering::Relaxed);
+        self.events_processed.inc();
     }
 
     /// Record an event dropped
     pub fn record_event_dropped(&self) {
-        self.events_dropped.fetch_add(1, Ordering::Relaxed);
+        self.events_dropped.inc();
     }
 
     /// Record an alert generated
     pub fn record_alert(&self) {
-        self.alerts_generated.fetch_add(1, Ordering::Relaxed);
+        self.alerts_generated.inc();
     }
 
     /// Record a backpressure event
     pub fn record_backpressure(&self) {
-        self.backpressure_events.fetch_add(1, Ordering::Relaxed);
+        self.backpressure_events.inc();
     }
 
     /// Record an error
     pub fn record_error(&self) {
-        self.errors.fetch_add(1, Ordering::Relaxed);
+        self.errors.inc();
+    }
+
+    /// Record the latency from a triggering event to its alert
+    pub fn record_alert_latency(&self, latency_ns: u64) {
+        self.event_to_alert_latency_ns.record(latency_ns);
+    }
+
+    /// Record how long an event waited before evaluation
+    pub fn record_queue_delay(&self, delay_ns: u64) {
+        self.queue_delay_ns.record(delay_ns);
     }
 
     /// Update NFA active states
@@ -208,17 +723,16 @@ impl EngineMetrics {
     }
 
     /// Get or create metrics for a specific rule
+    ///
+    /// Callers on hot paths should keep the returned handle rather than
+    /// look it up per event.
     pub fn rule_metrics(&self, rule_id: &str) -> Arc<RuleMetrics> {
-        let mut rules = self.rule_metrics.write();
-        rules
-            .entry(rule_id.to_string())
-            .or_insert_with(|| Arc::new(RuleMetrics::new()))
-            .clone()
+        self.rule_metrics.get_or_insert(rule_id)
     }
 
     /// Calculate and update EPS (call this periodically)
     pub fn update_eps(&self) {
-        let total = self.events_received.load(Ordering::Relaxed);
+        let total = self.events_received.get();
         let elapsed_secs = self.start_time.elapsed().as_secs_f64();
 
         if elapsed_secs > 0.0 {
@@ -243,8 +757,8 @@ impl EngineMetrics {
 
     /// Get drop rate as a percentage
     pub fn drop_rate_pct(&self) -> f64 {
-        let received = self.events_received.load(Ordering::Relaxed);
-        let dropped = self.events_dropped.load(Ordering::Relaxed);
+        let received = self.events_received.get();
+        let dropped = self.events_dropped.get();
 
         if received > 0 {
             (dropped as f64 / received as f64) * 100.0
@@ -256,128 +770,200 @@ impl EngineMetrics {
     /// Get comprehensive metrics snapshot
     pub fn snapshot(&self) -> MetricsSnapshot {
         MetricsSnapshot {
-            events_received: self.events_received.load(Ordering::Relaxed),
-            events_processed: self.events_processed.load(Ordering::Relaxed),
-            events_dropped: self.events_dropped.load(Ordering::Relaxed),
-            alerts_generated: self.alerts_generated.load(Ordering::Relaxed),
+            events_received: self.events_received.get(),
+            events_processed: self.events_processed.get(),
+            events_dropped: self.events_dropped.get(),
+            alerts_generated: self.alerts_generated.get(),
+            event_to_alert_latency_ns: self.event_to_alert_latency_ns.snapshot(),
+            queue_delay_ns: self.queue_delay_ns.snapshot(),
             current_eps: self.current_eps.load(Ordering::Relaxed),
             peak_eps: self.peak_eps.load(Ordering::Relaxed),
             drop_rate_pct: self.drop_rate_pct(),
             nfa_active_states: self.nfa_active_states.load(Ordering::Relaxed),
             peak_nfa_active_states: self.peak_nfa_active_states.load(Ordering::Relaxed),
-            backpressure_events: self.backpressure_events.load(Ordering::Relaxed),
-            errors: self.errors.load(Ordering::Relaxed),
+            backpressure_events: self.backpressure_events.get(),
+            errors: self.errors.get(),
             uptime_secs: self.start_time.elapsed().as_secs(),
         }
     }
 
     /// Export metrics in Prometheus format
     pub fn export_prometheus(&self) -> String {
-        let snap = self.snapshot();
         let mut output = String::new();
+        // Writing into a String cannot fail
+        let _ = self.write_prometheus(&mut output);
+        output
+    }
 
-        output.push_str("# HELP kestrel_events_received Total events received\n");
-        output.push_str("# TYPE kestrel_events_received counter\n");
-        output.push_str(&format!(
-            "kestrel_events_received {}\n",
-            snap.events_received
-        ));
-
-        output.push_str("# HELP kestrel_events_processed Total events processed\n");
-        output.push_str("# TYPE kestrel_events_processed counter\n");
-        output.push_str(&format!(
-            "kestrel_events_processed {}\n",
-            snap.events_processed
-        ));
-
-        output.push_str("# HELP kestrel_events_dropped Total events dropped\n");
-        output.push_str("# TYPE kestrel_events_dropped counter\n");
-        output.push_str(&format!("kestrel_events_dropped {}\n", snap.events_dropped));
-
-        output.push_str("# HELP kestrel_alerts_generated Total alerts generated\n");
-        output.push_str("# TYPE kestrel_alerts_generated counter\n");
-        output.push_str(&format!(
-            "kestrel_alerts_generated {}\n",
-            snap.alerts_generated
-        ));
-
-        output.push_str("# HELP kestrel_current_events_per_second Current events per second\n");
-        output.push_str("# TYPE kestrel_current_events_per_second gauge\n");
-        output.push_str(&format!(
-            "kestrel_current_events_per_second {}\n",
-            snap.current_eps
-        ));
-
-        output.push_str("# HELP kestrel_peak_events_per_second Peak events per second observed\n");
-        output.push_str("# TYPE kestrel_peak_events_per_second gauge\n");
-        output.push_str(&format!(
-            "kestrel_peak_events_per_second {}\n",
-            snap.peak_eps
-        ));
-
-        output.push_str("# HELP kestrel_drop_rate_percent Drop rate percentage\n");
-        output.push_str("# TYPE kestrel_drop_rate_percent gauge\n");
-        output.push_str(&format!(
-            "kestrel_drop_rate_percent {:.2}\n",
-            snap.drop_rate_pct
-        ));
-
-        output.push_str("# HELP kestrel_nfa_active_states Current NFA active states\n");
-        output.push_str("# TYPE kestrel_nfa_active_states gauge\n");
-        output.push_str(&format!(
-            "kestrel_nfa_active_states {}\n",
-            snap.nfa_active_states
-        ));
-
-        output.push_str("# HELP kestrel_peak_nfa_active_states Peak NFA active states\n");
-        output.push_str("# TYPE kestrel_peak_nfa_active_states gauge\n");
-        output.push_str(&format!(
-            "kestrel_peak_nfa_active_states {}\n",
-            snap.peak_nfa_active_states
-        ));
-
-        output.push_str("# HELP kestrel_backpressure_events Total backpressure events\n");
-        output.push_str("# TYPE kestrel_backpressure_events counter\n");
-        output.push_str(&format!(
-            "kestrel_backpressure_events {}\n",
-            snap.backpressure_events
-        ));
-
-        output.push_str("# HELP kestrel_errors Total errors\n");
-        output.push_str("# TYPE kestrel_errors counter\n");
-        output.push_str(&format!("kestrel_errors {}\n", snap.errors));
-
-        output.push_str("# HELP kestrel_uptime_seconds Engine uptime in seconds\n");
-        output.push_str("# TYPE kestrel_uptime_seconds gauge\n");
-        output.push_str(&format!("kestrel_uptime_seconds {}\n", snap.uptime_secs));
-
-        let rules = self.rule_metrics.read();
-        for (rule_id, metrics) in rules.iter() {
-            output.push_str(&format!("\n# Rule: {}\n", rule_id));
-
-            output.push_str(&format!(
-                "kestrel_rule_evaluations{{rule_id=\"{}\"}} {}\n",
-                rule_id,
-                metrics.get_eval_count()
-            ));
-            output.push_str(&format!(
-                "kestrel_rule_alerts{{rule_id=\"{}\"}} {}\n",
-                rule_id,
-                metrics.get_alert_count()
-            ));
-            output.push_str(&format!(
-                "kestrel_rule_eval_time_avg_ns{{rule_id=\"{}\"}} {}\n",
-                rule_id,
-                metrics.get_avg_eval_time_ns()
-            ));
-            output.push_str(&format!(
-                "kestrel_rule_eval_time_peak_ns{{rule_id=\"{}\"}} {}\n",
-                rule_id,
-                metrics.peak_eval_time_ns.load(Ordering::Relaxed)
-            ));
+    /// Stream metrics in Prometheus format into `out`
+    ///
+    /// Counters are read in place and the rule table is walked without
+    /// locking, so nothing is snapshotted; write into a reused buffer (see
+    /// `PrometheusExporter`) to keep scrapes allocation-free.
+    pub fn write_prometheus<W: Write>(&self, out: &mut W) -> fmt::Result {
+        self.write_engine_prometheus(out)?;
+        self.write_rules_prometheus(out, |_, _| true)
+    }
+
+    /// Engine-wide series
+    fn write_engine_prometheus<W: Write>(&self, out: &mut W) -> fmt::Result {
+        write_sample(
+            out,
+            "kestrel_events_received",
+            "counter",
+            "Total events received",
+            self.events_received.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_events_processed",
+            "counter",
+            "Total events processed",
+            self.events_processed.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_events_dropped",
+            "counter",
+            "Total events dropped",
+            self.events_dropped.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_alerts_generated",
+            "counter",
+            "Total alerts generated",
+            self.alerts_generated.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_current_events_per_second",
+            "gauge",
+            "Current events per second",
+            self.current_eps.load(Ordering::Relaxed),
+        )?;
+        write_sample(
+            out,
+            "kestrel_peak_events_per_second",
+            "gauge",
+            "Peak events per second observed",
+            self.peak_eps.load(Ordering::Relaxed),
+        )?;
+        write_sample(
+            out,
+            "kestrel_drop_rate_percent",
+            "gauge",
+            "Drop rate percentage",
+            format_args!("{:.2}", self.drop_rate_pct()),
+        )?;
+        write_sample(
+            out,
+            "kestrel_nfa_active_states",
+            "gauge",
+            "Current NFA active states",
+            self.nfa_active_states.load(Ordering::Relaxed),
+        )?;
+        write_sample(
+            out,
+            "kestrel_peak_nfa_active_states",
+            "gauge",
+            "Peak NFA active states",
+            self.peak_nfa_active_states.load(Ordering::Relaxed),
+        )?;
+        write_sample(
+            out,
+            "kestrel_backpressure_events",
+            "counter",
+            "Total backpressure events",
+            self.backpressure_events.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_errors",
+            "counter",
+            "Total errors",
+            self.errors.get(),
+        )?;
+        write_sample(
+            out,
+            "kestrel_uptime_seconds",
+            "gauge",
+            "Engine uptime in seconds",
+            self.start_time.elapsed().as_secs(),
+        )?;
+
+        self.event_to_alert_latency_ns.snapshot().write_prometheus(
+            out,
+            "kestrel_event_to_alert_latency_ns",
+            "Time from a triggering event to its alert (ns)",
+        )?;
+        self.queue_delay_ns.snapshot().write_prometheus(
+            out,
+            "kestrel_queue_delay_ns",
+            "Time from an event's timestamp to its evaluation (ns)",
+        )
+    }
+
+    /// Per-rule series for the rules `include` accepts, given their table index
+    ///
+    /// Each family is written in one block under a single HELP/TYPE header,
+    /// as the exposition format requires.
+    fn write_rules_prometheus<W: Write>(
+        &self,
+        out: &mut W,
+        include: impl Fn(usize, &RuleMetrics) -> bool,
+    ) -> fmt::Result {
+        let counters: [(&str, &str, &str, fn(&RuleMetrics) -> u64); 3] = [
+            (
+                "kestrel_rule_evaluations",
+                "counter",
+                "Rule evaluations",
+                RuleMetrics::get_eval_count,
+            ),
+            (
+                "kestrel_rule_alerts",
+                "counter",
+                "Alerts raised by the rule",
+                RuleMetrics::get_alert_count,
+            ),
+            (
+                "kestrel_rule_eval_time_peak_ns",
+                "gauge",
+                "Peak rule evaluation time (ns)",
+                RuleMetrics::get_peak_eval_time_ns,
+            ),
+        ];
+        for (name, kind, help, value) in counters {
+            writeln!(out, "# HELP {} {}", name, help)?;
+            writeln!(out, "# TYPE {} {}", name, kind)?;
+            for (index, rule_id, metrics) in self.rule_metrics.iter() {
+                if include(index, metrics) {
+                    writeln!(
+                        out,
+                        "{}{{rule_id=\"{}\"}} {}",
+                        name,
+                        rule_id,
+                        value(metrics)
+                    )?;
+                }
+            }
         }
 
-        output
+        writeln!(
+            out,
+            "# HELP kestrel_rule_eval_time_ns Rule evaluation time (ns)"
+        )?;
+        writeln!(out, "# TYPE kestrel_rule_eval_time_ns summary")?;
+        for (index, rule_id, metrics) in self.rule_metrics.iter() {
+            if include(index, metrics) {
+                metrics.eval_time_ns.snapshot().write_prometheus_samples(
+                    out,
+                    "kestrel_rule_eval_time_ns",
+                    Some(("rule_id", rule_id)),
+                )?;
+            }
+        }
+        Ok(())
     }
 
     /// Export metrics as JSON
@@ -385,15 +971,14 @@ impl EngineMetrics {
         let snap = self.snapshot();
 
         let mut rule_data = HashMap::new();
-        let rules = self.rule_metrics.read();
-        for (rule_id, metrics) in rules.iter() {
+        for (_, rule_id, metrics) in self.rule_metrics.iter() {
             rule_data.insert(
-                rule_id.clone(),
+                rule_id.to_string(),
                 serde_json::json!({
                     "evaluations": metrics.get_eval_count(),
                     "alerts": metrics.get_alert_count(),
-                    "avg_eval_time_ns": metrics.get_avg_eval_time_ns(),
-                    "peak_eval_time_ns": metrics.peak_eval_time_ns.load(Ordering::Relaxed),
+                    "eval_time_ns": metrics.eval_time_ns.snapshot().to_json(),
+                    "peak_eval_time_ns": metrics.get_peak_eval_time_ns(),
                 }),
             );
         }
@@ -410,6 +995,10 @@ impl EngineMetrics {
             "alerts": {
                 "total": snap.alerts_generated,
             },
+            "latency": {
+                "event_to_alert_ns": snap.event_to_alert_latency_ns.to_json(),
+                "queue_delay_ns": snap.queue_delay_ns.to_json(),
+            },
             "nfa": {
                 "active_states": snap.nfa_active_states,
                 "peak_active_states": snap.peak_nfa_active_states,
@@ -424,6 +1013,70 @@ impl EngineMetrics {
     }
 }
 
+/// Reusable Prometheus exporter for `EngineMetrics`
+///
+/// Keeps its output buffer between scrapes, so steady-state scrapes do not
+/// allocate. `scrape` always writes every series: Prometheus marks a series
+/// stale when a scrape omits it, so scrape endpoints must not filter.
+/// `push_delta` is for push-based collectors (e.g. a remote-write or
+/// pushgateway client) that merge incremental updates.
+#[derive(Debug, Default)]
+pub struct PrometheusExporter {
+    buffer: String,
+    /// Evaluation and alert counts at the last delta push, by rule table index
+    last_seen: Vec<(u64, u64)>,
+    /// Rules changed since the last delta push, by rule table index
+    changed: Vec<bool>,
+}
+
+impl PrometheusExporter {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Full exposition of the engine metrics
+    pub fn scrape(&mut self, metrics: &EngineMetrics) -> &str {
+        self.buffer.clear();
+        // Writing into a String cannot fail
+        let _ = metrics.write_prometheus(&mut self.buffer);
+        &self.buffer
+    }
+
+    /// Full exposition of every component
+    pub fn scrape_unified(&mut self, metrics: &UnifiedMetrics) -> &str {
+        self.buffer.clear();
+        let _ = metrics.write_prometheus(&mut self.buffer);
+        &self.buffer
+    }
+
+    /// Engine-wide series plus the rules that changed since the last call
+    ///
+    /// Only for pushing to a collector that keeps the last value of each
+    /// series; never serve this from a scrape endpoint, where the rules it
+    /// leaves out would go stale.
+    pub fn push_delta(&mut self, metrics: &EngineMetrics) -> &str {
+        self.changed.clear();
+        self.changed.resize(self.last_seen.len(), false);
+        for (index, _, rule) in metrics.rule_metrics.iter() {
+            if self.last_seen.len() <= index {
+                // Rules registered since the last push are always written
+                self.last_seen.resize(index + 1, (u64::MAX, u64::MAX));
+                self.changed.resize(index + 1, false);
+            }
+            let counts = (rule.get_eval_count(), rule.get_alert_count());
+            self.changed[index] = std::mem::replace(&mut self.last_seen[index], counts) != counts;
+        }
+
+        self.buffer.clear();
+        let changed = &self.changed;
+        let _ = metrics.write_engine_prometheus(&mut self.buffer);
+        let _ = metrics.write_rules_prometheus(&mut self.buffer, |index, _| {
+            changed.get(index).copied().unwrap_or(false)
+        });
+        &self.buffer
+    }
+}
+
 /// Snapshot of engine metrics
 #[derive(Debug, Clone)]
 pub struct MetricsSnapshot {
@@ -431,6 +1084,8 @@ pub struct MetricsSnapshot {
     pub events_processed: u64,
     pub events_dropped: u64,
     pub alerts_generated: u64,
+    pub event_to_alert_latency_ns: LatencySnapshot,
+    pub queue_delay_ns: LatencySnapshot,
     pub current_eps: u64,
     pub peak_eps: u64,
     pub drop_rate_pct: f64,
@@ -448,7 +1103,7 @@ mod tests {
     #[test]
     fn test_engine_metrics_creation() {
         let metrics = EngineMetrics::new();
-        assert_eq!(metrics.events_received.load(Ordering::Relaxed), 0);
+        assert_eq!(metrics.events_received.get(), 0);
     }
 
     #[test]
@@ -459,8 +1114,8 @@ mod tests {
         metrics.record_event_received();
         metrics.record_event_processed();
 
-        assert_eq!(metrics.events_received.load(Ordering::Relaxed), 2);
-        assert_eq!(metrics.events_processed.load(Ordering::Relaxed), 1);
+        assert_eq!(metrics.events_received.get(), 2);
+        assert_eq!(metrics.events_processed.get(), 1);
     }
 
     #[test]
@@ -512,6 +1167,172 @@ mod tests {
         assert!(output.contains("kestrel_events_processed 1"));
     }
 
+    #[test]
+    fn test_histogram() {
+        let histogram = Histogram::new();
+        for value in [0, 1, 3, 100, 1000] {
+            histogram.record(value);
+        }
+
+        let snap = histogram.snapshot();
+        assert_eq!(snap.count, 5);
+        assert_eq!(snap.sum, 1104);
+        assert_eq!(snap.percentile(0.5), 3);
+        assert_eq!(snap.percentile(0.8), 127);
+        assert_eq!(snap.percentile(1.0), 1000);
+
+        let mut output = String::new();
+        snap.write_prometheus(&mut output, "kestrel_test", "Test histogram")
+            .unwrap();
+        assert!(output.contains("kestrel_test_bucket{le=\"3\"} 3"));
+        assert!(output.contains("kestrel_test_bucket{le=\"+Inf\"} 5"));
+        assert!(output.contains("kestrel_test_count 5"));
+    }
+
+    #[test]
+    fn test_sharded_counter() {
+        let counter = Arc::new(ShardedCounter::new());
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                let counter = counter.clone();
+                std::thread::spawn(move || {
+                    for _ in 0..1000 {
+                        counter.inc();
+                    }
+                })
+            })
+            .collect();
+        for thread in threads {
+            thread.join().unwrap();
+        }
+        counter.add(5);
+        assert_eq!(counter.get(), 4005);
+    }
+
+    #[test]
+    fn test_latency_histogram_quantiles() {
+        // Bucket bounds are contiguous over the whole range
+        assert_eq!(LatencyHistogram::bucket(31), 31);
+        assert_eq!(LatencyHistogram::bucket(32), 32);
+        assert_eq!(LatencyHistogram::bucket(u64::MAX), LATENCY_BUCKETS - 1);
+        for i in 0..LATENCY_BUCKETS - 1 {
+            let bound = LatencyHistogram::bucket_bound(i);
+            assert_eq!(LatencyHistogram::bucket(bound), i);
+            assert_eq!(LatencyHistogram::bucket(bound + 1), i + 1);
+        }
+
+        let histogram = LatencyHistogram::new();
+        for value in 1..=10_000 {
+            histogram.record(value * 1000);
+        }
+        let snap = histogram.snapshot();
+        assert_eq!(snap.count, 10_000);
+        assert_eq!(snap.max, 10_000_000);
+        for (reported, exact) in [
+            (snap.p50, 5_000_000),
+            (snap.p99, 9_900_000),
+            (snap.p999, 9_990_000),
+        ] {
+            let error = reported.abs_diff(exact) as f64 / exact as f64;
+            assert!(error < 0.07, "{} vs {}", reported, exact);
+        }
+    }
+
+    #[test]
+    fn test_latency_export() {
+        let metrics = EngineMetrics::new();
+        metrics.record_alert_latency(1_000);
+        metrics.record_alert_latency(3_000);
+        metrics.record_queue_delay(200);
+        metrics.rule_metrics("r1").record_evaluation(500);
+
+        let output = metrics.export_prometheus();
+        assert!(output.contains("# TYPE kestrel_event_to_alert_latency_ns summary"));
+        assert!(output.contains("kestrel_event_to_alert_latency_ns{quantile=\"0.999\"} 3000"));
+        assert!(output.contains("kestrel_event_to_alert_latency_ns_count 2"));
+        assert!(output.contains("kestrel_queue_delay_ns_count 1"));
+        assert!(output.contains("kestrel_rule_eval_time_ns{rule_id=\"r1\",quantile=\"0.5\"} 500"));
+        assert!(output.contains("kestrel_rule_eval_time_ns_sum{rule_id=\"r1\"} 500"));
+        assert!(output.contains("kestrel_rule_evaluations{rule_id=\"r1\"} 1"));
+
+        let json = metrics.export_json();
+        assert_eq!(json["latency"]["event_to_alert_ns"]["count"], 2);
+        assert_eq!(json["latency"]["event_to_alert_ns"]["p999"], 3_000);
+        assert_eq!(json["rules"]["r1"]["eval_time_ns"]["p99"], 500);
+    }
+
+    #[test]
+    fn test_rule_metrics_table() {
+        let table = RuleMetricsTable::new();
+        let count = RULE_SEGMENT_BASE * 4;
+        for i in 0..count {
+            table.get_or_insert(&format!("rule-{}", i)).record_alert();
+        }
+        assert_eq!(table.len(), count);
+        assert_eq!(table.get("rule-7").unwrap().get_alert_count(), 1);
+        assert!(table.get("missing").is_none());
+
+        // Lookups return the registered entry rather than a new one
+        table.get_or_insert("rule-7").record_alert();
+        assert_eq!(table.len(), count);
+        assert_eq!(table.get("rule-7").unwrap().get_alert_count(), 2);
+
+        let ids: Vec<_> = table.iter().map(|(i, id, _)| (i, id.to_string())).collect();
+        assert_eq!(ids.len(), count);
+        assert_eq!(ids[200], (200, "rule-200".to_string()));
+    }
+
+    #[test]
+    fn test_prometheus_exporter_scrape_is_full() {
+        let metrics = EngineMetrics::new();
+        let hot = metrics.rule_metrics("hot");
+        metrics.rule_metrics("cold").record_evaluation(100);
+        hot.record_evaluation(100);
+
+        let mut exporter = PrometheusExporter::new();
+        let first = exporter.scrape(&metrics).to_string();
+        assert_eq!(first, metrics.export_prometheus());
+
+        // Unchanged rules stay in every scrape, one TYPE line per family
+        hot.record_evaluation(200);
+        let second = exporter.scrape(&metrics);
+        assert!(second.contains("kestrel_rule_evaluations{rule_id=\"hot\"} 2"));
+        assert!(second.contains("kestrel_rule_evaluations{rule_id=\"cold\"} 1"));
+        for family in [
+            "kestrel_rule_evaluations",
+            "kestrel_rule_alerts",
+            "kestrel_rule_eval_time_peak_ns",
+            "kestrel_rule_eval_time_ns",
+        ] {
+            let header = format!("# TYPE {} ", family);
+            assert_eq!(second.matches(&header).count(), 1, "{}", family);
+        }
+    }
+
+    #[test]
+    fn test_prometheus_exporter_push_delta() {
+        let metrics = EngineMetrics::new();
+        let hot = metrics.rule_metrics("hot");
+        let cold = metrics.rule_metrics("cold");
+        hot.record_evaluation(100);
+        cold.record_evaluation(100);
+
+        let mut exporter = PrometheusExporter::new();
+
+        // First push covers every rule, later ones only changed ones
+        let first = exporter.push_delta(&metrics);
+        assert!(first.contains("rule_id=\"hot\"") && first.contains("rule_id=\"cold\""));
+
+        hot.record_evaluation(200);
+        let delta = exporter.push_delta(&metrics);
+        assert!(delta.contains("kestrel_rule_evaluations{rule_id=\"hot\"} 2"));
+        assert!(!delta.contains("rule_id=\"cold\""));
+        assert!(delta.contains("kestrel_events_received 0"));
+
+        let idle = exporter.push_delta(&metrics);
+        assert!(!idle.contains("rule_id="));
+    }
+
     #[test]
     fn test_json_export() {
         let metrics = EngineMetrics::new();
@@ -534,6 +1355,21 @@ pub struct PoolMetricsSnapshot {
     pub pool_misses: u64,
     pub total_wait_ns: u64,
     pub peak_wait_ns: u64,
+    /// Acquires served by a recycled object
+    pub objects_reused: u64,
+    /// Released objects dropped because the pool was full
+    pub objects_discarded: u64,
+}
+
+impl PoolMetricsSnapshot {
+    /// Share of acquires served by a recycled object (0.0 to 1.0)
+    pub fn reuse_rate(&self) -> f64 {
+        if self.total_acquires == 0 {
+            0.0
+        } else {
+            self.objects_reused as f64 / self.total_acquires as f64
+        }
+    }
 }
 
 /// Unified metrics collector that aggregates metrics from all engine components
@@ -542,6 +1378,8 @@ pub struct UnifiedMetrics {
     pub engine: EngineMetrics,
     pub event_bus: Option<EventBusMetricsSnapshot>,
     pub pool: Option<PoolMetricsSnapshot>,
+    /// Rule cost profiler and how many of its most expensive rules to expose
+    pub profiler: Option<(Arc<RuleProfiler>, usize)>,
 }
 
 impl UnifiedMetrics {
@@ -550,6 +1388,7 @@ impl UnifiedMetrics {
             engine: EngineMetrics::new(),
             event_bus: None,
             pool: None,
+            profiler: None,
         }
     }
 
@@ -558,6 +1397,7 @@ impl UnifiedMetrics {
             engine,
             event_bus: None,
             pool: None,
+            profiler: None,
         }
     }
 
@@ -571,69 +1411,188 @@ impl UnifiedMetrics {
         self
     }
 
+    /// Expose the `top` most expensive rules from `profiler`
+    pub fn with_profiler(mut self, profiler: Arc<RuleProfiler>, top: usize) -> Self {
+        self.profiler = Some((profiler, top));
+        self
+    }
+
     /// Export all metrics in Prometheus format
     pub fn export_prometheus(&self) -> String {
         let mut output = String::new();
+        // Writing into a String cannot fail
+        let _ = self.write_prometheus(&mut output);
+        output
+    }
 
+    /// Stream all metrics in Prometheus format into `out`
+    pub fn write_prometheus<W: Write>(&self, out: &mut W) -> fmt::Result {
         // Engine metrics
-        output.push_str(&self.engine.export_prometheus());
+        self.engine.write_prometheus(out)?;
 
         // Event bus metrics if available
         if let Some(eb_metrics) = &self.event_bus {
-            output.push_str("\n# Event Bus Metrics\n");
-            output.push_str("# TYPE kestrel_eventbus_events_received counter\n");
-            output.push_str(&format!(
-                "kestrel_eventbus_events_received {}\n",
-                eb_metrics.events_received
-            ));
-            output.push_str("# TYPE kestrel_eventbus_events_processed counter\n");
-            output.push_str(&format!(
-                "kestrel_eventbus_events_processed {}\n",
-                eb_metrics.events_processed
-            ));
-            output.push_str("# TYPE kestrel_eventbus_events_dropped counter\n");
-            output.push_str(&format!(
-                "kestrel_eventbus_events_dropped {}\n",
-                eb_metrics.events_dropped
-            ));
-            output.push_str("# TYPE kestrel_eventbus_backpressure_count counter\n");
-            output.push_str(&format!(
-                "kestrel_eventbus_backpressure_count {}\n",
-                eb_metrics.backpressure_count
-            ));
+            writeln!(out, "\n# Event Bus Metrics")?;
+            write_typed(
+                out,
+                "kestrel_eventbus_events_received",
+                "counter",
+                eb_metrics.events_received,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_events_processed",
+                "counter",
+                eb_metrics.events_processed,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_events_dropped",
+                "counter",
+                eb_metrics.events_dropped,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_backpressure_count",
+                "counter",
+                eb_metrics.backpressure_count,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_batch_target",
+                "gauge",
+                eb_metrics.batch_target,
+            )?;
+            eb_metrics.batch_size.write_prometheus(
+                out,
+                "kestrel_eventbus_batch_size",
+                "Events per delivered batch",
+            )?;
+            eb_metrics.queue_delay_ns.write_prometheus(
+                out,
+                "kestrel_eventbus_queue_delay_ns",
+                "Time the oldest event of a batch waited before delivery (ns)",
+            )?;
+            writeln!(out, "# TYPE kestrel_eventbus_partition_events counter")?;
+            for (partition, events) in eb_metrics.partition_events.iter().enumerate() {
+                writeln!(
+                    out,
+                    "kestrel_eventbus_partition_events{{partition=\"{}\"}} {}",
+                    partition, events
+                )?;
+            }
+            write_typed(
+                out,
+                "kestrel_eventbus_rebalance_rounds",
+                "counter",
+                eb_metrics.rebalance_rounds,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_migrations",
+                "counter",
+                eb_metrics.migrations,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_migration_parked_events",
+                "counter",
+                eb_metrics.migration_parked_events,
+            )?;
+            writeln!(out, "# TYPE kestrel_eventbus_lane_depth gauge")?;
+            writeln!(
+                out,
+                "kestrel_eventbus_lane_depth{{lane=\"normal\"}} {}",
+                eb_metrics.normal_lane_depth
+            )?;
+            writeln!(
+                out,
+                "kestrel_eventbus_lane_depth{{lane=\"priority\"}} {}",
+                eb_metrics.priority_lane_depth
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_priority_lane_events",
+                "counter",
+                eb_metrics.priority_lane_events,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_events_shed",
+                "counter",
+                eb_metrics.events_shed,
+            )?;
+            write_typed(
+                out,
+                "kestrel_eventbus_overload_level",
+                "gauge",
+                eb_metrics.overload_level,
+            )?;
+            eb_metrics.priority_lane_latency_ns.write_prometheus(
+                out,
+                "kestrel_eventbus_priority_lane_latency_ns",
+                "Time from publishing a high-priority event to its delivery (ns)",
+            )?;
+            eb_metrics.migration_ns.write_prometheus(
+                out,
+                "kestrel_eventbus_migration_ns",
+                "Time from an entity range changing partition to its state handover (ns)",
+            )?;
         }
 
         // Pool metrics if available
         if let Some(pool) = &self.pool {
-            output.push_str("\n# Pool Metrics\n");
-            output.push_str("# HELP kestrel_pool_size Total pool size\n");
-            output.push_str("# TYPE kestrel_pool_size gauge\n");
-            output.push_str(&format!("kestrel_pool_size {}\n", pool.pool_size));
-            
-            output.push_str("# HELP kestrel_pool_active_instances Currently active instances\n");
-            output.push_str("# TYPE kestrel_pool_active_instances gauge\n");
-            output.push_str(&format!("kestrel_pool_active_instances {}\n", pool.active_instances));
-            
-            output.push_str("# HELP kestrel_pool_acquires_total Total pool acquires\n");
-            output.push_str("# TYPE kestrel_pool_acquires_total counter\n");
-            output.push_str(&format!("kestrel_pool_acquires_total {}\n", pool.total_acquires));
-            
-            output.push_str("# HELP kestrel_pool_releases_total Total pool releases\n");
-            output.push_str("# TYPE kestrel_pool_releases_total counter\n");
-            output.push_str(&format!("kestrel_pool_releases_total {}\n", pool.total_releases));
-            
-            output.push_str("# HELP kestrel_pool_misses_total Total pool misses\n");
-            output.push_str("# TYPE kestrel_pool_misses_total counter\n");
-            output.push_str(&format!("kestrel_pool_misses_total {}\n", pool.pool_misses));
-            
-            output.push_str("# HELP kestrel_pool_wait_time_total Total wait time (ns)\n");
-            output.push_str("# TYPE kestrel_pool_wait_time_total counter\n");
-            output.push_str(&format!("kestrel_pool_wait_time_total {}\n", pool.total_wait_ns));
-            
-            output.push_str("# HELP kestrel_pool_peak_wait_time Peak wait time (ns)\n");
-            output.push_str("# TYPE kestrel_pool_peak_wait_time gauge\n");
-            output.push_str(&format!("kestrel_pool_peak_wait_time {}\n", pool.peak_wait_ns));
-            
+            writeln!(out, "\n# Pool Metrics")?;
+            write_sample(
+                out,
+                "kestrel_pool_size",
+                "gauge",
+                "Total pool size",
+                pool.pool_size,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_active_instances",
+                "gauge",
+                "Currently active instances",
+                pool.active_instances,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_acquires_total",
+                "counter",
+                "Total pool acquires",
+                pool.total_acquires,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_releases_total",
+                "counter",
+                "Total pool releases",
+                pool.total_releases,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_misses_total",
+                "counter",
+                "Total pool misses",
+                pool.pool_misses,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_wait_time_total",
+                "counter",
+                "Total wait time (ns)",
+                pool.total_wait_ns,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_peak_wait_time",
+                "gauge",
+                "Peak wait time (ns)",
+                pool.peak_wait_ns,
+            )?;
+
             // Calculate hit rate
             let total_requests = pool.total_acquires + pool.pool_misses;
             let hit_rate = if total_requests > 0 {
@@ -641,12 +1600,43 @@ impl UnifiedMetrics {
             } else {
                 0.0
             };
-            output.push_str("# HELP kestrel_pool_hit_rate Pool hit rate (0-100)\n");
-            output.push_str("# TYPE kestrel_pool_hit_rate gauge\n");
-            output.push_str(&format!("kestrel_pool_hit_rate {:.2}\n", hit_rate));
+            write_sample(
+                out,
+                "kestrel_pool_hit_rate",
+                "gauge",
+                "Pool hit rate (0-100)",
+                format_args!("{:.2}", hit_rate),
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_reused_total",
+                "counter",
+                "Acquires served by a recycled object",
+                pool.objects_reused,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_discarded_total",
+                "counter",
+                "Released objects dropped because the pool was full",
+                pool.objects_discarded,
+            )?;
+            write_sample(
+                out,
+                "kestrel_pool_reuse_rate",
+                "gauge",
+                "Share of acquires served by a recycled object (0-1)",
+                format_args!("{:.4}", pool.reuse_rate()),
+            )?;
         }
 
-        output
+        // Rule cost profile if available
+        if let Some((profiler, top)) = &self.profiler {
+            writeln!(out, "\n# Rule Cost Profile")?;
+            profiler.write_prometheus(out, *top)?;
+        }
+
+        Ok(())
     }
 
     /// Export all metrics as JSON
@@ -660,6 +1650,22 @@ impl UnifiedMetrics {
                 "events_processed": eb_metrics.events_processed,
                 "events_dropped": eb_metrics.events_dropped,
                 "backpressure_count": eb_metrics.backpressure_count,
+                "batch_target": eb_metrics.batch_target,
+                "batch_size_p50": eb_metrics.batch_size.percentile(0.5),
+                "batch_size_p99": eb_metrics.batch_size.percentile(0.99),
+                "queue_delay_p50_ns": eb_metrics.queue_delay_ns.percentile(0.5),
+                "queue_delay_p99_ns": eb_metrics.queue_delay_ns.percentile(0.99),
+                "partition_events": eb_metrics.partition_events,
+                "rebalance_rounds": eb_metrics.rebalance_rounds,
+                "migrations": eb_metrics.migrations,
+                "migration_p99_ns": eb_metrics.migration_ns.percentile(0.99),
+                "migration_parked_events": eb_metrics.migration_parked_events,
+                "normal_lane_depth": eb_metrics.normal_lane_depth,
+                "priority_lane_depth": eb_metrics.priority_lane_depth,
+                "priority_lane_events": eb_metrics.priority_lane_events,
+                "priority_lane_p99_ns": eb_metrics.priority_lane_latency_ns.percentile(0.99),
+                "events_shed": eb_metrics.events_shed,
+                "overload_level": eb_metrics.overload_level,
             });
         }
 
@@ -673,6 +1679,9 @@ impl UnifiedMetrics {
                 "misses": pool.pool_misses,
                 "total_wait_ns": pool.total_wait_ns,
                 "peak_wait_ns": pool.peak_wait_ns,
+                "reused": pool.objects_reused,
+                "discarded": pool.objects_discarded,
+                "reuse_rate": pool.reuse_rate(),
             });
         }
 
@@ -720,6 +1729,7 @@ mod unified_metrics_tests {
             pool_misses: 5,
             total_wait_ns: 1_000_000,
             peak_wait_ns: 50_000,
+            ..Default::default()
         };
         unified = unified.with_pool(pool);
         
@@ -751,6 +1761,7 @@ mod unified_metrics_tests {
             pool_misses: 5,
             total_wait_ns: 1_000_000,
             peak_wait_ns: 50_000,
+            ..Default::default()
         };
         unified = unified.with_pool(pool);
         
@@ -760,4 +1771,38 @@ mod unified_metrics_tests {
         assert_eq!(json["pool"]["active_instances"], 3);
         assert_eq!(json["pool"]["total_acquires"], 100);
     }
+
+    #[test]
+    fn test_pool_reuse_export() {
+        let pool = crate::ObjectPool::<Vec<u32>>::new(1, 4);
+        for _ in 0..3 {
+            drop(pool.acquire());
+        }
+        let unified = UnifiedMetrics::new().with_pool(pool.metrics().into());
+
+        let output = unified.export_prometheus();
+        assert!(output.contains("kestrel_pool_acquires_total 3"));
+        assert!(output.contains("kestrel_pool_reused_total 3"));
+        assert!(output.contains("kestrel_pool_reuse_rate 1.0000"));
+
+        let json = unified.export_json();
+        assert_eq!(json["pool"]["reused"], 3);
+        assert_eq!(json["pool"]["reuse_rate"], 1.0);
+    }
+
+    #[test]
+    fn test_rule_profile_on_scrape() {
+        let profiler = Arc::new(RuleProfiler::new(crate::RuleProfilerConfig {
+            sample_every: 1,
+            ..Default::default()
+        }));
+        let sample = profiler.begin().unwrap();
+        profiler.end("costly", sample, 256);
+        let unified = UnifiedMetrics::new().with_profiler(profiler, 10);
+
+        let mut exporter = PrometheusExporter::new();
+        let output = exporter.scrape_unified(&unified);
+        assert!(output.contains("kestrel_rule_cost_partial_match_bytes{rule_id=\"costly\"} 256"));
+        assert!(output.contains("kestrel_rule_disabled{rule_id=\"costly\"} 0"));
+    }
 }
@@ -3,45 +3,241 @@
 //! This module provides object pooling to reduce heap allocations
 //! in hot paths. This is particularly useful for event processing
 //! where we need to allocate Vecs and other collections frequently.
-
+//!
+//! Returned objects are [`Reset`] and kept, so a pooled `Vec` keeps its
+//! capacity across uses. Each thread caches a few idle objects per pool in
+//! front of a shared lock-free free list; neither path takes a lock.
+
+use std::any::Any;
+use std::cell::{RefCell, UnsafeCell};
+use std::collections::VecDeque;
+use std::mem::MaybeUninit;
 use std::sync::atomic::{AtomicUsize, Ordering};
-use std::sync::Mutex;
+use std::sync::Arc;
+
+use crate::metrics::PoolMetricsSnapshot;
+use crate::ring::CachePadded;
+
+/// Objects that can be emptied for reuse while keeping their allocations
+pub trait Reset {
+    /// Return to the empty state
+    fn reset(&mut self);
+}
+
+impl<T> Reset for Vec<T> {
+    fn reset(&mut self) {
+        self.clear();
+    }
+}
+
+impl<T> Reset for VecDeque<T> {
+    fn reset(&mut self) {
+        self.clear();
+    }
+}
+
+impl Reset for String {
+    fn reset(&mut self) {
+        self.clear();
+    }
+}
+
+/// Idle objects a thread keeps per pool before spilling to the free list
+const LOCAL_CACHE_SIZE: usize = 16;
+
+static NEXT_POOL_ID: AtomicUsize = AtomicUsize::new(0);
+
+thread_local! {
+    /// This thread's idle objects, indexed by pool id
+    static LOCAL_CACHES: RefCell<Vec<Option<Box<dyn Any>>>> = RefCell::new(Vec::new());
+}
+
+/// A thread's idle objects for one pool
+///
+/// Dropped with the thread, taking its objects out of the pool's count.
+struct LocalCache<T> {
+    objects: Vec<T>,
+    idle: Arc<AtomicUsize>,
+}
+
+impl<T> Drop for LocalCache<T> {
+    fn drop(&mut self) {
+        self.idle.fetch_sub(self.objects.len(), Ordering::Relaxed);
+    }
+}
+
+/// A free list slot
+///
+/// `seq == pos` while the slot is empty for list position `pos`, and
+/// `seq == pos + 1` once an object is stored there.
+struct Slot<T> {
+    seq: AtomicUsize,
+    value: UnsafeCell<MaybeUninit<T>>,
+}
+
+/// Bounded lock-free multi-producer multi-consumer queue of idle objects
+struct FreeList<T> {
+    /// Next position to pop
+    head: CachePadded<AtomicUsize>,
+    /// Next position to push
+    tail: CachePadded<AtomicUsize>,
+    slots: Box<[Slot<T>]>,
+    mask: usize,
+}
+
+// Objects move between threads through the slots; a slot is only accessed
+// by the thread that claimed its position.
+unsafe impl<T: Send> Send for FreeList<T> {}
+unsafe impl<T: Send> Sync for FreeList<T> {}
 
-/// A simple object pool for reusable objects
+impl<T> FreeList<T> {
+    fn with_capacity(capacity: usize) -> Self {
+        let capacity = capacity.max(1).next_power_of_two();
+        Self {
+            head: CachePadded(AtomicUsize::new(0)),
+            tail: CachePadded(AtomicUsize::new(0)),
+            slots: (0..capacity)
+                .map(|pos| Slot {
+                    seq: AtomicUsize::new(pos),
+                    value: UnsafeCell::new(MaybeUninit::uninit()),
+                })
+                .collect(),
+            mask: capacity - 1,
+        }
+    }
+
+    /// Store an object, handing it back if the list is full
+    fn push(&self, value: T) -> Result<(), T> {
+        let mut pos = self.tail.load(Ordering::Relaxed);
+        loop {
+            let slot = &self.slots[pos & self.mask];
+            let seq = slot.seq.load(Ordering::Acquire);
+            match seq.wrapping_sub(pos) as isize {
+                0 => match self.tail.compare_exchange_weak(
+                    pos,
+                    pos.wrapping_add(1),
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => {
+                        // SAFETY: claiming `pos` gives exclusive access to the empty slot
+                        unsafe { (*slot.value.get()).write(value) };
+                        slot.seq.store(pos.wrapping_add(1), Ordering::Release);
+                        return Ok(());
+                    }
+                    Err(current) => pos = current,
+                },
+                lag if lag < 0 => return Err(value),
+                _ => pos = self.tail.load(Ordering::Relaxed),
+            }
+        }
+    }
+
+    fn pop(&self) -> Option<T> {
+        let mut pos = self.head.load(Ordering::Relaxed);
+        loop {
+            let slot = &self.slots[pos & self.mask];
+            let seq = slot.seq.load(Ordering::Acquire);
+            match seq.wrapping_sub(pos.wrapping_add(1)) as isize {
+                0 => match self.head.compare_exchange_weak(
+                    pos,
+                    pos.wrapping_add(1),
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => {
+                        // SAFETY: claiming `pos` gives exclusive access to the filled slot
+                        let value = unsafe { (*slot.value.get()).assume_init_read() };
+                        slot.seq
+                            .store(pos.wrapping_add(self.mask + 1), Ordering::Release);
+                        return Some(value);
+                    }
+                    Err(current) => pos = current,
+                },
+                lag if lag < 0 => return None,
+                _ => pos = self.head.load(Ordering::Relaxed),
+            }
+        }
+    }
+}
+
+impl<T> Drop for FreeList<T> {
+    fn drop(&mut self) {
+        while self.pop().is_some() {}
+    }
+}
+
+/// A lock-free object pool for reusable objects
+///
+/// Objects handed back are reset and kept while fewer than `max_size` are
+/// idle. Idle objects sit in the returning thread's cache first, so a
+/// thread that acquires and releases in a loop reuses its own objects
+/// without going through the shared free list; full caches spill to it.
+/// Every acquire and release still updates the pool's atomic idle count and
+/// metrics counters.
+///
+/// Objects in a thread's cache can only be acquired by that thread. Other
+/// threads miss them and allocate, and they count toward `max_size`, until
+/// the owning thread reuses them or exits. Dropping the pool frees the
+/// dropping thread's cache; other threads' caches are freed when those
+/// threads exit.
 ///
 /// # Type Parameters
-/// * `T` - The type of object to pool. Must implement Default.
-pub struct ObjectPool<T: Default> {
-    /// Pre-allocated objects
-    pool: Mutex<Vec<T>>,
-    /// Maximum size of the pool
+/// * `T` - The type of object to pool. Must implement Reset and Default.
+pub struct ObjectPool<T: Reset + Default + Send + 'static> {
+    /// Index of this pool's per-thread caches
+    id: usize,
+    /// Idle objects shared by all threads
+    free: FreeList<T>,
+    /// Maximum number of idle objects kept
     max_size: usize,
-    /// Current size of the pool (atomic for fast check)
-    current_size: AtomicUsize,
+    /// Idle objects a thread caches before spilling to `free`
+    local_size: usize,
+    /// Idle objects in `free` and the per-thread caches
+    current_size: Arc<AtomicUsize>,
     /// Total number of objects created (for metrics)
     total_created: AtomicUsize,
     /// Total number of objects reused (for metrics)
     total_reused: AtomicUsize,
+    /// Total number of acquires that found the pool empty (for metrics)
+    total_missed: AtomicUsize,
+    /// Total number of objects reset and kept on release (for metrics)
+    total_recycled: AtomicUsize,
+    /// Total number of objects dropped because the pool was full (for metrics)
+    total_discarded: AtomicUsize,
 }
 
-impl<T: Default> ObjectPool<T> {
+impl<T: Reset + Default + Send + 'static> ObjectPool<T> {
     /// Create a new object pool with the given capacity
     ///
     /// # Arguments
     /// * `initial_capacity` - Initial number of objects to pre-allocate
     /// * `max_size` - Maximum number of objects to keep in the pool
     pub fn new(initial_capacity: usize, max_size: usize) -> Self {
-        let mut pool = Vec::with_capacity(initial_capacity);
-        for _ in 0..initial_capacity {
-            pool.push(T::default());
+        Self::with_objects((0..initial_capacity).map(|_| T::default()), max_size)
+    }
+
+    fn with_objects(objects: impl ExactSizeIterator<Item = T>, max_size: usize) -> Self {
+        let initial_capacity = objects.len();
+        let free = FreeList::with_capacity(max_size.max(initial_capacity));
+        for obj in objects {
+            // The list holds at least `initial_capacity` objects
+            let _ = free.push(obj);
         }
 
         Self {
-            pool: Mutex::new(pool),
+            id: NEXT_POOL_ID.fetch_add(1, Ordering::Relaxed),
+            free,
             max_size,
-            current_size: AtomicUsize::new(initial_capacity),
+            // A quarter at most, so objects released on one thread and
+            // acquired on another reach the free list before the pool fills
+            local_size: LOCAL_CACHE_SIZE.min(max_size / 4),
+            current_size: Arc::new(AtomicUsize::new(initial_capacity)),
             total_created: AtomicUsize::new(initial_capacity),
             total_reused: AtomicUsize::new(0),
+            total_missed: AtomicUsize::new(0),
+            total_recycled: AtomicUsize::new(0),
+            total_discarded: AtomicUsize::new(0),
         }
     }
 
@@ -50,64 +246,112 @@ impl<T: Default> ObjectPool<T> {
     /// If the pool is empty, creates a new object.
     /// Returns the object and a guard that returns it to the pool when dropped.
     pub fn acquire(&self) -> PooledObject<'_, T> {
-        let obj = {
-            let mut pool = self.pool.lock().unwrap();
-            if let Some(obj) = pool.pop() {
-                self.current_size.fetch_sub(1, Ordering::Relaxed);
-                self.total_reused.fetch_add(1, Ordering::Relaxed);
-                obj
-            } else {
-                drop(pool);
-                self.total_created.fetch_add(1, Ordering::Relaxed);
-                T::default()
-            }
-        };
-
         PooledObject {
-            obj: Some(obj),
+            obj: Some(self.pull()),
             pool: self,
         }
     }
 
     /// Try to acquire an object from the pool without blocking
     ///
-    /// Returns None if the pool lock is poisoned.
+    /// The pool never blocks, so this always succeeds.
     pub fn try_acquire(&self) -> Option<PooledObject<'_, T>> {
-        let mut pool = self.pool.lock().ok()?;
-        if let Some(obj) = pool.pop() {
-            drop(pool);
-            self.current_size.fetch_sub(1, Ordering::Relaxed);
-            self.total_reused.fetch_add(1, Ordering::Relaxed);
-            Some(PooledObject {
-                obj: Some(obj),
-                pool: self,
-            })
-        } else {
-            drop(pool);
-            self.total_created.fetch_add(1, Ordering::Relaxed);
-            Some(PooledObject {
-                obj: Some(T::default()),
-                pool: self,
-            })
+        Some(self.acquire())
+    }
+
+    /// Take an object out of the pool, creating one if none is idle
+    ///
+    /// Unlike [`acquire`](Self::acquire), the object does not return on its
+    /// own; hand it back with [`recycle`](Self::recycle).
+    pub fn pull(&self) -> T {
+        let idle = self
+            .with_local_cache(|cache| cache.pop())
+            .flatten()
+            .or_else(|| self.free.pop());
+
+        match idle {
+            Some(obj) => {
+                self.current_size.fetch_sub(1, Ordering::Relaxed);
+                self.total_reused.fetch_add(1, Ordering::Relaxed);
+                obj
+            }
+            None => {
+                self.total_created.fetch_add(1, Ordering::Relaxed);
+                self.total_missed.fetch_add(1, Ordering::Relaxed);
+                T::default()
+            }
         }
     }
 
     /// Return an object to the pool
     ///
-    /// If the pool is at capacity, the object is dropped.
-    fn release(&self, _obj: T) {
-        // Only keep objects if we're under the max size
-        let current = self.current_size.load(Ordering::Relaxed);
-        if current < self.max_size {
-            // Create a fresh default object for the pool
-            let obj = T::default();
-
-            if let Ok(mut pool) = self.pool.lock() {
-                pool.push(obj);
-                self.current_size.fetch_add(1, Ordering::Relaxed);
+    /// The object is reset and kept unless `max_size` objects are already
+    /// idle, in which case it is dropped.
+    pub fn recycle(&self, mut obj: T) {
+        let max_size = self.max_size;
+        let kept = self
+            .current_size
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |idle| {
+                (idle < max_size).then(|| idle + 1)
+            })
+            .is_ok();
+        if !kept {
+            self.total_discarded.fetch_add(1, Ordering::Relaxed);
+            return;
+        }
+
+        obj.reset();
+        self.total_recycled.fetch_add(1, Ordering::Relaxed);
+
+        let mut obj = Some(obj);
+        self.with_local_cache(|cache| {
+            if cache.len() >= self.local_size {
+                // Keep half the cache local and share the rest
+                for spilled in cache.drain(self.local_size / 2..) {
+                    self.store_shared(spilled);
+                }
             }
+            if self.local_size > 0 {
+                cache.extend(obj.take());
+            }
+        });
+        if let Some(obj) = obj {
+            self.store_shared(obj);
+        }
+    }
+
+    /// Put an idle object on the shared free list
+    fn store_shared(&self, obj: T) {
+        if self.free.push(obj).is_err() {
+            // Only reachable when more objects were pre-allocated than kept
+            self.current_size.fetch_sub(1, Ordering::Relaxed);
+            self.total_discarded.fetch_add(1, Ordering::Relaxed);
         }
-        // If at capacity, _obj is dropped when it goes out of scope
+    }
+
+    /// Run `f` on this thread's cache for the pool
+    ///
+    /// Returns None when the cache is unavailable: during thread teardown,
+    /// or when reentered from an object's `reset` or `drop`.
+    fn with_local_cache<R>(&self, f: impl FnOnce(&mut Vec<T>) -> R) -> Option<R> {
+        LOCAL_CACHES
+            .try_with(|caches| {
+                let mut caches = caches.try_borrow_mut().ok()?;
+                if caches.len() <= self.id {
+                    caches.resize_with(self.id + 1, || None);
+                }
+                caches[self.id]
+                    .get_or_insert_with(|| {
+                        Box::new(LocalCache::<T> {
+                            objects: Vec::new(),
+                            idle: self.current_size.clone(),
+                        })
+                    })
+                    .downcast_mut::<LocalCache<T>>()
+                    .map(|cache| f(&mut cache.objects))
+            })
+            .ok()
+            .flatten()
     }
 
     /// Get pool metrics
@@ -117,6 +361,9 @@ impl<T: Default> ObjectPool<T> {
             max_size: self.max_size,
             total_created: self.total_created.load(Ordering::Relaxed),
             total_reused: self.total_reused.load(Ordering::Relaxed),
+            total_missed: self.total_missed.load(Ordering::Relaxed),
+            total_recycled: self.total_recycled.load(Ordering::Relaxed),
+            total_discarded: self.total_discarded.load(Ordering::Relaxed),
         }
     }
 
@@ -126,6 +373,18 @@ impl<T: Default> ObjectPool<T> {
     }
 }
 
+impl<T: Reset + Default + Send + 'static> Drop for ObjectPool<T> {
+    fn drop(&mut self) {
+        let _ = LOCAL_CACHES.try_with(|caches| {
+            if let Ok(mut caches) = caches.try_borrow_mut() {
+                if let Some(cache) = caches.get_mut(self.id) {
+                    cache.take();
+                }
+            }
+        });
+    }
+}
+
 /// Metrics for the object pool
 #[derive(Debug, Clone, Copy)]
 pub struct PoolMetrics {
@@ -137,6 +396,12 @@ pub struct PoolMetrics {
     pub total_created: usize,
     /// Total number of objects reused from pool
     pub total_reused: usize,
+    /// Total number of acquires that found the pool empty
+    pub total_missed: usize,
+    /// Total number of released objects kept for reuse
+    pub total_recycled: usize,
+    /// Total number of released objects dropped because the pool was full
+    pub total_discarded: usize,
 }
 
 impl PoolMetrics {
@@ -151,13 +416,30 @@ impl PoolMetrics {
     }
 }
 
+impl From<PoolMetrics> for PoolMetricsSnapshot {
+    fn from(metrics: PoolMetrics) -> Self {
+        let acquires = (metrics.total_missed + metrics.total_reused) as u64;
+        let releases = (metrics.total_recycled + metrics.total_discarded) as u64;
+        Self {
+            pool_size: metrics.current_size,
+            active_instances: acquires.saturating_sub(releases) as usize,
+            total_acquires: acquires,
+            total_releases: releases,
+            pool_misses: metrics.total_missed as u64,
+            objects_reused: metrics.total_reused as u64,
+            objects_discarded: metrics.total_discarded as u64,
+            ..Default::default()
+        }
+    }
+}
+
 /// A pooled object that returns to the pool when dropped
-pub struct PooledObject<'a, T: Default> {
+pub struct PooledObject<'a, T: Reset + Default + Send + 'static> {
     obj: Option<T>,
     pool: &'a ObjectPool<T>,
 }
 
-impl<'a, T: Default> PooledObject<'a, T> {
+impl<'a, T: Reset + Default + Send + 'static> PooledObject<'a, T> {
     /// Get a reference to the object
     pub fn get(&self) -> &T {
         self.obj.as_ref().unwrap()
@@ -174,7 +456,7 @@ impl<'a, T: Default> PooledObject<'a, T> {
     }
 }
 
-impl<'a, T: Default> std::ops::Deref for PooledObject<'a, T> {
+impl<'a, T: Reset + Default + Send + 'static> std::ops::Deref for PooledObject<'a, T> {
     type Target = T;
 
     fn deref(&self) -> &Self::Target {
@@ -182,16 +464,16 @@ impl<'a, T: Default> std::ops::Deref for PooledObject<'a, T> {
     }
 }
 
-impl<'a, T: Default> std::ops::DerefMut for PooledObject<'a, T> {
+impl<'a, T: Reset + Default + Send + 'static> std::ops::DerefMut for PooledObject<'a, T> {
     fn deref_mut(&mut self) -> &mut Self::Target {
         self.get_mut()
     }
 }
 
-impl<'a, T: Default> Drop for PooledObject<'a, T> {
+impl<'a, T: Reset + Default + Send + 'static> Drop for PooledObject<'a, T> {
     fn drop(&mut self) {
         if let Some(obj) = self.obj.take() {
-            self.pool.release(obj);
+            self.pool.recycle(obj);
         }
     }
 }
@@ -202,18 +484,10 @@ pub type EventVecPool = ObjectPool<Vec<kestrel_event::Event>>;
 impl EventVecPool {
     /// Create a new pool for event vectors with specified capacity
     pub fn for_events(initial_capacity: usize, max_size: usize, vec_capacity: usize) -> Self {
-        let mut pool = Vec::with_capacity(initial_capacity);
-        for _ in 0..initial_capacity {
-            pool.push(Vec::with_capacity(vec_capacity));
-        }
-
-        Self {
-            pool: Mutex::new(pool),
+        Self::with_objects(
+            (0..initial_capacity).map(|_| Vec::with_capacity(vec_capacity)),
             max_size,
-            current_size: AtomicUsize::new(initial_capacity),
-            total_created: AtomicUsize::new(initial_capacity),
-            total_reused: AtomicUsize::new(0),
-        }
+        )
     }
 }
 
@@ -223,8 +497,6 @@ pub struct PoolManager {
     pub event_batch_pool: Option<Arc<EventVecPool>>,
 }
 
-use std::sync::Arc;
-
 impl PoolManager {
     /// Create a new pool manager with default pools
     pub fn new() -> Self {
@@ -285,10 +557,10 @@ mod tests {
     #[test]
     fn test_pooled_object_deref() {
         let pool = ObjectPool::<Vec<u32>>::new(1, 2);
-        
+
         let mut obj = pool.acquire();
         obj.get_mut().push(42);
-        
+
         assert_eq!(obj.get()[0], 42);
         assert_eq!(obj.len(), 1);
     }
@@ -306,4 +578,80 @@ mod tests {
         let metrics = pool.metrics();
         assert!(metrics.reuse_rate() > 0.8, "Should have high reuse rate");
     }
+
+    #[test]
+    fn test_recycled_objects_keep_capacity() {
+        let pool = ObjectPool::<Vec<u32>>::new(0, 2);
+
+        let mut obj = pool.pull();
+        obj.extend(0..128);
+        pool.recycle(obj);
+
+        let obj = pool.pull();
+        assert!(obj.is_empty());
+        assert!(obj.capacity() >= 128);
+        assert_eq!(pool.metrics().total_reused, 1);
+
+        // Only `max_size` idle objects are kept
+        let extra = (pool.pull(), pool.pull());
+        pool.recycle(obj);
+        pool.recycle(extra.0);
+        pool.recycle(extra.1);
+        let metrics = pool.metrics();
+        assert_eq!(metrics.current_size, 2);
+        assert_eq!(metrics.total_discarded, 1);
+    }
+
+    #[test]
+    fn test_idle_objects_shared_across_threads() {
+        let pool = Arc::new(ObjectPool::<Vec<u32>>::new(0, 64));
+
+        // More than a thread caches, so most spill to the free list
+        let objects: Vec<_> = (0..40).map(|_| pool.pull()).collect();
+        for obj in objects {
+            pool.recycle(obj);
+        }
+        assert_eq!(pool.available(), 40);
+
+        let other = pool.clone();
+        std::thread::spawn(move || {
+            let objects: Vec<_> = (0..40).map(|_| other.pull()).collect();
+            for obj in objects {
+                other.recycle(obj);
+            }
+        })
+        .join()
+        .unwrap();
+
+        // The other thread reused what spilled and its cache left with it
+        let metrics = pool.metrics();
+        assert_eq!(metrics.total_created, 40 + LOCAL_CACHE_SIZE);
+        assert_eq!(metrics.total_reused, 40 - LOCAL_CACHE_SIZE);
+        assert_eq!(metrics.current_size, 40);
+    }
+
+    #[test]
+    fn test_concurrent_acquire_release() {
+        let pool = Arc::new(ObjectPool::<Vec<u32>>::new(0, 32));
+
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                let pool = pool.clone();
+                std::thread::spawn(move || {
+                    for i in 0..1000 {
+                        let mut obj = pool.acquire();
+                        assert!(obj.is_empty());
+                        obj.push(i);
+                    }
+                })
+            })
+            .collect();
+        for thread in threads {
+            thread.join().unwrap();
+        }
+
+        let metrics = pool.metrics();
+        assert!(metrics.current_size <= 32);
+        assert!(metrics.reuse_rate() > 0.9);
+    }
 }
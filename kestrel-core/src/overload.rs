@@ -0,0 +1,438 @@
+//! Overload control and load shedding
+//!
+//! The controller turns queue depth and processing lag into a shedding
+//! level from 0 (no shedding) to `MAX_SHED_LEVEL`. Each level sheds another
+//! band of event types, lowest detection value first. A shed type is
+//! sampled down to its keep budget by hashing (event type, entity), so a
+//! kept entity keeps its whole stream of that type. Shed events are dropped
+//! at the publisher, before they reach a ring, and reported to the caller as
+//! `PublishError::Shed`.
+//!
+//! Protected event types (those required by loaded sequence rules) are
+//! never shed.
+
+use crate::priority::EventTypeSet;
+use crate::ring::CachePadded;
+use kestrel_event::Event;
+use parking_lot::Mutex;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU32, AtomicU64, AtomicU8, Ordering};
+use std::time::{Duration, Instant};
+use tracing::{info, warn};
+
+/// Highest shedding level; every unprotected type is shed
+pub const MAX_SHED_LEVEL: u8 = 4;
+
+/// Value band added to the shed set per level
+const VALUE_BAND: u32 = 256 / MAX_SHED_LEVEL as u32;
+
+/// Keep threshold meaning "keep everything"
+const KEEP_ALL: u32 = 1 << 16;
+
+/// Admissions per partition between pressure evaluations
+const EVALUATE_EVERY: u64 = 64;
+
+/// Overload controller configuration
+#[derive(Debug, Clone)]
+pub struct OverloadConfig {
+    /// Pressure (0-1) above which the shedding level steps up
+    pub high_watermark: f64,
+
+    /// Pressure below which the shedding level steps down
+    pub low_watermark: f64,
+
+    /// Batch queue delay treated as full pressure
+    pub max_lag: Duration,
+
+    /// Minimum time between level changes
+    pub check_interval: Duration,
+
+    /// Shedding policy per event type
+    pub event_types: HashMap<u16, SheddingPolicy>,
+
+    /// Policy for event types without an entry
+    pub default_policy: SheddingPolicy,
+}
+
+impl Default for OverloadConfig {
+    fn default() -> Self {
+        Self {
+            high_watermark: 0.8,
+            low_watermark: 0.5,
+            max_lag: Duration::from_millis(100),
+            check_interval: Duration::from_millis(100),
+            event_types: HashMap::new(),
+            default_policy: SheddingPolicy::default(),
+        }
+    }
+}
+
+/// How an event type is shed under overload
+#[derive(Debug, Clone, Copy)]
+pub struct SheddingPolicy {
+    /// Detection value; lower values are shed at lower levels
+    pub value: u8,
+
+    /// Fraction of entities kept while the type is shed (0-1)
+    pub keep_ratio: f64,
+}
+
+impl Default for SheddingPolicy {
+    fn default() -> Self {
+        Self {
+            value: 128,
+            keep_ratio: 0.1,
+        }
+    }
+}
+
+/// Signal that drove the shedding level
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum OverloadReason {
+    /// Partition rings filling up
+    QueueDepth,
+    /// Batches waiting too long before delivery
+    ProcessingLag,
+}
+
+/// What has been shed and why
+#[derive(Debug, Clone)]
+pub struct OverloadReport {
+    /// Current shedding level
+    pub level: u8,
+    /// Signal behind the current level; `None` when not shedding
+    pub reason: Option<OverloadReason>,
+    /// Events shed per event type, most shed first
+    pub shed_by_type: Vec<(u16, u64)>,
+    /// Events shed while queue depth drove the level
+    pub shed_for_queue_depth: u64,
+    /// Events shed while processing lag drove the level
+    pub shed_for_processing_lag: u64,
+    /// Number of level changes
+    pub level_changes: u64,
+}
+
+/// Decides which events to admit under overload
+pub struct OverloadController {
+    config: OverloadConfig,
+    level: AtomicU8,
+    /// 0 = none, 1 = queue depth, 2 = processing lag
+    reason: AtomicU8,
+    /// Policy index per event type; 0 is the default policy
+    policy_index: Box<[u32]>,
+    /// The default policy followed by every configured one
+    policies: Box<[SheddingPolicy]>,
+    /// Keep threshold per policy at the current level, out of `KEEP_ALL`
+    keep: Box<[AtomicU32]>,
+    protected: EventTypeSet,
+    shed: Box<[AtomicU64]>,
+    shed_for_depth: AtomicU64,
+    shed_for_lag: AtomicU64,
+    /// Largest batch queue delay since the last evaluation
+    max_lag_ns: AtomicU64,
+    /// Admissions per partition, so publishers to different partitions do
+    /// not contend on one counter
+    admissions: Box<[CachePadded<AtomicU64>]>,
+    last_evaluation: Mutex<Instant>,
+    level_changes: AtomicU64,
+}
+
+impl std::fmt::Debug for OverloadController {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("OverloadController")
+            .field("level", &self.level())
+            .finish()
+    }
+}
+
+impl OverloadController {
+    /// Create a controller for a bus with `partitions` partitions
+    pub fn new(config: OverloadConfig, partitions: usize) -> Self {
+        let slots = u16::MAX as usize + 1;
+        let mut policy_index = vec![0u32; slots];
+        let mut policies = vec![config.default_policy];
+        for (&event_type, &policy) in &config.event_types {
+            policy_index[event_type as usize] = policies.len() as u32;
+            policies.push(policy);
+        }
+
+        Self {
+            config,
+            level: AtomicU8::new(0),
+            reason: AtomicU8::new(0),
+            policy_index: policy_index.into(),
+            keep: policies.iter().map(|_| AtomicU32::new(KEEP_ALL)).collect(),
+            policies: policies.into(),
+            protected: EventTypeSet::new(&[]),
+            shed: (0..slots).map(|_| AtomicU64::new(0)).collect(),
+            shed_for_depth: AtomicU64::new(0),
+            shed_for_lag: AtomicU64::new(0),
+            max_lag_ns: AtomicU64::new(0),
+            admissions: (0..partitions.max(1))
+                .map(|_| CachePadded::default())
+                .collect(),
+            last_evaluation: Mutex::new(Instant::now()),
+            level_changes: AtomicU64::new(0),
+        }
+    }
+
+    /// Current shedding level
+    pub fn level(&self) -> u8 {
+        self.level.load(Ordering::Relaxed)
+    }
+
+    /// Never shed `event_type`
+    pub fn protect(&self, event_type: u16) {
+        self.protected.insert(event_type);
+    }
+
+    /// Shed `event_type` again according to its policy
+    pub fn unprotect(&self, event_type: u16) {
+        self.protected.remove(event_type);
+    }
+
+    /// Whether `event` should be published; counts it if shed
+    pub fn admit(&self, event: &Event) -> bool {
+        let event_type = event.event_type_id;
+        let policy = self.policy_index[event_type as usize] as usize;
+        let keep = self.keep[policy].load(Ordering::Relaxed);
+        if keep >= KEEP_ALL || self.protected.contains(event_type) {
+            return true;
+        }
+        if sample(event.entity_key, event_type) < keep {
+            return true;
+        }
+
+        self.shed[event_type as usize].fetch_add(1, Ordering::Relaxed);
+        match self.reason() {
+            Some(OverloadReason::ProcessingLag) => &self.shed_for_lag,
+            _ => &self.shed_for_depth,
+        }
+        .fetch_add(1, Ordering::Relaxed);
+        false
+    }
+
+    /// Re-evaluate pressure every `EVALUATE_EVERY` admissions to `partition`
+    ///
+    /// `depth_ratio` is only called when an evaluation is due.
+    pub(crate) fn tick(&self, partition: usize, depth_ratio: impl FnOnce() -> f64) {
+        let admissions = &self.admissions[partition % self.admissions.len()];
+        if admissions.fetch_add(1, Ordering::Relaxed) % EVALUATE_EVERY == 0 {
+            self.evaluate(depth_ratio());
+        }
+    }
+
+    /// Note how long a batch waited before delivery
+    pub(crate) fn observe_lag(&self, lag: Duration) {
+        self.max_lag_ns
+            .fetch_max(lag.as_nanos() as u64, Ordering::Relaxed);
+    }
+
+    /// Step the shedding level once per `check_interval` based on pressure
+    ///
+    /// Returns the new level if it changed.
+    pub fn evaluate(&self, depth_ratio: f64) -> Option<u8> {
+        let mut last = self.last_evaluation.try_lock()?;
+        if last.elapsed() < self.config.check_interval {
+            return None;
+        }
+        *last = Instant::now();
+
+        let lag_ns = self.max_lag_ns.swap(0, Ordering::Relaxed);
+        let max_lag_ns = self.config.max_lag.as_nanos().max(1) as f64;
+        let lag_ratio = lag_ns as f64 / max_lag_ns;
+        let (pressure, reason) = if lag_ratio > depth_ratio {
+            (lag_ratio, OverloadReason::ProcessingLag)
+        } else {
+            (depth_ratio, OverloadReason::QueueDepth)
+        };
+
+        let level = self.level();
+        let new_level = if pressure > self.config.high_watermark && level < MAX_SHED_LEVEL {
+            level + 1
+        } else if pressure < self.config.low_watermark && level > 0 {
+            level - 1
+        } else {
+            return None;
+        };
+
+        self.set_level(new_level, reason);
+        if new_level > level {
+            warn!(
+                level = new_level,
+                reason = ?reason,
+                pressure,
+                "Overload: shedding more event types"
+            );
+        } else {
+            info!(
+                level = new_level,
+                pressure, "Overload easing: shedding fewer event types"
+            );
+        }
+        Some(new_level)
+    }
+
+    fn set_level(&self, level: u8, reason: OverloadReason) {
+        let shed_below = level as u32 * VALUE_BAND;
+        for (keep, policy) in self.keep.iter().zip(self.policies.iter()) {
+            let threshold = if (policy.value as u32) < shed_below {
+                (policy.keep_ratio.clamp(0.0, 1.0) * KEEP_ALL as f64) as u32
+            } else {
+                KEEP_ALL
+            };
+            keep.store(threshold, Ordering::Relaxed);
+        }
+
+        let reason = match (level, reason) {
+            (0, _) => 0,
+            (_, OverloadReason::QueueDepth) => 1,
+            (_, OverloadReason::ProcessingLag) => 2,
+        };
+        self.reason.store(reason, Ordering::Relaxed);
+        self.level.store(level, Ordering::Relaxed);
+        self.level_changes.fetch_add(1, Ordering::Relaxed);
+    }
+
+    fn reason(&self) -> Option<OverloadReason> {
+        match self.reason.load(Ordering::Relaxed) {
+            1 => Some(OverloadReason::QueueDepth),
+            2 => Some(OverloadReason::ProcessingLag),
+            _ => None,
+        }
+    }
+
+    /// Total events shed
+    pub fn shed_total(&self) -> u64 {
+        self.shed_for_depth.load(Ordering::Relaxed) + self.shed_for_lag.load(Ordering::Relaxed)
+    }
+
+    pub fn report(&self) -> OverloadReport {
+        let mut shed_by_type: Vec<(u16, u64)> = self
+            .shed
+            .iter()
+            .enumerate()
+            .map(|(event_type, shed)| (event_type as u16, shed.load(Ordering::Relaxed)))
+            .filter(|(_, shed)| *shed > 0)
+            .collect();
+        shed_by_type.sort_by(|a, b| b.1.cmp(&a.1));
+
+        OverloadReport {
+            level: self.level(),
+            reason: self.reason(),
+            shed_by_type,
+            shed_for_queue_depth: self.shed_for_depth.load(Ordering::Relaxed),
+            shed_for_processing_lag: self.shed_for_lag.load(Ordering::Relaxed),
+            level_changes: self.level_changes.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Stable 16-bit sample of an (entity, event type) pair
+fn sample(entity_key: u128, event_type: u16) -> u32 {
+    let mut x = (entity_key as u64) ^ ((entity_key >> 64) as u64) ^ ((event_type as u64) << 48);
+    // splitmix64 finalizer
+    x = (x ^ (x >> 30)).wrapping_mul(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)).wrapping_mul(0x94d049bb133111eb);
+    x ^= x >> 31;
+    (x & 0xffff) as u32
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn event(event_type: u16, entity_key: u128) -> Event {
+        Event::builder()
+            .event_type(event_type)
+            .ts_mono(0)
+            .ts_wall(0)
+            .entity_key(entity_key)
+            .build()
+            .unwrap()
+    }
+
+    fn controller() -> OverloadController {
+        let mut event_types = HashMap::new();
+        // Bulk file events go first, half of the entities are kept
+        event_types.insert(
+            1,
+            SheddingPolicy {
+                value: 10,
+                keep_ratio: 0.5,
+            },
+        );
+        // Exec events are valuable and only shed at the last level
+        event_types.insert(
+            2,
+            SheddingPolicy {
+                value: 250,
+                keep_ratio: 0.0,
+            },
+        );
+        OverloadController::new(
+            OverloadConfig {
+                check_interval: Duration::ZERO,
+                event_types,
+                ..Default::default()
+            },
+            1,
+        )
+    }
+
+    #[test]
+    fn test_levels_shed_low_value_types_first() {
+        let controller = controller();
+        assert_eq!(controller.evaluate(0.9), Some(1));
+
+        let admitted = (0..1000)
+            .filter(|&entity| controller.admit(&event(1, entity)))
+            .count();
+        assert!((400..600).contains(&admitted), "admitted {}", admitted);
+        assert!((0..1000).all(|entity| controller.admit(&event(2, entity))));
+
+        // Sampling is per entity: the same entity is always kept or shed
+        let kept = controller.admit(&event(1, 7));
+        assert!((0..10).all(|_| controller.admit(&event(1, 7)) == kept));
+
+        for level in 2..=MAX_SHED_LEVEL {
+            assert_eq!(controller.evaluate(1.0), Some(level));
+        }
+        assert_eq!(controller.evaluate(1.0), None);
+        assert!(!controller.admit(&event(2, 1)));
+
+        // Protected types pass at any level
+        controller.protect(2);
+        assert!(controller.admit(&event(2, 1)));
+        controller.unprotect(2);
+        assert!(!controller.admit(&event(2, 1)));
+        controller.protect(2);
+
+        let report = controller.report();
+        assert_eq!(report.level, MAX_SHED_LEVEL);
+        assert_eq!(report.reason, Some(OverloadReason::QueueDepth));
+        assert_eq!(report.shed_by_type[0].0, 1);
+        assert_eq!(
+            report.shed_by_type.iter().find(|(t, _)| *t == 2),
+            Some(&(2, 2))
+        );
+        assert_eq!(report.shed_for_queue_depth, controller.shed_total());
+    }
+
+    #[test]
+    fn test_lag_pressure_and_recovery() {
+        let controller = controller();
+        controller.observe_lag(Duration::from_millis(500));
+        assert_eq!(controller.evaluate(0.0), Some(1));
+        assert_eq!(
+            controller.report().reason,
+            Some(OverloadReason::ProcessingLag)
+        );
+
+        // Between the watermarks the level holds; below the low one it eases
+        assert_eq!(controller.evaluate(0.6), None);
+        assert_eq!(controller.evaluate(0.1), Some(0));
+        assert_eq!(controller.report().reason, None);
+        assert!((0..100).all(|entity| controller.admit(&event(1, entity))));
+    }
+}
@@ -0,0 +1,140 @@
+//! Event priority classes
+//!
+//! Event types marked high priority (typically those that blockable rules
+//! inspect) travel through a separate per-partition lane that workers drain
+//! and deliver before their regular batch, so an enforcement decision does
+//! not wait behind a burst of bulk events.
+//!
+//! The lanes are independent queues: a high-priority event may be delivered
+//! before earlier regular events of the same entity.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// Priority class of an event type
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum EventPriority {
+    /// Batched with the bulk of events
+    #[default]
+    Normal,
+    /// Routed through the low-latency lane
+    High,
+}
+
+const WORDS: usize = (u16::MAX as usize + 1) / 64;
+
+/// Lock-free set of event types, cheap to query on the publish path
+pub(crate) struct EventTypeSet {
+    words: Box<[AtomicU64]>,
+}
+
+impl EventTypeSet {
+    pub(crate) fn new(event_types: &[u16]) -> Self {
+        let set = Self {
+            words: (0..WORDS).map(|_| AtomicU64::new(0)).collect(),
+        };
+        for &event_type in event_types {
+            set.insert(event_type);
+        }
+        set
+    }
+
+    pub(crate) fn contains(&self, event_type: u16) -> bool {
+        let (word, bit) = Self::slot(event_type);
+        self.words[word].load(Ordering::Relaxed) & bit != 0
+    }
+
+    pub(crate) fn insert(&self, event_type: u16) {
+        let (word, bit) = Self::slot(event_type);
+        self.words[word].fetch_or(bit, Ordering::Relaxed);
+    }
+
+    pub(crate) fn remove(&self, event_type: u16) {
+        let (word, bit) = Self::slot(event_type);
+        self.words[word].fetch_and(!bit, Ordering::Relaxed);
+    }
+
+    /// Make the set hold exactly `event_types`
+    ///
+    /// Each word is stored once, so types in both the old and the new set
+    /// never read as absent.
+    pub(crate) fn replace(&self, event_types: impl IntoIterator<Item = u16>) {
+        let mut words = vec![0u64; WORDS];
+        for event_type in event_types {
+            let (word, bit) = Self::slot(event_type);
+            words[word] |= bit;
+        }
+        for (slot, word) in self.words.iter().zip(words) {
+            slot.store(word, Ordering::Relaxed);
+        }
+    }
+
+    fn slot(event_type: u16) -> (usize, u64) {
+        (event_type as usize / 64, 1 << (event_type % 64))
+    }
+}
+
+/// Priority of every event type
+pub(crate) struct PriorityClasses {
+    high: EventTypeSet,
+    /// High priority from the configuration, kept across `replace_high`
+    configured: Box<[u16]>,
+}
+
+impl PriorityClasses {
+    pub(crate) fn new(high_priority_event_types: &[u16]) -> Self {
+        Self {
+            high: EventTypeSet::new(high_priority_event_types),
+            configured: high_priority_event_types.into(),
+        }
+    }
+
+    pub(crate) fn get(&self, event_type: u16) -> EventPriority {
+        if self.high.contains(event_type) {
+            EventPriority::High
+        } else {
+            EventPriority::Normal
+        }
+    }
+
+    pub(crate) fn is_high(&self, event_type: u16) -> bool {
+        self.high.contains(event_type)
+    }
+
+    pub(crate) fn set(&self, event_type: u16, priority: EventPriority) {
+        match priority {
+            EventPriority::High => self.high.insert(event_type),
+            EventPriority::Normal => self.high.remove(event_type),
+        }
+    }
+
+    /// Make `event_types` and the configured types the only high ones
+    pub(crate) fn replace_high(&self, event_types: &[u16]) {
+        self.high
+            .replace(self.configured.iter().chain(event_types).copied());
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_priority_classes() {
+        let classes = PriorityClasses::new(&[1, 65535]);
+        assert!(classes.is_high(1));
+        assert!(classes.is_high(65535));
+        assert_eq!(classes.get(2), EventPriority::Normal);
+
+        classes.set(2, EventPriority::High);
+        classes.set(1, EventPriority::Normal);
+        assert!(classes.is_high(2));
+        assert!(!classes.is_high(1));
+
+        // Replacing drops everything but the new and configured types
+        classes.replace_high(&[3]);
+        assert!(classes.is_high(1));
+        assert!(classes.is_high(3));
+        assert!(classes.is_high(65535));
+        assert!(!classes.is_high(2));
+    }
+}
@@ -0,0 +1,515 @@
+//! Sampling per-rule cost profiler
+//!
+//! One in `sample_every` rule evaluations (on average) is measured: wall
+//! time, heap allocations made by the evaluating thread, and the rule's
+//! partial-match memory afterwards. Gaps between samples are randomized so
+//! a fixed rule order cannot alias with the sampling period. Because the
+//! sampling is uniform, a rule's sampled cost times `sample_every`
+//! estimates its total cost.
+//!
+//! Allocations are only counted when the binary installs
+//! `CountingAllocator` as its global allocator; otherwise they read zero.
+//!
+//! Each rule also carries a kill switch. Disabled rules are skipped by the
+//! engine, and a rule whose mean sampled cost exceeds
+//! `max_mean_eval_ns` is disabled automatically. Compiled rules hold their
+//! switch from `kill_switch`, so checking it is a single atomic load.
+
+use parking_lot::{Mutex, RwLock};
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+use std::collections::HashMap;
+use std::fmt::{self, Write};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::Instant;
+use tracing::warn;
+
+thread_local! {
+    /// (allocations, bytes) made by this thread under `CountingAllocator`
+    static THREAD_ALLOCATIONS: Cell<(u64, u64)> = const { Cell::new((0, 0)) };
+
+    /// Evaluations left until the next sample, and the gap generator state
+    static SAMPLE_COUNTDOWN: Cell<(u32, u64)> = const { Cell::new((1, 0)) };
+}
+
+/// Global allocator wrapper that counts allocations per thread
+///
+/// Install with `#[global_allocator]` to attribute allocations to rules.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct CountingAllocator;
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        count_allocation(layout.size());
+        System.alloc(layout)
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        count_allocation(layout.size());
+        System.alloc_zeroed(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        count_allocation(new_size);
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+#[inline]
+fn count_allocation(size: usize) {
+    let _ = THREAD_ALLOCATIONS.try_with(|counts| {
+        let (allocations, bytes) = counts.get();
+        counts.set((allocations + 1, bytes + size as u64));
+    });
+}
+
+/// Allocations and bytes counted on the current thread so far
+pub fn thread_allocations() -> (u64, u64) {
+    THREAD_ALLOCATIONS
+        .try_with(|counts| counts.get())
+        .unwrap_or((0, 0))
+}
+
+/// Profiler configuration
+#[derive(Debug, Clone)]
+pub struct RuleProfilerConfig {
+    /// Mean evaluations per sample (0 disables sampling)
+    pub sample_every: u32,
+
+    /// Mean sampled evaluation time above which a rule is disabled
+    pub max_mean_eval_ns: Option<u64>,
+
+    /// Samples required before the automatic kill switch may trip
+    pub min_samples: u64,
+}
+
+impl Default for RuleProfilerConfig {
+    fn default() -> Self {
+        Self {
+            sample_every: 64,
+            max_mean_eval_ns: None,
+            min_samples: 32,
+        }
+    }
+}
+
+/// Measurement of one sampled evaluation in progress
+#[derive(Debug)]
+pub struct ProfileSample {
+    started: Instant,
+    allocations: (u64, u64),
+}
+
+/// Accumulated cost of one rule
+#[derive(Debug, Default)]
+struct RuleProfile {
+    samples: AtomicU64,
+    cpu_ns: AtomicU64,
+    peak_ns: AtomicU64,
+    allocations: AtomicU64,
+    alloc_bytes: AtomicU64,
+    partial_match_bytes: AtomicU64,
+    /// Kill switch, shared with the compiled rule
+    disabled: Arc<AtomicBool>,
+    /// Why the kill switch is on
+    disabled_reason: Mutex<Option<String>>,
+}
+
+/// Cost report for one rule
+#[derive(Debug, Clone, PartialEq)]
+pub struct RuleCost {
+    pub rule_id: String,
+    /// Sampled evaluations
+    pub samples: u64,
+    /// Mean time per evaluation
+    pub mean_eval_ns: u64,
+    /// Slowest sampled evaluation
+    pub peak_eval_ns: u64,
+    /// Estimated total evaluation time across all evaluations
+    pub estimated_cpu_ns: u64,
+    /// Mean heap allocations per evaluation
+    pub allocations_per_eval: f64,
+    /// Mean bytes allocated per evaluation
+    pub alloc_bytes_per_eval: f64,
+    /// Partial-match memory at the last sample
+    pub partial_match_bytes: u64,
+    /// Why the rule is disabled, if it is
+    pub disabled: Option<String>,
+}
+
+/// Always-on sampling profiler attributing evaluation cost to rules
+#[derive(Debug)]
+pub struct RuleProfiler {
+    config: RuleProfilerConfig,
+    rules: RwLock<HashMap<String, Arc<RuleProfile>>>,
+}
+
+impl RuleProfiler {
+    pub fn new(config: RuleProfilerConfig) -> Self {
+        Self {
+            config,
+            rules: RwLock::new(HashMap::new()),
+        }
+    }
+
+    pub fn config(&self) -> &RuleProfilerConfig {
+        &self.config
+    }
+
+    /// Start measuring an evaluation if it is picked for sampling
+    #[inline]
+    pub fn begin(&self) -> Option<ProfileSample> {
+        if self.config.sample_every == 0 || !self.pick_sample() {
+            return None;
+        }
+        Some(ProfileSample {
+            started: Instant::now(),
+            allocations: thread_allocations(),
+        })
+    }
+
+    fn pick_sample(&self) -> bool {
+        let every = self.config.sample_every as u64;
+        SAMPLE_COUNTDOWN
+            .try_with(|state| {
+                let (left, mut seed) = state.get();
+                if left > 1 {
+                    state.set((left - 1, seed));
+                    return false;
+                }
+                // xorshift64; the gap is uniform in [1, 2 * every - 1]
+                if seed == 0 {
+                    seed = state as *const Cell<(u32, u64)> as usize as u64 | 1;
+                }
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                let gap = 1 + seed % (2 * every - 1);
+                state.set((gap as u32, seed));
+                true
+            })
+            .unwrap_or(false)
+    }
+
+    /// Record a sampled evaluation of `rule_id`
+    ///
+    /// Returns true if the sample tripped the automatic kill switch.
+    pub fn end(&self, rule_id: &str, sample: ProfileSample, partial_match_bytes: usize) -> bool {
+        let elapsed_ns = sample.started.elapsed().as_nanos() as u64;
+        let (allocations, bytes) = thread_allocations();
+
+        let profile = self.profile(rule_id);
+        let samples = profile.samples.fetch_add(1, Ordering::Relaxed) + 1;
+        let cpu_ns = profile.cpu_ns.fetch_add(elapsed_ns, Ordering::Relaxed) + elapsed_ns;
+        profile.peak_ns.fetch_max(elapsed_ns, Ordering::Relaxed);
+        profile.allocations.fetch_add(
+            allocations.saturating_sub(sample.allocations.0),
+            Ordering::Relaxed,
+        );
+        profile.alloc_bytes.fetch_add(
+            bytes.saturating_sub(sample.allocations.1),
+            Ordering::Relaxed,
+        );
+        profile
+            .partial_match_bytes
+            .store(partial_match_bytes as u64, Ordering::Relaxed);
+
+        match self.config.max_mean_eval_ns {
+            Some(limit) if samples >= self.config.min_samples && cpu_ns / samples > limit => {
+                let reason = format!(
+                    "mean evaluation time {}ns over {}ns",
+                    cpu_ns / samples,
+                    limit
+                );
+                if self.set_disabled(&profile, Some(reason.clone())) {
+                    warn!(rule_id, reason = %reason, "Rule disabled by profiler");
+                    return true;
+                }
+                false
+            }
+            _ => false,
+        }
+    }
+
+    fn profile(&self, rule_id: &str) -> Arc<RuleProfile> {
+        if let Some(profile) = self.rules.read().get(rule_id) {
+            return profile.clone();
+        }
+        self.rules
+            .write()
+            .entry(rule_id.to_string())
+            .or_default()
+            .clone()
+    }
+
+    /// The rule's kill switch, on while the rule is disabled
+    ///
+    /// Compiled rules keep this and check it before each evaluation instead
+    /// of calling `is_disabled`.
+    pub fn kill_switch(&self, rule_id: &str) -> Arc<AtomicBool> {
+        self.profile(rule_id).disabled.clone()
+    }
+
+    /// Switch a rule off until `enable` is called
+    pub fn disable(&self, rule_id: &str, reason: impl Into<String>) {
+        let profile = self.profile(rule_id);
+        self.set_disabled(&profile, Some(reason.into()));
+    }
+
+    /// Switch a rule back on
+    pub fn enable(&self, rule_id: &str) {
+        if let Some(profile) = self.rules.read().get(rule_id) {
+            self.set_disabled(profile, None);
+        }
+    }
+
+    /// Returns true if the rule's state changed
+    fn set_disabled(&self, profile: &RuleProfile, reason: Option<String>) -> bool {
+        let mut disabled_reason = profile.disabled_reason.lock();
+        let changed = disabled_reason.is_some() != reason.is_some();
+        profile.disabled.store(reason.is_some(), Ordering::Relaxed);
+        *disabled_reason = reason;
+        changed
+    }
+
+    /// Whether the rule's kill switch is on, looked up by id
+    pub fn is_disabled(&self, rule_id: &str) -> bool {
+        self.rules
+            .read()
+            .get(rule_id)
+            .is_some_and(|profile| profile.disabled.load(Ordering::Relaxed))
+    }
+
+    /// Cost report for one rule
+    pub fn cost(&self, rule_id: &str) -> Option<RuleCost> {
+        let rules = self.rules.read();
+        rules
+            .get(rule_id)
+            .map(|profile| self.report(rule_id, profile))
+    }
+
+    /// The `n` rules with the highest estimated total evaluation time
+    pub fn top(&self, n: usize) -> Vec<RuleCost> {
+        let mut costs: Vec<RuleCost> = self
+            .rules
+            .read()
+            .iter()
+            .map(|(rule_id, profile)| self.report(rule_id, profile))
+            .collect();
+        costs.sort_by(|a, b| {
+            b.estimated_cpu_ns
+                .cmp(&a.estimated_cpu_ns)
+                .then_with(|| a.rule_id.cmp(&b.rule_id))
+        });
+        costs.truncate(n);
+        costs
+    }
+
+    fn report(&self, rule_id: &str, profile: &RuleProfile) -> RuleCost {
+        let samples = profile.samples.load(Ordering::Relaxed);
+        let cpu_ns = profile.cpu_ns.load(Ordering::Relaxed);
+        let per_eval = |total: u64| {
+            if samples == 0 {
+                0.0
+            } else {
+                total as f64 / samples as f64
+            }
+        };
+
+        RuleCost {
+            rule_id: rule_id.to_string(),
+            samples,
+            mean_eval_ns: cpu_ns.checked_div(samples).unwrap_or(0),
+            peak_eval_ns: profile.peak_ns.load(Ordering::Relaxed),
+            estimated_cpu_ns: cpu_ns.saturating_mul(self.config.sample_every.max(1) as u64),
+            allocations_per_eval: per_eval(profile.allocations.load(Ordering::Relaxed)),
+            alloc_bytes_per_eval: per_eval(profile.alloc_bytes.load(Ordering::Relaxed)),
+            partial_match_bytes: profile.partial_match_bytes.load(Ordering::Relaxed),
+            disabled: profile.disabled_reason.lock().clone(),
+        }
+    }
+
+    /// Write the `n` most expensive rules in Prometheus text format
+    pub fn write_prometheus<W: Write>(&self, out: &mut W, n: usize) -> fmt::Result {
+        let top = self.top(n);
+        let series: [(&str, &str, &str, fn(&RuleCost) -> f64); 5] = [
+            (
+                "kestrel_rule_cost_cpu_ns",
+                "counter",
+                "Estimated rule evaluation time (ns)",
+                |cost| cost.estimated_cpu_ns as f64,
+            ),
+            (
+                "kestrel_rule_cost_mean_eval_ns",
+                "gauge",
+                "Mean sampled rule evaluation time (ns)",
+                |cost| cost.mean_eval_ns as f64,
+            ),
+            (
+                "kestrel_rule_cost_alloc_bytes_per_eval",
+                "gauge",
+                "Mean bytes allocated per rule evaluation",
+                |cost| cost.alloc_bytes_per_eval,
+            ),
+            (
+                "kestrel_rule_cost_partial_match_bytes",
+                "gauge",
+                "Partial-match memory held by the rule",
+                |cost| cost.partial_match_bytes as f64,
+            ),
+            (
+                "kestrel_rule_disabled",
+                "gauge",
+                "Whether the rule kill switch is on",
+                |cost| cost.disabled.is_some() as u8 as f64,
+            ),
+        ];
+
+        for (name, kind, help, value) in series {
+            writeln!(out, "# HELP {} {}", name, help)?;
+            writeln!(out, "# TYPE {} {}", name, kind)?;
+            for cost in &top {
+                writeln!(
+                    out,
+                    "{}{{rule_id=\"{}\"}} {}",
+                    name,
+                    cost.rule_id,
+                    value(cost)
+                )?;
+            }
+        }
+        Ok(())
+    }
+
+    /// Write a plain-text table of the `n` most expensive rules
+    pub fn write_report<W: Write>(&self, out: &mut W, n: usize) -> fmt::Result {
+        writeln!(
+            out,
+            "{:<32} {:>10} {:>12} {:>12} {:>14} {:>12}  status",
+            "rule", "samples", "mean_ns", "peak_ns", "alloc_B/eval", "pm_bytes"
+        )?;
+        for cost in self.top(n) {
+            writeln!(
+                out,
+                "{:<32} {:>10} {:>12} {:>12} {:>14.1} {:>12}  {}",
+                cost.rule_id,
+                cost.samples,
+                cost.mean_eval_ns,
+                cost.peak_eval_ns,
+                cost.alloc_bytes_per_eval,
+                cost.partial_match_bytes,
+                cost.disabled.as_deref().unwrap_or("active")
+            )?;
+        }
+        Ok(())
+    }
+}
+
+impl Default for RuleProfiler {
+    fn default() -> Self {
+        Self::new(RuleProfilerConfig::default())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::time::Duration;
+
+    fn always_sample() -> RuleProfiler {
+        RuleProfiler::new(RuleProfilerConfig {
+            sample_every: 1,
+            ..Default::default()
+        })
+    }
+
+    #[test]
+    fn test_sampling_rate() {
+        let profiler = RuleProfiler::new(RuleProfilerConfig {
+            sample_every: 16,
+            ..Default::default()
+        });
+        let sampled = (0..16_000).filter(|_| profiler.begin().is_some()).count();
+        assert!((800..1200).contains(&sampled), "sampled {}", sampled);
+
+        let off = RuleProfiler::new(RuleProfilerConfig {
+            sample_every: 0,
+            ..Default::default()
+        });
+        assert!(off.begin().is_none());
+    }
+
+    #[test]
+    fn test_top_rules_by_cost() {
+        let profiler = always_sample();
+        for _ in 0..3 {
+            let sample = profiler.begin().unwrap();
+            std::thread::sleep(Duration::from_millis(2));
+            profiler.end("slow", sample, 512);
+
+            let sample = profiler.begin().unwrap();
+            profiler.end("fast", sample, 0);
+        }
+
+        let top = profiler.top(1);
+        assert_eq!(top.len(), 1);
+        assert_eq!(top[0].rule_id, "slow");
+        assert_eq!(top[0].samples, 3);
+        assert!(top[0].mean_eval_ns >= 2_000_000);
+        assert_eq!(top[0].partial_match_bytes, 512);
+        assert_eq!(profiler.top(10).len(), 2);
+
+        let mut report = String::new();
+        profiler.write_report(&mut report, 10).unwrap();
+        assert!(report.lines().nth(1).unwrap().starts_with("slow"));
+
+        let mut prometheus = String::new();
+        profiler.write_prometheus(&mut prometheus, 10).unwrap();
+        assert!(prometheus.contains("kestrel_rule_cost_partial_match_bytes{rule_id=\"slow\"} 512"));
+        assert!(prometheus.contains("kestrel_rule_disabled{rule_id=\"fast\"} 0"));
+    }
+
+    #[test]
+    fn test_kill_switch() {
+        let profiler = always_sample();
+        let switch = profiler.kill_switch("rule");
+        assert!(!profiler.is_disabled("rule"));
+
+        profiler.disable("rule", "operator request");
+        assert!(profiler.is_disabled("rule"));
+        assert!(switch.load(Ordering::Relaxed));
+        assert!(!profiler.is_disabled("other"));
+        assert_eq!(
+            profiler.cost("rule").unwrap().disabled.as_deref(),
+            Some("operator request")
+        );
+
+        profiler.enable("rule");
+        assert!(!profiler.is_disabled("rule"));
+        assert!(!switch.load(Ordering::Relaxed));
+    }
+
+    #[test]
+    fn test_automatic_kill_switch() {
+        let profiler = RuleProfiler::new(RuleProfilerConfig {
+            sample_every: 1,
+            max_mean_eval_ns: Some(100_000),
+            min_samples: 2,
+        });
+
+        let sample = profiler.begin().unwrap();
+        std::thread::sleep(Duration::from_millis(1));
+        assert!(!profiler.end("pathological", sample, 0));
+        assert!(!profiler.is_disabled("pathological"));
+
+        let sample = profiler.begin().unwrap();
+        std::thread::sleep(Duration::from_millis(1));
+        assert!(profiler.end("pathological", sample, 0));
+        assert!(profiler.is_disabled("pathological"));
+    }
+}
@@ -0,0 +1,600 @@
+//! Skew-aware partition rebalancing
+//!
+//! With rebalancing enabled, events are routed by entity key through a table
+//! of buckets (`entity_key % buckets`), each owned by one partition. The
+//! initial layout matches `PartitionStrategy::EntityKey`. Workers count the
+//! events of every bucket they handle, and a rebalancer periodically moves
+//! hot buckets from the busiest partition to the idlest one.
+//!
+//! Moving bucket `b` from partition A to partition B:
+//!
+//! 1. The rebalancer points `b` at B, so new events for `b` enter B's ring,
+//!    and tells A to release `b`.
+//! 2. A waits for publishers that looked up A to finish their push, delivers
+//!    everything queued in its ring, exports the state of `b` from its
+//!    `PartitionHandler` and sends it to B.
+//! 3. Until the state arrives, B parks the events of `b`. It then imports
+//!    the state and delivers the parked events ahead of newer ones.
+//!
+//! Publishers hold a bucket gate from the owner lookup until their push
+//! completes, so once A has waited no event for `b` can still reach it and
+//! every event of an entity is delivered in publish order. Publishers never
+//! hold a gate while waiting for ring space; they release it and look the
+//! owner up again.
+
+use crate::eventbus::{EventBusMetrics, Partitioner};
+use crate::ring::CachePadded;
+use kestrel_event::Event;
+use std::any::Any;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use tokio::sync::mpsc;
+use tracing::{debug, info};
+
+/// State of an entity range handed from one partition to another
+pub type PartitionState = Box<dyn Any + Send>;
+
+/// Rebalancing configuration
+#[derive(Debug, Clone)]
+pub struct RebalanceConfig {
+    /// How often partition loads are compared
+    pub interval: Duration,
+
+    /// Routing buckets per partition; more buckets allow finer moves
+    pub buckets_per_partition: usize,
+
+    /// Rebalance when the busiest partition exceeds the mean load by this factor
+    pub skew_threshold: f64,
+
+    /// Maximum buckets moved per round
+    pub max_moves_per_round: usize,
+
+    /// Skip rounds that saw fewer events than this across all partitions
+    pub min_events_per_round: u64,
+}
+
+impl Default for RebalanceConfig {
+    fn default() -> Self {
+        Self {
+            interval: Duration::from_secs(1),
+            buckets_per_partition: 64,
+            skew_threshold: 1.5,
+            max_moves_per_round: 4,
+            min_events_per_round: 1000,
+        }
+    }
+}
+
+/// Entities whose state moves between partitions together
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EntityRange {
+    bucket: usize,
+    buckets: usize,
+}
+
+impl EntityRange {
+    /// Routing bucket of this range
+    pub fn bucket(&self) -> usize {
+        self.bucket
+    }
+
+    /// Whether `entity_key` belongs to this range
+    pub fn contains(&self, entity_key: u128) -> bool {
+        bucket_of(entity_key, self.buckets) == self.bucket
+    }
+}
+
+fn bucket_of(entity_key: u128, buckets: usize) -> usize {
+    (entity_key % buckets as u128) as usize
+}
+
+/// Bucket ownership shared by publishers, workers and the rebalancer
+pub(crate) struct RoutingTable {
+    owners: Box<[AtomicUsize]>,
+    /// Events handled per bucket since the last round
+    loads: Box<[AtomicU64]>,
+    /// Buckets whose handover has not completed yet
+    migrating: Box<[AtomicBool]>,
+    gates: Box<[CachePadded<BucketGate>]>,
+}
+
+/// Publishers routing through a bucket, counted per owner generation
+///
+/// A move bumps `generation` after changing the owner, and the old owner
+/// waits for the previous generation's count to reach zero. A publisher
+/// only keeps its count if the generation did not change while it counted
+/// itself, so it is always counted in the slot the next move waits on. One
+/// that counted itself in the old generation may have seen the old owner;
+/// any later one is guaranteed to see the new owner.
+#[derive(Default)]
+struct BucketGate {
+    generation: AtomicUsize,
+    publishers: [AtomicUsize; 2],
+}
+
+/// Keeps a bucket from changing owner until the routed event is pushed
+pub(crate) struct RouteGuard<'a>(&'a AtomicUsize);
+
+impl Drop for RouteGuard<'_> {
+    fn drop(&mut self) {
+        self.0.fetch_sub(1, Ordering::Release);
+    }
+}
+
+impl RoutingTable {
+    fn new(partitions: usize, buckets_per_partition: usize) -> Self {
+        let buckets = partitions * buckets_per_partition.max(1);
+        Self {
+            owners: (0..buckets)
+                .map(|b| AtomicUsize::new(b % partitions))
+                .collect(),
+            loads: (0..buckets).map(|_| AtomicU64::new(0)).collect(),
+            migrating: (0..buckets).map(|_| AtomicBool::new(false)).collect(),
+            gates: (0..buckets).map(|_| CachePadded::default()).collect(),
+        }
+    }
+
+    /// Owner of `entity_key`'s bucket, fixed while the guard is held
+    pub(crate) fn enter(&self, entity_key: u128) -> (usize, RouteGuard<'_>) {
+        let bucket = self.bucket(entity_key);
+        let gate = &self.gates[bucket];
+        loop {
+            let generation = gate.generation.load(Ordering::SeqCst);
+            let publishers = &gate.publishers[generation & 1];
+            publishers.fetch_add(1, Ordering::SeqCst);
+            // A move in between may already have checked this slot
+            if gate.generation.load(Ordering::SeqCst) != generation {
+                publishers.fetch_sub(1, Ordering::SeqCst);
+                continue;
+            }
+            let owner = self.owners[bucket].load(Ordering::SeqCst);
+            return (owner, RouteGuard(publishers));
+        }
+    }
+
+    /// Point `bucket` at `to`, returning the generation that saw the old owner
+    fn set_owner(&self, bucket: usize, to: usize) -> usize {
+        self.owners[bucket].store(to, Ordering::SeqCst);
+        self.gates[bucket].generation.fetch_add(1, Ordering::SeqCst)
+    }
+
+    /// Whether publishers of `bucket`'s `generation` have all pushed
+    fn drained(&self, bucket: usize, generation: usize) -> bool {
+        self.gates[bucket].publishers[generation & 1].load(Ordering::SeqCst) == 0
+    }
+
+    fn bucket(&self, entity_key: u128) -> usize {
+        bucket_of(entity_key, self.owners.len())
+    }
+
+    fn owner(&self, bucket: usize) -> usize {
+        self.owners[bucket].load(Ordering::Acquire)
+    }
+
+    fn range(&self, bucket: usize) -> EntityRange {
+        EntityRange {
+            bucket,
+            buckets: self.owners.len(),
+        }
+    }
+}
+
+impl Partitioner for RoutingTable {
+    fn partition(&self, event: &Event, _partition_count: usize) -> usize {
+        self.owner(self.bucket(event.entity_key))
+    }
+}
+
+/// A bucket moving between partitions
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) struct Move {
+    pub(crate) bucket: usize,
+    pub(crate) from: usize,
+    pub(crate) to: usize,
+}
+
+/// Pick bucket moves that flatten per-partition load
+///
+/// Repeatedly moves a bucket from the busiest to the idlest partition while
+/// the busiest exceeds the mean by `skew_threshold`. The chosen bucket is
+/// the one that best halves the gap between the two; a bucket carrying more
+/// than the whole gap (a single hot entity) is never moved, since that would
+/// only swap which partition is overloaded.
+pub(crate) fn plan_moves(
+    owners: &[usize],
+    loads: &[u64],
+    movable: &[bool],
+    partitions: usize,
+    config: &RebalanceConfig,
+) -> Vec<Move> {
+    let mut partition_loads = vec![0u64; partitions];
+    for (bucket, &load) in loads.iter().enumerate() {
+        partition_loads[owners[bucket]] += load;
+    }
+    let total: u64 = partition_loads.iter().sum();
+    if partitions < 2 || total == 0 || total < config.min_events_per_round {
+        return Vec::new();
+    }
+
+    let mean = total as f64 / partitions as f64;
+    let mut owners = owners.to_vec();
+    let mut moved = vec![false; loads.len()];
+    let mut moves = Vec::new();
+
+    while moves.len() < config.max_moves_per_round {
+        let hot = (0..partitions)
+            .max_by_key(|&p| partition_loads[p])
+            .unwrap_or(0);
+        let cold = (0..partitions)
+            .min_by_key(|&p| partition_loads[p])
+            .unwrap_or(0);
+        if partition_loads[hot] as f64 <= mean * config.skew_threshold {
+            break;
+        }
+
+        // Moving load `l` leaves max(hot - l, cold + l), better while l < gap
+        let gap = partition_loads[hot] - partition_loads[cold];
+        let best = (0..loads.len())
+            .filter(|&b| owners[b] == hot && movable[b] && !moved[b])
+            .filter(|&b| loads[b] > 0 && loads[b] < gap)
+            .min_by_key(|&b| (2 * loads[b]).abs_diff(gap));
+        let Some(bucket) = best else {
+            break;
+        };
+
+        owners[bucket] = cold;
+        moved[bucket] = true;
+        partition_loads[hot] -= loads[bucket];
+        partition_loads[cold] += loads[bucket];
+        moves.push(Move {
+            bucket,
+            from: hot,
+            to: cold,
+        });
+    }
+
+    moves
+}
+
+/// Messages from the rebalancer and other partitions to a worker
+pub(crate) enum Control {
+    /// Hand `bucket` to partition `to` once queued events are delivered
+    Release {
+        bucket: usize,
+        to: usize,
+        /// Owner generation of publishers that may still push here
+        generation: usize,
+        started: Instant,
+    },
+    /// Ownership and state of `bucket` from its previous owner
+    Adopt {
+        bucket: usize,
+        state: Option<PartitionState>,
+        started: Instant,
+    },
+}
+
+/// Moves hot buckets between partitions
+pub(crate) struct Rebalancer {
+    table: Arc<RoutingTable>,
+    peers: Arc<[mpsc::UnboundedSender<Control>]>,
+    config: RebalanceConfig,
+    metrics: Arc<EventBusMetrics>,
+}
+
+impl Rebalancer {
+    /// Create the routing table and the routing view of each partition
+    pub(crate) fn new(
+        partitions: usize,
+        config: RebalanceConfig,
+        metrics: Arc<EventBusMetrics>,
+    ) -> (Self, Vec<PartitionRouting>) {
+        let table = Arc::new(RoutingTable::new(partitions, config.buckets_per_partition));
+        let (peers, receivers): (Vec<_>, Vec<_>) =
+            (0..partitions).map(|_| mpsc::unbounded_channel()).unzip();
+        let peers: Arc<[_]> = peers.into();
+
+        let routings = receivers
+            .into_iter()
+            .enumerate()
+            .map(|(partition_id, control)| PartitionRouting {
+                partition_id,
+                table: table.clone(),
+                owned: (0..table.owners.len())
+                    .map(|b| table.owner(b) == partition_id)
+                    .collect(),
+                parked: HashMap::new(),
+                control,
+                peers: peers.clone(),
+                metrics: metrics.clone(),
+            })
+            .collect();
+
+        let rebalancer = Self {
+            table,
+            peers,
+            config,
+            metrics,
+        };
+        (rebalancer, routings)
+    }
+
+    pub(crate) fn partitioner(&self) -> Arc<dyn Partitioner> {
+        self.table.clone()
+    }
+
+    pub(crate) fn routes(&self) -> Arc<RoutingTable> {
+        self.table.clone()
+    }
+
+    /// Run one round over the loads seen since the previous round
+    ///
+    /// Does not wait for the moves; each old owner completes its handover
+    /// on its own worker.
+    pub(crate) fn rebalance(&self) -> Vec<Move> {
+        let table = &self.table;
+        let loads: Vec<u64> = table
+            .loads
+            .iter()
+            .map(|l| l.swap(0, Ordering::Relaxed))
+            .collect();
+        let owners: Vec<usize> = (0..table.owners.len()).map(|b| table.owner(b)).collect();
+        let movable: Vec<bool> = table
+            .migrating
+            .iter()
+            .map(|m| !m.load(Ordering::Acquire))
+            .collect();
+
+        let moves = plan_moves(&owners, &loads, &movable, self.peers.len(), &self.config);
+        self.metrics
+            .rebalance_rounds
+            .fetch_add(1, Ordering::Relaxed);
+
+        for m in &moves {
+            table.migrating[m.bucket].store(true, Ordering::Release);
+            let generation = table.set_owner(m.bucket, m.to);
+            let release = Control::Release {
+                bucket: m.bucket,
+                to: m.to,
+                generation,
+                started: Instant::now(),
+            };
+            if self.peers[m.from].send(release).is_err() {
+                // The worker has exited; there is no state left to hand over
+                table.migrating[m.bucket].store(false, Ordering::Release);
+                continue;
+            }
+            self.metrics.migrations.fetch_add(1, Ordering::Relaxed);
+            debug!(
+                bucket = m.bucket,
+                from = m.from,
+                to = m.to,
+                load = loads[m.bucket],
+                "Moving hot bucket"
+            );
+        }
+
+        if !moves.is_empty() {
+            info!(moves = moves.len(), "Rebalanced EventBus partitions");
+        }
+        moves
+    }
+
+    /// Run rounds every `interval` on a background thread until `shutdown`
+    pub(crate) fn spawn(
+        self: Arc<Self>,
+        shutdown: Arc<AtomicBool>,
+    ) -> std::io::Result<std::thread::JoinHandle<()>> {
+        let tick = self.config.interval.min(Duration::from_millis(50));
+
+        std::thread::Builder::new()
+            .name("kestrel-rebalance".to_string())
+            .spawn(move || loop {
+                let round_start = Instant::now();
+                while round_start.elapsed() < self.config.interval {
+                    if shutdown.load(Ordering::Relaxed) {
+                        return;
+                    }
+                    std::thread::sleep(tick);
+                }
+                self.rebalance();
+            })
+    }
+}
+
+/// A worker's view of bucket ownership
+///
+/// The worker owns a bucket from the moment it adopts the bucket's state
+/// until it releases it; the routing table may point elsewhere in between.
+pub(crate) struct PartitionRouting {
+    partition_id: usize,
+    table: Arc<RoutingTable>,
+    owned: Vec<bool>,
+    /// Events of buckets routed here whose state has not arrived yet
+    parked: HashMap<usize, Vec<Event>>,
+    control: mpsc::UnboundedReceiver<Control>,
+    peers: Arc<[mpsc::UnboundedSender<Control>]>,
+    metrics: Arc<EventBusMetrics>,
+}
+
+impl PartitionRouting {
+    /// Wait for the next control message
+    pub(crate) async fn next_control(&mut self) -> Control {
+        match self.control.recv().await {
+            Some(control) => control,
+            None => std::future::pending().await,
+        }
+    }
+
+    /// Keep the events in `batch[start..]` this partition owns
+    ///
+    /// Events of buckets being handed to this partition are parked. The
+    /// bucket gates ensure no event arrives for a bucket after its release.
+    pub(crate) fn filter(&mut self, batch: &mut Vec<Event>, start: usize) {
+        let mut foreign = false;
+        for event in &batch[start..] {
+            let bucket = self.table.bucket(event.entity_key);
+            if self.owned[bucket] {
+                self.table.loads[bucket].fetch_add(1, Ordering::Relaxed);
+            } else {
+                foreign = true;
+            }
+        }
+        if !foreign {
+            return;
+        }
+
+        for event in batch.split_off(start) {
+            let bucket = self.table.bucket(event.entity_key);
+            if self.owned[bucket] {
+                batch.push(event);
+                continue;
+            }
+
+            debug_assert_eq!(self.table.owner(bucket), self.partition_id);
+            self.table.loads[bucket].fetch_add(1, Ordering::Relaxed);
+            self.metrics
+                .migration_parked_events
+                .fetch_add(1, Ordering::Relaxed);
+            self.parked.entry(bucket).or_default().push(event);
+        }
+    }
+
+    pub(crate) fn range(&self, bucket: usize) -> EntityRange {
+        self.table.range(bucket)
+    }
+
+    /// Wait for publishers that routed `bucket` here before it moved
+    ///
+    /// Publishers hold the gate only between the owner lookup and a push
+    /// that does not wait, so this is a short spin.
+    pub(crate) async fn wait_publishers(&self, bucket: usize, generation: usize) {
+        while !self.table.drained(bucket, generation) {
+            tokio::task::yield_now().await;
+        }
+    }
+
+    /// Stop owning `bucket` and send its state to partition `to`
+    pub(crate) fn release(
+        &mut self,
+        bucket: usize,
+        to: usize,
+        state: Option<PartitionState>,
+        started: Instant,
+    ) {
+        self.owned[bucket] = false;
+        let _ = self.peers[to].send(Control::Adopt {
+            bucket,
+            state,
+            started,
+        });
+    }
+
+    /// Take ownership of `bucket` and return the events parked for it
+    pub(crate) fn adopt(&mut self, bucket: usize, started: Instant) -> Vec<Event> {
+        self.owned[bucket] = true;
+        self.table.migrating[bucket].store(false, Ordering::Release);
+        self.metrics
+            .migration_ns
+            .record(started.elapsed().as_nanos() as u64);
+        self.parked.remove(&bucket).unwrap_or_default()
+    }
+
+    /// Events still parked for buckets whose state never arrived
+    pub(crate) fn take_parked(&mut self) -> Vec<Event> {
+        self.parked.drain().flat_map(|(_, events)| events).collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn config() -> RebalanceConfig {
+        RebalanceConfig {
+            skew_threshold: 1.2,
+            min_events_per_round: 10,
+            ..Default::default()
+        }
+    }
+
+    #[test]
+    fn test_plan_moves_spreads_hot_buckets() {
+        // Buckets 0 and 2 on partition 0 are hot, partition 1 is idle
+        let owners = [0, 1, 0, 1];
+        let loads = [500, 10, 400, 10];
+        let moves = plan_moves(&owners, &loads, &[true; 4], 2, &config());
+        assert_eq!(
+            moves,
+            vec![Move {
+                bucket: 2,
+                from: 0,
+                to: 1
+            }]
+        );
+    }
+
+    #[test]
+    fn test_plan_moves_keeps_single_hot_entity() {
+        // Moving the only hot bucket would just overload partition 1
+        let owners = [0, 1, 0, 1];
+        let loads = [1000, 10, 0, 10];
+        assert!(plan_moves(&owners, &loads, &[true; 4], 2, &config()).is_empty());
+
+        // Balanced or quiet partitions are left alone
+        assert!(plan_moves(&owners, &[50, 50, 50, 50], &[true; 4], 2, &config()).is_empty());
+        assert!(plan_moves(&owners, &[5, 0, 3, 0], &[true; 4], 2, &config()).is_empty());
+    }
+
+    #[test]
+    fn test_plan_moves_skips_migrating_buckets() {
+        let owners = [0, 1, 0, 1];
+        let loads = [500, 10, 400, 10];
+        let movable = [true, true, false, true];
+        let moves = plan_moves(&owners, &loads, &movable, 2, &config());
+        assert_eq!(
+            moves,
+            vec![Move {
+                bucket: 0,
+                from: 0,
+                to: 1
+            }]
+        );
+    }
+
+    #[test]
+    fn test_entity_range() {
+        let table = RoutingTable::new(2, 4);
+        let range = table.range(3);
+        assert!(range.contains(3));
+        assert!(range.contains(11));
+        assert!(!range.contains(4));
+        assert_eq!(table.owner(3), 1);
+    }
+
+    #[test]
+    fn test_move_waits_for_routed_publishers() {
+        let table = RoutingTable::new(2, 4);
+        let (owner, guard) = table.enter(3);
+        assert_eq!(owner, 1);
+
+        let generation = table.set_owner(3, 0);
+        assert!(!table.drained(3, generation));
+
+        // Publishers arriving after the move see the new owner and do not
+        // hold it up; the one that saw the old owner does
+        let (owner, late) = table.enter(11);
+        assert_eq!(owner, 0);
+        assert!(!table.drained(3, generation));
+        drop(guard);
+        assert!(table.drained(3, generation));
+
+        // The next move waits on the publisher that saw this one's owner
+        let next = table.set_owner(3, 1);
+        assert!(!table.drained(3, next));
+        drop(late);
+        assert!(table.drained(3, next));
+    }
+}
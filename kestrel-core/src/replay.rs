@@ -7,14 +7,19 @@
 //! - Validating engine behavior with known inputs
 //! - Time travel debugging
 
-use crate::{EventBus, TimeManager};
+use crate::alert::Alert;
+use crate::binlog::{self, LogFile, LogMeta, LogReader, LogWriter, LogWriterConfig};
+use crate::eventbus::PublishError;
+use crate::{EventBus, EventBusConfig, EventBusHandle, PartitionHandler, TimeManager};
 use kestrel_event::Event;
 use kestrel_schema::SchemaRegistry;
 use serde::{Deserialize, Serialize};
+use std::collections::{BTreeMap, HashMap};
 use std::fs::File;
 use std::io::{BufReader, BufWriter, Write};
 use std::path::PathBuf;
 use std::sync::Arc;
+use std::time::{Duration, Instant};
 use thiserror::Error;
 
 use tracing::{debug, error, info, warn};
@@ -157,22 +162,61 @@ impl From<kestrel_schema::TypedValue> for SerializedValue {
 
 /// Binary log format for offline replay
 ///
-/// Stores events in a JSON-based format for compatibility and debugging.
-/// In production, would use more efficient binary serialization.
+/// Writes the block-compressed format of `crate::binlog`. JSON lines (one
+/// header line, then one line per event) remain available as an export
+/// format for debugging, and `read_events` accepts either.
 pub struct BinaryLog {
     /// Schema registry for type information (reserved for future use)
     #[allow(dead_code)]
     schema: Arc<SchemaRegistry>,
+    writer_config: LogWriterConfig,
 }
 
 impl BinaryLog {
     /// Create a new binary log instance
     pub fn new(schema: Arc<SchemaRegistry>) -> Self {
-        Self { schema }
+        Self {
+            schema,
+            writer_config: LogWriterConfig::default(),
+        }
+    }
+
+    /// Use `config` for block size and compression when writing
+    pub fn with_writer_config(mut self, config: LogWriterConfig) -> Self {
+        self.writer_config = config;
+        self
     }
 
     /// Write events to log file
-    pub fn write_events(&self, path: PathBuf, events: &[Event], rule_pack_hash: String) -> Result<(), ReplayError> {
+    pub fn write_events(
+        &self,
+        path: PathBuf,
+        events: &[Event],
+        rule_pack_hash: String,
+    ) -> Result<(), ReplayError> {
+        let meta = LogMeta::new(rule_pack_hash);
+        let mut writer = LogWriter::create(&path, &meta, self.writer_config.clone())?;
+        for event in events {
+            writer.append(event)?;
+        }
+
+        let file = writer
+            .finish()?
+            .into_inner()
+            .map_err(|e| ReplayError::Io(e.into_error()))?;
+        file.sync_all()?;
+
+        info!(path = %path.display(), count = events.len(), "Wrote event log");
+        Ok(())
+    }
+
+    /// Write events as JSON lines, for inspection and external tools
+    pub fn write_events_json(
+        &self,
+        path: PathBuf,
+        events: &[Event],
+        rule_pack_hash: String,
+    ) -> Result<(), ReplayError> {
         if events.is_empty() {
             // Create empty file with header only
             let file = File::create(&path)?;
@@ -242,12 +286,52 @@ impl BinaryLog {
             file.sync_all()?;
         }
 
-        info!(path = %path.display(), count = events.len(), "Wrote event log");
+        info!(path = %path.display(), count = events.len(), "Wrote JSON event log");
         Ok(())
     }
 
-    /// Read events from log file
+    /// Convert a binary log to JSON lines; returns the number of events
+    pub fn export_json(&self, log_path: PathBuf, json_path: PathBuf) -> Result<usize, ReplayError> {
+        let reader = LogReader::new(std::fs::read(&log_path)?)?;
+        let events = Self::read_blocks(&reader)?;
+        self.write_events_json(json_path, &events, reader.meta().rule_pack_hash.clone())?;
+        Ok(events.len())
+    }
+
+    /// Read events from a binary or JSON lines log file
     pub fn read_events(&self, path: PathBuf) -> Result<Vec<Event>, ReplayError> {
+        let mut magic = [0u8; 4];
+        let is_binary = {
+            use std::io::Read;
+            let mut file = File::open(&path)?;
+            file.read_exact(&mut magic).is_ok() && binlog::is_binary_log(&magic)
+        };
+        if !is_binary {
+            return self.read_events_json(path);
+        }
+
+        let reader = LogReader::new(std::fs::read(&path)?)?;
+        if reader.meta().schema_version != 1 {
+            warn!(
+                log_version = reader.meta().schema_version,
+                "Schema version mismatch, may have compatibility issues"
+            );
+        }
+
+        let events = Self::read_blocks(&reader)?;
+        info!(path = %path.display(), count = events.len(), "Read event log");
+        Ok(events)
+    }
+
+    fn read_blocks(reader: &LogReader<Vec<u8>>) -> Result<Vec<Event>, ReplayError> {
+        let mut events = Vec::with_capacity(reader.event_count() as usize);
+        for block in 0..reader.blocks().len() {
+            events.extend(reader.read_block(block)?);
+        }
+        Ok(events)
+    }
+
+    fn read_events_json(&self, path: PathBuf) -> Result<Vec<Event>, ReplayError> {
         let file = File::open(&path)?;
         let reader = BufReader::new(file);
 
@@ -307,7 +391,7 @@ impl BinaryLog {
             events.push(event);
         }
 
-        info!(path = %path.display(), count = events.len(), "Read event log");
+        info!(path = %path.display(), count = events.len(), "Read JSON event log");
         Ok(events)
     }
 }
@@ -341,6 +425,16 @@ pub struct ReplayConfig {
 
     /// Number of verification runs
     pub verification_runs: usize,
+
+    /// Replay as fast as the bus accepts events: no sleeps, events
+    /// published in batches and mock time advanced once per batch
+    pub unthrottled: bool,
+
+    /// Events per published batch in unthrottled mode
+    pub batch_size: usize,
+
+    /// How long an unthrottled replay waits for the bus to drain
+    pub drain_timeout: Duration,
 }
 
 impl Default for ReplayConfig {
@@ -355,6 +449,9 @@ impl Default for ReplayConfig {
             record_for_verification: false,
             seed: None,
             verification_runs: 3,
+            unthrottled: false,
+            batch_size: 4096,
+            drain_timeout: Duration::from_secs(30),
         }
     }
 }
@@ -371,6 +468,9 @@ pub struct ReplaySource {
 
     /// Next event ID to assign
     next_event_id: u64,
+
+    /// Throughput of the last unthrottled replay
+    throughput: Option<ReplayThroughput>,
 }
 
 impl ReplaySource {
@@ -385,39 +485,64 @@ impl ReplaySource {
             schema,
             time_manager,
             next_event_id: 1,
+            throughput: None,
         }
     }
 
     /// Start replaying events to EventBus
+    ///
+    /// Binary logs are memory-mapped and streamed in timestamp order, so
+    /// the first event is published right away and memory use does not
+    /// grow with the log. JSON logs are loaded and sorted up front.
     pub async fn start(&mut self, event_bus: &EventBus) -> Result<usize, ReplayError> {
         info!(path = %self.config.log_path.display(), "Starting replay");
 
-        let binary_log = BinaryLog::new(self.schema.clone());
-        let mut events = binary_log.read_events(self.config.log_path.clone())?;
+        let log = LogFile::open(&self.config.log_path)?;
+        let reader = if binlog::is_binary_log(log.as_ref()) {
+            Some(LogReader::new(log)?)
+        } else {
+            None
+        };
 
-        if events.is_empty() {
-            warn!("No events to replay");
-            return Ok(0);
-        }
+        let mut events: Box<dyn Iterator<Item = Result<Event, ReplayError>> + Send + '_> =
+            match &reader {
+                Some(reader) => Box::new(reader.merged_events()),
+                None => {
+                    let binary_log = BinaryLog::new(self.schema.clone());
+                    let mut events = binary_log.read_events(self.config.log_path.clone())?;
+
+                    // Sort events for deterministic replay: (ts_mono_ns, event_id)
+                    events.sort_by(|a, b| {
+                        a.ts_mono_ns
+                            .cmp(&b.ts_mono_ns)
+                            .then_with(|| a.event_id.cmp(&b.event_id))
+                    });
+                    Box::new(events.into_iter().map(Ok))
+                }
+            };
 
-        // Sort events for deterministic replay: (ts_mono_ns, event_id)
-        events.sort_by(|a, b| {
-            a.ts_mono_ns
-                .cmp(&b.ts_mono_ns)
-                .then_with(|| a.event_id.cmp(&b.event_id))
-        });
+        let mut events = match events.next().transpose()? {
+            Some(first_event) => {
+                // Set mock time to first event's timestamp
+                self.time_manager
+                    .provider()
+                    .set_time(first_event.ts_mono_ns, first_event.ts_wall_ns);
+                std::iter::once(Ok(first_event)).chain(events)
+            }
+            None => {
+                warn!("No events to replay");
+                return Ok(0);
+            }
+        };
 
-        // Set mock time to first event's timestamp
-        if let Some(first_event) = events.first() {
-            self.time_manager
-                .provider()
-                .set_time(first_event.ts_mono_ns, first_event.ts_wall_ns);
+        if self.config.unthrottled {
+            return self.publish_unthrottled(event_bus, events).await;
         }
 
         let event_bus_handle = event_bus.handle();
         let mut count = 0;
 
-        for mut event in events {
+        while let Some(mut event) = events.next().transpose()? {
             // Assign event_id if not set
             if event.event_id == 0 {
                 event.event_id = self.next_event_id;
@@ -448,10 +573,14 @@ impl ReplaySource {
             let timestamp_ns = event.ts_mono_ns;
 
             // Publish event
-            if let Err(e) = event_bus_handle.publish(event).await {
-                error!(error = %e, "Failed to publish event during replay");
-                if self.config.stop_on_error {
-                    return Err(ReplayError::PublishError(e.to_string()));
+            match event_bus_handle.publish(event).await {
+                // Shedding is the configured overload policy, not a failure
+                Ok(()) | Err(PublishError::Shed) => {}
+                Err(e) => {
+                    error!(error = %e, "Failed to publish event during replay");
+                    if self.config.stop_on_error {
+                        return Err(ReplayError::PublishError(e.to_string()));
+                    }
                 }
             }
 
@@ -467,6 +596,108 @@ impl ReplaySource {
         Ok(count)
     }
 
+    /// Publish `events` in batches without pacing, then wait for the bus
+    /// to deliver them
+    async fn publish_unthrottled<I>(
+        &mut self,
+        event_bus: &EventBus,
+        mut events: I,
+    ) -> Result<usize, ReplayError>
+    where
+        I: Iterator<Item = Result<Event, ReplayError>>,
+    {
+        let handle = event_bus.handle();
+        let started = Instant::now();
+        let batch_size = self.config.batch_size.max(1);
+        let mut count = 0;
+
+        loop {
+            let mut batch = Vec::with_capacity(batch_size);
+            for event in events.by_ref().take(batch_size) {
+                let mut event = event?;
+                if event.event_id == 0 {
+                    event.event_id = self.next_event_id;
+                    self.next_event_id += 1;
+                }
+                batch.push(event);
+            }
+            let Some(last) = batch.last() else {
+                break;
+            };
+            self.time_manager
+                .provider()
+                .set_time(last.ts_mono_ns, last.ts_wall_ns);
+
+            // Grouped by partition, one ring claim per group
+            let len = batch.len();
+            if let Err(e) = handle.publish_batch(batch).await {
+                error!(error = %e, "Failed to publish batch during replay");
+                if self.config.stop_on_error {
+                    return Err(ReplayError::PublishError(e.to_string()));
+                }
+            }
+            count += len;
+        }
+
+        self.wait_for_drain(&handle).await;
+        let throughput = ReplayThroughput::new(count, started.elapsed());
+        info!(
+            count,
+            elapsed_ms = throughput.elapsed.as_millis() as u64,
+            events_per_sec = throughput.events_per_sec as u64,
+            "Unthrottled replay completed"
+        );
+        self.throughput = Some(throughput);
+        Ok(count)
+    }
+
+    /// Wait until the bus has delivered every event it accepted
+    async fn wait_for_drain(&self, handle: &EventBusHandle) {
+        let deadline = Instant::now() + self.config.drain_timeout;
+        loop {
+            let metrics = handle.metrics();
+            if metrics.events_processed >= metrics.events_received {
+                return;
+            }
+            if Instant::now() >= deadline {
+                warn!(
+                    pending = metrics.events_received - metrics.events_processed,
+                    "Replay drain timed out"
+                );
+                return;
+            }
+            tokio::time::sleep(Duration::from_millis(1)).await;
+        }
+    }
+
+    /// Replay the whole log unthrottled into one handler per partition
+    ///
+    /// Builds a thread-per-core bus from `bus_config`, so each partition's
+    /// events are evaluated on its own thread by the handler `make_handler`
+    /// returns for it. Returns end-to-end throughput, publish to delivery.
+    pub async fn replay_into<F, H>(
+        &mut self,
+        bus_config: EventBusConfig,
+        make_handler: F,
+    ) -> Result<ReplayThroughput, ReplayError>
+    where
+        F: FnMut(usize) -> H,
+        H: PartitionHandler,
+    {
+        let event_bus = EventBus::new_thread_per_core(bus_config, make_handler)?;
+        let unthrottled = std::mem::replace(&mut self.config.unthrottled, true);
+        self.throughput = None;
+        let result = self.start(&event_bus).await;
+        self.config.unthrottled = unthrottled;
+        result?;
+        Ok(self.throughput.clone().unwrap_or_default())
+    }
+
+    /// Throughput of the last unthrottled replay
+    pub fn throughput(&self) -> Option<&ReplayThroughput> {
+        self.throughput.as_ref()
+    }
+
     /// Get replay statistics
     pub fn stats(&self) -> ReplayStats {
         ReplayStats {
@@ -617,6 +848,102 @@ pub struct ReplayStats {
     pub current_ts_wall_ns: u64,
 }
 
+/// End-to-end throughput of an unthrottled replay
+#[derive(Debug, Clone, Default)]
+pub struct ReplayThroughput {
+    pub events: usize,
+    /// From the first publish until the bus drained
+    pub elapsed: Duration,
+    pub events_per_sec: f64,
+}
+
+impl ReplayThroughput {
+    fn new(events: usize, elapsed: Duration) -> Self {
+        Self {
+            events,
+            elapsed,
+            events_per_sec: events as f64 / elapsed.as_secs_f64().max(1e-9),
+        }
+    }
+}
+
+/// Identity of an alert across replays: its rule and the events it cites
+#[derive(Debug, Clone, PartialEq, Eq, Hash, PartialOrd, Ord, Serialize, Deserialize)]
+pub struct AlertSignature {
+    pub rule_id: String,
+    /// (event type, timestamp) of each evidence event
+    pub events: Vec<(u16, u64)>,
+}
+
+impl AlertSignature {
+    pub fn of(alert: &Alert) -> Self {
+        Self {
+            rule_id: alert.rule_id.clone(),
+            events: alert
+                .events
+                .iter()
+                .map(|event| (event.event_type_id, event.timestamp_ns))
+                .collect(),
+        }
+    }
+}
+
+/// Alerts that differ between a baseline and a candidate replay
+///
+/// Alerts are compared by `AlertSignature` as multisets, so the order in
+/// which parallel workers raised them does not matter.
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct AlertDiff {
+    /// Alerts raised by both
+    pub matched: usize,
+    /// Raised by the baseline only
+    pub missing: Vec<AlertSignature>,
+    /// Raised by the candidate only
+    pub added: Vec<AlertSignature>,
+}
+
+impl AlertDiff {
+    pub fn between(baseline: &[Alert], candidate: &[Alert]) -> Self {
+        let mut balance: HashMap<AlertSignature, i64> = HashMap::new();
+        for alert in baseline {
+            *balance.entry(AlertSignature::of(alert)).or_default() += 1;
+        }
+        for alert in candidate {
+            *balance.entry(AlertSignature::of(alert)).or_default() -= 1;
+        }
+
+        let mut diff = Self::default();
+        for (signature, count) in balance {
+            let side = if count > 0 {
+                &mut diff.missing
+            } else {
+                &mut diff.added
+            };
+            side.extend(std::iter::repeat(signature).take(count.unsigned_abs() as usize));
+        }
+        diff.missing.sort();
+        diff.added.sort();
+        diff.matched = baseline.len() - diff.missing.len();
+        diff
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.missing.is_empty() && self.added.is_empty()
+    }
+
+    /// (missing, added) counts per rule
+    pub fn by_rule(&self) -> BTreeMap<&str, (usize, usize)> {
+        let mut by_rule: BTreeMap<&str, (usize, usize)> = BTreeMap::new();
+        for signature in &self.missing {
+            by_rule.entry(&signature.rule_id).or_default().0 += 1;
+        }
+        for signature in &self.added {
+            by_rule.entry(&signature.rule_id).or_default().1 += 1;
+        }
+        by_rule
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -682,6 +1009,36 @@ mod tests {
         assert!(result.is_ok());
     }
 
+    #[test]
+    fn test_binary_log_json_export() {
+        let log = BinaryLog::new(create_test_schema());
+        let events = create_test_events(20);
+
+        let temp_dir = std::env::temp_dir();
+        let log_path = temp_dir.join(format!("test_export_{}.log", std::process::id()));
+        let json_path = temp_dir.join(format!("test_export_{}.jsonl", std::process::id()));
+
+        log.write_events(log_path.clone(), &events, "test_hash".to_string())
+            .unwrap();
+        let exported = log.export_json(log_path.clone(), json_path.clone());
+        assert_eq!(exported.unwrap(), 20);
+
+        // Both formats read back to the same events
+        let binary = log.read_events(log_path.clone()).unwrap();
+        let json = log.read_events(json_path.clone()).unwrap();
+        assert_eq!(binary.len(), 20);
+        for (b, j) in binary.iter().zip(&json) {
+            assert_eq!(b.ts_mono_ns, j.ts_mono_ns);
+            assert_eq!(b.entity_key, j.entity_key);
+            assert_eq!(b.fields, j.fields);
+        }
+        let size = |path: &PathBuf| std::fs::metadata(path).unwrap().len();
+        assert!(size(&log_path) < size(&json_path));
+
+        let _ = std::fs::remove_file(log_path);
+        let _ = std::fs::remove_file(json_path);
+    }
+
     #[test]
     fn test_replay_config_default() {
         let config = ReplayConfig::default();
@@ -1130,6 +1487,95 @@ mod tests {
         assert_eq!(first_run_results, second_run_results);
     }
 
+    #[tokio::test]
+    async fn test_unthrottled_replay_into_workers_with_alert_diff() {
+        use crate::alert::EventEvidence;
+        use std::sync::Mutex;
+
+        let schema = create_test_schema();
+        let log_path =
+            std::env::temp_dir().join(format!("test_unthrottled_{}.log", std::process::id()));
+        let events = create_test_events(1000);
+        BinaryLog::new(schema.clone())
+            .write_events(log_path.clone(), &events, "test_hash".to_string())
+            .unwrap();
+
+        // Each "rule pack" alerts on events whose field 1 is a multiple of `every`
+        let run = |every: i64| {
+            let schema = schema.clone();
+            let log_path = log_path.clone();
+            async move {
+                let alerts: Arc<Mutex<Vec<Alert>>> = Arc::default();
+                let config = ReplayConfig {
+                    log_path,
+                    batch_size: 64,
+                    ..Default::default()
+                };
+                let mut replay = ReplaySource::new(config, schema, TimeManager::mock());
+                let bus_config = EventBusConfig {
+                    partitions: 2,
+                    batch_timeout_ms: 1,
+                    thread_per_core: crate::ThreadPerCoreConfig {
+                        pin_threads: false,
+                        numa_aware: false,
+                    },
+                    ..Default::default()
+                };
+                let sink = alerts.clone();
+                let throughput = replay
+                    .replay_into(bus_config, move |_| {
+                        let sink = sink.clone();
+                        move |_partition: usize, batch: &[Event]| {
+                            for event in batch {
+                                let Some(TypedValue::I64(n)) = event.get_field(1) else {
+                                    continue;
+                                };
+                                if n % every != 0 {
+                                    continue;
+                                }
+                                sink.lock().unwrap().push(Alert {
+                                    id: String::new(),
+                                    rule_id: format!("every-{}", every),
+                                    rule_name: String::new(),
+                                    severity: crate::Severity::Low,
+                                    timestamp_ns: 0,
+                                    title: String::new(),
+                                    description: None,
+                                    events: vec![EventEvidence {
+                                        event_type_id: event.event_type_id,
+                                        timestamp_ns: event.ts_mono_ns,
+                                        fields: Vec::new(),
+                                    }],
+                                    context: serde_json::Value::Null,
+                                });
+                            }
+                        }
+                    })
+                    .await
+                    .unwrap();
+                let alerts = std::mem::take(&mut *alerts.lock().unwrap());
+                (throughput, alerts)
+            }
+        };
+
+        let (throughput, baseline) = run(10).await;
+        assert_eq!(throughput.events, 1000);
+        assert!(throughput.events_per_sec > 0.0);
+        assert_eq!(baseline.len(), 100);
+
+        let (_, same) = run(10).await;
+        assert!(AlertDiff::between(&baseline, &same).is_empty());
+
+        let (_, candidate) = run(20).await;
+        let diff = AlertDiff::between(&baseline, &candidate);
+        assert_eq!(diff.matched, 0);
+        assert_eq!(diff.missing.len(), 100);
+        assert_eq!(diff.added.len(), 50);
+        assert_eq!(diff.by_rule()["every-10"], (100, 0));
+
+        let _ = std::fs::remove_file(log_path);
+    }
+
     #[tokio::test]
     async fn test_verification_run_result() {
         let result = VerificationRunResult {
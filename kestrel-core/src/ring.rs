@@ -0,0 +1,495 @@
+//! Bounded lock-free MPSC ring
+//!
+//! Pre-sized ring of slots used as the EventBus partition transport.
+//! Producers claim a run of slots with one CAS on the tail and the consumer
+//! releases a run of slots with one store to the head, so shared cache lines
+//! are touched once per batch rather than once per event. Wakeups are also
+//! issued once per batch.
+
+use std::cell::UnsafeCell;
+use std::mem::MaybeUninit;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::sync::Arc;
+use tokio::sync::Notify;
+
+/// Error pushing to a ring
+#[derive(Debug, Clone, Copy, PartialEq, Eq, thiserror::Error)]
+pub enum RingError {
+    #[error("Ring is full")]
+    Full,
+
+    #[error("Ring is closed")]
+    Closed,
+}
+
+/// Aligns a value to its own cache line to avoid false sharing
+#[repr(align(64))]
+#[derive(Debug, Default)]
+pub(crate) struct CachePadded<T>(pub(crate) T);
+
+impl<T> std::ops::Deref for CachePadded<T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        &self.0
+    }
+}
+
+/// A ring slot
+///
+/// `seq == pos + 1` once the value for ring position `pos` is written.
+struct Slot<T> {
+    seq: AtomicUsize,
+    value: UnsafeCell<MaybeUninit<T>>,
+}
+
+struct Shared<T> {
+    /// Next position the consumer reads
+    head: CachePadded<AtomicUsize>,
+    /// Next position a producer claims
+    tail: CachePadded<AtomicUsize>,
+    slots: Box<[Slot<T>]>,
+    mask: usize,
+    closed: AtomicBool,
+    /// Signalled when slots are published
+    readable: Notify,
+    /// Signalled when slots are released
+    writable: Notify,
+}
+
+// Values are moved across threads through the slots; each slot is written by
+// the one producer that claimed it and read by the single consumer.
+unsafe impl<T: Send> Send for Shared<T> {}
+unsafe impl<T: Send> Sync for Shared<T> {}
+
+impl<T> Shared<T> {
+    fn capacity(&self) -> usize {
+        self.slots.len()
+    }
+
+    fn len(&self) -> usize {
+        let head = self.head.load(Ordering::Acquire);
+        let tail = self.tail.load(Ordering::Acquire);
+        tail.wrapping_sub(head).min(self.capacity())
+    }
+
+    fn close(&self) {
+        self.closed.store(true, Ordering::Release);
+        self.readable.notify_one();
+        self.writable.notify_waiters();
+    }
+
+    /// Claim `n` consecutive slots, returning the first position
+    fn try_claim(&self, n: usize) -> Result<usize, RingError> {
+        loop {
+            if self.closed.load(Ordering::Acquire) {
+                return Err(RingError::Closed);
+            }
+            // Head is loaded first so `tail >= head` holds for the check below
+            let head = self.head.load(Ordering::Acquire);
+            let tail = self.tail.load(Ordering::Relaxed);
+            if tail.wrapping_sub(head) + n > self.capacity() {
+                return Err(RingError::Full);
+            }
+            if self
+                .tail
+                .compare_exchange_weak(tail, tail + n, Ordering::AcqRel, Ordering::Relaxed)
+                .is_ok()
+            {
+                return Ok(tail);
+            }
+        }
+    }
+
+    /// Write a value into a claimed position and publish it
+    fn publish(&self, pos: usize, value: T) {
+        let slot = &self.slots[pos & self.mask];
+        // SAFETY: `pos` was claimed by this producer, and the consumer has
+        // released the slot's previous value before head passed it.
+        unsafe { (*slot.value.get()).write(value) };
+        slot.seq.store(pos + 1, Ordering::Release);
+    }
+}
+
+impl<T> Drop for Shared<T> {
+    fn drop(&mut self) {
+        let head = *self.head.0.get_mut();
+        let tail = *self.tail.0.get_mut();
+        for pos in head..tail {
+            let slot = &mut self.slots[pos & self.mask];
+            if *slot.seq.get_mut() == pos + 1 {
+                // SAFETY: the slot was published and never consumed
+                unsafe { slot.value.get_mut().assume_init_drop() };
+            }
+        }
+    }
+}
+
+/// Create a ring with room for at least `capacity` values
+///
+/// The capacity is rounded up to a power of two.
+pub fn ring<T>(capacity: usize) -> (RingProducer<T>, RingConsumer<T>) {
+    let capacity = capacity.max(1).next_power_of_two();
+    let slots = (0..capacity)
+        .map(|_| Slot {
+            seq: AtomicUsize::new(0),
+            value: UnsafeCell::new(MaybeUninit::uninit()),
+        })
+        .collect();
+
+    let shared = Arc::new(Shared {
+        head: CachePadded(AtomicUsize::new(0)),
+        tail: CachePadded(AtomicUsize::new(0)),
+        slots,
+        mask: capacity - 1,
+        closed: AtomicBool::new(false),
+        readable: Notify::new(),
+        writable: Notify::new(),
+    });
+
+    (
+        RingProducer {
+            shared: shared.clone(),
+        },
+        RingConsumer { shared },
+    )
+}
+
+/// Producer side of a ring; cheap to clone
+pub struct RingProducer<T> {
+    shared: Arc<Shared<T>>,
+}
+
+impl<T> Clone for RingProducer<T> {
+    fn clone(&self) -> Self {
+        Self {
+            shared: self.shared.clone(),
+        }
+    }
+}
+
+impl<T> std::fmt::Debug for RingProducer<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("RingProducer")
+            .field("capacity", &self.capacity())
+            .field("len", &self.len())
+            .finish()
+    }
+}
+
+impl<T> RingProducer<T> {
+    /// Number of slots
+    pub fn capacity(&self) -> usize {
+        self.shared.capacity()
+    }
+
+    /// Approximate number of values waiting in the ring
+    pub fn len(&self) -> usize {
+        self.shared.len()
+    }
+
+    /// Whether the ring is currently empty
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Whether the ring has been closed
+    pub fn is_closed(&self) -> bool {
+        self.shared.closed.load(Ordering::Acquire)
+    }
+
+    /// Close the ring; the consumer still drains published values
+    pub fn close(&self) {
+        self.shared.close();
+    }
+
+    /// Push one value without waiting
+    pub fn try_push(&self, value: T) -> Result<(), RingError> {
+        self.try_push_or_keep(value).map_err(|(e, _)| e)
+    }
+
+    /// Like `try_push`, but hands `value` back when it cannot be pushed
+    pub(crate) fn try_push_or_keep(&self, value: T) -> Result<(), (RingError, T)> {
+        match self.shared.try_claim(1) {
+            Ok(pos) => {
+                self.shared.publish(pos, value);
+                self.shared.readable.notify_one();
+                Ok(())
+            }
+            Err(e) => Err((e, value)),
+        }
+    }
+
+    /// Wait until a slot is free or the ring is closed
+    pub async fn writable(&self) {
+        let writable = self.shared.writable.notified();
+        tokio::pin!(writable);
+        writable.as_mut().enable();
+        if self.len() < self.capacity() || self.is_closed() {
+            return;
+        }
+        writable.await;
+    }
+
+    /// Push all of `values` without waiting
+    ///
+    /// All-or-nothing: on success `values` is drained, on error it is left
+    /// untouched. Batches larger than the capacity always fail with `Full`.
+    pub fn try_push_batch(&self, values: &mut Vec<T>) -> Result<(), RingError> {
+        if values.is_empty() {
+            return Ok(());
+        }
+        let start = self.shared.try_claim(values.len())?;
+        for (offset, value) in values.drain(..).enumerate() {
+            self.shared.publish(start + offset, value);
+        }
+        self.shared.readable.notify_one();
+        Ok(())
+    }
+
+    /// Push one value, waiting for space
+    pub async fn push(&self, value: T) -> Result<(), RingError> {
+        let pos = loop {
+            let writable = self.shared.writable.notified();
+            tokio::pin!(writable);
+            writable.as_mut().enable();
+            match self.shared.try_claim(1) {
+                Ok(pos) => break pos,
+                Err(RingError::Full) => writable.await,
+                Err(e) => return Err(e),
+            }
+        };
+        self.shared.publish(pos, value);
+        self.shared.readable.notify_one();
+        Ok(())
+    }
+
+    /// Push all of `values`, waiting for space
+    ///
+    /// Batches larger than the capacity are pushed in capacity-sized chunks.
+    /// Cancel safe: values not yet pushed remain in `values`.
+    pub async fn push_batch(&self, values: &mut Vec<T>) -> Result<(), RingError> {
+        while !values.is_empty() {
+            let chunk = values.len().min(self.capacity());
+            let start = loop {
+                let writable = self.shared.writable.notified();
+                tokio::pin!(writable);
+                writable.as_mut().enable();
+                match self.shared.try_claim(chunk) {
+                    Ok(start) => break start,
+                    Err(RingError::Full) => writable.await,
+                    Err(e) => return Err(e),
+                }
+            };
+            for (offset, value) in values.drain(..chunk).enumerate() {
+                self.shared.publish(start + offset, value);
+            }
+            self.shared.readable.notify_one();
+        }
+        Ok(())
+    }
+}
+
+/// Consumer side of a ring; there is exactly one per ring
+pub struct RingConsumer<T> {
+    shared: Arc<Shared<T>>,
+}
+
+impl<T> std::fmt::Debug for RingConsumer<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("RingConsumer")
+            .field("capacity", &self.shared.capacity())
+            .field("len", &self.len())
+            .finish()
+    }
+}
+
+impl<T> RingConsumer<T> {
+    /// Approximate number of values waiting in the ring
+    pub fn len(&self) -> usize {
+        self.shared.len()
+    }
+
+    /// Whether no published value is waiting
+    pub fn is_empty(&self) -> bool {
+        let head = self.shared.head.load(Ordering::Relaxed);
+        let slot = &self.shared.slots[head & self.shared.mask];
+        slot.seq.load(Ordering::Acquire) != head + 1
+    }
+
+    /// Whether every claimed slot has been consumed
+    ///
+    /// Unlike `is_empty`, this counts slots a producer has claimed but not
+    /// yet published. Once the ring is closed and drained, no value can
+    /// still arrive.
+    pub fn is_drained(&self) -> bool {
+        self.shared.head.load(Ordering::Relaxed) == self.shared.tail.load(Ordering::Acquire)
+    }
+
+    /// Whether the ring has been closed
+    pub fn is_closed(&self) -> bool {
+        self.shared.closed.load(Ordering::Acquire)
+    }
+
+    /// Close the ring; further pushes fail with `Closed`
+    pub fn close(&self) {
+        self.shared.close();
+    }
+
+    /// Move up to `max` published values into `out`, returning the count
+    pub fn drain_into(&mut self, out: &mut Vec<T>, max: usize) -> usize {
+        let shared = &*self.shared;
+        let head = shared.head.load(Ordering::Relaxed);
+
+        let mut taken = 0;
+        while taken < max {
+            let pos = head + taken;
+            let slot = &shared.slots[pos & shared.mask];
+            if slot.seq.load(Ordering::Acquire) != pos + 1 {
+                break;
+            }
+            // SAFETY: the slot is published and only this consumer reads it
+            out.push(unsafe { (*slot.value.get()).assume_init_read() });
+            taken += 1;
+        }
+
+        if taken > 0 {
+            shared.head.store(head + taken, Ordering::Release);
+            shared.writable.notify_waiters();
+        }
+        taken
+    }
+
+    /// Wait until a value is published or the ring is closed
+    pub async fn readable(&self) {
+        let readable = self.shared.readable.notified();
+        tokio::pin!(readable);
+        readable.as_mut().enable();
+        if !self.is_empty() || self.is_closed() {
+            return;
+        }
+        readable.await;
+    }
+}
+
+impl<T> Drop for RingConsumer<T> {
+    fn drop(&mut self) {
+        self.shared.close();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_ring_batch_push_and_drain() {
+        let (producer, mut consumer) = ring::<u32>(6);
+        assert_eq!(producer.capacity(), 8);
+
+        let mut batch = vec![1, 2, 3, 4, 5];
+        producer.try_push_batch(&mut batch).unwrap();
+        assert!(batch.is_empty());
+
+        // All-or-nothing when the batch does not fit
+        let mut batch = vec![6, 7, 8, 9];
+        assert_eq!(producer.try_push_batch(&mut batch), Err(RingError::Full));
+        assert_eq!(batch.len(), 4);
+
+        let mut out = Vec::new();
+        assert_eq!(consumer.drain_into(&mut out, 3), 3);
+        assert_eq!(out, vec![1, 2, 3]);
+
+        // Wraps around the end of the slot array
+        producer.try_push_batch(&mut batch).unwrap();
+        out.clear();
+        assert_eq!(consumer.drain_into(&mut out, 100), 6);
+        assert_eq!(out, vec![4, 5, 6, 7, 8, 9]);
+        assert!(consumer.is_empty());
+    }
+
+    #[test]
+    fn test_ring_close_and_drop() {
+        let value = Arc::new(());
+        let (producer, consumer) = ring(4);
+        producer.try_push(value.clone()).unwrap();
+        producer.try_push(value.clone()).unwrap();
+
+        consumer.close();
+        assert_eq!(producer.try_push(value.clone()), Err(RingError::Closed));
+
+        // Unconsumed values are dropped with the ring
+        drop(consumer);
+        drop(producer);
+        assert_eq!(Arc::strong_count(&value), 1);
+    }
+
+    #[tokio::test]
+    async fn test_ring_full_push_keeps_value() {
+        let (producer, mut consumer) = ring::<u32>(2);
+        producer.try_push(1).unwrap();
+        producer.try_push(2).unwrap();
+        assert_eq!(producer.try_push_or_keep(3), Err((RingError::Full, 3)));
+
+        let waiter = {
+            let producer = producer.clone();
+            tokio::spawn(async move { producer.writable().await })
+        };
+        tokio::task::yield_now().await;
+        assert!(!waiter.is_finished());
+
+        let mut out = Vec::new();
+        consumer.drain_into(&mut out, 1);
+        waiter.await.unwrap();
+        producer.try_push_or_keep(3).unwrap();
+    }
+
+    #[test]
+    fn test_ring_drained_counts_claimed_slots() {
+        let (producer, mut consumer) = ring::<u32>(4);
+        let pos = producer.shared.try_claim(1).unwrap();
+        consumer.close();
+
+        // Claimed but not yet published
+        assert!(consumer.is_empty());
+        assert!(!consumer.is_drained());
+
+        producer.shared.publish(pos, 7);
+        let mut out = Vec::new();
+        assert_eq!(consumer.drain_into(&mut out, 10), 1);
+        assert_eq!(out, vec![7]);
+        assert!(consumer.is_drained());
+    }
+
+    #[tokio::test(flavor = "multi_thread", worker_threads = 4)]
+    async fn test_ring_concurrent_producers() {
+        let (producer, mut consumer) = ring::<u64>(64);
+
+        let mut tasks = Vec::new();
+        for p in 0..4u64 {
+            let producer = producer.clone();
+            tasks.push(tokio::spawn(async move {
+                for chunk in 0..50u64 {
+                    let mut batch: Vec<u64> = (0..10).map(|i| p * 1000 + chunk * 10 + i).collect();
+                    producer.push_batch(&mut batch).await.unwrap();
+                }
+            }));
+        }
+
+        let mut out = Vec::new();
+        while out.len() < 2000 {
+            consumer.readable().await;
+            consumer.drain_into(&mut out, 128);
+        }
+        for task in tasks {
+            task.await.unwrap();
+        }
+
+        // Each producer's values arrive in order
+        for p in 0..4u64 {
+            let seen: Vec<u64> = out.iter().copied().filter(|v| v / 1000 == p).collect();
+            let expected: Vec<u64> = (0..500).map(|i| p * 1000 + i).collect();
+            assert_eq!(seen, expected);
+        }
+    }
+}
@@ -6,11 +6,326 @@
 //! - Deterministic testing
 //! - Offline replay with reproducible results
 //! - Time travel debugging
-
-use std::sync::atomic::{AtomicU64, Ordering};
-use std::sync::Arc;
+//!
+//! Real time comes from two process-wide clocks. `monotonic_ns` reads the
+//! TSC directly when it is invariant (x86_64 Linux), scaled by a
+//! calibration the ticker thread refines against `CLOCK_MONOTONIC` every
+//! second; elsewhere it reads `CLOCK_MONOTONIC`. Refinements slew the
+//! rate rather than step the value, so the clock never runs backwards.
+//! `coarse_monotonic_ns` is a cached value the ticker refreshes every
+//! millisecond, for expiry and budget checks that do not need better
+//! precision. `stop_ticker` ends the ticker thread at shutdown.
+
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread::JoinHandle;
 use std::time::Duration;
 
+/// Refresh period of the coarse clock
+pub const COARSE_TICK: Duration = Duration::from_millis(1);
+
+/// Coarse ticks between TSC recalibrations
+#[cfg(all(target_os = "linux", target_arch = "x86_64"))]
+const RECALIBRATE_TICKS: u32 = 1000;
+
+/// The process-wide ticker behind `coarse_monotonic_ns`
+static TICKER: Ticker = Ticker::new(true);
+
+/// `CLOCK_MONOTONIC` in nanoseconds
+#[cfg(target_os = "linux")]
+fn clock_monotonic_ns() -> u64 {
+    let mut ts = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    // SAFETY: `ts` is a valid timespec for the call to fill in
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
+}
+
+/// Nanoseconds since first use, offset so it is never zero
+#[cfg(not(target_os = "linux"))]
+fn clock_monotonic_ns() -> u64 {
+    static ANCHOR: OnceLock<std::time::Instant> = OnceLock::new();
+    ANCHOR
+        .get_or_init(std::time::Instant::now)
+        .elapsed()
+        .as_nanos() as u64
+        + 1
+}
+
+/// TSC to nanosecond conversion, published through a sequence lock
+#[cfg(all(target_os = "linux", target_arch = "x86_64"))]
+mod tsc {
+    use super::clock_monotonic_ns;
+    use super::start_ticker;
+    use super::{COARSE_TICK, RECALIBRATE_TICKS};
+    use std::sync::atomic::{fence, AtomicU64, Ordering};
+    use std::sync::OnceLock;
+    use std::time::{Duration, Instant};
+
+    /// Fractional bits of the ns-per-tick multiplier
+    const SHIFT: u32 = 32;
+
+    /// Time over which a recalibration absorbs the clock's lead
+    const SLEW_NS: u64 = RECALIBRATE_TICKS as u64 * COARSE_TICK.as_nanos() as u64;
+
+    pub(super) struct Calibration {
+        seq: AtomicU64,
+        base_tsc: AtomicU64,
+        base_ns: AtomicU64,
+        mult: AtomicU64,
+        origin: (u64, u64),
+    }
+
+    #[inline]
+    pub(super) fn rdtsc() -> u64 {
+        // SAFETY: RDTSC is available on every x86_64 CPU
+        unsafe { core::arch::x86_64::_rdtsc() }
+    }
+
+    fn invariant_tsc() -> bool {
+        use core::arch::x86_64::__cpuid;
+        // SAFETY: CPUID is available on every x86_64 CPU
+        unsafe {
+            __cpuid(0x8000_0000).eax >= 0x8000_0007 && __cpuid(0x8000_0007).edx & (1 << 8) != 0
+        }
+    }
+
+    fn multiplier(origin: (u64, u64), tsc: u64, ns: u64) -> Option<u64> {
+        let ticks = tsc.checked_sub(origin.0).filter(|&ticks| ticks > 0)?;
+        let nanos = ns.checked_sub(origin.1)?;
+        u64::try_from(((nanos as u128) << SHIFT) / ticks as u128).ok()
+    }
+
+    impl Calibration {
+        /// Calibrate over a short busy wait, or `None` without a usable TSC
+        pub(super) fn new() -> Option<Self> {
+            if !invariant_tsc() {
+                return None;
+            }
+            let origin = (rdtsc(), clock_monotonic_ns());
+            let started = Instant::now();
+            while started.elapsed() < Duration::from_millis(2) {
+                std::hint::spin_loop();
+            }
+            let (tsc, ns) = (rdtsc(), clock_monotonic_ns());
+            let mult = multiplier(origin, tsc, ns)?;
+            Some(Self {
+                seq: AtomicU64::new(0),
+                base_tsc: AtomicU64::new(tsc),
+                base_ns: AtomicU64::new(ns),
+                mult: AtomicU64::new(mult),
+                origin,
+            })
+        }
+
+        #[inline]
+        pub(super) fn now_ns(&self) -> u64 {
+            loop {
+                let seq = self.seq.load(Ordering::Acquire);
+                let base_tsc = self.base_tsc.load(Ordering::Relaxed);
+                let base_ns = self.base_ns.load(Ordering::Relaxed);
+                let mult = self.mult.load(Ordering::Relaxed);
+                fence(Ordering::Acquire);
+                if seq & 1 == 0 && self.seq.load(Ordering::Relaxed) == seq {
+                    return extrapolate(base_tsc, base_ns, mult, rdtsc());
+                }
+                std::hint::spin_loop();
+            }
+        }
+
+        /// Re-anchor on `CLOCK_MONOTONIC`; the multiplier is measured from
+        /// the origin, so it gets more precise the longer the process runs
+        ///
+        /// A clock running behind steps forward. A clock running ahead keeps
+        /// its current value and runs slower until `CLOCK_MONOTONIC` catches
+        /// up over the next `SLEW_NS`, so readers never see it go back.
+        ///
+        /// Only the ticker thread calls this.
+        pub(super) fn recalibrate(&self) {
+            let (tsc, ns) = (rdtsc(), clock_monotonic_ns());
+            let Some(target) = multiplier(self.origin, tsc, ns) else {
+                return;
+            };
+            // Only this thread writes, so the current values are stable
+            let current = extrapolate(
+                self.base_tsc.load(Ordering::Relaxed),
+                self.base_ns.load(Ordering::Relaxed),
+                self.mult.load(Ordering::Relaxed),
+                tsc,
+            );
+            let (ns, mult) = match current.checked_sub(ns) {
+                Some(lead) if lead > 0 => {
+                    let lead = lead.min(SLEW_NS / 2);
+                    let slewed = target as u128 * (SLEW_NS - lead) as u128 / SLEW_NS as u128;
+                    (current, slewed as u64)
+                }
+                _ => (ns, target),
+            };
+
+            let seq = self.seq.load(Ordering::Relaxed);
+            self.seq.store(seq + 1, Ordering::Relaxed);
+            fence(Ordering::Release);
+            self.base_tsc.store(tsc, Ordering::Relaxed);
+            self.base_ns.store(ns, Ordering::Relaxed);
+            self.mult.store(mult, Ordering::Relaxed);
+            self.seq.store(seq + 2, Ordering::Release);
+        }
+    }
+
+    #[inline]
+    fn extrapolate(base_tsc: u64, base_ns: u64, mult: u64, tsc: u64) -> u64 {
+        let ticks = tsc.saturating_sub(base_tsc);
+        base_ns + ((ticks as u128 * mult as u128) >> SHIFT) as u64
+    }
+
+    pub(super) fn calibration() -> Option<&'static Calibration> {
+        static CALIBRATION: OnceLock<Option<Calibration>> = OnceLock::new();
+        let calibration = CALIBRATION.get_or_init(Calibration::new).as_ref();
+        if calibration.is_some() {
+            start_ticker();
+        }
+        calibration
+    }
+
+    #[cfg(test)]
+    mod tests {
+        use super::*;
+
+        #[test]
+        fn test_recalibrate_slews_instead_of_stepping_back() {
+            let Some(calibration) = Calibration::new() else {
+                return;
+            };
+            // Put the clock 1ms ahead of CLOCK_MONOTONIC
+            let ahead = calibration.base_ns.load(Ordering::Relaxed) + 1_000_000;
+            calibration.base_ns.store(ahead, Ordering::Relaxed);
+            let mult = calibration.mult.load(Ordering::Relaxed);
+
+            let before = calibration.now_ns();
+            calibration.recalibrate();
+            let after = calibration.now_ns();
+
+            assert!(after >= before, "{} < {}", after, before);
+            assert!(calibration.mult.load(Ordering::Relaxed) < mult);
+        }
+    }
+}
+
+/// Thread that refreshes a coarse clock every `COARSE_TICK`
+struct Ticker {
+    started: OnceLock<()>,
+    /// Cached monotonic time
+    now: AtomicU64,
+    thread: Mutex<Option<JoinHandle<()>>>,
+    stop: AtomicBool,
+    /// Set if the thread is not running; reads fall back to exact
+    stale: AtomicBool,
+    /// Whether the thread also refines the TSC calibration
+    recalibrate: bool,
+}
+
+impl Ticker {
+    const fn new(recalibrate: bool) -> Self {
+        Self {
+            started: OnceLock::new(),
+            now: AtomicU64::new(0),
+            thread: Mutex::new(None),
+            stop: AtomicBool::new(false),
+            stale: AtomicBool::new(false),
+            recalibrate,
+        }
+    }
+
+    /// Start the thread on first use
+    fn start(&'static self) {
+        self.started.get_or_init(|| {
+            self.now.store(clock_monotonic_ns(), Ordering::Relaxed);
+            if self.stop.load(Ordering::Relaxed) {
+                self.stale.store(true, Ordering::Relaxed);
+                return;
+            }
+            let spawned = std::thread::Builder::new()
+                .name("kestrel-clock".to_string())
+                .spawn(move || self.run());
+            match spawned {
+                Ok(handle) => *self.thread.lock().unwrap() = Some(handle),
+                Err(_) => self.stale.store(true, Ordering::Relaxed),
+            }
+        });
+    }
+
+    fn run(&self) {
+        #[cfg(all(target_os = "linux", target_arch = "x86_64"))]
+        let mut ticks = 0u32;
+        while !self.stop.load(Ordering::Relaxed) {
+            std::thread::sleep(COARSE_TICK);
+            self.now.store(clock_monotonic_ns(), Ordering::Relaxed);
+
+            #[cfg(all(target_os = "linux", target_arch = "x86_64"))]
+            if self.recalibrate {
+                ticks += 1;
+                if ticks == RECALIBRATE_TICKS {
+                    ticks = 0;
+                    if let Some(calibration) = tsc::calibration() {
+                        calibration.recalibrate();
+                    }
+                }
+            }
+        }
+    }
+
+    #[inline]
+    fn now_ns(&'static self) -> u64 {
+        self.start();
+        if self.stale.load(Ordering::Relaxed) {
+            return clock_monotonic_ns();
+        }
+        self.now.load(Ordering::Relaxed)
+    }
+
+    /// Stop the thread and wait for it to exit; it is not restarted
+    fn stop(&self) {
+        self.stop.store(true, Ordering::Relaxed);
+        self.stale.store(true, Ordering::Relaxed);
+        let handle = self.thread.lock().unwrap().take();
+        if let Some(handle) = handle {
+            let _ = handle.join();
+        }
+    }
+}
+
+/// Start the thread that refreshes the coarse clock and TSC calibration
+fn start_ticker() {
+    TICKER.start();
+}
+
+/// Stop the clock ticker thread and wait for it to exit
+///
+/// For process shutdown. Afterwards `coarse_monotonic_ns` reads the exact
+/// clock and the TSC calibration keeps its last values; the ticker is not
+/// restarted.
+pub fn stop_ticker() {
+    TICKER.stop();
+}
+
+/// Monotonic time in nanoseconds, on the `CLOCK_MONOTONIC` timeline
+#[inline]
+pub fn monotonic_ns() -> u64 {
+    #[cfg(all(target_os = "linux", target_arch = "x86_64"))]
+    if let Some(calibration) = tsc::calibration() {
+        return calibration.now_ns();
+    }
+    clock_monotonic_ns()
+}
+
+/// Monotonic time at most about `COARSE_TICK` old
+#[inline]
+pub fn coarse_monotonic_ns() -> u64 {
+    TICKER.now_ns()
+}
+
 /// Time provider trait
 ///
 /// Abstraction over time sources that allows mocking for testing.
@@ -21,6 +336,11 @@ pub trait TimeProvider: Send + Sync {
     /// Get current wall clock timestamp in nanoseconds
     fn wall_ns(&self) -> u64;
 
+    /// Get a monotonic timestamp that may lag by about a millisecond
+    fn coarse_mono_ns(&self) -> u64 {
+        self.mono_ns()
+    }
+
     /// Advance time by a duration (for mock time)
     fn advance(&self, _duration: Duration) {
         // Default implementation does nothing
@@ -39,17 +359,14 @@ pub trait TimeProvider: Send + Sync {
 pub struct RealTimeProvider;
 
 impl TimeProvider for RealTimeProvider {
+    #[inline]
     fn mono_ns(&self) -> u64 {
-        // Use std::time::Instant for monotonic time
-        // Since Instant::elapsed() gives duration since creation,
-        // we need a different approach for absolute monotonic time
-        // For now, use UNIX time as approximation
-        use std::time::{SystemTime, UNIX_EPOCH};
+        monotonic_ns()
+    }
 
-        SystemTime::now()
-            .duration_since(UNIX_EPOCH)
-            .map(|d| d.as_nanos() as u64)
-            .unwrap_or(0)
+    #[inline]
+    fn coarse_mono_ns(&self) -> u64 {
+        coarse_monotonic_ns()
     }
 
     fn wall_ns(&self) -> u64 {
@@ -126,10 +443,24 @@ impl TimeProvider for MockTimeProvider {
     }
 }
 
+/// Time source behind a `TimeManager`
+#[derive(Clone)]
+enum TimeSource {
+    Real,
+    Mock(MockTimeProvider),
+    /// Read through `TimeManager::provider`
+    Custom,
+}
+
 /// Global time manager
 ///
-/// Provides a way to switch between real and mock time sources.
+/// Provides a way to switch between real and mock time sources. The real
+/// and mock sources are matched on directly, so the per-event clock reads
+/// on hot paths inline instead of going through a vtable; only providers
+/// passed to `with_provider` are called dynamically.
+#[derive(Clone)]
 pub struct TimeManager {
+    source: TimeSource,
     provider: Arc<dyn TimeProvider>,
 }
 
@@ -137,32 +468,61 @@ impl TimeManager {
     /// Create a new time manager with real time provider
     pub fn real() -> Self {
         Self {
+            source: TimeSource::Real,
             provider: Arc::new(RealTimeProvider),
         }
     }
 
     /// Create a new time manager with mock time provider
     pub fn mock() -> Self {
-        Self {
-            provider: Arc::new(MockTimeProvider::new()),
-        }
+        Self::with_mock(MockTimeProvider::new())
     }
 
     /// Create a new time manager with a specific mock time provider
     pub fn with_mock(mock: MockTimeProvider) -> Self {
+        // Clones share the mock's clock
         Self {
-            provider: Arc::new(mock),
+            provider: Arc::new(mock.clone()),
+            source: TimeSource::Mock(mock),
+        }
+    }
+
+    /// Create a new time manager with a custom time provider
+    pub fn with_provider(provider: Arc<dyn TimeProvider>) -> Self {
+        Self {
+            source: TimeSource::Custom,
+            provider,
         }
     }
 
     /// Get current monotonic timestamp in nanoseconds
+    #[inline]
     pub fn mono_ns(&self) -> u64 {
-        self.provider.mono_ns()
+        match &self.source {
+            TimeSource::Real => monotonic_ns(),
+            TimeSource::Mock(mock) => mock.mono_ns(),
+            TimeSource::Custom => self.provider.mono_ns(),
+        }
+    }
+
+    /// Get a monotonic timestamp that may lag by about a millisecond
+    #[inline]
+    pub fn coarse_mono_ns(&self) -> u64 {
+        match &self.source {
+            TimeSource::Real => coarse_monotonic_ns(),
+            TimeSource::Mock(mock) => mock.coarse_mono_ns(),
+            TimeSource::Custom => self.provider.coarse_mono_ns(),
+        }
     }
 
     /// Get current wall clock timestamp in nanoseconds
+    #[inline]
     pub fn wall_ns(&self) -> u64 {
-        self.provider.wall_ns()
+        match &self.source {
+            TimeSource::Real => RealTimeProvider.wall_ns(),
+            TimeSource::Mock(mock) => mock.wall_ns(),
+            TimeSource::Custom => self.provider.wall_ns(),
+        }
     }
 
     /// Get a reference to the inner time provider
@@ -171,14 +531,6 @@ impl TimeManager {
     }
 }
 
-impl Clone for TimeManager {
-    fn clone(&self) -> Self {
-        Self {
-            provider: Arc::clone(&self.provider),
-        }
-    }
-}
-
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -259,6 +611,63 @@ mod tests {
         assert_eq!(manager.wall_ns(), 0);
     }
 
+    #[test]
+    fn test_monotonic_clock() {
+        let first = monotonic_ns();
+        let mut last = first;
+        for _ in 0..10_000 {
+            let now = monotonic_ns();
+            assert!(now >= last, "{} < {}", now, last);
+            last = now;
+        }
+
+        std::thread::sleep(Duration::from_millis(20));
+        let second = monotonic_ns();
+        assert!(second > first);
+        // Loose bound: the TSC calibration may be off by a few percent
+        assert!(second - first >= 10_000_000, "{}", second - first);
+    }
+
+    #[test]
+    fn test_coarse_clock() {
+        let before = coarse_monotonic_ns();
+        std::thread::sleep(Duration::from_millis(20));
+        let after = coarse_monotonic_ns();
+
+        assert!(after > before);
+        // Compare on the same timeline: the TSC clock may lead or lag
+        assert!(after <= clock_monotonic_ns());
+
+        let manager = TimeManager::real();
+        assert!(manager.coarse_mono_ns() > 0);
+    }
+
+    #[test]
+    fn test_stop_ticker() {
+        // A private ticker, so the process-wide one keeps running for
+        // the other tests
+        let ticker: &'static Ticker = Box::leak(Box::new(Ticker::new(false)));
+        ticker.now_ns();
+        assert!(ticker.thread.lock().unwrap().is_some());
+        ticker.stop();
+        assert!(ticker.thread.lock().unwrap().is_none());
+
+        // Without the thread, reads are exact
+        let before = clock_monotonic_ns();
+        assert!(ticker.now_ns() >= before);
+    }
+
+    #[test]
+    fn test_time_manager_custom_provider() {
+        let mock = MockTimeProvider::with_values(1000, 2000);
+        let manager = TimeManager::with_provider(Arc::new(mock.clone()));
+
+        mock.advance(Duration::from_nanos(500));
+        assert_eq!(manager.mono_ns(), 1500);
+        assert_eq!(manager.coarse_mono_ns(), 1500);
+        assert_eq!(manager.wall_ns(), 2500);
+    }
+
     #[test]
     fn test_time_manager_clone() {
         let manager1 = TimeManager::mock();
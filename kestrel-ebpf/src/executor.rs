@@ -455,7 +455,7 @@ impl EbpfExecutor {
         if let Some(entry) = self.get_cache_entry(entity_key) {
             BlockStatus::Blocked {
                 action: entry.decision.action,
-                reason: entry.decision.reason.clone(),
+                reason: entry.decision.reason.to_string(),
                 expires_at: entry.expires_at_ns,
             }
         } else {
@@ -616,7 +616,7 @@ impl EbpfExecutor {
             let record = EnforcementAuditRecord {
                 timestamp_ns: now_ns(),
                 decision_id: decision.map(|d| d.id.clone()).unwrap_or_default(),
-                rule_id: decision.map(|d| d.rule_id.clone()).unwrap_or_default(),
+                rule_id: decision.map(|d| d.rule_id.to_string()).unwrap_or_default(),
                 action_type: decision.map(|d| d.action).unwrap_or(ActionType::Allow),
                 entity_key,
                 target: decision
@@ -3,24 +3,35 @@
 //! This is the core detection engine that coordinates event processing,
 // //! rule evaluation, alert generation, and enforcement actions.
 
+use kestrel_core::action::current_timestamp_ns;
+use kestrel_core::time::{coarse_monotonic_ns, monotonic_ns};
 use kestrel_core::{
-    ActionDecision, ActionExecutor, ActionPolicy, ActionTarget,
-    ActionType, Alert, AlertOutput, AlertOutputConfig, EventBus, EventBusConfig, EventEvidence,
-    NoOpExecutor, Severity,
+    ActionDecision, ActionExecutor, ActionPipeline, ActionPipelineConfig, ActionPipelineStats,
+    ActionPolicy, ActionReason, ActionTarget, ActionType, Alert, AlertOutput, AlertOutputConfig,
+    EngineMetrics, EpochCache, EpochCell, EventBus, EventBusConfig, EventEvidence, NoOpExecutor,
+    ObjectPool, ProfileSample, RuleMetrics, RuleProfiler, RuleProfilerConfig, Severity,
 };
 use kestrel_event::Event;
-use kestrel_nfa::{CompiledSequence, NfaEngine, NfaEngineConfig, PredicateEvaluator};
-use kestrel_rules::{Rule, RuleDefinition, RuleManager, Severity as RuleSeverity};
+use kestrel_nfa::{
+    CompiledSequence, NfaClock, NfaEngine, NfaEngineConfig, PredicateEvaluator, SequenceAlert,
+    SequenceProfiler, SequenceSet, SequenceSwap,
+};
+use kestrel_rules::{Rule, RuleChanges, RuleDefinition, RuleManager, Severity as RuleSeverity};
 use kestrel_schema::SchemaRegistry;
+use std::collections::HashSet;
+use std::sync::atomic::AtomicBool;
 use std::sync::Arc;
 use thiserror::Error;
 use tokio::time::Duration;
 use tracing::{debug, error, info, warn};
 
 #[cfg(feature = "wasm")]
-use kestrel_eql::{EqlCompiler, IrRuleType};
+use kestrel_eql::{EqlCompiler, IrLiteralSet, IrRuleType};
 #[cfg(feature = "wasm")]
-use kestrel_runtime_wasm::{WasmConfig, WasmEngine};
+use kestrel_runtime_wasm::{
+    EvaluationId, FieldRegex, LiteralSetTable, PredicateTables, PreparedPredicate, WasmConfig,
+    WasmEngine,
+};
 
 // Runtime abstraction layer
 pub mod runtime;
@@ -34,6 +45,10 @@ pub use runtime::WasmRuntimeAdapter;
 #[cfg(feature = "lua")]
 pub use runtime::LuaRuntimeAdapter;
 
+// Sequence matching on thread-per-core EventBus partitions
+pub mod partition;
+pub use partition::NfaPartitionHandler;
+
 /// Engine operation mode
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
 pub enum EngineMode {
@@ -65,12 +80,22 @@ pub struct EngineConfig {
     /// Action executor for enforcement (optional, uses NoOpExecutor if None)
     pub action_executor: Option<Arc<dyn ActionExecutor>>,
 
+    /// Batch, deduplicate and execute actions off the detection path
+    /// (None = execute each action inline while evaluating the event)
+    pub action_pipeline: Option<ActionPipelineConfig>,
+
     /// Wasm runtime configuration (optional)
     #[cfg(feature = "wasm")]
     pub wasm_config: Option<WasmConfig>,
 
     /// NFA engine configuration
     pub nfa_config: Option<NfaEngineConfig>,
+
+    /// Worker threads used to compile rule packs (0 = one per available core)
+    pub compile_threads: usize,
+
+    /// Per-rule cost profiler and kill switch configuration
+    pub profiler: RuleProfilerConfig,
 }
 
 impl Default for EngineConfig {
@@ -81,9 +106,12 @@ impl Default for EngineConfig {
             rules_dir: std::path::PathBuf::from("./rules"),
             mode: EngineMode::Detect,
             action_executor: None,
+            action_pipeline: None,
             #[cfg(feature = "wasm")]
             wasm_config: None,
             nfa_config: Some(NfaEngineConfig::default()),
+            compile_threads: 0,
+            profiler: RuleProfilerConfig::default(),
         }
     }
 }
@@ -91,8 +119,8 @@ impl Default for EngineConfig {
 /// Single-event rule with compiled predicate
 #[derive(Debug, Clone)]
 pub struct SingleEventRule {
-    pub rule_id: String,
-    pub rule_name: String,
+    pub rule_id: Arc<str>,
+    pub rule_name: Arc<str>,
     pub event_type: u16,
     pub severity: Severity,
     pub description: Option<String>,
@@ -101,14 +129,22 @@ pub struct SingleEventRule {
     pub blockable: bool,
     /// Action to take when rule matches (None = alert only)
     pub action_type: Option<ActionType>,
+    /// The rule's kill switch in the engine's `RuleProfiler`
+    pub kill_switch: Arc<AtomicBool>,
+    /// The rule's entry in the engine's `EngineMetrics`
+    pub metrics: Arc<RuleMetrics>,
 }
 
 #[derive(Debug, Clone)]
 pub enum CompiledPredicate {
     #[cfg(feature = "wasm")]
     Wasm {
-        wasm_bytes: Vec<u8>,
+        /// Compiled once when the rule is, instantiated per evaluation
+        prepared: PreparedPredicate,
         required_fields: Vec<u32>,
+        /// Literal sets and field regexes the module references by index;
+        /// the regexes are merged into per-field sets at load
+        tables: PredicateTables,
     },
     #[cfg(feature = "lua")]
     Lua {
@@ -129,15 +165,39 @@ fn rule_severity_to_severity(severity: RuleSeverity) -> Severity {
     }
 }
 
+/// Whether a rule with `action` enforces on events in inline mode
+#[cfg(feature = "wasm")]
+fn is_blockable(action: Option<ActionType>) -> bool {
+    matches!(action, Some(action) if action != ActionType::Alert)
+}
+
 /// Determine action target from event
 fn determine_action_target(event: &Event) -> ActionTarget {
     // For now, use a simple default target based on entity key
     // In a full implementation, this would extract PID and executable from event fields
     let pid = (event.entity_key & 0xFFFFFFFF) as u32;
-    let executable = format!("entity_{}", event.entity_key);
 
-    // Default to process execution target
-    ActionTarget::ProcessExec { pid, executable }
+    // Default to process execution target; the decision carries the entity
+    // key, so the executable is left unknown rather than formatted from it
+    ActionTarget::ProcessExec {
+        pid,
+        executable: String::new(),
+    }
+}
+
+/// Reports sampled NFA sequence costs to the engine's rule profiler
+struct NfaRuleProfiler<'a>(&'a RuleProfiler);
+
+impl SequenceProfiler for NfaRuleProfiler<'_> {
+    type Sample = ProfileSample;
+
+    fn begin(&self) -> Option<ProfileSample> {
+        self.0.begin()
+    }
+
+    fn end(&self, sequence_id: &str, sample: ProfileSample, partial_match_bytes: usize) {
+        self.0.end(sequence_id, sample, partial_match_bytes);
+    }
 }
 
 /// Detection engine
@@ -153,17 +213,34 @@ pub struct DetectionEngine {
     /// Action executor for enforcement
     action_executor: Arc<dyn ActionExecutor>,
 
+    /// Asynchronous executor in front of `action_executor`, if configured
+    action_pipeline: Option<ActionPipeline>,
+
     #[cfg(feature = "wasm")]
     wasm_engine: Option<Arc<WasmEngine>>,
 
-    #[cfg(feature = "wasm")]
-    eql_compiler: std::sync::Mutex<Option<EqlCompiler>>,
+    /// Worker threads used by `compile_rules`
+    #[cfg_attr(not(feature = "wasm"), allow(dead_code))]
+    compile_threads: usize,
 
     /// NFA engine for sequence detection
     nfa_engine: Option<NfaEngine>,
 
-    /// Compiled single-event rules
-    single_event_rules: Arc<tokio::sync::RwLock<Vec<SingleEventRule>>>,
+    /// Recycled buffers the NFA engine writes sequence alerts into
+    sequence_alert_buffers: ObjectPool<Vec<SequenceAlert>>,
+
+    /// Sampled per-rule costs and kill switches
+    rule_profiler: Arc<RuleProfiler>,
+
+    /// Compiled single-event rules, swapped as a whole on recompilation
+    single_event_rules: Arc<EpochCell<Vec<SingleEventRule>>>,
+
+    /// This engine's view of `single_event_rules`, refreshed on swaps
+    #[cfg_attr(not(feature = "wasm"), allow(dead_code))]
+    single_event_rules_cache: EpochCache<Vec<SingleEventRule>>,
+
+    /// Event types loaded sequences protect from overload shedding
+    sequence_event_types: HashSet<u16>,
 
     /// Alert counter (atomic for thread safety)
     alerts_generated: Arc<std::sync::atomic::AtomicU64>,
@@ -173,6 +250,9 @@ pub struct DetectionEngine {
 
     /// Error counter for tracking engine errors (atomic for thread safety)
     errors_count: Arc<std::sync::atomic::AtomicU64>,
+
+    /// Event latencies and per-rule evaluation times
+    metrics: Arc<EngineMetrics>,
 }
 
 impl DetectionEngine {
@@ -205,16 +285,14 @@ impl DetectionEngine {
         let stats = rule_manager.load_all().await?;
         info!(loaded = stats.loaded, failed = stats.failed, "Rules loaded");
 
-        // Initialize EQL compiler if Wasm is enabled
-        #[cfg(feature = "wasm")]
-        let eql_compiler = std::sync::Mutex::new(if config.wasm_config.is_some() {
-            Some(EqlCompiler::new(schema.clone()))
+        // Resolve rule compilation parallelism
+        let compile_threads = if config.compile_threads == 0 {
+            std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(1)
         } else {
-            None
-        });
-
-        #[cfg(not(feature = "wasm"))]
-        let eql_compiler = std::sync::Mutex::new(None);
+            config.compile_threads
+        };
 
         // Initialize Wasm engine if configured
         #[cfg(feature = "wasm")]
@@ -242,7 +320,10 @@ impl DetectionEngine {
             let predicate_evaluator = None;
 
             if let Some(evaluator) = predicate_evaluator {
-                let engine = NfaEngine::new(nfa_config, evaluator);
+                let engine = NfaEngine::new(nfa_config, evaluator).with_clock(NfaClock {
+                    precise_ns: monotonic_ns,
+                    coarse_ns: coarse_monotonic_ns,
+                });
                 info!("NFA engine initialized");
                 Some(engine)
             } else {
@@ -253,12 +334,15 @@ impl DetectionEngine {
             None
         };
 
-        let single_event_rules = Arc::new(tokio::sync::RwLock::new(Vec::new()));
+        let single_event_rules = Arc::new(EpochCell::new(Vec::new()));
 
         // Initialize action executor
         let action_executor = config
             .action_executor
             .unwrap_or_else(|| Arc::new(NoOpExecutor::default()) as Arc<dyn ActionExecutor>);
+        let action_pipeline = config
+            .action_pipeline
+            .map(|pipeline| ActionPipeline::new(action_executor.clone(), pipeline));
 
         // Log the engine mode
         info!(mode = ?config.mode, "Detection engine mode");
@@ -270,15 +354,20 @@ impl DetectionEngine {
             schema,
             mode: config.mode,
             action_executor,
+            action_pipeline,
             #[cfg(feature = "wasm")]
             wasm_engine,
-            #[cfg(feature = "wasm")]
-            eql_compiler,
+            compile_threads,
             nfa_engine,
+            sequence_alert_buffers: ObjectPool::new(1, 4),
+            rule_profiler: Arc::new(RuleProfiler::new(config.profiler)),
+            single_event_rules_cache: EpochCache::new(&single_event_rules),
             single_event_rules,
+            sequence_event_types: HashSet::new(),
             alerts_generated: Arc::new(std::sync::atomic::AtomicU64::new(0)),
             actions_generated: Arc::new(std::sync::atomic::AtomicU64::new(0)),
             errors_count: Arc::new(std::sync::atomic::AtomicU64::new(0)),
+            metrics: Arc::new(EngineMetrics::new()),
         })
     }
 
@@ -287,86 +376,52 @@ impl DetectionEngine {
         &self.rule_manager
     }
 
-    /// Compile and register a single-event rule
-    #[cfg(feature = "wasm")]
-    pub async fn compile_single_event_rule(&self, rule: &Rule) -> Result<(), EngineError> {
-        let mut compiler_guard = self
-            .eql_compiler
-            .lock()
-            .map_err(|e| EngineError::WasmRuntimeError(format!("Mutex lock error: {}", e)))?;
+    /// Action pipeline counters and detect-to-enforce latencies, if the
+    /// pipeline is enabled
+    pub fn action_pipeline_stats(&self) -> Option<&Arc<ActionPipelineStats>> {
+        self.action_pipeline.as_ref().map(ActionPipeline::stats)
+    }
 
-        let compiler = match &mut *compiler_guard {
-            Some(c) => c,
-            None => {
-                return Err(EngineError::WasmRuntimeError(
-                    "EQL compiler not initialized".to_string(),
-                ))
-            }
-        };
+    /// Engine metrics, including event latencies and per-rule evaluation times
+    pub fn metrics(&self) -> &Arc<EngineMetrics> {
+        &self.metrics
+    }
 
-        let _wasm_engine = match &self.wasm_engine {
-            Some(e) => e,
-            None => {
-                return Err(EngineError::WasmRuntimeError(
-                    "Wasm engine not initialized".to_string(),
-                ))
-            }
-        };
+    /// Get the per-rule cost profiler
+    pub fn rule_profiler(&self) -> &Arc<RuleProfiler> {
+        &self.rule_profiler
+    }
 
-        let definition = match &rule.definition {
-            RuleDefinition::Eql(eql) => eql.clone(),
-            RuleDefinition::Wasm(_) => return Ok(()),
-            RuleDefinition::Lua(_) => return Ok(()),
-        };
+    /// Stop evaluating a rule (single-event or sequence) until re-enabled
+    pub fn disable_rule(&self, rule_id: &str, reason: &str) {
+        warn!(rule_id, reason, "Rule disabled");
+        self.rule_profiler.disable(rule_id, reason);
+    }
 
-        let ir = compiler
-            .compile_to_ir(&definition)
-            .map_err(|e| EngineError::WasmRuntimeError(format!("EQL compilation error: {}", e)))?;
-
-        match &ir.rule_type {
-            IrRuleType::Event { event_type } => {
-                let event_type_id = self.schema.get_event_type_id(event_type).ok_or_else(|| {
-                    EngineError::WasmRuntimeError(format!(
-                        "Event type '{}' not registered in schema",
-                        event_type
-                    ))
-                })?;
-
-                let predicate = ir.predicates.get("main").ok_or_else(|| {
-                    EngineError::WasmRuntimeError("No main predicate found".to_string())
-                })?;
-
-                let required_fields: Vec<u32> = predicate.required_fields.clone();
-
-                let wasm_bytes = compiler.compile_to_wasm(&definition).map_err(|e| {
-                    EngineError::WasmRuntimeError(format!("Wasm compilation error: {}", e))
-                })?;
-
-                let wasm_bytes = wat::parse_str(&wasm_bytes).map_err(|e| {
-                    EngineError::WasmRuntimeError(format!("WAT parsing error: {}", e))
-                })?;
-
-                let single_rule = SingleEventRule {
-                    rule_id: rule.metadata.id.clone(),
-                    rule_name: rule.metadata.name.clone(),
-                    event_type: event_type_id,
-                    severity: rule_severity_to_severity(rule.metadata.severity),
-                    description: rule.metadata.description.clone(),
-                    predicate: CompiledPredicate::Wasm {
-                        wasm_bytes,
-                        required_fields,
-                    },
-                    blockable: false,  // Default to non-blockable for now
-                    action_type: None, // Default to alert-only for now
-                };
+    /// Resume evaluating a rule switched off by `disable_rule` or the profiler
+    pub fn enable_rule(&self, rule_id: &str) {
+        info!(rule_id, "Rule enabled");
+        self.rule_profiler.enable(rule_id);
+    }
+
+    /// Compile and register a single-event rule
+    #[cfg(feature = "wasm")]
+    pub async fn compile_single_event_rule(&self, rule: &Rule) -> Result<(), EngineError> {
+        let wasm_engine = self.wasm_engine.as_ref().ok_or_else(|| {
+            EngineError::WasmRuntimeError("EQL compiler not initialized".to_string())
+        })?;
 
-                let mut rules = self.single_event_rules.write().await;
+        let mut compiler = EqlCompiler::new(self.schema.clone());
+        if let Some(mut single_rule) =
+            compile_eql_rule(&mut compiler, &self.schema, wasm_engine, rule)?
+        {
+            self.attach_rule_state(std::slice::from_mut(&mut single_rule));
+            self.single_event_rules.try_update(|rules| {
                 rules.push(single_rule);
-                info!(rule_id = %rule.metadata.id, "Compiled single-event rule");
-            }
-            IrRuleType::Sequence { .. } => {
-                info!(rule_id = %rule.metadata.id, "Skipping sequence rule (handled by NFA engine)");
-            }
+                self.register_field_regexes(rules)?;
+                self.prioritize_blockable(rules);
+                Ok::<_, EngineError>(())
+            })?;
         }
 
         Ok(())
@@ -378,36 +433,230 @@ impl DetectionEngine {
     }
 
     /// Compile all loaded rules into single-event and sequence rules
+    ///
+    /// Rules are parsed, analyzed and code-generated in parallel on
+    /// `compile_threads` dedicated threads, each with its own `EqlCompiler`.
+    /// The resulting table replaces the current single-event rules in one
+    /// atomic swap: evaluation never waits on the reload, and events already
+    /// in flight finish against the table they started with. On error the
+    /// current table is left untouched.
     pub async fn compile_rules(&self) -> Result<(), EngineError> {
         info!("Compiling rules");
 
         let rule_ids = self.rule_manager.list_rules().await;
-
+        let mut rules = Vec::with_capacity(rule_ids.len());
         for rule_id in rule_ids {
             if let Some(rule) = self.rule_manager.get_rule(&rule_id).await {
-                self.compile_single_event_rule(&rule).await?;
+                rules.push(rule);
+            }
+        }
+
+        #[cfg(feature = "wasm")]
+        let mut compiled = {
+            let threads = self.compile_threads;
+            let start = std::time::Instant::now();
+            let rule_count = rules.len();
+            let compiled = self.compile_pack(rules, threads).await?;
+
+            debug!(
+                rules = rule_count,
+                threads,
+                elapsed_ms = start.elapsed().as_millis() as u64,
+                "Rule pack compiled"
+            );
+
+            self.register_field_regexes(&compiled)?;
+            compiled
+        };
+
+        #[cfg(not(feature = "wasm"))]
+        let mut compiled: Vec<SingleEventRule> = {
+            drop(rules);
+            Vec::new()
+        };
+
+        let count = compiled.len();
+        self.attach_rule_state(&mut compiled);
+        self.prioritize_blockable(&compiled);
+        self.single_event_rules.store(Arc::new(compiled));
+        info!(
+            count,
+            epoch = self.single_event_rules.epoch(),
+            "Single-event rules compiled"
+        );
+
+        Ok(())
+    }
+
+    /// Recompile only the rules a reload touched
+    ///
+    /// Updated rules are compiled off the event path and, together with the
+    /// untouched compiled rules, replace the table in one atomic swap;
+    /// removed rules drop out of it. On error the current table is left
+    /// untouched.
+    pub async fn apply_rule_changes(&self, changes: &RuleChanges) -> Result<(), EngineError> {
+        if changes.is_empty() {
+            return Ok(());
+        }
+
+        let mut rules = Vec::with_capacity(changes.updated.len());
+        for rule_id in &changes.updated {
+            if let Some(rule) = self.rule_manager.get_rule(rule_id).await {
+                rules.push(rule);
             }
         }
 
-        let count = self.single_event_rules.read().await.len();
-        info!(count, "Single-event rules compiled");
+        #[cfg(feature = "wasm")]
+        let mut compiled = {
+            let threads = self.compile_threads.min(rules.len()).max(1);
+            self.compile_pack(rules, threads).await?
+        };
+
+        #[cfg(not(feature = "wasm"))]
+        let mut compiled: Vec<SingleEventRule> = {
+            drop(rules);
+            Vec::new()
+        };
+
+        self.attach_rule_state(&mut compiled);
+
+        // Merge under the cell's writer lock so concurrent changes are kept
+        let mut count = 0;
+        let epoch = self.single_event_rules.try_update(|table| {
+            table.retain(|rule| {
+                let listed = |ids: &[String]| ids.iter().any(|id| **id == *rule.rule_id);
+                !listed(&changes.updated) && !listed(&changes.removed)
+            });
+            table.extend(compiled);
+
+            #[cfg(feature = "wasm")]
+            self.register_field_regexes(table)?;
+
+            self.prioritize_blockable(table);
+            count = table.len();
+            Ok::<_, EngineError>(())
+        })?;
+        info!(
+            updated = changes.updated.len(),
+            removed = changes.removed.len(),
+            count,
+            epoch,
+            "Single-event rules updated"
+        );
 
         Ok(())
     }
 
+    /// Compile `rules` on `threads` blocking workers, keeping the
+    /// single-event EQL rules
+    #[cfg(feature = "wasm")]
+    async fn compile_pack(
+        &self,
+        rules: Vec<Rule>,
+        threads: usize,
+    ) -> Result<Vec<SingleEventRule>, EngineError> {
+        let wasm_engine = match &self.wasm_engine {
+            Some(wasm_engine) => wasm_engine.clone(),
+            None if rules.is_empty() => return Ok(Vec::new()),
+            None => {
+                return Err(EngineError::WasmRuntimeError(
+                    "EQL compiler not initialized".to_string(),
+                ))
+            }
+        };
+
+        let schema = self.schema.clone();
+        let results = tokio::task::spawn_blocking(move || {
+            compile_rules_parallel(&schema, &wasm_engine, &rules, threads)
+        })
+        .await
+        .map_err(|e| {
+            EngineError::WasmRuntimeError(format!("Rule compilation task failed: {}", e))
+        })?;
+
+        let mut compiled = Vec::with_capacity(results.len());
+        for result in results {
+            if let Some(single_rule) = result? {
+                compiled.push(single_rule);
+            }
+        }
+        Ok(compiled)
+    }
+
+    /// Rebuild the per-field regex sets from every field regex in `rules`
+    ///
+    /// Regex sets span the whole table, so this runs whenever it changes.
+    #[cfg(feature = "wasm")]
+    fn register_field_regexes(&self, rules: &[SingleEventRule]) -> Result<(), EngineError> {
+        let wasm_engine = match &self.wasm_engine {
+            Some(wasm_engine) => wasm_engine,
+            None => return Ok(()),
+        };
+
+        let patterns = rules
+            .iter()
+            .filter_map(|rule| match &rule.predicate {
+                CompiledPredicate::Wasm { tables, .. } => Some(tables.field_regexes.iter()),
+                _ => None,
+            })
+            .flatten()
+            .map(|regex| (regex.field_id(), regex.pattern().to_string()));
+        wasm_engine
+            .register_field_regexes(patterns)
+            .map_err(|e| EngineError::WasmRuntimeError(e.to_string()))?;
+        Ok(())
+    }
+
+    /// Point each rule at its kill switch and its metrics
+    fn attach_rule_state(&self, rules: &mut [SingleEventRule]) {
+        for rule in rules {
+            rule.kill_switch = self.rule_profiler.kill_switch(&rule.rule_id);
+            rule.metrics = self.metrics.rule_metrics(&rule.rule_id);
+        }
+    }
+
+    /// Route the event types of blockable rules through the EventBus
+    /// high-priority lane, so enforcement decisions skip bulk batching
+    ///
+    /// `rules` is the whole single-event table: the lane assignment is
+    /// rebuilt from it, so types no longer inspected by a blockable rule go
+    /// back to the normal lane. Only applies in inline mode, where blockable
+    /// rules act on events.
+    fn prioritize_blockable(&self, rules: &[SingleEventRule]) {
+        if self.mode != EngineMode::Inline {
+            return;
+        }
+
+        let event_types: Vec<u16> = rules
+            .iter()
+            .filter(|rule| rule.blockable)
+            .map(|rule| rule.event_type)
+            .collect();
+        self.event_bus
+            .handle()
+            .set_high_priority_event_types(&event_types);
+    }
+
     /// Get engine statistics
     pub async fn stats(&self) -> EngineStats {
         let rule_count = self.rule_manager.rule_count().await;
         let alerts_generated = self
             .alerts_generated
             .load(std::sync::atomic::Ordering::Relaxed);
+        // Pipelined actions count once they have executed
         let actions_generated = self
             .actions_generated
-            .load(std::sync::atomic::Ordering::Relaxed);
+            .load(std::sync::atomic::Ordering::Relaxed)
+            + self.action_pipeline.as_ref().map_or(0, |pipeline| {
+                pipeline
+                    .stats()
+                    .executed
+                    .load(std::sync::atomic::Ordering::Relaxed)
+            });
         let errors_count = self
             .errors_count
             .load(std::sync::atomic::Ordering::Relaxed);
-        let single_event_rule_count = self.single_event_rules.read().await.len();
+        let single_event_rule_count = self.single_event_rules.load().len();
 
         EngineStats {
             rule_count,
@@ -418,6 +667,64 @@ impl DetectionEngine {
         }
     }
 
+    /// Execute an inline decision, through the action pipeline if one is
+    /// configured
+    ///
+    /// Blocks always run here: the blocked operation may only resume once
+    /// the block is in place. A decision the pipeline cannot take is
+    /// executed here as well rather than dropped.
+    #[cfg(feature = "wasm")]
+    fn enforce(&self, decision: ActionDecision) {
+        let decision = match &self.action_pipeline {
+            Some(pipeline) if decision.action != ActionType::Block => {
+                match pipeline.try_submit(decision) {
+                    Ok(()) => return,
+                    Err(e) => {
+                        debug!(error = %e, "Executing action inline");
+                        e.into_decision()
+                    }
+                }
+            }
+            _ => decision,
+        };
+
+        match self.action_executor.execute(&decision) {
+            Ok(result) if result.success => {
+                self.actions_generated
+                    .fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+                debug!(
+                    action_id = %decision.id,
+                    action = ?decision.action,
+                    "Action executed successfully"
+                );
+            }
+            Ok(result) => {
+                debug!(
+                    action_id = %decision.id,
+                    action = ?decision.action,
+                    error = %result.error.as_deref().unwrap_or(""),
+                    "Action not executed (executor decision)"
+                );
+            }
+            Err(e) => {
+                error!(
+                    action_id = %decision.id,
+                    action = ?decision.action,
+                    error = %e,
+                    "Action execution failed"
+                );
+            }
+        }
+    }
+
+    /// Count an alert `event` completed for a rule and the engine
+    fn record_alert(&self, rule: &RuleMetrics, event: &Event) {
+        rule.record_alert();
+        self.metrics.record_alert();
+        self.metrics
+            .record_alert_latency(current_timestamp_ns().saturating_sub(event.ts_wall_ns));
+    }
+
     /// Start the detection engine's event processing loop
     /// This method subscribes to the event bus and processes events in the background.
     /// Returns immediately after starting the event loop.
@@ -454,12 +761,17 @@ impl DetectionEngine {
         );
 
         let mut alerts = Vec::new();
+        self.metrics.record_event_processed();
+        self.metrics
+            .record_queue_delay(current_timestamp_ns().saturating_sub(event.ts_wall_ns));
 
         // Evaluate against NFA engine (sequence rules)
         if let Some(ref mut nfa_engine) = self.nfa_engine {
-            match nfa_engine.process_event(event) {
-                Ok(sequence_alerts) => {
-                    for seq_alert in sequence_alerts {
+            let mut sequence_alerts = self.sequence_alert_buffers.acquire();
+            let profiler = NfaRuleProfiler(&self.rule_profiler);
+            match nfa_engine.process_event_profiled(event, &mut sequence_alerts, &profiler) {
+                Ok(()) => {
+                    for seq_alert in sequence_alerts.drain(..) {
                         // Convert events to EventEvidence
                         let events: Vec<EventEvidence> = seq_alert
                             .events
@@ -500,6 +812,7 @@ impl DetectionEngine {
                         // Increment alert counter
                         self.alerts_generated
                             .fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+                        self.record_alert(&self.metrics.rule_metrics(&seq_alert.rule_id), event);
                     }
                 }
                 Err(e) => {
@@ -513,25 +826,35 @@ impl DetectionEngine {
         // Evaluate single-event rules
         #[cfg(feature = "wasm")]
         {
-            let rules = self.single_event_rules.read().await;
+            let rules = self
+                .single_event_rules_cache
+                .get(&self.single_event_rules)
+                .clone();
             let wasm_engine = match &self.wasm_engine {
                 Some(e) => e,
                 None => return Ok(alerts),
             };
+            // All rules share the event's cached regex set results
+            let evaluation = EvaluationId::next();
 
             for single_rule in rules.iter() {
                 // Check if event type matches
-                if single_rule.event_type != event.event_type_id {
+                if single_rule.event_type != event.event_type_id
+                    || single_rule
+                        .kill_switch
+                        .load(std::sync::atomic::Ordering::Relaxed)
+                {
                     continue;
                 }
 
                 // Evaluate predicate
+                let started = std::time::Instant::now();
+                let sample = self.rule_profiler.begin();
                 let matched = match &single_rule.predicate {
                     CompiledPredicate::Wasm {
-                        wasm_bytes,
-                        required_fields: _,
+                        prepared, tables, ..
                     } => {
-                        self.eval_wasm_predicate(wasm_engine, wasm_bytes, event)
+                        self.eval_wasm_predicate(wasm_engine, prepared, tables, evaluation, event)
                             .await?
                     }
                     CompiledPredicate::AlwaysMatch => true,
@@ -540,14 +863,20 @@ impl DetectionEngine {
                     #[cfg(not(feature = "wasm"))]
                     CompiledPredicate::Lua { .. } => false,
                 };
+                if let Some(sample) = sample {
+                    self.rule_profiler.end(&single_rule.rule_id, sample, 0);
+                }
+                single_rule
+                    .metrics
+                    .record_evaluation(started.elapsed().as_nanos() as u64);
 
                 if matched {
                     let alert_id = format!("{}-{}", single_rule.rule_id, event.ts_mono_ns);
 
                     let alert = Alert {
                         id: alert_id.clone(),
-                        rule_id: single_rule.rule_id.clone(),
-                        rule_name: single_rule.rule_name.clone(),
+                        rule_id: single_rule.rule_id.to_string(),
+                        rule_name: single_rule.rule_name.to_string(),
                         severity: single_rule.severity,
                         title: format!("Single-event rule matched: {}", single_rule.rule_name),
                         description: single_rule.description.clone(),
@@ -559,12 +888,14 @@ impl DetectionEngine {
                         }],
                         context: serde_json::json!({
                             "rule_type": "single_event",
+                            "entity_key": event.entity_key,
                         }),
                     };
                     alerts.push(alert);
 
                     self.alerts_generated
                         .fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+                    self.record_alert(&single_rule.metrics, event);
 
                     // In Inline mode, execute action if rule is blockable
                     if self.mode == EngineMode::Inline && single_rule.blockable {
@@ -574,37 +905,12 @@ impl DetectionEngine {
                                 action_type,
                                 ActionPolicy::Inline,
                                 determine_action_target(event),
-                                format!("Rule matched: {}", single_rule.rule_name),
+                                ActionReason::RuleMatched(single_rule.rule_name.clone()),
                                 vec![],
-                            );
-
-                            match self.action_executor.execute(&decision) {
-                                Ok(result) if result.success => {
-                                    self.actions_generated
-                                        .fetch_add(1, std::sync::atomic::Ordering::Relaxed);
-                                    debug!(
-                                        action_id = %decision.id,
-                                        action = ?action_type,
-                                        "Action executed successfully"
-                                    );
-                                }
-                                Ok(result) => {
-                                    debug!(
-                                        action_id = %decision.id,
-                                        action = ?action_type,
-                                        error = %result.error.as_deref().unwrap_or(""),
-                                        "Action not executed (executor decision)"
-                                    );
-                                }
-                                Err(e) => {
-                                    error!(
-                                        action_id = %decision.id,
-                                        action = ?action_type,
-                                        error = %e,
-                                        "Action execution failed"
-                                    );
-                                }
-                            }
+                            )
+                            .with_entity_key(event.entity_key);
+
+                            self.enforce(decision);
                         }
                     }
                 }
@@ -618,24 +924,265 @@ impl DetectionEngine {
     async fn eval_wasm_predicate(
         &self,
         wasm_engine: &WasmEngine,
-        wasm_bytes: &[u8],
+        prepared: &PreparedPredicate,
+        tables: &PredicateTables,
+        evaluation: EvaluationId,
         event: &Event,
     ) -> Result<bool, EngineError> {
         wasm_engine
-            .eval_adhoc_predicate(wasm_bytes, event)
+            .eval_prepared_predicate(prepared, tables, evaluation, event)
             .await
             .map_err(|e| EngineError::WasmRuntimeError(e.to_string()))
     }
 
     /// Load a compiled sequence into the NFA engine
-    pub fn load_sequence(&mut self, sequence: CompiledSequence) -> Result<(), EngineError> {
+    ///
+    /// The sequence's event types are exempt from overload shedding, since a
+    /// dropped step would silently break the match.
+    pub fn load_sequence(&mut self, mut sequence: CompiledSequence) -> Result<(), EngineError> {
         if let Some(ref mut nfa_engine) = self.nfa_engine {
+            let kill_switch = self.rule_profiler.kill_switch(&sequence.id);
+            sequence.sequence.set_kill_switch(kill_switch);
+            let steps = &sequence.sequence.steps;
+            let event_types: Vec<u16> = steps
+                .iter()
+                .chain(sequence.sequence.until_step.as_deref())
+                .map(|step| step.event_type_id)
+                .collect();
+
             nfa_engine
                 .load_sequence(sequence)
                 .map_err(|e| EngineError::NfaError(e.to_string()))?;
+            self.event_bus.handle().protect_event_types(&event_types);
+            self.sequence_event_types.extend(event_types);
         }
         Ok(())
     }
+
+    /// Build a sequence set for `swap_sequences` on a blocking thread
+    ///
+    /// Borrows no engine, so events keep being evaluated while the set is
+    /// built. Each sequence is wired to its kill switch in `profiler`.
+    pub async fn prepare_sequences(
+        profiler: Arc<RuleProfiler>,
+        sequences: Vec<CompiledSequence>,
+    ) -> Result<PreparedSequences, EngineError> {
+        tokio::task::spawn_blocking(move || {
+            let mut sequences = sequences;
+            let mut event_types = HashSet::new();
+            for compiled in &mut sequences {
+                let sequence = &mut compiled.sequence;
+                sequence.set_kill_switch(profiler.kill_switch(&compiled.id));
+                event_types.extend(
+                    sequence
+                        .steps
+                        .iter()
+                        .chain(sequence.until_step.as_deref())
+                        .map(|step| step.event_type_id),
+                );
+            }
+            PreparedSequences {
+                set: SequenceSet::build(sequences),
+                event_types,
+            }
+        })
+        .await
+        .map_err(|e| EngineError::NfaError(format!("Sequence set build failed: {}", e)))
+    }
+
+    /// Replace all loaded sequences with a set from `prepare_sequences`
+    ///
+    /// Partial matches of sequences whose definition is unchanged carry
+    /// over; those of changed and removed sequences are reclaimed lazily by
+    /// the NFA engine. Event types no remaining sequence needs become
+    /// sheddable again.
+    pub fn swap_sequences(
+        &mut self,
+        prepared: PreparedSequences,
+    ) -> Result<SequenceSwap, EngineError> {
+        let nfa_engine = match self.nfa_engine.as_mut() {
+            Some(nfa_engine) => nfa_engine,
+            None => return Ok(SequenceSwap::default()),
+        };
+
+        let swap = nfa_engine
+            .swap_sequences(prepared.set)
+            .map_err(|e| EngineError::NfaError(e.to_string()))?;
+
+        let handle = self.event_bus.handle();
+        let needed: Vec<u16> = prepared.event_types.iter().copied().collect();
+        handle.protect_event_types(&needed);
+        let released: Vec<u16> = self
+            .sequence_event_types
+            .difference(&prepared.event_types)
+            .copied()
+            .collect();
+        handle.unprotect_event_types(&released);
+        self.sequence_event_types = prepared.event_types;
+
+        info!(
+            kept = swap.kept,
+            added = swap.added,
+            changed = swap.changed,
+            removed = swap.removed,
+            "Sequence rules swapped"
+        );
+
+        Ok(swap)
+    }
+
+    /// Number of times the single-event rule table has been replaced
+    pub fn rule_set_epoch(&self) -> u64 {
+        self.single_event_rules.epoch()
+    }
+}
+
+/// Sequence set built by `DetectionEngine::prepare_sequences`
+#[derive(Debug)]
+pub struct PreparedSequences {
+    set: SequenceSet,
+    /// Event types the set's steps and until conditions match
+    event_types: HashSet<u16>,
+}
+
+/// Compile one EQL rule: parse, semantic analysis, codegen, WAT assembly
+/// and Wasm compilation against `wasm_engine`
+///
+/// Returns `None` for rules that are not single-event EQL rules (sequences
+/// are handled by the NFA engine, Wasm/Lua rules are loaded directly).
+#[cfg(feature = "wasm")]
+fn compile_eql_rule(
+    compiler: &mut EqlCompiler,
+    schema: &SchemaRegistry,
+    wasm_engine: &WasmEngine,
+    rule: &Rule,
+) -> Result<Option<SingleEventRule>, EngineError> {
+    let definition = match &rule.definition {
+        RuleDefinition::Eql(eql) => eql,
+        RuleDefinition::Wasm(_) => return Ok(None),
+        RuleDefinition::Lua(_) => return Ok(None),
+    };
+
+    let (ir, wat) = compiler
+        .compile_to_ir_and_wasm(definition)
+        .map_err(|e| EngineError::WasmRuntimeError(format!("EQL compilation error: {}", e)))?;
+
+    match &ir.rule_type {
+        IrRuleType::Event { event_type } => {
+            let event_type_id = schema.get_event_type_id(event_type).ok_or_else(|| {
+                EngineError::WasmRuntimeError(format!(
+                    "Event type '{}' not registered in schema",
+                    event_type
+                ))
+            })?;
+
+            let predicate = ir.predicates.get("main").ok_or_else(|| {
+                EngineError::WasmRuntimeError("No main predicate found".to_string())
+            })?;
+
+            let required_fields: Vec<u32> = predicate.required_fields.clone();
+            let tables = PredicateTables {
+                literal_sets: ir
+                    .literal_sets()
+                    .into_iter()
+                    .map(literal_set_table)
+                    .collect(),
+                field_regexes: ir
+                    .field_regex_patterns()
+                    .into_iter()
+                    .map(|(field_id, pattern)| FieldRegex::new(field_id, pattern))
+                    .collect(),
+            };
+
+            let wasm_bytes = wat::parse_str(&wat).map_err(|e| {
+                EngineError::WasmRuntimeError(format!("WAT parsing error: {}", e))
+            })?;
+            let prepared = wasm_engine
+                .prepare_predicate(&wasm_bytes)
+                .map_err(|e| EngineError::WasmRuntimeError(e.to_string()))?;
+
+            info!(rule_id = %rule.metadata.id, "Compiled single-event rule");
+
+            Ok(Some(SingleEventRule {
+                rule_id: rule.metadata.id.as_str().into(),
+                rule_name: rule.metadata.name.as_str().into(),
+                event_type: event_type_id,
+                severity: rule_severity_to_severity(rule.metadata.severity),
+                description: rule.metadata.description.clone(),
+                predicate: CompiledPredicate::Wasm {
+                    prepared,
+                    required_fields,
+                    tables,
+                },
+                blockable: is_blockable(rule.metadata.action),
+                action_type: rule.metadata.action,
+                kill_switch: Default::default(),
+                metrics: Default::default(),
+            }))
+        }
+        IrRuleType::Sequence { .. } => {
+            info!(rule_id = %rule.metadata.id, "Skipping sequence rule (handled by NFA engine)");
+            Ok(None)
+        }
+    }
+}
+
+/// Convert an IR literal set into the runtime's lookup table
+#[cfg(feature = "wasm")]
+fn literal_set_table(set: &IrLiteralSet) -> LiteralSetTable {
+    match set {
+        IrLiteralSet::Int(ints) => LiteralSetTable::from_ints(ints.iter().copied()),
+        IrLiteralSet::String(strings) => {
+            LiteralSetTable::from_strings(strings.iter().map(String::as_str))
+        }
+    }
+}
+
+/// Compile a rule pack on `threads` scoped worker threads
+///
+/// Workers pull rule indices from a shared counter, so one expensive rule
+/// does not hold up a whole chunk. Each worker also compiles its rules'
+/// Wasm, so evaluation never does. Results are returned in input order.
+#[cfg(feature = "wasm")]
+fn compile_rules_parallel(
+    schema: &Arc<SchemaRegistry>,
+    wasm_engine: &WasmEngine,
+    rules: &[Rule],
+    threads: usize,
+) -> Vec<Result<Option<SingleEventRule>, EngineError>> {
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    let next = AtomicUsize::new(0);
+    let workers = threads.clamp(1, rules.len().max(1));
+
+    let mut indexed: Vec<(usize, Result<Option<SingleEventRule>, EngineError>)> =
+        std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut compiler = EqlCompiler::new(schema.clone());
+                        let mut out = Vec::new();
+                        loop {
+                            let idx = next.fetch_add(1, Ordering::Relaxed);
+                            let Some(rule) = rules.get(idx) else {
+                                break;
+                            };
+                            let result = compile_eql_rule(&mut compiler, schema, wasm_engine, rule);
+                            out.push((idx, result));
+                        }
+                        out
+                    })
+                })
+                .collect();
+
+            handles
+                .into_iter()
+                .flat_map(|h| h.join().expect("rule compile worker panicked"))
+                .collect()
+        });
+
+    indexed.sort_unstable_by_key(|(idx, _)| *idx);
+    indexed.into_iter().map(|(_, result)| result).collect()
 }
 
 /// Engine statistics
@@ -670,6 +1217,7 @@ pub enum EngineError {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use kestrel_core::EventPriority;
     use kestrel_event::Event;
     use tokio::time::Duration;
 
@@ -692,20 +1240,31 @@ mod tests {
         assert_eq!(stats.rule_count, 0);
     }
 
+    #[cfg(feature = "wasm")]
+    #[test]
+    fn test_rule_action_sets_blockable() {
+        assert!(!is_blockable(None));
+        assert!(!is_blockable(Some(ActionType::Alert)));
+        assert!(is_blockable(Some(ActionType::Block)));
+        assert!(is_blockable(Some(ActionType::Kill)));
+    }
+
     #[tokio::test]
     async fn test_single_event_rule_always_match() {
         let rule = SingleEventRule {
-            rule_id: "test-always-match".to_string(),
-            rule_name: "Test Always Match".to_string(),
+            rule_id: "test-always-match".into(),
+            rule_name: "Test Always Match".into(),
             event_type: 1,
             severity: Severity::Medium,
             description: Some("A test rule that always matches".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        assert_eq!(rule.rule_id, "test-always-match");
+        assert_eq!(&*rule.rule_id, "test-always-match");
         assert_eq!(rule.event_type, 1);
     }
 
@@ -754,20 +1313,22 @@ mod tests {
         let mut engine = DetectionEngine::new(config).await.unwrap();
 
         let rule = SingleEventRule {
-            rule_id: "test-always-match-rule".to_string(),
-            rule_name: "Test Always Match Rule".to_string(),
+            rule_id: "test-always-match-rule".into(),
+            rule_name: "Test Always Match Rule".into(),
             event_type: 1,
             severity: Severity::Medium,
             description: Some("A test rule that always matches".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: engine.metrics().rule_metrics("test-always-match-rule"),
         };
+        let rule_metrics = rule.metrics.clone();
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -782,6 +1343,63 @@ mod tests {
         assert_eq!(alerts.len(), 1);
         assert_eq!(alerts[0].rule_id, "test-always-match-rule");
         assert_eq!(alerts[0].severity, Severity::Medium);
+        assert_eq!(rule_metrics.get_eval_count(), 1);
+        assert_eq!(rule_metrics.get_alert_count(), 1);
+        assert_eq!(engine.metrics().event_to_alert_latency_ns.count(), 1);
+    }
+
+    #[tokio::test]
+    async fn test_rule_kill_switch_and_profile() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            #[cfg(feature = "wasm")]
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            profiler: RuleProfilerConfig {
+                sample_every: 1,
+                ..Default::default()
+            },
+            ..Default::default()
+        };
+        let mut engine = DetectionEngine::new(config).await.unwrap();
+
+        let rule = SingleEventRule {
+            rule_id: "noisy-rule".into(),
+            rule_name: "Noisy Rule".into(),
+            event_type: 1,
+            severity: Severity::Low,
+            description: None,
+            predicate: CompiledPredicate::AlwaysMatch,
+            blockable: false,
+            action_type: None,
+            kill_switch: engine.rule_profiler().kill_switch("noisy-rule"),
+            metrics: Default::default(),
+        };
+        engine.single_event_rules.update(|rules| rules.push(rule));
+
+        let event = Event::builder()
+            .event_type(1)
+            .ts_mono(1000)
+            .ts_wall(1000)
+            .entity_key(42)
+            .build()
+            .unwrap();
+
+        let alerts = engine.eval_event(&event).await.unwrap();
+        if cfg!(feature = "wasm") {
+            assert_eq!(alerts.len(), 1);
+            assert_eq!(engine.rule_profiler().top(1)[0].rule_id, "noisy-rule");
+        }
+
+        engine.disable_rule("noisy-rule", "too noisy");
+        assert!(engine.eval_event(&event).await.unwrap().is_empty());
+
+        engine.enable_rule("noisy-rule");
+        let alerts = engine.eval_event(&event).await.unwrap();
+        assert_eq!(alerts.len(), usize::from(cfg!(feature = "wasm")));
     }
 
     #[tokio::test]
@@ -809,20 +1427,21 @@ mod tests {
         let mut engine = DetectionEngine::new(config).await.unwrap();
 
         let rule = SingleEventRule {
-            rule_id: "test-type-match-rule".to_string(),
-            rule_name: "Test Type Match Rule".to_string(),
+            rule_id: "test-type-match-rule".into(),
+            rule_name: "Test Type Match Rule".into(),
             event_type: 99,
             severity: Severity::High,
             description: Some("A test rule for event type 99".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -862,44 +1481,49 @@ mod tests {
         let mut engine = DetectionEngine::new(config).await.unwrap();
 
         let rule1 = SingleEventRule {
-            rule_id: "test-rule-1".to_string(),
-            rule_name: "Test Rule 1".to_string(),
+            rule_id: "test-rule-1".into(),
+            rule_name: "Test Rule 1".into(),
             event_type: 1,
             severity: Severity::Low,
             description: Some("First test rule".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
         let rule2 = SingleEventRule {
-            rule_id: "test-rule-2".to_string(),
-            rule_name: "Test Rule 2".to_string(),
+            rule_id: "test-rule-2".into(),
+            rule_name: "Test Rule 2".into(),
             event_type: 1,
             severity: Severity::High,
             description: Some("Second test rule".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
         let rule3 = SingleEventRule {
-            rule_id: "test-rule-3".to_string(),
-            rule_name: "Test Rule 3".to_string(),
+            rule_id: "test-rule-3".into(),
+            rule_name: "Test Rule 3".into(),
             event_type: 2,
             severity: Severity::Critical,
             description: Some("Third test rule (different event type)".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,
             action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule1);
             rules.push(rule2);
             rules.push(rule3);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -949,20 +1573,35 @@ mod tests {
 
         // Create a blockable rule with Block action
         let rule = SingleEventRule {
-            rule_id: "test-blockable-rule".to_string(),
-            rule_name: "Test Blockable Rule".to_string(),
+            rule_id: "test-blockable-rule".into(),
+            rule_name: "Test Blockable Rule".into(),
             event_type: 1,
             severity: Severity::High,
             description: Some("A test rule that should trigger enforcement".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: true,
             action_type: Some(ActionType::Block),
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        // Blockable event types take the EventBus high-priority lane
+        engine.prioritize_blockable(std::slice::from_ref(&rule));
+        assert_eq!(
+            engine.event_bus.handle().event_priority(1),
+            EventPriority::High
+        );
+        // and go back to the normal lane once no blockable rule inspects them
+        engine.prioritize_blockable(&[]);
+        assert_eq!(
+            engine.event_bus.handle().event_priority(1),
+            EventPriority::Normal
+        );
+        engine.prioritize_blockable(std::slice::from_ref(&rule));
+
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -985,6 +1624,72 @@ mod tests {
         assert_eq!(stats.alerts_generated, 1);
     }
 
+    #[tokio::test]
+    async fn test_inline_mode_action_pipeline() {
+        use kestrel_core::{ActionType, NoOpExecutor};
+        use kestrel_event::Event;
+        use std::sync::atomic::Ordering;
+
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            #[cfg(feature = "wasm")]
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            mode: EngineMode::Inline,
+            action_executor: Some(Arc::new(NoOpExecutor::default()) as Arc<dyn ActionExecutor>),
+            action_pipeline: Some(ActionPipelineConfig::default()),
+            ..Default::default()
+        };
+        let mut engine = DetectionEngine::new(config).await.unwrap();
+
+        engine.single_event_rules.update(|rules| {
+            rules.push(SingleEventRule {
+                rule_id: "kill-rule".into(),
+                rule_name: "Kill Rule".into(),
+                event_type: 1,
+                severity: Severity::High,
+                description: None,
+                predicate: CompiledPredicate::AlwaysMatch,
+                blockable: true,
+                action_type: Some(ActionType::Kill),
+                kill_switch: Default::default(),
+                metrics: Default::default(),
+            });
+        });
+
+        // The same process matching twice is enforced once
+        for ts in [1000, 2000] {
+            let event = Event::builder()
+                .event_type(1)
+                .ts_mono(ts)
+                .ts_wall(ts)
+                .entity_key(42)
+                .build()
+                .unwrap();
+            assert_eq!(engine.eval_event(&event).await.unwrap().len(), 1);
+        }
+
+        let stats = engine.action_pipeline_stats().unwrap().clone();
+        tokio::time::timeout(Duration::from_secs(5), async {
+            while stats.executed.load(Ordering::Relaxed)
+                + stats.deduplicated.load(Ordering::Relaxed)
+                < 2
+            {
+                tokio::time::sleep(Duration::from_millis(1)).await;
+            }
+        })
+        .await
+        .unwrap();
+
+        assert_eq!(stats.executed.load(Ordering::Relaxed), 1);
+        assert_eq!(stats.deduplicated.load(Ordering::Relaxed), 1);
+        assert_eq!(stats.detect_to_enforce_ns.count(), 1);
+        assert_eq!(engine.stats().await.actions_generated, 1);
+    }
+
     #[tokio::test]
     async fn test_detect_mode_no_enforcement() {
         use kestrel_core::{ActionType, NoOpExecutor};
@@ -1016,20 +1721,21 @@ mod tests {
 
         // Create a blockable rule with Block action
         let rule = SingleEventRule {
-            rule_id: "test-no-enforce-rule".to_string(),
-            rule_name: "Test No Enforcement Rule".to_string(),
+            rule_id: "test-no-enforce-rule".into(),
+            rule_name: "Test No Enforcement Rule".into(),
             event_type: 1,
             severity: Severity::High,
             description: Some("A blockable rule in Detect mode".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: true,
             action_type: Some(ActionType::Block),
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -1082,20 +1788,21 @@ mod tests {
 
         // Create a non-blockable rule (blockable=false)
         let rule = SingleEventRule {
-            rule_id: "test-non-blockable".to_string(),
-            rule_name: "Test Non-Blockable Rule".to_string(),
+            rule_id: "test-non-blockable".into(),
+            rule_name: "Test Non-Blockable Rule".into(),
             event_type: 1,
             severity: Severity::Medium,
             description: Some("A non-blockable rule".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: false,                     // Not blockable
             action_type: Some(ActionType::Block), // Has action but not blockable
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -1148,20 +1855,21 @@ mod tests {
 
         // Create a blockable rule with Kill action
         let rule = SingleEventRule {
-            rule_id: "test-kill-rule".to_string(),
-            rule_name: "Test Kill Rule".to_string(),
+            rule_id: "test-kill-rule".into(),
+            rule_name: "Test Kill Rule".into(),
             event_type: 1,
             severity: Severity::Critical,
             description: Some("A kill rule for critical threats".to_string()),
             predicate: CompiledPredicate::AlwaysMatch,
             blockable: true,
             action_type: Some(ActionType::Kill),
+            kill_switch: Default::default(),
+            metrics: Default::default(),
         };
 
-        {
-            let mut rules = engine.single_event_rules.write().await;
+        engine.single_event_rules.update(|rules| {
             rules.push(rule);
-        }
+        });
 
         let event = Event::builder()
             .event_type(1)
@@ -1182,4 +1890,297 @@ mod tests {
         let stats = engine.stats().await;
         assert_eq!(stats.actions_generated, 1);
     }
+
+    #[cfg(feature = "wasm")]
+    #[tokio::test]
+    async fn test_eql_rule_with_large_in_list_matches() {
+        use kestrel_schema::{EventTypeDef, FieldDataType, FieldDef, TypedValue};
+
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            ..Default::default()
+        };
+        let mut engine = DetectionEngine::new(config).await.unwrap();
+
+        let event_type = engine
+            .schema
+            .register_event_type(EventTypeDef {
+                name: "process".to_string(),
+                description: None,
+                parent: None,
+            })
+            .unwrap();
+        let pid_field = engine
+            .schema
+            .register_field(FieldDef {
+                path: "process.pid".to_string(),
+                data_type: FieldDataType::I64,
+                description: None,
+            })
+            .unwrap();
+
+        // 20 literals: lowered to a host-side set lookup
+        let pids: Vec<String> = (1000..1020).map(|pid| pid.to_string()).collect();
+        let rule = Rule {
+            metadata: kestrel_rules::RuleMetadata {
+                id: "large-in-list".to_string(),
+                name: "Large in list".to_string(),
+                description: None,
+                version: "1.0.0".to_string(),
+                author: None,
+                tags: Vec::new(),
+                severity: Severity::High,
+                action: None,
+            },
+            definition: RuleDefinition::Eql(format!(
+                "process where process.pid in ({})",
+                pids.join(", ")
+            )),
+        };
+        engine.compile_single_event_rule(&rule).await.unwrap();
+
+        let event = |pid: i64| {
+            Event::builder()
+                .event_type(event_type)
+                .ts_mono(1000)
+                .ts_wall(1000)
+                .entity_key(pid as u128)
+                .field(pid_field, TypedValue::I64(pid))
+                .build()
+                .unwrap()
+        };
+
+        let alerts = engine.eval_event(&event(1013)).await.unwrap();
+        assert_eq!(alerts.len(), 1);
+        assert_eq!(alerts[0].rule_id, "large-in-list");
+
+        assert!(engine.eval_event(&event(1020)).await.unwrap().is_empty());
+    }
+
+    #[cfg(feature = "wasm")]
+    #[tokio::test]
+    async fn test_compile_rules_error_keeps_existing_table() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+        for i in 0..8 {
+            std::fs::write(
+                rules_dir.join(format!("broken-{}.eql", i)),
+                "this is not eql (",
+            )
+            .unwrap();
+        }
+
+        let config = EngineConfig {
+            rules_dir,
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            compile_threads: 4,
+            ..Default::default()
+        };
+
+        let engine = DetectionEngine::new(config).await.unwrap();
+
+        engine.single_event_rules.update(|rules| {
+            rules.push(SingleEventRule {
+                rule_id: "existing".into(),
+                rule_name: "Existing".into(),
+                event_type: 1,
+                severity: Severity::Low,
+                description: None,
+                predicate: CompiledPredicate::AlwaysMatch,
+                blockable: false,
+                action_type: None,
+                kill_switch: Default::default(),
+                metrics: Default::default(),
+            });
+        });
+
+        assert!(engine.compile_rules().await.is_err());
+
+        let stats = engine.stats().await;
+        assert_eq!(stats.rule_count, 8);
+        assert_eq!(stats.single_event_rule_count, 1);
+    }
+
+    #[tokio::test]
+    async fn test_rule_table_swap_keeps_inflight_snapshot() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            #[cfg(feature = "wasm")]
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            ..Default::default()
+        };
+        let engine = DetectionEngine::new(config).await.unwrap();
+
+        engine.single_event_rules.update(|rules| {
+            rules.push(SingleEventRule {
+                rule_id: "old".into(),
+                rule_name: "Old".into(),
+                event_type: 1,
+                severity: Severity::Low,
+                description: None,
+                predicate: CompiledPredicate::AlwaysMatch,
+                blockable: false,
+                action_type: None,
+                kill_switch: Default::default(),
+                metrics: Default::default(),
+            });
+        });
+        let in_flight = engine.single_event_rules.load();
+
+        // The recompiled (empty) pack replaces the table without waiting
+        // for the evaluation holding the old one
+        engine.compile_rules().await.unwrap();
+        assert_eq!(engine.rule_set_epoch(), 2);
+        assert_eq!(engine.stats().await.single_event_rule_count, 0);
+        assert_eq!(in_flight.len(), 1);
+        assert_eq!(&*in_flight[0].rule_id, "old");
+    }
+
+    #[tokio::test]
+    async fn test_apply_rule_changes_removes_rules() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            #[cfg(feature = "wasm")]
+            wasm_config: Some(kestrel_runtime_wasm::WasmConfig::default()),
+            ..Default::default()
+        };
+        let engine = DetectionEngine::new(config).await.unwrap();
+
+        let rule = |id: &str| SingleEventRule {
+            rule_id: id.into(),
+            rule_name: id.into(),
+            event_type: 1,
+            severity: Severity::Low,
+            description: None,
+            predicate: CompiledPredicate::AlwaysMatch,
+            blockable: false,
+            action_type: None,
+            kill_switch: Default::default(),
+            metrics: Default::default(),
+        };
+        engine.single_event_rules.update(|rules| {
+            rules.push(rule("kept"));
+            rules.push(rule("removed"));
+        });
+
+        engine
+            .apply_rule_changes(&RuleChanges::default())
+            .await
+            .unwrap();
+        assert_eq!(engine.rule_set_epoch(), 1);
+
+        let changes = RuleChanges {
+            updated: Vec::new(),
+            removed: vec!["removed".to_string()],
+        };
+        engine.apply_rule_changes(&changes).await.unwrap();
+        assert_eq!(engine.rule_set_epoch(), 2);
+
+        let table = engine.single_event_rules.load();
+        assert_eq!(table.len(), 1);
+        assert_eq!(&*table[0].rule_id, "kept");
+    }
+
+    struct AlwaysMatchEvaluator;
+
+    impl PredicateEvaluator for AlwaysMatchEvaluator {
+        fn evaluate(&self, _predicate_id: &str, _event: &Event) -> kestrel_nfa::NfaResult<bool> {
+            Ok(true)
+        }
+
+        fn get_required_fields(&self, _predicate_id: &str) -> kestrel_nfa::NfaResult<Vec<u32>> {
+            Ok(vec![])
+        }
+
+        fn has_predicate(&self, _predicate_id: &str) -> bool {
+            true
+        }
+    }
+
+    #[tokio::test]
+    async fn test_swap_sequences_carries_over_partial_matches() {
+        use kestrel_nfa::{NfaSequence, SeqStep};
+
+        let temp_dir = tempfile::tempdir().unwrap();
+        let rules_dir = temp_dir.path().join("rules");
+        std::fs::create_dir(&rules_dir).unwrap();
+
+        let config = EngineConfig {
+            rules_dir,
+            ..Default::default()
+        };
+        let mut engine = DetectionEngine::new(config).await.unwrap();
+        engine.nfa_engine = Some(NfaEngine::new(
+            NfaEngineConfig::default(),
+            Arc::new(AlwaysMatchEvaluator),
+        ));
+
+        let sequence = |id: &str, event_types: &[u16]| CompiledSequence {
+            id: id.to_string(),
+            sequence: NfaSequence::new(
+                id.to_string(),
+                100,
+                event_types
+                    .iter()
+                    .enumerate()
+                    .map(|(i, &event_type)| SeqStep::new(i as u16, "p".to_string(), event_type))
+                    .collect(),
+                Some(5000),
+                None,
+            ),
+            rule_id: id.to_string(),
+            rule_name: id.to_string(),
+        };
+        let event = |event_type: u16, ts: u64| {
+            Event::builder()
+                .event_type(event_type)
+                .ts_mono(ts)
+                .ts_wall(ts)
+                .entity_key(42)
+                .build()
+                .unwrap()
+        };
+
+        let profiler = engine.rule_profiler().clone();
+        let prepare = |sequences| DetectionEngine::prepare_sequences(profiler.clone(), sequences);
+
+        let prepared = prepare(vec![sequence("seq", &[1, 2])]).await.unwrap();
+        let swap = engine.swap_sequences(prepared).unwrap();
+        assert_eq!(swap.added, 1);
+        assert!(engine.eval_event(&event(1, 1000)).await.unwrap().is_empty());
+
+        // Reloading an identical definition keeps the in-flight match
+        let prepared = prepare(vec![sequence("seq", &[1, 2]), sequence("other", &[3])])
+            .await
+            .unwrap();
+        let swap = engine.swap_sequences(prepared).unwrap();
+        assert_eq!((swap.kept, swap.added), (1, 1));
+
+        let alerts = engine.eval_event(&event(2, 2000)).await.unwrap();
+        assert_eq!(alerts.len(), 1);
+        assert_eq!(alerts[0].rule_id, "seq");
+        let metrics = engine.metrics();
+        assert_eq!(metrics.queue_delay_ns.count(), 2);
+        assert_eq!(metrics.event_to_alert_latency_ns.count(), 1);
+        assert_eq!(metrics.rule_metrics("seq").get_alert_count(), 1);
+
+        // Dropping a sequence releases the event types only it needed
+        let prepared = prepare(vec![sequence("seq", &[1, 2])]).await.unwrap();
+        engine.swap_sequences(prepared).unwrap();
+        assert_eq!(engine.sequence_event_types, HashSet::from([1, 2]));
+    }
 }
@@ -0,0 +1,214 @@
+//! Sequence matching on EventBus partition threads
+//!
+//! With `EventBus::new_thread_per_core`, each partition runs its own
+//! `NfaEngine` over the entities routed to it. When the rebalancer moves an
+//! entity range to another partition, the range's partial matches move with
+//! it, so a sequence that started on one partition completes on the other.
+
+use kestrel_core::{EntityRange, PartitionHandler, PartitionState};
+use kestrel_event::Event;
+use kestrel_nfa::{NfaEngine, PartialMatch, SequenceAlert};
+use tracing::warn;
+
+/// `PartitionHandler` that feeds a partition's events to its own `NfaEngine`
+pub struct NfaPartitionHandler<F> {
+    nfa: NfaEngine,
+    on_alert: F,
+}
+
+impl<F> NfaPartitionHandler<F>
+where
+    F: FnMut(usize, SequenceAlert) + Send + 'static,
+{
+    /// Run `nfa` for one partition, passing each sequence alert to `on_alert`
+    pub fn new(nfa: NfaEngine, on_alert: F) -> Self {
+        Self { nfa, on_alert }
+    }
+
+    /// The partition's sequence engine
+    pub fn nfa(&self) -> &NfaEngine {
+        &self.nfa
+    }
+}
+
+impl<F> PartitionHandler for NfaPartitionHandler<F>
+where
+    F: FnMut(usize, SequenceAlert) + Send + 'static,
+{
+    fn handle_batch(&mut self, partition_id: usize, batch: &[Event]) {
+        for event in batch {
+            match self.nfa.process_event(event) {
+                Ok(alerts) => {
+                    for alert in alerts {
+                        (self.on_alert)(partition_id, alert);
+                    }
+                }
+                Err(e) => {
+                    warn!(partition = partition_id, error = %e, "Sequence evaluation failed")
+                }
+            }
+        }
+    }
+
+    fn export_state(
+        &mut self,
+        _partition_id: usize,
+        range: &EntityRange,
+    ) -> Option<PartitionState> {
+        let matches = self
+            .nfa
+            .export_entities(|entity_key| range.contains(entity_key));
+        if matches.is_empty() {
+            return None;
+        }
+        Some(Box::new(matches))
+    }
+
+    fn import_state(&mut self, partition_id: usize, range: &EntityRange, state: PartitionState) {
+        let matches = match state.downcast::<Vec<PartialMatch>>() {
+            Ok(matches) => *matches,
+            Err(_) => {
+                warn!(
+                    partition = partition_id,
+                    bucket = range.bucket(),
+                    "Ignoring partition state not exported by an NFA handler"
+                );
+                return;
+            }
+        };
+        if let Err(e) = self.nfa.import_entities(matches) {
+            warn!(
+                partition = partition_id,
+                bucket = range.bucket(),
+                error = %e,
+                "Failed to import partial matches"
+            );
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use kestrel_core::{EventBus, EventBusConfig, RebalanceConfig, ThreadPerCoreConfig};
+    use kestrel_nfa::{
+        CompiledSequence, NfaEngineConfig, NfaSequence, PredicateEvaluator, SeqStep,
+    };
+    use std::sync::{Arc, Mutex};
+    use std::time::Duration;
+
+    struct AlwaysMatchEvaluator;
+
+    impl PredicateEvaluator for AlwaysMatchEvaluator {
+        fn evaluate(&self, _predicate_id: &str, _event: &Event) -> kestrel_nfa::NfaResult<bool> {
+            Ok(true)
+        }
+
+        fn get_required_fields(&self, _predicate_id: &str) -> kestrel_nfa::NfaResult<Vec<u32>> {
+            Ok(vec![])
+        }
+
+        fn has_predicate(&self, _predicate_id: &str) -> bool {
+            true
+        }
+    }
+
+    fn sequence_engine() -> NfaEngine {
+        let mut nfa = NfaEngine::new(NfaEngineConfig::default(), Arc::new(AlwaysMatchEvaluator));
+        let sequence = NfaSequence::new(
+            "seq".to_string(),
+            100,
+            vec![
+                SeqStep::new(0, "p".to_string(), 1),
+                SeqStep::new(1, "p".to_string(), 2),
+            ],
+            Some(5000),
+            None,
+        );
+        nfa.load_sequence(CompiledSequence {
+            id: "seq".to_string(),
+            sequence,
+            rule_id: "seq".to_string(),
+            rule_name: "seq".to_string(),
+        })
+        .unwrap();
+        nfa
+    }
+
+    fn event(event_type: u16, entity_key: u128, ts: u64) -> Event {
+        Event::builder()
+            .event_type(event_type)
+            .ts_mono(ts)
+            .ts_wall(ts)
+            .entity_key(entity_key)
+            .build()
+            .unwrap()
+    }
+
+    #[tokio::test]
+    async fn test_partial_matches_follow_moved_range() {
+        let config = EventBusConfig {
+            partitions: 2,
+            batch_size: 16,
+            batch_timeout_ms: 5,
+            rebalance: Some(RebalanceConfig {
+                interval: Duration::from_secs(3600),
+                buckets_per_partition: 4,
+                skew_threshold: 1.2,
+                max_moves_per_round: 1,
+                min_events_per_round: 1,
+            }),
+            thread_per_core: ThreadPerCoreConfig {
+                pin_threads: false,
+                numa_aware: false,
+            },
+            ..Default::default()
+        };
+
+        let alerts = Arc::new(Mutex::new(Vec::new()));
+        let sink = alerts.clone();
+        let bus = EventBus::new_thread_per_core(config, move |_| {
+            let sink = sink.clone();
+            NfaPartitionHandler::new(sequence_engine(), move |_, alert: SequenceAlert| {
+                sink.lock().unwrap().push(alert.entity_key)
+            })
+        })
+        .unwrap();
+        let handle = bus.handle();
+
+        let wait_processed = |expected: u64| {
+            let handle = handle.clone();
+            async move {
+                for _ in 0..200 {
+                    if handle.metrics().events_processed == expected {
+                        break;
+                    }
+                    tokio::time::sleep(Duration::from_millis(5)).await;
+                }
+                assert_eq!(handle.metrics().events_processed, expected);
+            }
+        };
+
+        // Entities 0, 2 and 4 share partition 0 and make it hot; every
+        // entity then starts the sequence
+        let keys = [0u128, 1, 2, 4];
+        let mut first: Vec<Event> = [2u128, 2, 4, 4, 4, 4]
+            .iter()
+            .map(|&key| event(3, key, 500))
+            .collect();
+        first.extend(keys.iter().map(|&key| event(1, key, 1000)));
+        handle.publish_batch(first).await.unwrap();
+        wait_processed(10).await;
+        assert_eq!(bus.rebalance(), 1);
+
+        // The moved entity completes its sequence on the new partition
+        let second: Vec<Event> = keys.iter().map(|&key| event(2, key, 2000)).collect();
+        handle.publish_batch(second).await.unwrap();
+        wait_processed(14).await;
+
+        let mut matched = alerts.lock().unwrap().clone();
+        matched.sort_unstable();
+        assert_eq!(matched, keys);
+        assert_eq!(handle.metrics().migrations, 1);
+    }
+}
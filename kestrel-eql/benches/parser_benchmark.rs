@@ -0,0 +1,72 @@
+// EQL Parser Benchmarks
+//
+// Compares the pest parser with the hand-written Pratt parser on
+// IOC-style rules with large `in` lists, and measures parsing of the
+// shipped rule pack.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use kestrel_eql::{parser, pratt_parser};
+use std::path::Path;
+
+/// Build an IOC rule with `count` hash literals in an `in` list
+fn ioc_rule(count: usize) -> String {
+    let hashes: Vec<String> = (0..count).map(|i| format!("\"{:064x}\"", i)).collect();
+    format!(
+        "file where file.hash in ({}) and file.path != \"/usr/bin/true\"",
+        hashes.join(", ")
+    )
+}
+
+/// Load every `rules/*/rule.eql` shipped with the repository
+fn rule_pack() -> Vec<String> {
+    let rules_dir = Path::new(env!("CARGO_MANIFEST_DIR")).join("../rules");
+    let Ok(entries) = std::fs::read_dir(rules_dir) else {
+        return Vec::new();
+    };
+    entries
+        .filter_map(|entry| std::fs::read_to_string(entry.ok()?.path().join("rule.eql")).ok())
+        .collect()
+}
+
+/// Benchmark large `in` lists with both parsers
+fn bench_ioc_in_lists(c: &mut Criterion) {
+    let mut group = c.benchmark_group("eql_parse_ioc");
+
+    for count in [100, 1000, 5000].iter() {
+        let rule = ioc_rule(*count);
+        group.throughput(Throughput::Bytes(rule.len() as u64));
+
+        group.bench_with_input(BenchmarkId::new("pest", count), &rule, |b, rule| {
+            b.iter(|| black_box(parser::parse(black_box(rule))))
+        });
+        group.bench_with_input(BenchmarkId::new("pratt", count), &rule, |b, rule| {
+            b.iter(|| black_box(pratt_parser::parse(black_box(rule))))
+        });
+    }
+
+    group.finish();
+}
+
+/// Benchmark parsing the shipped rule pack
+fn bench_rule_pack(c: &mut Criterion) {
+    let rules = rule_pack();
+    if rules.is_empty() {
+        return;
+    }
+
+    let mut group = c.benchmark_group("eql_parse_rule_pack");
+    group.throughput(Throughput::Elements(rules.len() as u64));
+
+    group.bench_function("pratt", |b| {
+        b.iter(|| {
+            for rule in &rules {
+                black_box(pratt_parser::parse(black_box(rule)).ok());
+            }
+        })
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_ioc_in_lists, bench_rule_pack);
+criterion_main!(benches);
@@ -8,7 +8,8 @@
 //! - One `pred_init` export for initialization
 //! - One `pred_eval(predicate_id, event_handle)` dispatcher
 //! - Internal functions for each predicate (e.g., `$pred_eval_0`, `$pred_eval_1`)
-//! - String data section for literals
+//! - String data section for literals, placed after the string scratch
+//!   buffer that `event_get_str` writes field values into
 //!
 //! ## Type System
 //!
@@ -23,6 +24,9 @@ use crate::ir::*;
 use std::collections::HashMap;
 use std::io::Write;
 
+/// Size of the scratch buffer at offset 0 that string fields are read into
+const SCRATCH_BUFFER_SIZE: u32 = 256;
+
 /// Field type for Wasm codegen
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum WasmFieldType {
@@ -52,6 +56,11 @@ pub struct WasmCodeGenerator {
     string_literals: Vec<StringLiteral>,
     /// Next available offset in data section
     next_offset: u32,
+    /// Literal sets in host table-index order (see `IrRule::literal_sets`)
+    literal_sets: Vec<IrLiteralSet>,
+    /// Field regexes in host table-index order (see
+    /// `IrRule::field_regex_patterns`)
+    field_regexes: Vec<(u32, String)>,
 }
 
 impl WasmCodeGenerator {
@@ -61,7 +70,9 @@ impl WasmCodeGenerator {
             predicate_indices: HashMap::new(),
             field_types: HashMap::new(),
             string_literals: Vec::new(),
-            next_offset: 0,
+            next_offset: SCRATCH_BUFFER_SIZE,
+            literal_sets: Vec::new(),
+            field_regexes: Vec::new(),
         }
     }
 
@@ -80,6 +91,12 @@ impl WasmCodeGenerator {
         // Collect string literals and compute offsets
         self.collect_string_literals(rule)?;
 
+        // Number literal sets; the runtime registers one table per index
+        self.literal_sets = rule.literal_sets().into_iter().cloned().collect();
+
+        // Number field regexes; the runtime resolves each index to its regex
+        self.field_regexes = rule.field_regex_patterns();
+
         // Write module header
         writeln!(output, "(module")?;
         writeln!(output, "  ;; Import Host API v1 functions")?;
@@ -108,11 +125,45 @@ impl WasmCodeGenerator {
             output,
             "    (func $re_match (param i32 i32 i32) (result i32)))"
         )?;
+        writeln!(output, "  (import \"kestrel\" \"re_match_field\"")?;
+        writeln!(
+            output,
+            "    (func $re_match_field (param i32) (result i32)))"
+        )?;
         writeln!(output, "  (import \"kestrel\" \"glob_match\"")?;
         writeln!(
             output,
             "    (func $glob_match (param i32 i32 i32) (result i32)))"
         )?;
+        for name in [
+            "str_contains",
+            "str_starts_with",
+            "str_ends_with",
+            "str_equals",
+            "str_equals_ci",
+        ] {
+            writeln!(output, "  (import \"kestrel\" \"{}\"", name)?;
+            writeln!(
+                output,
+                "    (func ${} (param i32 i32 i32) (result i32)))",
+                name
+            )?;
+        }
+        writeln!(output, "  (import \"kestrel\" \"set_contains_i64\"")?;
+        writeln!(
+            output,
+            "    (func $set_contains_i64 (param i32 i64) (result i32)))"
+        )?;
+        writeln!(output, "  (import \"kestrel\" \"set_contains_str\"")?;
+        writeln!(
+            output,
+            "    (func $set_contains_str (param i32 i32 i32) (result i32)))"
+        )?;
+        writeln!(output, "  (import \"kestrel\" \"set_contains_field_str\"")?;
+        writeln!(
+            output,
+            "    (func $set_contains_field_str (param i32 i32 i32) (result i32)))"
+        )?;
         writeln!(output, "  (import \"kestrel\" \"alert_emit\"")?;
         writeln!(
             output,
@@ -177,7 +228,7 @@ impl WasmCodeGenerator {
         }
 
         if self.string_literals.is_empty() {
-            writeln!(output, "  (data (i32.const 0) \"\")")?;
+            writeln!(output, "  (data (i32.const {}) \"\")", SCRATCH_BUFFER_SIZE)?;
         }
 
         writeln!(output)?;
@@ -276,6 +327,7 @@ impl WasmCodeGenerator {
             "  (func $pred_eval_{} (param $event_handle i32) (result i32)",
             idx
         )?;
+        writeln!(output, "    (local $str_len i32)")?;
 
         // Generate expression evaluation
         self.generate_node(output, &predicate.root, true)?;
@@ -314,7 +366,7 @@ impl WasmCodeGenerator {
                     self.analyze_node_types(arg)?;
                 }
             }
-            IrNode::In { value, values: _ } => {
+            IrNode::In { value, values: _ } | IrNode::InSet { value, set: _ } => {
                 self.analyze_node_types(value)?;
             }
             IrNode::ArrayQuantifier { element_condition, .. } => {
@@ -328,7 +380,7 @@ impl WasmCodeGenerator {
     /// Collect string literals from all predicates
     fn collect_string_literals(&mut self, rule: &IrRule) -> Result<()> {
         self.string_literals.clear();
-        self.next_offset = 0;
+        self.next_offset = SCRATCH_BUFFER_SIZE;
 
         for predicate in rule.predicates.values() {
             self.collect_node_literals(&predicate.root)?;
@@ -382,6 +434,10 @@ impl WasmCodeGenerator {
                     }
                 }
             }
+            IrNode::InSet { value, set: _ } => {
+                // Set members live in the host table, not the data section
+                self.collect_node_literals(value)?;
+            }
             IrNode::ArrayQuantifier { element_condition, .. } => {
                 self.collect_node_literals(element_condition)?;
             }
@@ -443,7 +499,11 @@ impl WasmCodeGenerator {
                         writeln!(output, "    (local.get $event_handle)")?;
                         writeln!(output, "    (i32.const {})  ;; field_id", field_id)?;
                         writeln!(output, "    (i32.const 0)  ;; buffer ptr")?;
-                        writeln!(output, "    (i32.const 256)  ;; buffer size")?;
+                        writeln!(
+                            output,
+                            "    (i32.const {})  ;; buffer size",
+                            SCRATCH_BUFFER_SIZE
+                        )?;
                         writeln!(output, "    (call $event_get_str)")?;
                     }
                     WasmFieldType::Bool => {
@@ -519,6 +579,9 @@ impl WasmCodeGenerator {
             IrNode::In { value, values } => {
                 self.generate_in(output, value, values, is_root)?;
             }
+            IrNode::InSet { value, set } => {
+                self.generate_in_set(output, value, set, is_root)?;
+            }
             IrNode::ArrayQuantifier {
                 quantifier,
                 field_id,
@@ -630,7 +693,11 @@ impl WasmCodeGenerator {
                 writeln!(output, "    (local.get $event_handle)")?;
                 writeln!(output, "    (i32.const {})", field_id)?;
                 writeln!(output, "    (i32.const 0)  ;; buffer ptr")?;
-                writeln!(output, "    (i32.const 256)  ;; buffer size")?;
+                writeln!(
+                    output,
+                    "    (i32.const {})  ;; buffer size",
+                    SCRATCH_BUFFER_SIZE
+                )?;
                 writeln!(output, "    (call $event_get_str)")?;
                 writeln!(output, "    (i32.const 0)  ;; string ptr")?;
                 writeln!(output, "    (i32.ne)")?;
@@ -869,13 +936,13 @@ impl WasmCodeGenerator {
 
         match func {
             IrFunction::Contains => {
-                self.generate_string_function(output, "contains", args, is_root)?;
+                self.generate_string_function(output, "str_contains", args, is_root)?;
             }
             IrFunction::StartsWith => {
-                self.generate_string_function(output, "startsWith", args, is_root)?;
+                self.generate_string_function(output, "str_starts_with", args, is_root)?;
             }
             IrFunction::EndsWith => {
-                self.generate_string_function(output, "endsWith", args, is_root)?;
+                self.generate_string_function(output, "str_ends_with", args, is_root)?;
             }
             IrFunction::Regex => {
                 self.generate_regex_function(output, args, is_root)?;
@@ -884,58 +951,77 @@ impl WasmCodeGenerator {
                 self.generate_wildcard_function(output, args, is_root)?;
             }
             IrFunction::StringEqualsCi => {
-                self.generate_string_function(output, "stringEqualsCi", args, is_root)?;
+                self.generate_string_function(output, "str_equals_ci", args, is_root)?;
+            }
+            IrFunction::StringEquals => {
+                self.generate_string_function(output, "str_equals", args, is_root)?;
             }
         }
 
         Ok(())
     }
 
-    /// Generate string function (contains, startsWith, endsWith)
+    /// Generate string function (contains, startsWith, endsWith, string equality)
+    ///
+    /// A field compared with a string literal calls the dedicated host
+    /// function, which reads the field straight from the event; the literal
+    /// is passed by its data section offset and length.
     fn generate_string_function(
         &self,
         output: &mut Vec<u8>,
-        func_name: &str,
+        host_fn: &str,
         args: &[IrNode],
         is_root: bool,
     ) -> Result<()> {
         if args.len() < 2 {
-            writeln!(output, "    ;; Error: {} requires 2 args", func_name)?;
+            writeln!(output, "    ;; Error: {} requires 2 args", host_fn)?;
             writeln!(output, "    (i64.const 0)")?;
             return Ok(());
         }
 
         // args[0] is the string to search in (usually a field)
-        // args[1] is the pattern (usually a string literal)
-
-        // Generate the haystack (string to search in)
-        writeln!(output, "    ;; Get haystack string")?;
-        self.generate_node(output, &args[0], false)?;
-        writeln!(output, "    (i32.const 0)  ;; buffer")?;
-        writeln!(output, "    (i32.const 256)  ;; buffer size")?;
-        writeln!(output, "    (call $event_get_str)  ;; get haystack")?;
-        writeln!(output, "    (local.set $haystack_ptr)")?;
-        writeln!(output, "    (local.get $haystack_ptr)")?;
+        // args[1] is the needle (usually a string literal)
+        let operands = match (&args[0], &args[1]) {
+            (
+                IrNode::LoadField { field_id },
+                IrNode::Literal {
+                    value: IrLiteral::String(needle),
+                },
+            ) => Some((*field_id, needle)),
+            // Equality is symmetric
+            (
+                IrNode::Literal {
+                    value: IrLiteral::String(needle),
+                },
+                IrNode::LoadField { field_id },
+            ) if host_fn.starts_with("str_equals") => Some((*field_id, needle)),
+            _ => None,
+        };
 
-        // Generate the needle (pattern to search for)
-        if let IrNode::Literal {
-            value: IrLiteral::String(s),
-        } = &args[1]
-        {
-            if let Some((offset, _length)) = self.get_string_literal_info(s) {
-                writeln!(output, "    ;; Needle: \"{}\"", s)?;
+        match operands.and_then(|(field_id, needle)| {
+            self.get_string_literal_info(needle)
+                .map(|(offset, length)| (field_id, needle, offset, length))
+        }) {
+            Some((field_id, needle, offset, length)) => {
+                writeln!(output, "    (i32.const {})  ;; field", field_id)?;
+                writeln!(
+                    output,
+                    "    ;; Needle: \"{}\"",
+                    self.escape_wat_string(needle)
+                )?;
                 writeln!(output, "    (i32.const {})  ;; needle offset", offset)?;
-            } else {
-                writeln!(output, "    (i32.const 0)  ;; needle offset (not found)")?;
+                writeln!(output, "    (i32.const {})  ;; needle length", length)?;
+                writeln!(output, "    (call ${})", host_fn)?;
+            }
+            None => {
+                writeln!(
+                    output,
+                    "    ;; Operands are not a field and a string literal"
+                )?;
+                writeln!(output, "    (i32.const 0)")?;
             }
-        } else {
-            writeln!(output, "    ;; Needle is not a literal")?;
-            writeln!(output, "    (i32.const 0)")?;
         }
 
-        // Use glob_match for string matching (simple prefix/suffix check)
-        writeln!(output, "    (call $glob_match)")?;
-
         if is_root {
             writeln!(output, "    (if (result i32)")?;
             writeln!(output, "      (then (i32.const 1))")?;
@@ -962,6 +1048,39 @@ impl WasmCodeGenerator {
         // args[0] is the pattern (literal)
         // args[1] is the string to match
 
+        // Literal pattern on a field: matched through the host's per-field
+        // regex set, which scans the field once per event for all rules
+        if let (
+            IrNode::Literal {
+                value: IrLiteral::String(pattern),
+            },
+            IrNode::LoadField { field_id },
+        ) = (&args[0], &args[1])
+        {
+            let regex_idx = self
+                .field_regexes
+                .iter()
+                .position(|(f, p)| f == field_id && p == pattern)
+                .ok_or_else(|| EqlError::CodegenError {
+                    message: "Field regex not registered".to_string(),
+                })?;
+
+            writeln!(
+                output,
+                "    (i32.const {})  ;; regex index (field {})",
+                regex_idx, field_id
+            )?;
+            writeln!(output, "    (call $re_match_field)")?;
+
+            if is_root {
+                writeln!(output, "    (if (result i32)")?;
+                writeln!(output, "      (then (i32.const 1))")?;
+                writeln!(output, "      (else (i32.const 0))")?;
+                writeln!(output, "    )")?;
+            }
+            return Ok(());
+        }
+
         // Generate pattern
         if let IrNode::Literal {
             value: IrLiteral::String(s),
@@ -978,7 +1097,11 @@ impl WasmCodeGenerator {
 
         // Generate string to match
         writeln!(output, "    (i32.const 0)  ;; buffer")?;
-        writeln!(output, "    (i32.const 256)  ;; buffer size")?;
+        writeln!(
+            output,
+            "    (i32.const {})  ;; buffer size",
+            SCRATCH_BUFFER_SIZE
+        )?;
         writeln!(output, "    (call $event_get_str)")?;
 
         writeln!(output, "    (call $re_match)")?;
@@ -1025,7 +1148,11 @@ impl WasmCodeGenerator {
 
         // Generate string to match
         writeln!(output, "    (i32.const 0)  ;; buffer")?;
-        writeln!(output, "    (i32.const 256)  ;; buffer size")?;
+        writeln!(
+            output,
+            "    (i32.const {})  ;; buffer size",
+            SCRATCH_BUFFER_SIZE
+        )?;
         writeln!(output, "    (call $event_get_str)")?;
 
         writeln!(output, "    (call $glob_match)")?;
@@ -1079,6 +1206,87 @@ impl WasmCodeGenerator {
         Ok(())
     }
 
+    /// Generate set membership against a host-side table
+    ///
+    /// One host call per evaluation regardless of the set size:
+    /// `set_contains_i64(set_idx, value)` for int sets and
+    /// `set_contains_str(set_idx, ptr, len)` for string sets. A string
+    /// that fills the scratch buffer may have been truncated, so it is
+    /// looked up in full with `set_contains_field_str(set_idx, event, field)`.
+    fn generate_in_set(
+        &self,
+        output: &mut Vec<u8>,
+        value: &IrNode,
+        set: &IrLiteralSet,
+        is_root: bool,
+    ) -> Result<()> {
+        let set_idx = self
+            .literal_sets
+            .iter()
+            .position(|s| s == set)
+            .ok_or_else(|| EqlError::CodegenError {
+                message: "Literal set not registered".to_string(),
+            })?;
+
+        writeln!(
+            output,
+            "    ;; Set membership: table {} with {} values",
+            set_idx,
+            set.len()
+        )?;
+        match set {
+            IrLiteralSet::Int(_) => {
+                writeln!(output, "    (i32.const {})  ;; set index", set_idx)?;
+                self.generate_node(output, value, false)?;
+                writeln!(output, "    (call $set_contains_i64)")?;
+            }
+            IrLiteralSet::String(_) => {
+                if let IrNode::LoadField { field_id } = value {
+                    writeln!(output, "    (local.get $event_handle)")?;
+                    writeln!(output, "    (i32.const {})  ;; field_id", field_id)?;
+                    writeln!(output, "    (i32.const 0)  ;; buffer ptr")?;
+                    writeln!(
+                        output,
+                        "    (i32.const {})  ;; buffer size",
+                        SCRATCH_BUFFER_SIZE
+                    )?;
+                    writeln!(output, "    (call $event_get_str)")?;
+                    writeln!(output, "    (local.set $str_len)")?;
+                    writeln!(output, "    (if (result i32)")?;
+                    writeln!(
+                        output,
+                        "      (i32.lt_u (local.get $str_len) (i32.const {}))",
+                        SCRATCH_BUFFER_SIZE
+                    )?;
+                    writeln!(output, "      (then")?;
+                    writeln!(output, "        (i32.const {})  ;; set index", set_idx)?;
+                    writeln!(output, "        (i32.const 0)  ;; buffer ptr")?;
+                    writeln!(output, "        (local.get $str_len)")?;
+                    writeln!(output, "        (call $set_contains_str))")?;
+                    writeln!(output, "      (else")?;
+                    writeln!(output, "        ;; May be truncated: look up in full")?;
+                    writeln!(output, "        (i32.const {})  ;; set index", set_idx)?;
+                    writeln!(output, "        (local.get $event_handle)")?;
+                    writeln!(output, "        (i32.const {})  ;; field_id", field_id)?;
+                    writeln!(output, "        (call $set_contains_field_str))")?;
+                    writeln!(output, "    )")?;
+                } else {
+                    writeln!(output, "    ;; Value is not a field")?;
+                    writeln!(output, "    (i32.const {})  ;; set index", set_idx)?;
+                    writeln!(output, "    (i32.const 0)")?;
+                    writeln!(output, "    (i32.const 0)")?;
+                    writeln!(output, "    (call $set_contains_str)")?;
+                }
+            }
+        }
+
+        if !is_root {
+            writeln!(output, "    (i64.extend_i32_u)")?;
+        }
+
+        Ok(())
+    }
+
     /// Generate array quantifier (any/all)
     ///
     /// Note: This requires Host API support for array iteration.
@@ -1382,7 +1590,78 @@ mod tests {
         assert!(result.is_ok());
 
         let wat = result.unwrap();
-        // Should reference glob_match for contains
-        assert!(wat.contains("$glob_match"));
+        // Contains calls its host function directly, not the glob matcher
+        assert!(wat.contains("(i32.const 1)  ;; field"));
+        assert!(wat.contains("(i32.const 256)  ;; needle offset"));
+        assert!(wat.contains("(i32.const 10)  ;; needle length"));
+        assert!(wat.contains("(call $str_contains)"));
+        assert!(!wat.contains("(call $glob_match)"));
+    }
+
+    #[test]
+    fn test_in_set_uses_host_table() {
+        let mut generator = WasmCodeGenerator::new();
+
+        let hashes: Vec<String> = (0..1000).map(|i| format!("{:064x}", i)).collect();
+        let mut rule = IrRule::new(
+            "test-rule".to_string(),
+            IrRuleType::Event {
+                event_type: "file".to_string(),
+            },
+        );
+        rule.add_predicate(
+            IrPredicate::builder("main", "file")
+                .condition(IrNode::InSet {
+                    value: Box::new(IrNode::LoadField { field_id: 7 }),
+                    set: IrLiteralSet::String(hashes.clone()),
+                })
+                .build(),
+        );
+
+        let wat = generator.generate(&rule).unwrap();
+
+        assert!(wat.contains("(call $set_contains_str)"));
+        assert!(wat.contains("(i32.const 0)  ;; set index"));
+        // Values filling the scratch buffer fall back to a full comparison
+        assert!(wat.contains("(i32.lt_u (local.get $str_len) (i32.const 256))"));
+        assert_eq!(wat.matches("(call $set_contains_field_str)").count(), 1);
+        // Members are not copied into the module
+        assert!(!wat.contains(&hashes[42]));
+        assert_eq!(wat.matches("(call $set_contains_str)").count(), 1);
+    }
+
+    #[test]
+    fn test_field_regex_uses_regex_set() {
+        let mut generator = WasmCodeGenerator::new();
+
+        let mut rule = IrRule::new(
+            "test-rule".to_string(),
+            IrRuleType::Event {
+                event_type: "process".to_string(),
+            },
+        );
+        rule.add_predicate(
+            IrPredicate::builder("main", "process")
+                .condition(IrNode::FunctionCall {
+                    func: IrFunction::Regex,
+                    args: vec![
+                        IrNode::Literal {
+                            value: IrLiteral::String("curl .*".to_string()),
+                        },
+                        IrNode::LoadField { field_id: 4 },
+                    ],
+                })
+                .build(),
+        );
+
+        let wat = generator.generate(&rule).unwrap();
+
+        assert!(wat.contains("(call $re_match_field)"));
+        assert!(wat.contains("(i32.const 0)  ;; regex index (field 4)"));
+        assert!(!wat.contains("(call $re_match)"));
+
+        // Literals are laid out past the string scratch buffer
+        assert!(wat.contains("(data (i32.const 256) \"curl .*\")"));
+        assert!(!wat.contains("(data (i32.const 0)"));
     }
 }
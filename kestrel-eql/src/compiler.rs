@@ -5,7 +5,7 @@
 use crate::codegen_wasm::WasmCodeGenerator;
 use crate::error::Result;
 use crate::ir::*;
-use crate::parser;
+use crate::pratt_parser;
 use crate::semantic::SemanticAnalyzer;
 use kestrel_schema::SchemaRegistry;
 use std::sync::Arc;
@@ -30,7 +30,7 @@ impl EqlCompiler {
     /// Compile EQL query to Wasm
     pub fn compile_to_wasm(&mut self, eql: &str) -> Result<String> {
         // Step 1: Parse EQL to AST
-        let ast = parser::parse(eql)?;
+        let ast = pratt_parser::parse(eql)?;
 
         // Step 2: Semantic analysis to IR
         let mut analyzer = SemanticAnalyzer::new(self.schema.clone());
@@ -42,10 +42,25 @@ impl EqlCompiler {
         Ok(wat)
     }
 
+    /// Compile EQL query to both IR and Wasm
+    ///
+    /// Parses and analyzes the query once; used by bulk rule loading where
+    /// the IR (event type, required fields) and the WAT are both needed.
+    pub fn compile_to_ir_and_wasm(&mut self, eql: &str) -> Result<(IrRule, String)> {
+        let ast = pratt_parser::parse(eql)?;
+
+        let mut analyzer = SemanticAnalyzer::new(self.schema.clone());
+        let ir = analyzer.analyze(&ast)?;
+
+        let wat = self.wasm_generator.generate(&ir)?;
+
+        Ok((ir, wat))
+    }
+
     /// Compile EQL query and return IR (for debugging)
     pub fn compile_to_ir(&self, eql: &str) -> Result<IrRule> {
         // Step 1: Parse EQL to AST
-        let ast = parser::parse(eql)?;
+        let ast = pratt_parser::parse(eql)?;
 
         // Step 2: Semantic analysis to IR
         let mut analyzer = SemanticAnalyzer::new(self.schema.clone());
@@ -56,7 +71,7 @@ impl EqlCompiler {
 
     /// Parse EQL query to AST (for debugging)
     pub fn parse(&self, eql: &str) -> Result<crate::ast::Query> {
-        parser::parse(eql)
+        pratt_parser::parse(eql)
     }
 }
 
@@ -5,7 +5,7 @@
 //! and sequences as state machines.
 
 use serde::{Deserialize, Serialize};
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 
 /// IR for a compiled EQL rule
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
@@ -70,6 +70,11 @@ pub enum IrNode {
         value: Box<IrNode>,
         values: Vec<IrLiteral>,
     },
+    /// Set membership against a host-side table (large `in` lists)
+    InSet {
+        value: Box<IrNode>,
+        set: IrLiteralSet,
+    },
     /// Array quantifier (any/all)
     ArrayQuantifier {
         quantifier: IrQuantifierType,
@@ -87,6 +92,87 @@ pub enum IrLiteral {
     Null,
 }
 
+/// Homogeneous literal set, sorted and deduplicated
+///
+/// Produced by semantic analysis for `in` lists of at least
+/// `IN_SET_THRESHOLD` literals; backends look values up in a host-side
+/// table instead of chaining one comparison per literal.
+#[derive(Debug, Clone, PartialEq, Eq, Hash, Serialize, Deserialize)]
+pub enum IrLiteralSet {
+    Int(Vec<i64>),
+    String(Vec<String>),
+}
+
+/// Minimum `in` list size lowered to `IrNode::InSet`
+pub const IN_SET_THRESHOLD: usize = 16;
+
+impl IrLiteralSet {
+    /// Build a set from `in` list literals
+    ///
+    /// Returns `None` unless all literals are ints or all are strings.
+    pub fn from_literals(values: &[IrLiteral]) -> Option<Self> {
+        let set = match values.first()? {
+            IrLiteral::Int(_) => {
+                let mut ints = values
+                    .iter()
+                    .map(|v| match v {
+                        IrLiteral::Int(i) => Some(*i),
+                        _ => None,
+                    })
+                    .collect::<Option<Vec<i64>>>()?;
+                ints.sort_unstable();
+                ints.dedup();
+                IrLiteralSet::Int(ints)
+            }
+            IrLiteral::String(_) => {
+                let mut strings = values
+                    .iter()
+                    .map(|v| match v {
+                        IrLiteral::String(s) => Some(s.clone()),
+                        _ => None,
+                    })
+                    .collect::<Option<Vec<String>>>()?;
+                strings.sort_unstable();
+                strings.dedup();
+                IrLiteralSet::String(strings)
+            }
+            _ => return None,
+        };
+        Some(set)
+    }
+
+    /// Number of distinct values
+    pub fn len(&self) -> usize {
+        match self {
+            IrLiteralSet::Int(ints) => ints.len(),
+            IrLiteralSet::String(strings) => strings.len(),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Binary-search membership test
+    pub fn contains(&self, value: &IrLiteral) -> bool {
+        match (self, value) {
+            (IrLiteralSet::Int(ints), IrLiteral::Int(i)) => ints.binary_search(i).is_ok(),
+            (IrLiteralSet::String(strings), IrLiteral::String(s)) => {
+                strings.binary_search(s).is_ok()
+            }
+            _ => false,
+        }
+    }
+
+    /// String members, empty for int sets
+    pub fn strings(&self) -> &[String] {
+        match self {
+            IrLiteralSet::String(strings) => strings,
+            IrLiteralSet::Int(_) => &[],
+        }
+    }
+}
+
 /// Binary operation
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
 pub enum IrBinaryOp {
@@ -139,6 +225,8 @@ pub enum IrFunction {
     Wildcard,
     /// Case-insensitive string compare: `stringEqualsCi(a, b)`
     StringEqualsCi,
+    /// Case-sensitive string compare; lowered from exact wildcard patterns
+    StringEquals,
 }
 
 /// Sequence configuration
@@ -242,6 +330,39 @@ impl IrRule {
 
         Ok(())
     }
+
+    /// Literal sets used by `InSet` nodes, in table-index order
+    ///
+    /// Predicates are visited in ID order and duplicate sets share one
+    /// index, so codegen and the runtime agree on the numbering.
+    pub fn literal_sets(&self) -> Vec<&IrLiteralSet> {
+        let mut ids: Vec<&String> = self.predicates.keys().collect();
+        ids.sort();
+
+        let mut sets = Vec::new();
+        let mut seen = HashSet::new();
+        for id in ids {
+            self.predicates[id]
+                .root
+                .collect_literal_sets(&mut sets, &mut seen);
+        }
+        sets
+    }
+
+    /// `(field_id, pattern)` regexes applied directly to a field, in host
+    /// table-index order
+    ///
+    /// Sorted and deduplicated across all predicates, so codegen and the
+    /// runtime agree on the numbering.
+    pub fn field_regex_patterns(&self) -> Vec<(u32, String)> {
+        let mut pairs = Vec::new();
+        for predicate in self.predicates.values() {
+            predicate.root.collect_field_regex_patterns(&mut pairs);
+        }
+        pairs.sort();
+        pairs.dedup();
+        pairs
+    }
 }
 
 impl IrNode {
@@ -264,7 +385,7 @@ impl IrNode {
                     ids.extend(arg.field_ids());
                 }
             }
-            IrNode::In { value, .. } => {
+            IrNode::In { value, .. } | IrNode::InSet { value, .. } => {
                 ids.extend(value.field_ids());
             }
             _ => {}
@@ -306,6 +427,9 @@ impl IrNode {
                     }
                 }
             }
+            IrNode::InSet { value, .. } => {
+                patterns.extend(value.regex_patterns());
+            }
             _ => {}
         }
         patterns.sort();
@@ -313,6 +437,48 @@ impl IrNode {
         patterns
     }
 
+    /// Get `(field_id, pattern)` pairs of regexes applied directly to a field
+    ///
+    /// Used at rule pack load to build one regex set per field.
+    pub fn field_regex_patterns(&self) -> Vec<(u32, String)> {
+        let mut pairs = Vec::new();
+        self.collect_field_regex_patterns(&mut pairs);
+        pairs.sort();
+        pairs.dedup();
+        pairs
+    }
+
+    fn collect_field_regex_patterns(&self, pairs: &mut Vec<(u32, String)>) {
+        match self {
+            IrNode::FunctionCall { func, args } => {
+                if let (
+                    IrFunction::Regex,
+                    [IrNode::Literal {
+                        value: IrLiteral::String(pattern),
+                    }, IrNode::LoadField { field_id }],
+                ) = (func, args.as_slice())
+                {
+                    pairs.push((*field_id, pattern.clone()));
+                }
+                for arg in args {
+                    arg.collect_field_regex_patterns(pairs);
+                }
+            }
+            IrNode::BinaryOp { left, right, .. } => {
+                left.collect_field_regex_patterns(pairs);
+                right.collect_field_regex_patterns(pairs);
+            }
+            IrNode::UnaryOp { operand, .. } => operand.collect_field_regex_patterns(pairs),
+            IrNode::In { value, .. } | IrNode::InSet { value, .. } => {
+                value.collect_field_regex_patterns(pairs)
+            }
+            IrNode::ArrayQuantifier {
+                element_condition, ..
+            } => element_condition.collect_field_regex_patterns(pairs),
+            IrNode::Literal { .. } | IrNode::LoadField { .. } => {}
+        }
+    }
+
     /// Get all glob patterns used in this node
     pub fn glob_patterns(&self) -> Vec<String> {
         let mut patterns = Vec::new();
@@ -343,6 +509,37 @@ impl IrNode {
         patterns.dedup();
         patterns
     }
+
+    /// Collect `InSet` literal sets, deduplicated, in traversal order
+    fn collect_literal_sets<'a>(
+        &'a self,
+        sets: &mut Vec<&'a IrLiteralSet>,
+        seen: &mut HashSet<&'a IrLiteralSet>,
+    ) {
+        match self {
+            IrNode::InSet { value, set } => {
+                value.collect_literal_sets(sets, seen);
+                if seen.insert(set) {
+                    sets.push(set);
+                }
+            }
+            IrNode::In { value, .. } => value.collect_literal_sets(sets, seen),
+            IrNode::BinaryOp { left, right, .. } => {
+                left.collect_literal_sets(sets, seen);
+                right.collect_literal_sets(sets, seen);
+            }
+            IrNode::UnaryOp { operand, .. } => operand.collect_literal_sets(sets, seen),
+            IrNode::FunctionCall { args, .. } => {
+                for arg in args {
+                    arg.collect_literal_sets(sets, seen);
+                }
+            }
+            IrNode::ArrayQuantifier {
+                element_condition, ..
+            } => element_condition.collect_literal_sets(sets, seen),
+            IrNode::Literal { .. } | IrNode::LoadField { .. } => {}
+        }
+    }
 }
 
 impl Default for IrPredicate {
@@ -592,5 +789,54 @@ mod tests {
 
         let patterns = node.regex_patterns();
         assert_eq!(patterns, vec![".*\\.exe".to_string()]);
+
+        let pairs = and(node.clone(), node).field_regex_patterns();
+        assert_eq!(pairs, vec![(3, ".*\\.exe".to_string())]);
+    }
+
+    #[test]
+    fn test_literal_set_from_literals() {
+        let set = IrLiteralSet::from_literals(&[
+            IrLiteral::Int(3),
+            IrLiteral::Int(1),
+            IrLiteral::Int(3),
+        ])
+        .unwrap();
+        assert_eq!(set, IrLiteralSet::Int(vec![1, 3]));
+        assert!(set.contains(&IrLiteral::Int(1)));
+        assert!(!set.contains(&IrLiteral::Int(2)));
+        assert!(!set.contains(&IrLiteral::String("1".to_string())));
+
+        // Mixed or null lists stay as comparison chains
+        assert!(IrLiteralSet::from_literals(&[
+            IrLiteral::Int(1),
+            IrLiteral::String("a".to_string()),
+        ])
+        .is_none());
+        assert!(IrLiteralSet::from_literals(&[IrLiteral::Null]).is_none());
+    }
+
+    #[test]
+    fn test_rule_literal_sets_are_deduplicated() {
+        let set = IrLiteralSet::String(vec!["a".to_string(), "b".to_string()]);
+        let in_set = IrNode::InSet {
+            value: Box::new(IrNode::LoadField { field_id: 1 }),
+            set: set.clone(),
+        };
+
+        let mut rule = IrRule::new(
+            "test-sets".to_string(),
+            IrRuleType::Event {
+                event_type: "file".to_string(),
+            },
+        );
+        rule.add_predicate(
+            IrPredicate::builder("main", "file")
+                .condition(or(in_set.clone(), in_set))
+                .build(),
+        );
+
+        assert_eq!(rule.literal_sets(), vec![&set]);
+        assert_eq!(rule.predicates["main"].required_fields, vec![1]);
     }
 }
@@ -0,0 +1,251 @@
+//! Zero-copy EQL lexer
+//!
+//! Tokens borrow their text from the input, so lexing a rule allocates
+//! nothing; only the AST built from the tokens owns strings.
+//!
+//! Besides the tokens of the pest grammar (`eql.pest`), the lexer accepts
+//! `--` line comments and the `~` of the `regex~` operator, both of which
+//! appear in the rule files shipped under `rules/`.
+
+use crate::error::{EqlError, Result};
+
+/// Token kind
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TokenKind {
+    /// Identifier or dotted field reference (`process`, `process.pid`)
+    Ident,
+    /// Unsigned integer literal
+    Int,
+    /// String literal, including the surrounding quotes
+    Str,
+    LParen,
+    RParen,
+    LBracket,
+    RBracket,
+    Comma,
+    /// `=` (only used by `maxspan=`)
+    Assign,
+    EqEq,
+    NotEq,
+    Less,
+    LessEq,
+    Greater,
+    GreaterEq,
+    Plus,
+    Minus,
+    Star,
+    Slash,
+    AndAnd,
+    OrOr,
+    Bang,
+    Tilde,
+    Eof,
+}
+
+/// A token borrowing its text from the input
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Token<'a> {
+    pub kind: TokenKind,
+    pub text: &'a str,
+    /// Byte offset of the token in the input
+    pub start: usize,
+}
+
+impl<'a> Token<'a> {
+    /// Byte offset just past the token
+    pub fn end(&self) -> usize {
+        self.start + self.text.len()
+    }
+
+    /// Whether this token is the given keyword
+    pub fn is_keyword(&self, keyword: &str) -> bool {
+        self.kind == TokenKind::Ident && self.text == keyword
+    }
+}
+
+/// Zero-copy lexer over an EQL query
+///
+/// Cheap to clone, which the parser uses for multi-token lookahead.
+#[derive(Debug, Clone)]
+pub struct Lexer<'a> {
+    src: &'a str,
+    pos: usize,
+}
+
+impl<'a> Lexer<'a> {
+    /// Create a lexer over `src`
+    pub fn new(src: &'a str) -> Self {
+        Self { src, pos: 0 }
+    }
+
+    /// Produce the next token, `Eof` at end of input
+    pub fn next_token(&mut self) -> Result<Token<'a>> {
+        self.skip_trivia();
+
+        let bytes = self.src.as_bytes();
+        let start = self.pos;
+
+        let Some(&b) = bytes.get(start) else {
+            return Ok(Token {
+                kind: TokenKind::Eof,
+                text: "",
+                start,
+            });
+        };
+
+        let (kind, len) = match b {
+            b'a'..=b'z' | b'A'..=b'Z' => (TokenKind::Ident, self.scan_field_ref(start)),
+            b'0'..=b'9' => {
+                let len = bytes[start..]
+                    .iter()
+                    .take_while(|c| c.is_ascii_digit())
+                    .count();
+                (TokenKind::Int, len)
+            }
+            b'"' => match find_closing_quote(&bytes[start + 1..]) {
+                Some(close) => (TokenKind::Str, close + 2),
+                None => {
+                    return Err(EqlError::syntax(
+                        location(self.src, start),
+                        "Unterminated string literal",
+                    ))
+                }
+            },
+            b'(' => (TokenKind::LParen, 1),
+            b')' => (TokenKind::RParen, 1),
+            b'[' => (TokenKind::LBracket, 1),
+            b']' => (TokenKind::RBracket, 1),
+            b',' => (TokenKind::Comma, 1),
+            b'+' => (TokenKind::Plus, 1),
+            b'-' => (TokenKind::Minus, 1),
+            b'*' => (TokenKind::Star, 1),
+            b'/' => (TokenKind::Slash, 1),
+            b'~' => (TokenKind::Tilde, 1),
+            b'=' if bytes.get(start + 1) == Some(&b'=') => (TokenKind::EqEq, 2),
+            b'=' => (TokenKind::Assign, 1),
+            b'!' if bytes.get(start + 1) == Some(&b'=') => (TokenKind::NotEq, 2),
+            b'!' => (TokenKind::Bang, 1),
+            b'<' if bytes.get(start + 1) == Some(&b'=') => (TokenKind::LessEq, 2),
+            b'<' => (TokenKind::Less, 1),
+            b'>' if bytes.get(start + 1) == Some(&b'=') => (TokenKind::GreaterEq, 2),
+            b'>' => (TokenKind::Greater, 1),
+            b'&' if bytes.get(start + 1) == Some(&b'&') => (TokenKind::AndAnd, 2),
+            b'|' if bytes.get(start + 1) == Some(&b'|') => (TokenKind::OrOr, 2),
+            _ => {
+                let c = self.src[start..].chars().next().unwrap_or('?');
+                return Err(EqlError::syntax(
+                    location(self.src, start),
+                    format!("Unexpected character '{}'", c),
+                ));
+            }
+        };
+
+        self.pos = start + len;
+        Ok(Token {
+            kind,
+            text: &self.src[start..start + len],
+            start,
+        })
+    }
+
+    /// Skip whitespace and `--` line comments
+    fn skip_trivia(&mut self) {
+        let bytes = self.src.as_bytes();
+        loop {
+            while let Some(b' ' | b'\t' | b'\n' | b'\r') = bytes.get(self.pos) {
+                self.pos += 1;
+            }
+            if bytes.get(self.pos) == Some(&b'-') && bytes.get(self.pos + 1) == Some(&b'-') {
+                while let Some(&b) = bytes.get(self.pos) {
+                    if b == b'\n' {
+                        break;
+                    }
+                    self.pos += 1;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    /// Scan `identifier ("." identifier)*`, returning its length
+    fn scan_field_ref(&self, start: usize) -> usize {
+        let bytes = self.src.as_bytes();
+        let mut pos = start;
+        loop {
+            // identifier = ASCII letter followed by letters, digits or '_'
+            pos += 1;
+            while let Some(b'a'..=b'z' | b'A'..=b'Z' | b'0'..=b'9' | b'_') = bytes.get(pos) {
+                pos += 1;
+            }
+            match (bytes.get(pos), bytes.get(pos + 1)) {
+                (Some(b'.'), Some(b'a'..=b'z' | b'A'..=b'Z')) => pos += 1,
+                _ => return pos - start,
+            }
+        }
+    }
+}
+
+/// Find the closing quote of a string literal body
+fn find_closing_quote(bytes: &[u8]) -> Option<usize> {
+    bytes.iter().position(|&b| b == b'"')
+}
+
+/// Render a byte offset as `line:column` for error messages
+pub fn location(src: &str, offset: usize) -> String {
+    let offset = offset.min(src.len());
+    let before = &src[..offset];
+    let line = before.bytes().filter(|&b| b == b'\n').count() + 1;
+    let column = before.rfind('\n').map_or(offset, |nl| offset - nl - 1) + 1;
+    format!("{}:{}", line, column)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn kinds(src: &str) -> Vec<TokenKind> {
+        let mut lexer = Lexer::new(src);
+        let mut out = Vec::new();
+        loop {
+            let token = lexer.next_token().unwrap();
+            out.push(token.kind);
+            if token.kind == TokenKind::Eof {
+                return out;
+            }
+        }
+    }
+
+    #[test]
+    fn test_lex_field_refs_and_operators() {
+        use TokenKind::*;
+        assert_eq!(
+            kinds("process.pid >= 10 && !x != \"a b\""),
+            vec![Ident, GreaterEq, Int, AndAnd, Bang, Ident, NotEq, Str, Eof]
+        );
+    }
+
+    #[test]
+    fn test_lex_tokens_borrow_input() {
+        let src = "file where file.path == \"/etc/passwd\"";
+        let mut lexer = Lexer::new(src);
+        lexer.next_token().unwrap();
+        lexer.next_token().unwrap();
+        let field = lexer.next_token().unwrap();
+        assert_eq!(field.text, "file.path");
+        assert_eq!(field.start, 11);
+        assert!(std::ptr::eq(field.text.as_ptr(), src[11..].as_ptr()));
+    }
+
+    #[test]
+    fn test_lex_comments_and_errors() {
+        use TokenKind::*;
+        assert_eq!(kinds("-- header\nprocess -- trailing\n"), vec![Ident, Eof]);
+        assert!(Lexer::new("\"open").next_token().is_err());
+        let mut lexer = Lexer::new("x == $");
+        lexer.next_token().unwrap();
+        lexer.next_token().unwrap();
+        assert!(lexer.next_token().is_err());
+        assert_eq!(location("a\nbc", 3), "2:2");
+    }
+}
@@ -7,10 +7,13 @@ pub mod codegen_wasm;
 pub mod compiler;
 pub mod error;
 pub mod ir;
+pub mod lexer;
+pub mod lowering;
 pub mod parser;
+pub mod pratt_parser;
 pub mod semantic;
 
 // Re-exports
 pub use compiler::EqlCompiler;
 pub use error::{EqlError, Result};
-pub use ir::{IrLiteral, IrNode, IrPredicate, IrRule, IrRuleType};
+pub use ir::{IrLiteral, IrLiteralSet, IrNode, IrPredicate, IrRule, IrRuleType};
@@ -0,0 +1,211 @@
+//! IR lowering passes
+//!
+//! Rewrites applied to predicate roots after semantic analysis, before
+//! requirement extraction and codegen.
+
+use crate::ir::*;
+
+/// Shape of a wildcard pattern that needs no glob matcher
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum WildcardShape {
+    /// `lit`
+    Exact,
+    /// `lit*`
+    Prefix,
+    /// `*lit`
+    Suffix,
+    /// `*lit*`
+    Infix,
+}
+
+/// Rewrite wildcard calls with simple patterns into string functions
+///
+/// | Pattern | Lowered to                   |
+/// |---------|------------------------------|
+/// | `lit`   | `stringEquals(value, "lit")` |
+/// | `lit*`  | `startsWith(value, "lit")`   |
+/// | `*lit`  | `endsWith(value, "lit")`     |
+/// | `*lit*` | `contains(value, "lit")`     |
+///
+/// The literal then reaches `PatternExtractor`, so the predicate can be
+/// prefiltered by the AC-DFA. Patterns with `?`, character classes or
+/// inner `*` keep the glob matcher.
+pub fn lower_wildcards(node: &mut IrNode) {
+    match node {
+        IrNode::FunctionCall {
+            func: IrFunction::Wildcard,
+            args,
+        } => {
+            if let Some(lowered) = lower_wildcard_call(args) {
+                *node = lowered;
+            }
+        }
+        IrNode::FunctionCall { args, .. } => {
+            for arg in args {
+                lower_wildcards(arg);
+            }
+        }
+        IrNode::BinaryOp { left, right, .. } => {
+            lower_wildcards(left);
+            lower_wildcards(right);
+        }
+        IrNode::UnaryOp { operand, .. } => lower_wildcards(operand),
+        IrNode::ArrayQuantifier {
+            element_condition, ..
+        } => lower_wildcards(element_condition),
+        IrNode::In { .. }
+        | IrNode::InSet { .. }
+        | IrNode::Literal { .. }
+        | IrNode::LoadField { .. } => {}
+    }
+}
+
+/// Lower `wildcard(pattern, value)`; the pattern may be either argument
+fn lower_wildcard_call(args: &[IrNode]) -> Option<IrNode> {
+    let (pattern, value) = match args {
+        [IrNode::Literal {
+            value: IrLiteral::String(pattern),
+        }, value]
+        | [value, IrNode::Literal {
+            value: IrLiteral::String(pattern),
+        }] if !matches!(value, IrNode::Literal { .. }) => (pattern, value),
+        _ => return None,
+    };
+
+    let (shape, literal) = classify_wildcard(pattern)?;
+    let value = value.clone();
+    let literal = IrNode::Literal {
+        value: IrLiteral::String(literal.to_string()),
+    };
+
+    let func = match shape {
+        WildcardShape::Exact => IrFunction::StringEquals,
+        WildcardShape::Prefix => IrFunction::StartsWith,
+        WildcardShape::Suffix => IrFunction::EndsWith,
+        WildcardShape::Infix => IrFunction::Contains,
+    };
+
+    Some(IrNode::FunctionCall {
+        func,
+        args: vec![value, literal],
+    })
+}
+
+/// Classify a wildcard pattern, returning its shape and literal part
+fn classify_wildcard(pattern: &str) -> Option<(WildcardShape, &str)> {
+    let (leading, rest) = match pattern.strip_prefix('*') {
+        Some(rest) => (true, rest),
+        None => (false, pattern),
+    };
+    let (trailing, literal) = match rest.strip_suffix('*') {
+        Some(literal) => (true, literal),
+        None => (false, rest),
+    };
+
+    // `*` alone, `**` and any remaining metacharacter need the glob matcher
+    if literal.is_empty() || literal.contains(['*', '?', '[', ']']) {
+        return None;
+    }
+
+    let shape = match (leading, trailing) {
+        (false, false) => WildcardShape::Exact,
+        (false, true) => WildcardShape::Prefix,
+        (true, false) => WildcardShape::Suffix,
+        (true, true) => WildcardShape::Infix,
+    };
+    Some((shape, literal))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn wildcard(pattern: &str) -> IrNode {
+        IrNode::FunctionCall {
+            func: IrFunction::Wildcard,
+            args: vec![
+                IrNode::Literal {
+                    value: IrLiteral::String(pattern.to_string()),
+                },
+                IrNode::LoadField { field_id: 1 },
+            ],
+        }
+    }
+
+    fn call(func: IrFunction, literal: &str) -> IrNode {
+        IrNode::FunctionCall {
+            func,
+            args: vec![
+                IrNode::LoadField { field_id: 1 },
+                IrNode::Literal {
+                    value: IrLiteral::String(literal.to_string()),
+                },
+            ],
+        }
+    }
+
+    fn lowered(node: IrNode) -> IrNode {
+        let mut node = node;
+        lower_wildcards(&mut node);
+        node
+    }
+
+    #[test]
+    fn test_lower_simple_shapes() {
+        assert_eq!(
+            lowered(wildcard("*\\powershell.exe")),
+            call(IrFunction::EndsWith, "\\powershell.exe")
+        );
+        assert_eq!(
+            lowered(wildcard("/tmp/*")),
+            call(IrFunction::StartsWith, "/tmp/")
+        );
+        assert_eq!(
+            lowered(wildcard("*mimikatz*")),
+            call(IrFunction::Contains, "mimikatz")
+        );
+        assert_eq!(
+            lowered(wildcard("/bin/sh")),
+            call(IrFunction::StringEquals, "/bin/sh")
+        );
+    }
+
+    #[test]
+    fn test_keep_glob_for_complex_patterns() {
+        for pattern in ["*", "**", "/tmp/*.sh", "file?.txt", "[ab]*", "**/x"] {
+            assert_eq!(lowered(wildcard(pattern)), wildcard(pattern), "{}", pattern);
+        }
+    }
+
+    #[test]
+    fn test_lower_nested_and_field_first() {
+        let field_first = IrNode::FunctionCall {
+            func: IrFunction::Wildcard,
+            args: vec![
+                IrNode::LoadField { field_id: 1 },
+                IrNode::Literal {
+                    value: IrLiteral::String("*.exe".to_string()),
+                },
+            ],
+        };
+        let node = lowered(node_helpers::and(
+            IrNode::UnaryOp {
+                op: IrUnaryOp::Not,
+                operand: Box::new(field_first),
+            },
+            wildcard("/usr/*"),
+        ));
+
+        assert_eq!(
+            node,
+            node_helpers::and(
+                IrNode::UnaryOp {
+                    op: IrUnaryOp::Not,
+                    operand: Box::new(call(IrFunction::EndsWith, ".exe")),
+                },
+                call(IrFunction::StartsWith, "/usr/"),
+            )
+        );
+        assert!(node.glob_patterns().is_empty());
+    }
+}
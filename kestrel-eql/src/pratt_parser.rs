@@ -0,0 +1,611 @@
+//! Hand-written EQL parser
+//!
+//! A Pratt (top-down operator precedence) parser over the zero-copy
+//! [`Lexer`](crate::lexer::Lexer). It accepts the language of `eql.pest`
+//! and produces the same `ast::Query` types, without backtracking and
+//! without building an intermediate parse tree, which keeps bulk rule
+//! loading (e.g. IOC rules with thousands of `in` literals) linear.
+//!
+//! Precedence, lowest to highest:
+//!
+//! | Operators                        | Associativity |
+//! |----------------------------------|---------------|
+//! | `or`, `\|\|`                     | left          |
+//! | `and`, `&&`                      | left          |
+//! | `not`, `!` (prefix)              | -             |
+//! | `==` `!=` `<` `<=` `>` `>=` `regex~` | left      |
+//! | `+` `-`                          | left          |
+//! | `*` `/`                          | left          |
+//!
+//! `field regex~ "pattern"` is sugar for `regex("pattern", field)`.
+
+use crate::ast::*;
+use crate::error::{EqlError, Result};
+use crate::lexer::{location, Lexer, Token, TokenKind};
+
+/// Binding powers (left, right) of the infix operators
+const BP_OR: (u8, u8) = (1, 2);
+const BP_AND: (u8, u8) = (3, 4);
+const BP_COMPARISON: (u8, u8) = (5, 6);
+const BP_ADDITIVE: (u8, u8) = (7, 8);
+const BP_MULTIPLICATIVE: (u8, u8) = (9, 10);
+/// `not` may only start an operand of `and`/`or`, as in the grammar
+const BP_NOT_MAX: u8 = BP_AND.1;
+
+/// Parse EQL query string into AST
+pub fn parse(input: &str) -> Result<Query> {
+    let mut parser = Parser::new(input)?;
+    let query = parser.parse_query()?;
+    if parser.current.kind != TokenKind::Eof {
+        return Err(parser.error("Unexpected trailing input"));
+    }
+    Ok(query)
+}
+
+/// Infix operator recognized at the current token
+#[derive(Debug, Clone, Copy)]
+enum Infix {
+    Binary(BinaryOperator),
+    /// `regex~`, spans two tokens
+    RegexMatch,
+}
+
+struct Parser<'a> {
+    src: &'a str,
+    lexer: Lexer<'a>,
+    current: Token<'a>,
+}
+
+impl<'a> Parser<'a> {
+    fn new(src: &'a str) -> Result<Self> {
+        let mut lexer = Lexer::new(src);
+        let current = lexer.next_token()?;
+        Ok(Self {
+            src,
+            lexer,
+            current,
+        })
+    }
+
+    /// Consume the current token and return it
+    fn advance(&mut self) -> Result<Token<'a>> {
+        let next = self.lexer.next_token()?;
+        Ok(std::mem::replace(&mut self.current, next))
+    }
+
+    /// Look at the token after the current one
+    fn peek_next(&self) -> Result<Token<'a>> {
+        self.lexer.clone().next_token()
+    }
+
+    fn expect(&mut self, kind: TokenKind, what: &str) -> Result<Token<'a>> {
+        if self.current.kind == kind {
+            self.advance()
+        } else {
+            Err(self.error(format!("Expected {}", what)))
+        }
+    }
+
+    fn expect_keyword(&mut self, keyword: &str) -> Result<()> {
+        if self.current.is_keyword(keyword) {
+            self.advance()?;
+            Ok(())
+        } else {
+            Err(self.error(format!("Expected '{}'", keyword)))
+        }
+    }
+
+    /// Expect a plain (undotted) identifier
+    fn expect_identifier(&mut self, what: &str) -> Result<&'a str> {
+        if self.current.kind == TokenKind::Ident && !self.current.text.contains('.') {
+            Ok(self.advance()?.text)
+        } else {
+            Err(self.error(format!("Expected {}", what)))
+        }
+    }
+
+    fn error(&self, message: impl Into<String>) -> EqlError {
+        let found = match self.current.kind {
+            TokenKind::Eof => "end of input".to_string(),
+            _ => format!("'{}'", self.current.text),
+        };
+        EqlError::syntax(
+            location(self.src, self.current.start),
+            format!("{}, found {}", message.into(), found),
+        )
+    }
+
+    // ------------------------------------------------------------------
+    // Queries
+    // ------------------------------------------------------------------
+
+    fn parse_query(&mut self) -> Result<Query> {
+        if self.current.is_keyword("sequence") {
+            let next = self.peek_next()?;
+            if !next.is_keyword("where") && next.kind != TokenKind::Eof {
+                return self.parse_sequence_query();
+            }
+        }
+        self.parse_event_query()
+    }
+
+    fn parse_event_query(&mut self) -> Result<Query> {
+        let event_type = self.expect_identifier("event type")?.to_string();
+        let condition = self.parse_where_clause()?;
+
+        Ok(Query::Event(Box::new(EventQuery {
+            event_type,
+            condition,
+            captures: Vec::new(),
+        })))
+    }
+
+    fn parse_sequence_query(&mut self) -> Result<Query> {
+        self.expect_keyword("sequence")?;
+        self.expect_keyword("by")?;
+        let by = Some(
+            self.expect(TokenKind::Ident, "'by' field reference")?
+                .text
+                .to_string(),
+        );
+
+        let mut steps = Vec::new();
+        while self.current.kind == TokenKind::LBracket {
+            steps.push(self.parse_sequence_step()?);
+        }
+        if steps.is_empty() {
+            return Err(self.error("Expected sequence step"));
+        }
+
+        let maxspan = if self.current.is_keyword("with") {
+            self.advance()?;
+            self.expect_keyword("maxspan")?;
+            self.expect(TokenKind::Assign, "'='")?;
+            Some(self.parse_duration()?)
+        } else {
+            None
+        };
+
+        let until = if self.current.is_keyword("until") {
+            self.advance()?;
+            Some(Box::new(self.parse_sequence_step()?))
+        } else {
+            None
+        };
+
+        Ok(Query::Sequence(Box::new(SequenceQuery {
+            steps,
+            by,
+            maxspan,
+            until,
+            captures: Vec::new(),
+        })))
+    }
+
+    fn parse_sequence_step(&mut self) -> Result<SequenceStep> {
+        self.expect(TokenKind::LBracket, "'['")?;
+        let event_type = self.expect_identifier("event type")?.to_string();
+        let condition = self.parse_where_clause()?;
+        self.expect(TokenKind::RBracket, "']'")?;
+
+        Ok(SequenceStep {
+            event_type,
+            condition,
+            id: None,
+        })
+    }
+
+    fn parse_where_clause(&mut self) -> Result<Option<Expr>> {
+        if self.current.is_keyword("where") {
+            self.advance()?;
+            Ok(Some(self.parse_expr(0)?))
+        } else {
+            Ok(None)
+        }
+    }
+
+    /// Duration: integer immediately followed by `ms`, `s`, `m` or `h`
+    fn parse_duration(&mut self) -> Result<Duration> {
+        let value_token = self.expect(TokenKind::Int, "duration")?;
+        let value: u64 = value_token.text.parse().map_err(|_| {
+            EqlError::syntax(
+                location(self.src, value_token.start),
+                "Invalid duration value",
+            )
+        })?;
+
+        let unit = match self.current {
+            Token {
+                kind: TokenKind::Ident,
+                text,
+                start,
+            } if start == value_token.end() => match text {
+                "ms" => DurationUnit::Milliseconds,
+                "s" => DurationUnit::Seconds,
+                "m" => DurationUnit::Minutes,
+                "h" => DurationUnit::Hours,
+                _ => return Err(self.error("Invalid duration unit")),
+            },
+            _ => return Err(self.error("Expected duration unit")),
+        };
+        self.advance()?;
+
+        Ok(Duration { value, unit })
+    }
+
+    // ------------------------------------------------------------------
+    // Expressions
+    // ------------------------------------------------------------------
+
+    /// Parse an expression whose operators bind at least as tightly as `min_bp`
+    fn parse_expr(&mut self, min_bp: u8) -> Result<Expr> {
+        let mut lhs = self.parse_prefix(min_bp)?;
+
+        loop {
+            let Some((infix, (left_bp, right_bp))) = self.current_infix()? else {
+                break;
+            };
+            if left_bp < min_bp {
+                break;
+            }
+
+            self.advance()?;
+            if let Infix::RegexMatch = infix {
+                self.advance()?; // '~'
+            }
+
+            let rhs = self.parse_expr(right_bp)?;
+            lhs = match infix {
+                Infix::Binary(operator) => Expr::BinaryOp(Box::new(BinaryOp {
+                    operator,
+                    left: lhs,
+                    right: rhs,
+                })),
+                Infix::RegexMatch => Expr::FunctionCall(FunctionCall {
+                    function: "regex".to_string(),
+                    args: vec![rhs, lhs],
+                }),
+            };
+        }
+
+        Ok(lhs)
+    }
+
+    fn current_infix(&self) -> Result<Option<(Infix, (u8, u8))>> {
+        use BinaryOperator::*;
+
+        let binary = |op, bp| Ok(Some((Infix::Binary(op), bp)));
+        match self.current.kind {
+            TokenKind::OrOr => binary(Or, BP_OR),
+            TokenKind::AndAnd => binary(And, BP_AND),
+            TokenKind::EqEq => binary(Eq, BP_COMPARISON),
+            TokenKind::NotEq => binary(NotEq, BP_COMPARISON),
+            TokenKind::Less => binary(Less, BP_COMPARISON),
+            TokenKind::LessEq => binary(LessEq, BP_COMPARISON),
+            TokenKind::Greater => binary(Greater, BP_COMPARISON),
+            TokenKind::GreaterEq => binary(GreaterEq, BP_COMPARISON),
+            TokenKind::Plus => binary(Add, BP_ADDITIVE),
+            TokenKind::Minus => binary(Sub, BP_ADDITIVE),
+            TokenKind::Star => binary(Mul, BP_MULTIPLICATIVE),
+            TokenKind::Slash => binary(Div, BP_MULTIPLICATIVE),
+            TokenKind::Ident => match self.current.text {
+                "or" => binary(Or, BP_OR),
+                "and" => binary(And, BP_AND),
+                "regex" => {
+                    let next = self.peek_next()?;
+                    if next.kind == TokenKind::Tilde && next.start == self.current.end() {
+                        Ok(Some((Infix::RegexMatch, BP_COMPARISON)))
+                    } else {
+                        Ok(None)
+                    }
+                }
+                _ => Ok(None),
+            },
+            _ => Ok(None),
+        }
+    }
+
+    fn parse_prefix(&mut self, min_bp: u8) -> Result<Expr> {
+        if self.current.is_keyword("not") || self.current.kind == TokenKind::Bang {
+            if min_bp > BP_NOT_MAX {
+                return Err(self.error("'not' must be parenthesized here"));
+            }
+            self.advance()?;
+            let operand = self.parse_expr(BP_COMPARISON.0)?;
+            return Ok(Expr::UnaryOp(Box::new(UnaryOp {
+                operator: UnaryOperator::Not,
+                operand,
+            })));
+        }
+
+        self.parse_primary()
+    }
+
+    fn parse_primary(&mut self) -> Result<Expr> {
+        let token = self.current;
+        let atom = match token.kind {
+            TokenKind::LParen => {
+                self.advance()?;
+                let inner = self.parse_expr(0)?;
+                self.expect(TokenKind::RParen, "')'")?;
+                inner
+            }
+            TokenKind::Int => {
+                self.advance()?;
+                let value = token.text.parse::<i64>().map_err(|_| {
+                    EqlError::syntax(location(self.src, token.start), "Integer literal overflow")
+                })?;
+                Expr::IntLiteral(value)
+            }
+            TokenKind::Str => {
+                self.advance()?;
+                // Remove quotes; the grammar has no escape sequences
+                Expr::StringLiteral(token.text[1..token.text.len() - 1].to_string())
+            }
+            TokenKind::Ident => {
+                if self.peek_next()?.kind == TokenKind::LParen {
+                    if matches!(token.text, "any" | "all") && self.is_quantifier()? {
+                        return self.parse_quantifier();
+                    }
+                    return self.parse_function_call();
+                }
+                self.advance()?;
+                match token.text {
+                    "true" => Expr::BoolLiteral(true),
+                    "false" => Expr::BoolLiteral(false),
+                    "null" => Expr::Null,
+                    path => Expr::FieldRef(path.to_string()),
+                }
+            }
+            _ => return Err(self.error("Expected expression")),
+        };
+
+        if self.current.is_keyword("in") {
+            return self.parse_in(atom);
+        }
+        Ok(atom)
+    }
+
+    /// `atom in (expr, ...)`
+    fn parse_in(&mut self, value: Expr) -> Result<Expr> {
+        self.expect_keyword("in")?;
+        self.expect(TokenKind::LParen, "'('")?;
+        let values = self.parse_expr_list()?;
+        self.expect(TokenKind::RParen, "')'")?;
+
+        Ok(Expr::In(Box::new(InExpr {
+            value: Box::new(value),
+            values,
+        })))
+    }
+
+    /// `expr ("," expr)*`
+    fn parse_expr_list(&mut self) -> Result<Vec<Expr>> {
+        let mut exprs = vec![self.parse_expr(0)?];
+        while self.current.kind == TokenKind::Comma {
+            self.advance()?;
+            exprs.push(self.parse_expr(0)?);
+        }
+        Ok(exprs)
+    }
+
+    /// `name(expr, ...)`
+    fn parse_function_call(&mut self) -> Result<Expr> {
+        let function = self.expect_identifier("function name")?.to_string();
+        self.expect(TokenKind::LParen, "'('")?;
+        let args = self.parse_expr_list()?;
+        self.expect(TokenKind::RParen, "')'")?;
+
+        Ok(Expr::FunctionCall(FunctionCall { function, args }))
+    }
+
+    /// Whether the current `any`/`all` starts `any(field <op> ...)`
+    fn is_quantifier(&self) -> Result<bool> {
+        let mut lookahead = self.lexer.clone();
+        let _paren = lookahead.next_token()?;
+        let field = lookahead.next_token()?;
+        let op = lookahead.next_token()?;
+        Ok(field.kind == TokenKind::Ident
+            && matches!(
+                op.kind,
+                TokenKind::EqEq
+                    | TokenKind::NotEq
+                    | TokenKind::Less
+                    | TokenKind::LessEq
+                    | TokenKind::Greater
+                    | TokenKind::GreaterEq
+            ))
+    }
+
+    /// `any(field <op> expr)` / `all(field <op> expr)`
+    fn parse_quantifier(&mut self) -> Result<Expr> {
+        let quantifier = match self.advance()?.text {
+            "any" => QuantifierType::Any,
+            _ => QuantifierType::All,
+        };
+        self.expect(TokenKind::LParen, "'('")?;
+        let array_field = self.advance()?.text.to_string();
+        let operator = match self.advance()?.kind {
+            TokenKind::EqEq => BinaryOperator::Eq,
+            TokenKind::NotEq => BinaryOperator::NotEq,
+            TokenKind::Less => BinaryOperator::Less,
+            TokenKind::LessEq => BinaryOperator::LessEq,
+            TokenKind::Greater => BinaryOperator::Greater,
+            _ => BinaryOperator::GreaterEq,
+        };
+        let value = self.parse_expr(0)?;
+        self.expect(TokenKind::RParen, "')'")?;
+
+        let condition = Expr::BinaryOp(Box::new(BinaryOp {
+            operator,
+            left: Expr::FieldRef(array_field.clone()),
+            right: value,
+        }));
+
+        Ok(Expr::ArrayQuantifier(Box::new(ArrayQuantifier {
+            quantifier,
+            array_field,
+            condition,
+        })))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn condition(query: &str) -> Expr {
+        match parse(query).unwrap() {
+            Query::Event(eq) => eq.condition.unwrap(),
+            _ => panic!("Expected event query"),
+        }
+    }
+
+    fn binary(operator: BinaryOperator, left: Expr, right: Expr) -> Expr {
+        Expr::BinaryOp(Box::new(BinaryOp {
+            operator,
+            left,
+            right,
+        }))
+    }
+
+    fn field(path: &str) -> Expr {
+        Expr::FieldRef(path.to_string())
+    }
+
+    #[test]
+    fn test_parse_logical_precedence() {
+        let expr = condition("process where a == 1 or b == 2 and not c == 3");
+        let expected = binary(
+            BinaryOperator::Or,
+            binary(BinaryOperator::Eq, field("a"), Expr::IntLiteral(1)),
+            binary(
+                BinaryOperator::And,
+                binary(BinaryOperator::Eq, field("b"), Expr::IntLiteral(2)),
+                Expr::UnaryOp(Box::new(UnaryOp {
+                    operator: UnaryOperator::Not,
+                    operand: binary(BinaryOperator::Eq, field("c"), Expr::IntLiteral(3)),
+                })),
+            ),
+        );
+        assert_eq!(expr, expected);
+    }
+
+    #[test]
+    fn test_parse_arithmetic_precedence() {
+        let expr = condition("process where process.pid + 2 * 3 > 10");
+        let expected = binary(
+            BinaryOperator::Greater,
+            binary(
+                BinaryOperator::Add,
+                field("process.pid"),
+                binary(
+                    BinaryOperator::Mul,
+                    Expr::IntLiteral(2),
+                    Expr::IntLiteral(3),
+                ),
+            ),
+            Expr::IntLiteral(10),
+        );
+        assert_eq!(expr, expected);
+    }
+
+    #[test]
+    fn test_parse_large_in_list() {
+        let values: Vec<String> = (0..5000).map(|i| format!("\"{:032x}\"", i)).collect();
+        let query = format!("file where file.hash in ({})", values.join(", "));
+
+        match condition(&query) {
+            Expr::In(in_expr) => {
+                assert_eq!(*in_expr.value, field("file.hash"));
+                assert_eq!(in_expr.values.len(), 5000);
+                assert_eq!(
+                    in_expr.values[1],
+                    Expr::StringLiteral(format!("{:032x}", 1))
+                );
+            }
+            other => panic!("Expected in expression, got {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_parse_functions_and_quantifiers() {
+        let expr =
+            condition("file where wildcard(file.path, \"*.exe\") and any(file.tags == \"x\")");
+        match expr {
+            Expr::BinaryOp(op) => {
+                assert!(
+                    matches!(op.left, Expr::FunctionCall(ref fc) if fc.function == "wildcard" && fc.args.len() == 2)
+                );
+                match op.right {
+                    Expr::ArrayQuantifier(aq) => {
+                        assert_eq!(aq.quantifier, QuantifierType::Any);
+                        assert_eq!(aq.array_field, "file.tags");
+                    }
+                    other => panic!("Expected quantifier, got {:?}", other),
+                }
+            }
+            other => panic!("Expected binary op, got {:?}", other),
+        }
+    }
+
+    #[test]
+    fn test_parse_sequence_with_clauses() {
+        let query = parse(
+            "sequence by process.entity_id [process where process.pid > 1] [file] \
+             with maxspan=5m until [network]",
+        )
+        .unwrap();
+        match query {
+            Query::Sequence(sq) => {
+                assert_eq!(sq.by.as_deref(), Some("process.entity_id"));
+                assert_eq!(sq.steps.len(), 2);
+                assert!(sq.steps[0].condition.is_some());
+                assert_eq!(
+                    sq.maxspan,
+                    Some(Duration {
+                        value: 5,
+                        unit: DurationUnit::Minutes
+                    })
+                );
+                assert_eq!(sq.until.unwrap().event_type, "network");
+            }
+            _ => panic!("Expected sequence query"),
+        }
+    }
+
+    #[test]
+    fn test_parse_rule_file_syntax() {
+        let expr = condition(
+            "-- comment line\nprocess where\n  file.path regex~ \".*\\\\.ssh/.*\" -- trailing\n",
+        );
+        assert_eq!(
+            expr,
+            Expr::FunctionCall(FunctionCall {
+                function: "regex".to_string(),
+                args: vec![
+                    Expr::StringLiteral(".*\\\\.ssh/.*".to_string()),
+                    field("file.path"),
+                ],
+            })
+        );
+    }
+
+    #[test]
+    fn test_parse_syntax_errors() {
+        assert!(parse("process where process.pid = 1000").is_err());
+        assert!(parse("process where a == not b").is_err());
+        assert!(parse("sequence [process] [file]").is_err());
+        assert!(parse("sequence by process.pid [process] with maxspan=5 s").is_err());
+        assert!(parse("process where a in (1, 2").is_err());
+        assert!(parse("process where 99999999999999999999 == 1").is_err());
+        // Not in eql.pest
+        assert!(parse("process where process.pid % 2 == 0").is_err());
+        assert!(parse("process where process.pid == -1").is_err());
+
+        match parse("process where\n  a == ").unwrap_err() {
+            EqlError::SyntaxError { location, .. } => assert_eq!(location, "2:8"),
+            other => panic!("Expected syntax error, got {:?}", other),
+        }
+    }
+}
@@ -5,6 +5,7 @@
 use crate::ast::*;
 use crate::error::{EqlError, Result};
 use crate::ir::*;
+use crate::lowering;
 use kestrel_schema::SchemaRegistry;
 use std::collections::HashMap;
 use std::sync::Arc;
@@ -68,14 +69,7 @@ impl SemanticAnalyzer {
 
         self.current_event_type = Some(query.event_type.clone());
 
-        // Analyze condition if present
-        let root = if let Some(condition) = &query.condition {
-            self.analyze_expr(condition)?
-        } else {
-            IrNode::Literal {
-                value: IrLiteral::Bool(true),
-            }
-        };
+        let root = self.analyze_condition(query.condition.as_ref())?;
 
         // Extract field IDs, regex patterns, and glob patterns
         let required_fields = root.field_ids();
@@ -125,13 +119,7 @@ impl SemanticAnalyzer {
 
             self.current_event_type = Some(step.event_type.clone());
 
-            let root = if let Some(condition) = &step.condition {
-                self.analyze_expr(condition)?
-            } else {
-                IrNode::Literal {
-                    value: IrLiteral::Bool(true),
-                }
-            };
+            let root = self.analyze_condition(step.condition.as_ref())?;
 
             let required_fields = root.field_ids();
             let required_regex = root.regex_patterns();
@@ -155,13 +143,7 @@ impl SemanticAnalyzer {
 
             self.current_event_type = Some(until.event_type.clone());
 
-            let root = if let Some(condition) = &until.condition {
-                self.analyze_expr(condition)?
-            } else {
-                IrNode::Literal {
-                    value: IrLiteral::Bool(true),
-                }
-            };
+            let root = self.analyze_condition(until.condition.as_ref())?;
 
             let required_fields = root.field_ids();
             let required_regex = root.regex_patterns();
@@ -229,6 +211,18 @@ impl SemanticAnalyzer {
         Ok(ir_rule)
     }
 
+    /// Analyze an optional predicate condition and apply IR lowering passes
+    fn analyze_condition(&mut self, condition: Option<&Expr>) -> Result<IrNode> {
+        let mut root = match condition {
+            Some(condition) => self.analyze_expr(condition)?,
+            None => IrNode::Literal {
+                value: IrLiteral::Bool(true),
+            },
+        };
+        lowering::lower_wildcards(&mut root);
+        Ok(root)
+    }
+
     /// Analyze an expression
     fn analyze_expr(&mut self, expr: &Expr) -> Result<IrNode> {
         match expr {
@@ -279,7 +273,22 @@ impl SemanticAnalyzer {
                     Ok(Type::Unknown)
                 }
             }
-            _ => Ok(Type::Unknown),
+            IrNode::BinaryOp { op, .. } => match op {
+                IrBinaryOp::Add
+                | IrBinaryOp::Sub
+                | IrBinaryOp::Mul
+                | IrBinaryOp::Div
+                | IrBinaryOp::Mod => Ok(Type::Int),
+                _ => Ok(Type::Bool),
+            },
+            IrNode::UnaryOp { op, .. } => match op {
+                IrUnaryOp::Not => Ok(Type::Bool),
+                IrUnaryOp::Neg => Ok(Type::Int),
+            },
+            IrNode::FunctionCall { .. }
+            | IrNode::In { .. }
+            | IrNode::InSet { .. }
+            | IrNode::ArrayQuantifier { .. } => Ok(Type::Bool),
         }
     }
 
@@ -295,6 +304,15 @@ impl SemanticAnalyzer {
         let left_type = self.get_node_type(left)?;
         let right_type = self.get_node_type(right)?;
 
+        // A field missing from the schema has no type to check
+        for (type_, expr) in [(&left_type, left_expr), (&right_type, right_expr)] {
+            if let (Type::Unknown, Expr::FieldRef(path)) = (type_, expr) {
+                if self.schema.get_field_id(path).is_none() {
+                    return Err(EqlError::unknown_field(path.clone(), format!("{:?}", expr)));
+                }
+            }
+        }
+
         match op {
             // Logical operators: both operands must be boolean
             BinaryOperator::And | BinaryOperator::Or => {
@@ -434,11 +452,16 @@ impl SemanticAnalyzer {
             .iter()
             .map(|v| self.expr_to_literal(v))
             .collect();
+        let values = values?;
 
-        Ok(IrNode::In {
-            value,
-            values: values?,
-        })
+        // Large homogeneous lists become a single host-side table lookup
+        if values.len() >= IN_SET_THRESHOLD {
+            if let Some(set) = IrLiteralSet::from_literals(&values) {
+                return Ok(IrNode::InSet { value, set });
+            }
+        }
+
+        Ok(IrNode::In { value, values })
     }
 
     fn analyze_array_quantifier(&mut self, aq: &ArrayQuantifier) -> Result<IrNode> {
@@ -769,4 +792,81 @@ mod tests {
             _ => panic!("Expected UnknownEventType error"),
         }
     }
+
+    #[test]
+    fn test_large_in_list_lowered_to_set() {
+        use kestrel_schema::EventTypeDef;
+
+        let mut schema = SchemaRegistry::new();
+        schema
+            .register_event_type(EventTypeDef {
+                name: "file".to_string(),
+                description: None,
+                parent: None,
+            })
+            .unwrap();
+        let mut analyzer = SemanticAnalyzer::new(Arc::new(schema));
+
+        let hashes: Vec<String> = (0..IN_SET_THRESHOLD)
+            .map(|i| format!("\"{:x}\"", i))
+            .collect();
+        let query = crate::pratt_parser::parse(&format!(
+            "file where file.hash in ({}) or file.size in (1, 2)",
+            hashes.join(", ")
+        ))
+        .unwrap();
+
+        let ir = analyzer.analyze(&query).unwrap();
+        match &ir.predicates["main"].root {
+            IrNode::BinaryOp { left, right, .. } => {
+                match left.as_ref() {
+                    IrNode::InSet { set, .. } => assert_eq!(set.len(), IN_SET_THRESHOLD),
+                    other => panic!("Expected set lookup, got {:?}", other),
+                }
+                // Short lists keep the comparison chain
+                assert!(matches!(right.as_ref(), IrNode::In { .. }));
+            }
+            other => panic!("Expected binary op, got {:?}", other),
+        }
+        assert_eq!(ir.literal_sets().len(), 1);
+    }
+
+    #[test]
+    fn test_untyped_fields_rejected() {
+        use kestrel_schema::{EventTypeDef, FieldDataType, FieldDef};
+
+        let mut schema = SchemaRegistry::new();
+        schema
+            .register_event_type(EventTypeDef {
+                name: "file".to_string(),
+                description: None,
+                parent: None,
+            })
+            .unwrap();
+        schema
+            .register_field(FieldDef {
+                path: "file.entropy".to_string(),
+                data_type: FieldDataType::F64,
+                description: None,
+            })
+            .unwrap();
+        let mut analyzer = SemanticAnalyzer::new(Arc::new(schema));
+        let mut analyze = |eql: &str| analyzer.analyze(&crate::pratt_parser::parse(eql).unwrap());
+
+        assert!(matches!(
+            analyze("file where file.missing == 1"),
+            Err(EqlError::UnknownField { .. })
+        ));
+        for eql in [
+            "file where file.entropy and true",
+            "file where file.entropy + 1 == 2",
+            "file where file.entropy == 1",
+        ] {
+            assert!(
+                matches!(analyze(eql), Err(EqlError::TypeMismatch { .. })),
+                "{}",
+                eql
+            );
+        }
+    }
 }
@@ -218,6 +218,39 @@ fn test_compile_to_wasm_simple() {
     }
 }
 
+#[test]
+fn test_wildcard_shapes_compile_to_valid_wasm() {
+    let mut schema = SchemaRegistry::new();
+    schema
+        .register_event_type(kestrel_schema::EventTypeDef {
+            name: "file".to_string(),
+            description: None,
+            parent: None,
+        })
+        .unwrap();
+    schema
+        .register_field(kestrel_schema::FieldDef {
+            path: "file.path".to_string(),
+            data_type: kestrel_schema::FieldDataType::String,
+            description: None,
+        })
+        .unwrap();
+    let mut compiler = EqlCompiler::new(Arc::new(schema));
+
+    // Each shape lowered to a string host function
+    for (pattern, host_fn) in [
+        ("/bin/sh", "$str_equals"),
+        ("/tmp/*", "$str_starts_with"),
+        ("*.exe", "$str_ends_with"),
+        ("*mimikatz*", "$str_contains"),
+    ] {
+        let eql = format!("file where wildcard(file.path, \"{}\")", pattern);
+        let wat = compiler.compile_to_wasm(&eql).unwrap();
+        assert!(wat.contains(&format!("(call {})", host_fn)), "{}", pattern);
+        wat::parse_str(&wat).unwrap_or_else(|e| panic!("{}: invalid WAT: {}", pattern, e));
+    }
+}
+
 #[test]
 fn test_syntax_error_handling() {
     let compiler = create_test_compiler();
@@ -391,3 +424,55 @@ fn test_duration_raw_parsing() {
         assert!(result.is_ok(), "Failed to parse raw query with duration {}: {:?}", duration, result.err());
     }
 }
+
+#[test]
+fn test_parse_keeps_logical_structure() {
+    use kestrel_eql::ast::{BinaryOperator, Expr, Query};
+
+    let compiler = create_test_compiler();
+
+    let query = compiler
+        .parse("process where process.pid == 1 and process.ppid == 2 or process.uid == 0")
+        .unwrap();
+
+    match query {
+        Query::Event(eq) => match eq.condition {
+            Some(Expr::BinaryOp(or)) => {
+                assert_eq!(or.operator, BinaryOperator::Or);
+                assert!(
+                    matches!(or.left, Expr::BinaryOp(ref and) if and.operator == BinaryOperator::And)
+                );
+                assert!(
+                    matches!(or.right, Expr::BinaryOp(ref eq) if eq.operator == BinaryOperator::Eq)
+                );
+            }
+            other => panic!("Expected binary op, got {:?}", other),
+        },
+        _ => panic!("Expected event query"),
+    }
+}
+
+#[test]
+fn test_parse_shipped_rule_files() {
+    let compiler = create_test_compiler();
+    let rules_dir = std::path::Path::new(env!("CARGO_MANIFEST_DIR")).join("../rules");
+
+    let mut parsed = 0;
+    for entry in std::fs::read_dir(&rules_dir).unwrap() {
+        let path = entry.unwrap().path().join("rule.eql");
+        if !path.exists() {
+            continue;
+        }
+        let source = std::fs::read_to_string(&path).unwrap();
+        let result = compiler.parse(&source);
+        assert!(
+            result.is_ok(),
+            "Failed to parse {}: {:?}",
+            path.display(),
+            result.err()
+        );
+        parsed += 1;
+    }
+
+    assert!(parsed > 0, "No rule files found in {}", rules_dir.display());
+}
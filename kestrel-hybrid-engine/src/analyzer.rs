@@ -390,6 +390,11 @@ impl RuleComplexityAnalyzer {
                 Ok(())
             }
 
+            IrNode::InSet { set, .. } => {
+                complexity.string_literals += set.strings().len();
+                Ok(())
+            }
+
             // Unary operations
             IrNode::UnaryOp { operand, .. } => Self::analyze_node(operand, complexity),
 
@@ -11,12 +11,16 @@ use crate::metrics::{EvictionReason, NfaMetrics};
 use crate::state::{NfaSequence, NfaStateId, PartialMatch, SeqStep};
 use crate::store::{StateStore, StateStoreConfig};
 use crate::{CompiledSequence, NfaError, NfaResult, PredicateEvaluator, SequenceAlert};
-use ahash::AHashMap;
+use ahash::{AHashMap, AHashSet};
 use parking_lot::RwLock;
 use std::collections::HashMap;
-use std::sync::Arc;
+use std::sync::{Arc, OnceLock};
+use std::time::Instant;
 use tracing::{debug, trace, warn};
 
+/// Events between amortized sweeps for partial matches of retired sequences
+const RECLAIM_EVERY_EVENTS: u32 = 1024;
+
 /// Configuration for the NFA engine
 #[derive(Debug, Clone)]
 pub struct NfaEngineConfig {
@@ -60,13 +64,175 @@ impl Default for NfaEngineConfig {
     }
 }
 
-/// NFA Engine - main execution engine for sequence detection
-pub struct NfaEngine {
-    /// Loaded sequences indexed by sequence ID
-    sequences: AHashMap<String, NfaSequence>,
+/// Monotonic clocks the engine reads, in nanoseconds
+///
+/// Evaluations are timed with `precise_ns`; budget windows only need
+/// `coarse_ns`. Both default to a process-local `Instant`; hosts with a
+/// shared clock install it with `NfaEngine::with_clock`.
+#[derive(Debug, Clone, Copy)]
+pub struct NfaClock {
+    /// Clock for measuring evaluation time
+    pub precise_ns: fn() -> u64,
+    /// Clock for budget window boundaries
+    pub coarse_ns: fn() -> u64,
+}
+
+impl Default for NfaClock {
+    fn default() -> Self {
+        Self {
+            precise_ns: instant_ns,
+            coarse_ns: instant_ns,
+        }
+    }
+}
+
+fn instant_ns() -> u64 {
+    static EPOCH: OnceLock<Instant> = OnceLock::new();
+    EPOCH.get_or_init(Instant::now).elapsed().as_nanos() as u64
+}
+
+/// Hook for sampling the cost of individual sequence evaluations
+///
+/// `begin` decides whether an evaluation is measured; `end` receives the
+/// measurement along with the sequence's current partial-match memory.
+/// Switching sequences off is done through `NfaSequence::set_kill_switch`.
+pub trait SequenceProfiler {
+    type Sample;
+
+    /// Start measuring an evaluation, or `None` to leave it unsampled
+    fn begin(&self) -> Option<Self::Sample>;
+
+    /// Finish a measurement started by `begin`
+    fn end(&self, sequence_id: &str, sample: Self::Sample, partial_match_bytes: usize);
+}
+
+/// No-op profiler used by the plain processing entry points
+impl SequenceProfiler for () {
+    type Sample = ();
+
+    #[inline]
+    fn begin(&self) -> Option<()> {
+        None
+    }
+
+    #[inline]
+    fn end(&self, _sequence_id: &str, _sample: (), _partial_match_bytes: usize) {}
+}
+
+/// A complete set of sequences with its event type index
+///
+/// Can be built off the event path, e.g. on a reload thread, and installed
+/// with `NfaEngine::swap_sequences`.
+#[derive(Debug, Clone, Default)]
+pub struct SequenceSet {
+    /// Sequences indexed by sequence ID
+    sequences: AHashMap<String, Arc<NfaSequence>>,
 
     /// Event type index: event_type_id -> sequence IDs that have steps matching this type
     event_type_index: HashMap<u16, Vec<String>>,
+}
+
+impl SequenceSet {
+    /// Build a set from compiled sequences; a later duplicate ID replaces
+    /// an earlier one
+    pub fn build(compiled: impl IntoIterator<Item = CompiledSequence>) -> Self {
+        let mut set = Self::default();
+        for sequence in compiled {
+            set.insert(sequence.id, sequence.sequence);
+        }
+        set
+    }
+
+    /// Number of sequences in the set
+    pub fn len(&self) -> usize {
+        self.sequences.len()
+    }
+
+    /// Whether the set has no sequences
+    pub fn is_empty(&self) -> bool {
+        self.sequences.is_empty()
+    }
+
+    /// Whether a sequence with this ID is in the set
+    pub fn contains(&self, sequence_id: &str) -> bool {
+        self.sequences.contains_key(sequence_id)
+    }
+
+    fn insert(&mut self, id: String, sequence: NfaSequence) {
+        if self.sequences.contains_key(&id) {
+            self.unindex(&id);
+        }
+
+        // Use a Set to avoid duplicates for steps with same event_type_id
+        let mut event_types: AHashSet<u16> = AHashSet::default();
+        let until = sequence.until_step.as_deref();
+        for step in sequence.steps.iter().chain(until) {
+            if event_types.insert(step.event_type_id) {
+                self.event_type_index
+                    .entry(step.event_type_id)
+                    .or_insert_with(Vec::new)
+                    .push(id.clone());
+            }
+        }
+
+        self.sequences.insert(id, Arc::new(sequence));
+    }
+
+    fn remove(&mut self, id: &str) -> Option<Arc<NfaSequence>> {
+        let removed = self.sequences.remove(id)?;
+        self.unindex(id);
+        Some(removed)
+    }
+
+    fn unindex(&mut self, id: &str) {
+        for seq_ids in self.event_type_index.values_mut() {
+            seq_ids.retain(|seq_id| seq_id != id);
+        }
+    }
+}
+
+/// Outcome of `NfaEngine::swap_sequences`
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct SequenceSwap {
+    /// Sequences with an unchanged definition; their partial matches carry over
+    pub kept: usize,
+
+    /// Sequences new to the engine
+    pub added: usize,
+
+    /// Sequences whose definition changed; their partial matches are dropped
+    pub changed: usize,
+
+    /// Sequences no longer loaded
+    pub removed: usize,
+}
+
+/// Partial matches left behind by a removed or redefined sequence
+#[derive(Debug, Default)]
+struct RetiredSequence {
+    /// Number of states the old definition could have stored matches in
+    states: NfaStateId,
+
+    /// Entities whose old matches the event path has already dropped
+    purged: AHashSet<u128>,
+}
+
+/// NFA Engine - main execution engine for sequence detection
+pub struct NfaEngine {
+    /// Loaded sequences and their event type index
+    sequences: SequenceSet,
+
+    /// Sequences whose partial matches from before a reload are not yet reclaimed
+    retired: AHashMap<String, RetiredSequence>,
+
+    /// Next state store shard to sweep for retired matches
+    reclaim_shard: usize,
+
+    /// Shards left to sweep before all retired matches are reclaimed
+    reclaim_pending: usize,
+
+    /// Events processed since the last amortized sweep
+    events_since_reclaim: u32,
 
     /// Predicate evaluator for evaluating predicates
     predicate_evaluator: Arc<dyn PredicateEvaluator>,
@@ -82,6 +248,9 @@ pub struct NfaEngine {
 
     /// Per-rule budget tracking: sequence_id -> (eval_count, eval_time_ns, window_start_ns)
     budget_tracker: RwLock<AHashMap<String, (u64, u64, u64)>>,
+
+    /// Clocks for evaluation timing and budget windows
+    clock: NfaClock,
 }
 
 impl NfaEngine {
@@ -91,16 +260,26 @@ impl NfaEngine {
         let state_store = StateStore::new(config.state_store.clone());
 
         Self {
-            sequences: AHashMap::default(),
-            event_type_index: HashMap::default(),
+            sequences: SequenceSet::default(),
+            retired: AHashMap::default(),
+            reclaim_shard: 0,
+            reclaim_pending: 0,
+            events_since_reclaim: 0,
             predicate_evaluator,
             state_store,
             metrics,
             config,
             budget_tracker: RwLock::new(AHashMap::default()),
+            clock: NfaClock::default(),
         }
     }
 
+    /// Read time from `clock` instead of the default `Instant` clocks
+    pub fn with_clock(mut self, clock: NfaClock) -> Self {
+        self.clock = clock;
+        self
+    }
+
     /// Load a compiled sequence into the engine
     pub fn load_sequence(&mut self, compiled: CompiledSequence) -> NfaResult<()> {
         debug!(sequence_id = %compiled.id, "Loading sequence");
@@ -116,31 +295,133 @@ impl NfaEngine {
         // Register metrics for this sequence
         self.metrics.write().register_sequence(compiled.id.clone());
 
-        // Store the sequence
-        self.sequences
-            .insert(compiled.id.clone(), compiled.sequence.clone());
+        // Store the sequence and index its event types
+        self.sequences.insert(compiled.id, compiled.sequence);
 
-        // Update event type index - use a Set to avoid duplicates for steps with same event_type_id
-        let mut event_types: std::collections::HashSet<u16> = std::collections::HashSet::new();
-        for step in &compiled.sequence.steps {
-            if event_types.insert(step.event_type_id) {
-                // Only add if this event_type wasn't already indexed
-                self.event_type_index
-                    .entry(step.event_type_id)
-                    .or_insert_with(Vec::new)
-                    .push(compiled.id.clone());
+        Ok(())
+    }
+
+    /// Install a new sequence set in place of the loaded one
+    ///
+    /// Sequences whose definition is unchanged keep their partial matches.
+    /// Matches of changed and removed sequences are left in place and
+    /// reclaimed a shard at a time by `tick` and the event path, so the
+    /// swap costs O(sequences) however much state is live.
+    pub fn swap_sequences(&mut self, set: SequenceSet) -> NfaResult<SequenceSwap> {
+        if self.config.max_sequences > 0 && set.len() > self.config.max_sequences {
+            return Err(NfaError::InvalidSequence(format!(
+                "Maximum sequence limit reached: {}",
+                self.config.max_sequences
+            )));
+        }
+
+        let old = std::mem::replace(&mut self.sequences, set);
+        let mut swap = SequenceSwap::default();
+
+        for (id, sequence) in &old.sequences {
+            let current = self.sequences.sequences.get(id);
+            if current.map_or(false, |new| **new == **sequence) {
+                swap.kept += 1;
+                continue;
             }
+
+            if current.is_some() {
+                swap.changed += 1;
+            } else {
+                swap.removed += 1;
+                self.metrics.write().unregister_sequence(id);
+                self.budget_tracker.write().remove(id);
+            }
+            self.retire(id, sequence.steps.len() as NfaStateId);
         }
 
-        // Also index the until step if present
-        if let Some(until_step) = &compiled.sequence.until_step {
-            self.event_type_index
-                .entry(until_step.event_type_id)
-                .or_insert_with(Vec::new)
-                .push(compiled.id.clone());
+        for id in self.sequences.sequences.keys() {
+            if !old.contains(id) {
+                swap.added += 1;
+                self.metrics.write().register_sequence(id.clone());
+            }
         }
 
-        Ok(())
+        debug!(
+            kept = swap.kept,
+            added = swap.added,
+            changed = swap.changed,
+            removed = swap.removed,
+            "Sequence set swapped"
+        );
+
+        Ok(swap)
+    }
+
+    /// Queue a sequence's current partial matches for lazy reclamation
+    fn retire(&mut self, sequence_id: &str, states: NfaStateId) {
+        let retired = self.retired.entry(sequence_id.to_string()).or_default();
+        retired.states = retired.states.max(states);
+        // Matches created since an earlier retirement are stale now as well
+        retired.purged.clear();
+        self.reclaim_pending = self.state_store.num_shards();
+    }
+
+    /// Drop an entity's matches from before its sequence was redefined
+    ///
+    /// Runs the first time the new definition sees the entity, so stale
+    /// matches are never advanced even before the sweep reaches them.
+    fn purge_retired_entity(&mut self, sequence_id: &str, entity_key: u128) {
+        if let Some(retired) = self.retired.get_mut(sequence_id) {
+            if !retired.purged.insert(entity_key) {
+                return;
+            }
+
+            for state_id in 0..retired.states {
+                if self
+                    .state_store
+                    .remove(sequence_id, entity_key, state_id)
+                    .is_some()
+                {
+                    if let Some(seq_metrics) = self.metrics.read().get_sequence_metrics(sequence_id)
+                    {
+                        seq_metrics.partial_match_removed();
+                        seq_metrics.record_eviction(EvictionReason::Reloaded);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Sweep one state store shard for partial matches of retired sequences
+    fn reclaim_retired_shard(&mut self) {
+        if self.retired.is_empty() {
+            return;
+        }
+
+        let shard = self.reclaim_shard % self.state_store.num_shards();
+        let retired = &self.retired;
+        let reclaimed = self
+            .state_store
+            .take_from_shard(shard, |sequence_id, entity_key| {
+                retired
+                    .get(sequence_id)
+                    .map_or(false, |r| !r.purged.contains(&entity_key))
+            });
+
+        for pm in reclaimed {
+            let metrics_handle = self.metrics.read().get_sequence_metrics(&pm.sequence_id);
+            if let Some(seq_metrics) = metrics_handle {
+                seq_metrics.partial_match_removed();
+                seq_metrics.record_eviction(EvictionReason::Reloaded);
+            }
+        }
+
+        self.reclaim_shard = shard + 1;
+        self.reclaim_pending = self.reclaim_pending.saturating_sub(1);
+        if self.reclaim_pending == 0 {
+            self.retired.clear();
+        }
+    }
+
+    /// Number of removed or redefined sequences with state still to reclaim
+    pub fn retired_sequence_count(&self) -> usize {
+        self.retired.len()
     }
 
     /// Check and update budget for a sequence
@@ -153,8 +434,8 @@ impl NfaEngine {
             return false;
         }
 
-        let now_ns = std::time::Instant::now().elapsed().as_nanos() as u64;
         let window_ns = 1_000_000_000;
+        let now_ns = (self.clock.coarse_ns)();
 
         let mut tracker = self.budget_tracker.write();
         let (count, time, window_start) = tracker
@@ -195,41 +476,54 @@ impl NfaEngine {
     }
 
     /// Unload a sequence from the engine
+    ///
+    /// Its partial matches are reclaimed lazily, like those of sequences
+    /// dropped by `swap_sequences`.
     pub fn unload_sequence(&mut self, sequence_id: &str) -> NfaResult<bool> {
         debug!(sequence_id, "Unloading sequence");
 
-        let removed = self.sequences.remove(sequence_id).is_some();
-
-        if removed {
-            // Cleanup all partial matches for this sequence
-            self.cleanup_sequence(sequence_id);
+        let removed = self.sequences.remove(sequence_id);
 
-            // Remove from event type index
-            for (_event_type, seq_ids) in self.event_type_index.iter_mut() {
-                seq_ids.retain(|id| id != sequence_id);
-            }
+        if let Some(sequence) = &removed {
+            self.retire(sequence_id, sequence.steps.len() as NfaStateId);
 
             // Unregister metrics
             self.metrics.write().unregister_sequence(sequence_id);
         }
 
-        Ok(removed)
+        Ok(removed.is_some())
     }
 
     /// Process an event through the NFA engine
-    /// 
+    pub fn process_event(&mut self, event: &kestrel_event::Event) -> NfaResult<Vec<SequenceAlert>> {
+        let mut alerts = Vec::new();
+        self.process_event_into(event, &mut alerts)?;
+        Ok(alerts)
+    }
+
+    /// Process an event through the NFA engine, appending alerts to `alerts`
+    ///
     /// PERFORMANCE OPTIMIZED:
-    /// - Uses thread-local buffer to avoid allocations
+    /// - Alerts go straight into the caller's (typically pooled) buffer
     /// - Zero-copy sequence references (no clone)
     /// - Lock-free metrics for hot path
-    pub fn process_event(&mut self, event: &kestrel_event::Event) -> NfaResult<Vec<SequenceAlert>> {
-        use std::cell::RefCell;
-        
-        // Thread-local buffer to avoid allocations
-        thread_local! {
-            static ALERTS_BUF: RefCell<Vec<SequenceAlert>> = RefCell::new(Vec::with_capacity(16));
-        }
-        
+    pub fn process_event_into(
+        &mut self,
+        event: &kestrel_event::Event,
+        alerts: &mut Vec<SequenceAlert>,
+    ) -> NfaResult<()> {
+        self.process_event_profiled(event, alerts, &())
+    }
+
+    /// Process an event, reporting sampled per-sequence costs to `profiler`
+    ///
+    /// Sequences the profiler reports as disabled are skipped entirely.
+    pub fn process_event_profiled<P: SequenceProfiler>(
+        &mut self,
+        event: &kestrel_event::Event,
+        alerts: &mut Vec<SequenceAlert>,
+        profiler: &P,
+    ) -> NfaResult<()> {
         let entity_key = event.entity_key;
         let event_type_id = event.event_type_id;
 
@@ -242,40 +536,51 @@ impl NfaEngine {
         // Record event in metrics - use Relaxed ordering for hot path
         self.metrics.read().record_event_relaxed();
 
+        // Amortize reclaiming state of sequences dropped by a reload
+        if !self.retired.is_empty() {
+            self.events_since_reclaim += 1;
+            if self.events_since_reclaim >= RECLAIM_EVERY_EVENTS {
+                self.events_since_reclaim = 0;
+                self.reclaim_retired_shard();
+            }
+        }
+
         // Collect relevant sequence IDs to process (avoid borrow issues)
         let relevant_sequence_ids: Vec<String> = self
+            .sequences
             .event_type_index
             .get(&event_type_id)
             .map(|v| v.clone())
             .unwrap_or_default();
 
         // Process each sequence without cloning
-        ALERTS_BUF.with(|buf| {
-            let mut alerts = buf.borrow_mut();
-            alerts.clear();
-            
-            for seq_id in &relevant_sequence_ids {
-                // Record event for this sequence - lock-free
-                if let Some(seq_metrics) = self.metrics.read().get_sequence_metrics_arc(seq_id) {
-                    seq_metrics.record_event_relaxed();
-                }
+        for seq_id in &relevant_sequence_ids {
+            // Get sequence handle for processing (needed due to mutable borrow of self)
+            let seq = match self.sequences.sequences.get(seq_id) {
+                Some(seq) if !seq.is_disabled() => seq.clone(),
+                _ => continue,
+            };
 
-                // Process event through this sequence
-                // Get sequence clone for processing (needed due to mutable borrow of self)
-                if let Some(seq) = self.sequences.get(seq_id).cloned() {
-                    match self.process_sequence_event_optimized(&seq, event) {
-                        Ok(Some(match_alerts)) => alerts.extend(match_alerts),
-                        Ok(None) => {}
-                        Err(e) => {
-                            warn!(sequence_id = %seq_id, error = %e, "Sequence processing failed");
-                        }
-                    }
-                }
+            // Record event for this sequence - lock-free
+            if let Some(seq_metrics) = self.metrics.read().get_sequence_metrics_arc(seq_id) {
+                seq_metrics.record_event_relaxed();
             }
-            
-            // Return cloned alerts (alerts are expected to be returned)
-            Ok(alerts.clone())
-        })
+
+            if !self.retired.is_empty() {
+                self.purge_retired_entity(seq_id, entity_key);
+            }
+
+            // Process event through this sequence
+            let sample = profiler.begin();
+            if let Err(e) = self.process_sequence_event_optimized(&seq, event, alerts) {
+                warn!(sequence_id = %seq_id, error = %e, "Sequence processing failed");
+            }
+            if let Some(sample) = sample {
+                profiler.end(seq_id, sample, self.partial_match_bytes(seq_id));
+            }
+        }
+
+        Ok(())
     }
     
     /// Optimized sequence event processing using pre-computed indices
@@ -285,7 +590,8 @@ impl NfaEngine {
         &mut self,
         sequence: &NfaSequence,
         event: &kestrel_event::Event,
-    ) -> NfaResult<Option<Vec<SequenceAlert>>> {
+        alerts: &mut Vec<SequenceAlert>,
+    ) -> NfaResult<()> {
         let entity_key = event.entity_key;
         let event_type_id = event.event_type_id;
 
@@ -293,10 +599,9 @@ impl NfaEngine {
         let relevant_step_indices = sequence.get_relevant_steps(event_type_id);
         
         if relevant_step_indices.is_empty() {
-            return Ok(None);
+            return Ok(());
         }
 
-        let mut alerts = Vec::with_capacity(1); // Most sequences generate 0 or 1 alerts
         let _timestamp_ns = event.ts_mono_ns;
 
         // Check for until condition first
@@ -305,7 +610,7 @@ impl NfaEngine {
                 if self.step_matches(event, until_step, &sequence.id)? {
                     // Until condition matched - terminate all partial matches for this entity
                     self.terminate_entity_partial_matches(sequence, entity_key)?;
-                    return Ok(None);
+                    return Ok(());
                 }
             }
         }
@@ -369,11 +674,7 @@ impl NfaEngine {
             }
         }
 
-        Ok(if alerts.is_empty() {
-            None
-        } else {
-            Some(alerts)
-        })
+        Ok(())
     }
 
     /// Get the expected next state for an entity in a sequence
@@ -413,7 +714,7 @@ impl NfaEngine {
         step: &SeqStep,
         sequence_id: &str,
     ) -> NfaResult<bool> {
-        let start_time = std::time::Instant::now();
+        let start_ns = (self.clock.precise_ns)();
 
         let result = match self.predicate_evaluator.evaluate(&step.predicate_id, event) {
             Ok(matches) => Ok(matches),
@@ -427,7 +728,7 @@ impl NfaEngine {
             }
         };
 
-        let eval_time_ns = start_time.elapsed().as_nanos() as u64;
+        let eval_time_ns = (self.clock.precise_ns)().saturating_sub(start_ns);
 
         // Record evaluation time
         if let Some(seq_metrics) = self.metrics.read().get_sequence_metrics(sequence_id) {
@@ -679,15 +980,10 @@ impl NfaEngine {
         Ok(captures)
     }
 
-    /// Cleanup all partial matches for a sequence
-    fn cleanup_sequence(&mut self, _sequence_id: &str) {
-        // This would typically involve iterating through all entities and states
-        // and removing partial matches for this sequence
-        // For now, we'll rely on the periodic cleanup to handle this
-    }
-
     /// Perform periodic maintenance (cleanup expired states, etc.)
     pub fn tick(&mut self, now_ns: u64) {
+        self.reclaim_retired_shard();
+
         let maxspan_ms = self.config.state_store.default_maxspan_ms;
         let expired = self.state_store.cleanup_expired(now_ns, maxspan_ms);
 
@@ -726,6 +1022,47 @@ impl NfaEngine {
         }
     }
 
+    /// Remove and return the partial matches of entities selected by `pred`
+    ///
+    /// Together with `import_entities` this moves entity state between
+    /// engines, e.g. when the EventBus hands an entity range to another
+    /// partition.
+    pub fn export_entities(&mut self, pred: impl Fn(u128) -> bool) -> Vec<PartialMatch> {
+        let exported = self.state_store.take_entities(pred);
+
+        for pm in &exported {
+            let metrics_handle = self.metrics.read().get_sequence_metrics(&pm.sequence_id);
+            if let Some(seq_metrics) = metrics_handle {
+                seq_metrics.partial_match_removed();
+            }
+        }
+
+        exported
+    }
+
+    /// Adopt partial matches exported by another engine
+    pub fn import_entities(&mut self, matches: Vec<PartialMatch>) -> NfaResult<()> {
+        for pm in matches {
+            let metrics_handle = self.metrics.read().get_sequence_metrics(&pm.sequence_id);
+            self.state_store.insert(pm)?;
+            if let Some(seq_metrics) = metrics_handle {
+                seq_metrics.partial_match_created();
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Approximate memory held by the sequence's active partial matches
+    pub fn partial_match_bytes(&self, sequence_id: &str) -> usize {
+        self.metrics
+            .read()
+            .get_sequence_metrics(sequence_id)
+            .map_or(0, |metrics| {
+                metrics.get_active_count() * std::mem::size_of::<PartialMatch>()
+            })
+    }
+
     /// Get metrics
     pub fn metrics(&self) -> &Arc<RwLock<NfaMetrics>> {
         &self.metrics
@@ -906,8 +1243,8 @@ mod tests {
         assert!(engine.load_sequence(compiled).is_ok());
 
         // Check that event type index was populated
-        assert!(engine.event_type_index.contains_key(&1));
-        assert!(engine.event_type_index.contains_key(&2));
+        assert!(engine.sequences.event_type_index.contains_key(&1));
+        assert!(engine.sequences.event_type_index.contains_key(&2));
     }
 
     #[test]
@@ -1159,6 +1496,208 @@ mod tests {
         }
     }
 
+    #[test]
+    fn test_process_event_into_appends() {
+        let config = NfaEngineConfig {
+            max_evaluations_per_sec: 0,
+            max_eval_time_ns: 0,
+            ..Default::default()
+        };
+        let mut evaluator = TestPredicateEvaluator::new();
+        evaluator.set_result("pred1".to_string(), true);
+        let mut engine = NfaEngine::new(config, Arc::new(evaluator));
+
+        let sequence = NfaSequence::new(
+            "test_seq".to_string(),
+            100,
+            vec![SeqStep::new(0, "pred1".to_string(), 1)],
+            Some(5000),
+            None,
+        );
+        engine
+            .load_sequence(CompiledSequence {
+                id: "test_seq".to_string(),
+                sequence,
+                rule_id: "rule1".to_string(),
+                rule_name: "Test Rule".to_string(),
+            })
+            .unwrap();
+
+        // Alerts accumulate in the caller's buffer across events
+        let mut alerts = Vec::new();
+        engine
+            .process_event_into(&create_test_event(1, 1000), &mut alerts)
+            .unwrap();
+        engine
+            .process_event_into(&create_test_event(1, 2000), &mut alerts)
+            .unwrap();
+        assert_eq!(alerts.len(), 2);
+        assert!(alerts.iter().all(|alert| alert.rule_id == "test_seq"));
+    }
+
+    #[derive(Default)]
+    struct CountingProfiler {
+        samples: std::sync::Mutex<Vec<String>>,
+    }
+
+    impl SequenceProfiler for CountingProfiler {
+        type Sample = ();
+
+        fn begin(&self) -> Option<()> {
+            Some(())
+        }
+
+        fn end(&self, sequence_id: &str, _sample: (), _partial_match_bytes: usize) {
+            self.samples.lock().unwrap().push(sequence_id.to_string());
+        }
+    }
+
+    #[test]
+    fn test_process_event_profiled() {
+        let config = NfaEngineConfig {
+            max_evaluations_per_sec: 0,
+            max_eval_time_ns: 0,
+            ..Default::default()
+        };
+        let mut evaluator = TestPredicateEvaluator::new();
+        evaluator.set_result("pred1".to_string(), true);
+        let mut engine = NfaEngine::new(config, Arc::new(evaluator));
+
+        let seq_b_off = Arc::new(std::sync::atomic::AtomicBool::new(true));
+        for id in ["seq_a", "seq_b"] {
+            let mut sequence = NfaSequence::new(
+                id.to_string(),
+                100,
+                vec![SeqStep::new(0, "pred1".to_string(), 1)],
+                Some(5000),
+                None,
+            );
+            if id == "seq_b" {
+                sequence.set_kill_switch(seq_b_off.clone());
+            }
+            engine
+                .load_sequence(CompiledSequence {
+                    id: id.to_string(),
+                    sequence,
+                    rule_id: id.to_string(),
+                    rule_name: "Test Rule".to_string(),
+                })
+                .unwrap();
+        }
+
+        let profiler = CountingProfiler::default();
+        let mut alerts = Vec::new();
+        engine
+            .process_event_profiled(&create_test_event(1, 1000), &mut alerts, &profiler)
+            .unwrap();
+
+        // The disabled sequence is neither evaluated nor sampled
+        assert_eq!(alerts.len(), 1);
+        assert_eq!(alerts[0].rule_id, "seq_a");
+        assert_eq!(*profiler.samples.lock().unwrap(), vec!["seq_a".to_string()]);
+
+        // Switching it back on takes effect without reloading
+        seq_b_off.store(false, std::sync::atomic::Ordering::Relaxed);
+        engine
+            .process_event_profiled(&create_test_event(1, 2000), &mut alerts, &profiler)
+            .unwrap();
+        assert!(alerts.iter().any(|alert| alert.rule_id == "seq_b"));
+    }
+
+    fn swap_test_engine() -> NfaEngine {
+        let config = NfaEngineConfig {
+            max_evaluations_per_sec: 0,
+            max_eval_time_ns: 0,
+            ..Default::default()
+        };
+        let mut evaluator = TestPredicateEvaluator::new();
+        evaluator.set_result("pred1".to_string(), true);
+        NfaEngine::new(config, Arc::new(evaluator))
+    }
+
+    fn compiled_sequence(id: &str, event_types: &[u16]) -> CompiledSequence {
+        let steps = event_types
+            .iter()
+            .enumerate()
+            .map(|(i, &event_type)| SeqStep::new(i as NfaStateId, "pred1".to_string(), event_type))
+            .collect();
+
+        CompiledSequence {
+            id: id.to_string(),
+            sequence: NfaSequence::new(id.to_string(), 100, steps, Some(5000), None),
+            rule_id: id.to_string(),
+            rule_name: "Test Rule".to_string(),
+        }
+    }
+
+    #[test]
+    fn test_swap_sequences_carries_over_unchanged() {
+        let mut engine = swap_test_engine();
+        engine
+            .load_sequence(compiled_sequence("kept", &[1, 2]))
+            .unwrap();
+        engine
+            .load_sequence(compiled_sequence("removed", &[1, 3]))
+            .unwrap();
+        engine.process_event(&create_test_event(1, 1000)).unwrap();
+        assert_eq!(engine.state_store.total_matches(), 2);
+
+        let set = SequenceSet::build([
+            compiled_sequence("kept", &[1, 2]),
+            compiled_sequence("added", &[4]),
+        ]);
+        let swap = engine.swap_sequences(set).unwrap();
+        assert_eq!(
+            swap,
+            SequenceSwap {
+                kept: 1,
+                added: 1,
+                changed: 0,
+                removed: 1,
+            }
+        );
+        assert_eq!(engine.sequence_count(), 2);
+        assert_eq!(engine.retired_sequence_count(), 1);
+
+        // The kept sequence completes from its pre-swap partial match
+        let alerts = engine.process_event(&create_test_event(2, 2000)).unwrap();
+        assert_eq!(alerts.len(), 1);
+        assert_eq!(alerts[0].sequence_id, "kept");
+
+        // The removed sequence's match is left to maintenance, not the swap
+        assert!(engine.state_store.get("removed", 0x12345, 0).is_some());
+        for _ in 0..engine.state_store.num_shards() {
+            engine.tick(3000);
+        }
+        assert!(engine.state_store.get("removed", 0x12345, 0).is_none());
+        assert_eq!(engine.retired_sequence_count(), 0);
+    }
+
+    #[test]
+    fn test_swap_sequences_drops_state_of_changed() {
+        let mut engine = swap_test_engine();
+        engine
+            .load_sequence(compiled_sequence("seq", &[1, 2, 3]))
+            .unwrap();
+        engine.process_event(&create_test_event(1, 1000)).unwrap();
+
+        let set = SequenceSet::build([compiled_sequence("seq", &[4, 3])]);
+        assert_eq!(engine.swap_sequences(set).unwrap().changed, 1);
+
+        // A match of the old definition must not complete the new one
+        let alerts = engine.process_event(&create_test_event(3, 2000)).unwrap();
+        assert!(alerts.is_empty());
+        assert_eq!(engine.state_store.total_matches(), 0);
+
+        // Matches of the new definition survive the sweep
+        engine.process_event(&create_test_event(4, 3000)).unwrap();
+        for _ in 0..engine.state_store.num_shards() {
+            engine.tick(3000);
+        }
+        let alerts = engine.process_event(&create_test_event(3, 4000)).unwrap();
+        assert_eq!(alerts.len(), 1);
+    }
+
     fn create_test_event(event_type: u16, timestamp_ns: u64) -> kestrel_event::Event {
         kestrel_event::Event::builder()
             .event_type(event_type)
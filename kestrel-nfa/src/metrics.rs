@@ -25,6 +25,9 @@ pub enum EvictionReason {
 
     /// Entity completed sequence (matched all steps)
     Completed,
+
+    /// Sequence was removed or redefined by a reload
+    Reloaded,
 }
 
 /// Per-sequence metrics
@@ -8,12 +8,14 @@
 use kestrel_event::Event;
 use smallvec::{smallvec, SmallVec};
 use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
 
 /// Unique identifier for an NFA state (position in sequence)
 pub type NfaStateId = u16;
 
 /// A compiled sequence rule ready for NFA execution
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq)]
 pub struct NfaSequence {
     /// Unique sequence identifier
     pub id: String,
@@ -36,9 +38,35 @@ pub struct NfaSequence {
     /// PERFORMANCE: Pre-computed index: event_type_id -> [step_indices]
     /// Avoids filtering steps on every event
     pub(crate) event_type_to_steps: HashMap<u16, SmallVec<[usize; 4]>>,
+
+    /// Switch that stops the sequence from being evaluated
+    kill_switch: KillSwitch,
+}
+
+/// Shared flag that switches a sequence off
+///
+/// Not part of the sequence definition, so it is ignored by equality.
+#[derive(Debug, Clone, Default)]
+struct KillSwitch(Arc<AtomicBool>);
+
+impl PartialEq for KillSwitch {
+    fn eq(&self, _other: &Self) -> bool {
+        true
+    }
 }
 
 impl NfaSequence {
+    /// Share `switch` with the sequence; while it is set, events skip it
+    pub fn set_kill_switch(&mut self, switch: Arc<AtomicBool>) {
+        self.kill_switch = KillSwitch(switch);
+    }
+
+    /// Whether the sequence's kill switch is on
+    #[inline]
+    pub fn is_disabled(&self) -> bool {
+        self.kill_switch.0.load(Ordering::Relaxed)
+    }
+
     /// Get relevant step indices for a given event type
     /// Returns empty slice if no steps match this event type
     #[inline]
@@ -71,7 +99,7 @@ impl NfaSequence {
 }
 
 /// A single step in a sequence
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq)]
 pub struct SeqStep {
     /// State ID (position in sequence, 0-indexed)
     pub state_id: NfaStateId,
@@ -235,6 +263,7 @@ impl NfaSequence {
             until_step: until_step.map(Box::new),
             captures: Vec::new(),
             event_type_to_steps,
+            kill_switch: KillSwitch::default(),
         }
     }
 
@@ -256,6 +285,7 @@ impl NfaSequence {
             until_step: until_step.map(Box::new),
             captures,
             event_type_to_steps,
+            kill_switch: KillSwitch::default(),
         }
     }
 
@@ -335,6 +335,56 @@ impl StateStore {
         evicted
     }
 
+    /// Remove and return the partial matches of entities selected by `pred`
+    pub fn take_entities(&self, pred: impl Fn(u128) -> bool) -> Vec<PartialMatch> {
+        let mut taken = Vec::new();
+
+        for shard in &self.shards {
+            let mut shard_write = shard.write();
+            let keys: Vec<_> = shard_write
+                .matches
+                .keys()
+                .filter(|key| pred(key.1))
+                .cloned()
+                .collect();
+
+            for key in keys {
+                if let Some(pm) = shard_write.remove(&key) {
+                    taken.push(pm);
+                }
+            }
+        }
+
+        taken
+    }
+
+    /// Remove and return the matches in one shard whose sequence and entity
+    /// are selected by `pred`
+    ///
+    /// Lets callers reclaim state incrementally, a shard at a time.
+    pub fn take_from_shard(
+        &self,
+        shard: usize,
+        pred: impl Fn(&str, u128) -> bool,
+    ) -> Vec<PartialMatch> {
+        let mut shard_write = self.shards[shard].write();
+        let keys: Vec<_> = shard_write
+            .matches
+            .keys()
+            .filter(|key| pred(&key.0, key.1))
+            .cloned()
+            .collect();
+
+        keys.iter()
+            .filter_map(|key| shard_write.remove(key))
+            .collect()
+    }
+
+    /// Number of shards the state is split across
+    pub fn num_shards(&self) -> usize {
+        self.num_shards
+    }
+
     /// Get total number of partial matches across all shards
     pub fn total_matches(&self) -> usize {
         self.shards.iter().map(|s| s.read().total_matches()).sum()
@@ -465,4 +515,28 @@ mod tests {
 
         assert_eq!(store.total_matches(), 3);
     }
+
+    #[test]
+    fn test_take_entities() {
+        let config = StateStoreConfig::default();
+        let store = StateStore::new(config);
+
+        store.insert(create_test_partial_match("seq1", 1, 0)).unwrap();
+        store.insert(create_test_partial_match("seq1", 2, 0)).unwrap();
+        store.insert(create_test_partial_match("seq2", 3, 0)).unwrap();
+
+        let mut taken: Vec<u128> = store
+            .take_entities(|entity_key| entity_key % 2 == 1)
+            .iter()
+            .map(|pm| pm.entity_key)
+            .collect();
+        taken.sort();
+        assert_eq!(taken, vec![1, 3]);
+        assert_eq!(store.total_matches(), 1);
+        assert!(store.get("seq1", 2, 0).is_some());
+
+        // Quota counts were released with the taken matches
+        store.insert(create_test_partial_match("seq1", 1, 0)).unwrap();
+        assert_eq!(store.total_matches(), 2);
+    }
 }
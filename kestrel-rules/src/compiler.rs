@@ -371,6 +371,7 @@ mod tests {
                 author: None,
                 tags: vec![],
                 severity: crate::Severity::Medium,
+                action: None,
             },
             definition: RuleDefinition::Eql("process.name == \"bash\"".to_string()),
         };
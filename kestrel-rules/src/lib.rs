@@ -3,12 +3,13 @@
 //! This module handles rule loading, hot-reloading, and lifecycle management.
 
 use anyhow::Result;
+use kestrel_core::{content_hash, ActionType, DirWatcher, FileEventKind};
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
 use std::path::{Path, PathBuf};
 use std::sync::Arc;
 use thiserror::Error;
-use tokio::sync::{RwLock, Semaphore};
+use tokio::sync::{mpsc, RwLock, Semaphore};
 use tracing::{debug, error, info, warn};
 
 pub mod compiler;
@@ -17,6 +18,11 @@ pub use compiler::{
     IrCondition, IrPredicate, IrRule, IrRuleType, IrSequenceStep, RuleCompiler,
 };
 
+/// File in the rules directory recording the content hash and metadata of
+/// every rule file, so a restart only parses files that changed while it
+/// was down
+pub const RULE_HASHES_FILE: &str = ".kestrel-rule-hashes.json";
+
 /// Rule manager configuration
 #[derive(Debug, Clone)]
 pub struct RuleManagerConfig {
@@ -63,6 +69,10 @@ pub struct RuleMetadata {
 
     /// Severity level
     pub severity: Severity,
+
+    /// Enforcement action in inline mode; alert-only when unset
+    #[serde(default)]
+    pub action: Option<ActionType>,
 }
 
 // Re-export Severity from kestrel-schema for backward compatibility
@@ -94,10 +104,49 @@ pub enum RuleDefinition {
     Lua(String),
 }
 
+/// Loaded state of one rule file
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct RuleFile {
+    /// Hex SHA-256 of the file content
+    pub hash: String,
+
+    /// Id of the rule the file defines
+    pub rule_id: String,
+}
+
+/// State of one rule file as persisted for the next run
+#[derive(Debug, Clone, Serialize, Deserialize)]
+struct PersistedRuleFile {
+    /// Hex SHA-256 of the file content
+    hash: String,
+
+    /// Metadata parsed from that content
+    metadata: RuleMetadata,
+}
+
+/// Rules affected by a reload
+#[derive(Debug, Default, Clone, PartialEq, Eq)]
+pub struct RuleChanges {
+    /// Rules added or whose file content changed
+    pub updated: Vec<String>,
+
+    /// Rules whose file was deleted, or that were renamed
+    pub removed: Vec<String>,
+}
+
+impl RuleChanges {
+    /// Whether nothing changed
+    pub fn is_empty(&self) -> bool {
+        self.updated.is_empty() && self.removed.is_empty()
+    }
+}
+
 /// Rule manager
 pub struct RuleManager {
     config: RuleManagerConfig,
     rules: Arc<RwLock<HashMap<String, Rule>>>,
+    /// Loaded rule files, by path
+    files: Arc<RwLock<HashMap<PathBuf, RuleFile>>>,
     load_semaphore: Arc<Semaphore>,
 }
 
@@ -107,6 +156,7 @@ impl RuleManager {
         Self {
             config,
             rules: Arc::new(RwLock::new(HashMap::new())),
+            files: Arc::new(RwLock::new(HashMap::new())),
             load_semaphore: Arc::new(Semaphore::new(4)),
         }
     }
@@ -127,17 +177,22 @@ impl RuleManager {
 
         let entries = std::fs::read_dir(&self.config.rules_dir)
             .map_err(|e| RuleManagerError::IoError(self.config.rules_dir.clone(), e))?;
+        let persisted = self.read_persisted_files();
 
         for entry in entries {
             let entry =
                 entry.map_err(|e| RuleManagerError::IoError(self.config.rules_dir.clone(), e))?;
             let path = entry.path();
 
-            if path.is_dir() {
+            if path.is_dir() || is_hidden(&path) {
                 continue;
             }
 
-            match self.load_rule_file(&path).await {
+            let cached = path
+                .file_name()
+                .and_then(|name| name.to_str())
+                .and_then(|name| persisted.get(name));
+            match self.load_rule_file(&path, cached).await {
                 Ok(_) => {
                     stats.loaded += 1;
                     debug!(path = %path.display(), "Loaded rule");
@@ -149,99 +204,254 @@ impl RuleManager {
             }
         }
 
+        {
+            let files = self.files.read().await;
+            stats.changed = files
+                .iter()
+                .filter(|(path, file)| {
+                    let name = path.file_name().and_then(|name| name.to_str());
+                    name.and_then(|name| persisted.get(name))
+                        .map(|cached| &cached.hash)
+                        != Some(&file.hash)
+                })
+                .count();
+        }
+        self.persist_files().await;
+
         info!(
             loaded = stats.loaded,
             failed = stats.failed,
+            changed = stats.changed,
             "Rule loading complete"
         );
 
         Ok(stats)
     }
 
-    /// Load a single rule file
-    async fn load_rule_file(&self, path: &Path) -> Result<(), RuleManagerError> {
-        let extension = path
-            .extension()
-            .and_then(|e| e.to_str())
-            .ok_or_else(|| RuleManagerError::InvalidRuleFormat(path.to_path_buf()))?;
-
-        match extension {
-            "json" => self.load_json_rule(path).await,
-            "yaml" | "yml" => self.load_yaml_rule(path).await,
-            "eql" => self.load_eql_rule(path).await,
-            _ => Err(RuleManagerError::InvalidRuleFormat(path.to_path_buf())),
+    /// Reload the given rule files, skipping those whose content is unchanged
+    ///
+    /// Paths that no longer exist unload their rule. A file that fails to
+    /// parse keeps its previously loaded rule until it is fixed.
+    pub async fn reload_paths(&self, paths: &[PathBuf]) -> Result<RuleChanges, RuleManagerError> {
+        let mut changes = RuleChanges::default();
+        let (gone, present): (Vec<&PathBuf>, Vec<&PathBuf>) = paths
+            .iter()
+            .filter(|path| is_rule_file(path))
+            .partition(|path| !path.is_file());
+
+        // Forget deleted files first, so a rename seen as a new path plus a
+        // deleted one keeps its rule loaded
+        let mut orphaned = Vec::new();
+        {
+            let mut files = self.files.write().await;
+            for path in gone {
+                if let Some(file) = files.remove(path) {
+                    debug!(path = %path.display(), rule_id = %file.rule_id, "Rule file removed");
+                    orphaned.push(file.rule_id);
+                }
+            }
         }
-    }
-
-    /// Load a JSON rule file
-    async fn load_json_rule(&self, path: &Path) -> Result<(), RuleManagerError> {
-        let content = std::fs::read_to_string(path)
-            .map_err(|e| RuleManagerError::IoError(path.to_path_buf(), e))?;
 
-        let metadata: RuleMetadata = serde_json::from_str(&content)
-            .map_err(|e| RuleManagerError::ParseError(path.to_path_buf(), e.to_string()))?;
+        for path in present {
+            let previous = self.files.read().await.get(path).cloned();
+            match self.load_rule_file(path, None).await {
+                Ok(Some(rule_id)) => {
+                    if let Some(previous) = previous.filter(|file| file.rule_id != rule_id) {
+                        orphaned.push(previous.rule_id);
+                    }
+                    debug!(path = %path.display(), rule_id = %rule_id, "Reloaded rule");
+                    changes.updated.push(rule_id);
+                }
+                Ok(None) => {}
+                Err(e) => {
+                    error!(path = %path.display(), error = %e, "Failed to reload rule");
+                }
+            }
+        }
 
-        let rule = Rule {
-            metadata: metadata.clone(),
-            definition: RuleDefinition::Eql(content),
-        };
+        // A rule is unloaded only once no remaining file defines it
+        if !orphaned.is_empty() {
+            let files = self.files.read().await;
+            orphaned.retain(|rule_id| !files.values().any(|file| &file.rule_id == rule_id));
+            drop(files);
+            orphaned.sort();
+            orphaned.dedup();
+
+            let mut rules = self.rules.write().await;
+            for rule_id in orphaned {
+                rules.remove(&rule_id);
+                debug!(rule_id = %rule_id, "Unloaded rule");
+                changes.removed.push(rule_id);
+            }
+        }
 
-        let mut rules = self.rules.write().await;
-        rules.insert(metadata.id.clone(), rule);
+        if !changes.is_empty() {
+            self.persist_files().await;
+        }
 
-        Ok(())
+        Ok(changes)
     }
 
-    /// Load a YAML rule file
-    async fn load_yaml_rule(&self, path: &Path) -> Result<(), RuleManagerError> {
-        let content = std::fs::read_to_string(path)
-            .map_err(|e| RuleManagerError::IoError(path.to_path_buf(), e))?;
+    /// Reload every rule file in the directory and unload rules of files
+    /// that disappeared
+    pub async fn rescan(&self) -> Result<RuleChanges, RuleManagerError> {
+        let entries = std::fs::read_dir(&self.config.rules_dir)
+            .map_err(|e| RuleManagerError::IoError(self.config.rules_dir.clone(), e))?;
 
-        let metadata: RuleMetadata = serde_yaml::from_str(&content)
-            .map_err(|e| RuleManagerError::ParseError(path.to_path_buf(), e.to_string()))?;
+        let mut paths: Vec<PathBuf> = self.files.read().await.keys().cloned().collect();
+        for entry in entries {
+            let entry =
+                entry.map_err(|e| RuleManagerError::IoError(self.config.rules_dir.clone(), e))?;
+            if !paths.contains(&entry.path()) {
+                paths.push(entry.path());
+            }
+        }
 
-        let rule = Rule {
-            metadata: metadata.clone(),
-            definition: RuleDefinition::Eql(content),
-        };
+        self.reload_paths(&paths).await
+    }
 
-        let mut rules = self.rules.write().await;
-        rules.insert(metadata.id.clone(), rule);
+    /// Watch the rules directory and reload rule files as they change
+    ///
+    /// Uses inotify where available, so an idle directory costs nothing.
+    /// Each batch of effective changes is sent on the returned channel;
+    /// the watcher stops when the receiver is dropped.
+    pub fn watch(self: &Arc<Self>) -> Result<mpsc::Receiver<RuleChanges>, RuleManagerError> {
+        let dir = self.config.rules_dir.clone();
+        let mut watcher =
+            DirWatcher::new(&dir).map_err(|e| RuleManagerError::IoError(dir.clone(), e))?;
+        let (tx, rx) = mpsc::channel(16);
+        let manager = Arc::clone(self);
+
+        tokio::spawn(async move {
+            info!(
+                dir = %dir.display(),
+                polling = watcher.is_polling(),
+                "Watching rules directory"
+            );
 
-        Ok(())
+            loop {
+                let events = match watcher.next_events().await {
+                    Ok(events) => events,
+                    Err(e) => {
+                        warn!(dir = %dir.display(), error = %e, "Rules watcher stopped");
+                        break;
+                    }
+                };
+
+                let result = if events.iter().any(|e| e.kind == FileEventKind::Overflow) {
+                    manager.rescan().await
+                } else {
+                    let paths: Vec<PathBuf> = events.into_iter().map(|e| e.path).collect();
+                    manager.reload_paths(&paths).await
+                };
+
+                match result {
+                    Ok(changes) if changes.is_empty() => {}
+                    Ok(changes) => {
+                        info!(
+                            updated = changes.updated.len(),
+                            removed = changes.removed.len(),
+                            "Rules changed"
+                        );
+                        if tx.send(changes).await.is_err() {
+                            break;
+                        }
+                    }
+                    Err(e) => warn!(error = %e, "Failed to reload rules"),
+                }
+            }
+        });
+
+        Ok(rx)
     }
 
-    /// Load an EQL rule file
-    async fn load_eql_rule(&self, path: &Path) -> Result<(), RuleManagerError> {
+    /// Load a single rule file
+    ///
+    /// `cached` is the file's state from the previous run; while the content
+    /// hash still matches, the rule is rebuilt from it without parsing.
+    /// Returns the id of the loaded rule, or `None` if the file content is
+    /// the same as when it was last loaded.
+    async fn load_rule_file(
+        &self,
+        path: &Path,
+        cached: Option<&PersistedRuleFile>,
+    ) -> Result<Option<String>, RuleManagerError> {
         let content = std::fs::read_to_string(path)
             .map_err(|e| RuleManagerError::IoError(path.to_path_buf(), e))?;
+        let hash = content_hash(content.as_bytes());
+
+        if self.files.read().await.get(path).map(|file| &file.hash) == Some(&hash) {
+            return Ok(None);
+        }
 
-        // Extract rule ID from filename
-        let id = path
-            .file_stem()
-            .and_then(|s| s.to_str())
-            .unwrap_or("unknown")
-            .to_string();
-
-        let metadata = RuleMetadata {
-            id: id.clone(),
-            name: id.clone(),
-            description: None,
-            version: "1.0.0".to_string(),
-            author: None,
-            tags: vec![],
-            severity: Severity::Medium,
+        // Every rule format keeps its full source as the definition
+        let rule = match cached {
+            Some(cached) if cached.hash == hash => Rule {
+                metadata: cached.metadata.clone(),
+                definition: RuleDefinition::Eql(content),
+            },
+            _ => parse_rule(path, content)?,
         };
+        let rule_id = rule.metadata.id.clone();
+
+        self.rules.write().await.insert(rule_id.clone(), rule);
+        self.files.write().await.insert(
+            path.to_path_buf(),
+            RuleFile {
+                hash,
+                rule_id: rule_id.clone(),
+            },
+        );
+
+        Ok(Some(rule_id))
+    }
+
+    /// Rule files recorded by the previous run, by file name
+    fn read_persisted_files(&self) -> HashMap<String, PersistedRuleFile> {
+        let path = self.config.rules_dir.join(RULE_HASHES_FILE);
+        match std::fs::read(&path) {
+            Ok(content) => serde_json::from_slice(&content).unwrap_or_else(|e| {
+                warn!(path = %path.display(), error = %e, "Ignoring corrupt rule hashes");
+                HashMap::new()
+            }),
+            Err(_) => HashMap::new(),
+        }
+    }
 
-        let rule = Rule {
-            metadata,
-            definition: RuleDefinition::Eql(content),
+    /// Record the content hash and metadata of every loaded rule file
+    ///
+    /// Best effort: a read-only rules directory only costs the next start
+    /// a full parse.
+    async fn persist_files(&self) {
+        let persisted: HashMap<String, PersistedRuleFile> = {
+            let files = self.files.read().await;
+            let rules = self.rules.read().await;
+            files
+                .iter()
+                .filter_map(|(path, file)| {
+                    let name = path.file_name()?.to_str()?.to_string();
+                    let rule = rules.get(&file.rule_id)?;
+                    Some((
+                        name,
+                        PersistedRuleFile {
+                            hash: file.hash.clone(),
+                            metadata: rule.metadata.clone(),
+                        },
+                    ))
+                })
+                .collect()
         };
 
-        let mut rules = self.rules.write().await;
-        rules.insert(id, rule);
+        let path = self.config.rules_dir.join(RULE_HASHES_FILE);
+        let tmp = path.with_extension("json.tmp");
+        let result = serde_json::to_vec_pretty(&persisted)
+            .map_err(std::io::Error::from)
+            .and_then(|content| std::fs::write(&tmp, content))
+            .and_then(|_| std::fs::rename(&tmp, &path));
 
-        Ok(())
+        if let Err(e) = result {
+            warn!(path = %path.display(), error = %e, "Failed to persist rule hashes");
+        }
     }
 
     /// Get a rule by ID
@@ -260,11 +470,90 @@ impl RuleManager {
     }
 }
 
+/// Dotfiles, including the persisted rule hashes and editor temporaries
+fn is_hidden(path: &Path) -> bool {
+    path.file_name()
+        .and_then(|name| name.to_str())
+        .map_or(true, |name| name.starts_with('.'))
+}
+
+/// Whether `path` names a rule file the manager loads
+fn is_rule_file(path: &Path) -> bool {
+    let extension = path.extension().and_then(|e| e.to_str());
+    !is_hidden(path) && matches!(extension, Some("json" | "yaml" | "yml" | "eql"))
+}
+
+/// Parse rule file content according to the file extension
+fn parse_rule(path: &Path, content: String) -> Result<Rule, RuleManagerError> {
+    let extension = path
+        .extension()
+        .and_then(|e| e.to_str())
+        .ok_or_else(|| RuleManagerError::InvalidRuleFormat(path.to_path_buf()))?;
+
+    match extension {
+        "json" => parse_json_rule(path, content),
+        "yaml" | "yml" => parse_yaml_rule(path, content),
+        "eql" => Ok(parse_eql_rule(path, content)),
+        _ => Err(RuleManagerError::InvalidRuleFormat(path.to_path_buf())),
+    }
+}
+
+/// Parse a JSON rule file
+fn parse_json_rule(path: &Path, content: String) -> Result<Rule, RuleManagerError> {
+    let metadata: RuleMetadata = serde_json::from_str(&content)
+        .map_err(|e| RuleManagerError::ParseError(path.to_path_buf(), e.to_string()))?;
+
+    Ok(Rule {
+        metadata,
+        definition: RuleDefinition::Eql(content),
+    })
+}
+
+/// Parse a YAML rule file
+fn parse_yaml_rule(path: &Path, content: String) -> Result<Rule, RuleManagerError> {
+    let metadata: RuleMetadata = serde_yaml::from_str(&content)
+        .map_err(|e| RuleManagerError::ParseError(path.to_path_buf(), e.to_string()))?;
+
+    Ok(Rule {
+        metadata,
+        definition: RuleDefinition::Eql(content),
+    })
+}
+
+/// Parse an EQL rule file
+fn parse_eql_rule(path: &Path, content: String) -> Rule {
+    // Extract rule ID from filename
+    let id = path
+        .file_stem()
+        .and_then(|s| s.to_str())
+        .unwrap_or("unknown")
+        .to_string();
+
+    let metadata = RuleMetadata {
+        id: id.clone(),
+        name: id.clone(),
+        description: None,
+        version: "1.0.0".to_string(),
+        author: None,
+        tags: vec![],
+        severity: Severity::Medium,
+        action: None,
+    };
+
+    Rule {
+        metadata,
+        definition: RuleDefinition::Eql(content),
+    }
+}
+
 /// Rule loading statistics
 #[derive(Debug, Default, Clone)]
 pub struct LoadStats {
     pub loaded: usize,
     pub failed: usize,
+    /// Loaded files that are new or changed since the previous run, and so
+    /// were parsed rather than restored from the persisted metadata
+    pub changed: usize,
 }
 
 /// Rule manager errors
@@ -306,7 +595,8 @@ mod tests {
             "version": "1.0.0",
             "author": "Test Author",
             "tags": ["test"],
-            "severity": "High"
+            "severity": "High",
+            "action": "block"
         }"#;
 
         std::fs::write(&rule_file, rule_json).unwrap();
@@ -322,8 +612,148 @@ mod tests {
         assert_eq!(stats.loaded, 1);
         assert_eq!(stats.failed, 0);
 
-        let rule = manager.get_rule("test-001").await;
-        assert!(rule.is_some());
-        assert_eq!(rule.unwrap().metadata.name, "Test Rule");
+        let rule = manager.get_rule("test-001").await.unwrap();
+        assert_eq!(rule.metadata.name, "Test Rule");
+        assert_eq!(rule.metadata.action, Some(ActionType::Block));
+    }
+
+    fn json_rule(id: &str, name: &str) -> String {
+        format!(
+            r#"{{"id": "{}", "name": "{}", "version": "1.0.0", "tags": [], "severity": "Low"}}"#,
+            id, name
+        )
+    }
+
+    #[tokio::test]
+    async fn test_reload_paths_only_changed() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let a = temp_dir.path().join("a.json");
+        let b = temp_dir.path().join("b.json");
+        std::fs::write(&a, json_rule("rule-a", "A")).unwrap();
+        std::fs::write(&b, json_rule("rule-b", "B")).unwrap();
+
+        let manager = RuleManager::new(RuleManagerConfig {
+            rules_dir: temp_dir.path().to_path_buf(),
+            ..Default::default()
+        });
+        manager.load_all().await.unwrap();
+
+        // Rewriting identical content is not a change
+        std::fs::write(&a, json_rule("rule-a", "A")).unwrap();
+        std::fs::write(&b, json_rule("rule-b", "B2")).unwrap();
+        let changes = manager.reload_paths(&[a.clone(), b.clone()]).await.unwrap();
+        assert_eq!(changes.updated, vec!["rule-b".to_string()]);
+        assert!(changes.removed.is_empty());
+        assert_eq!(
+            manager.get_rule("rule-b").await.unwrap().metadata.name,
+            "B2"
+        );
+
+        // A broken edit keeps the loaded rule
+        std::fs::write(&b, "{").unwrap();
+        assert!(manager.reload_paths(&[b.clone()]).await.unwrap().is_empty());
+        assert!(manager.get_rule("rule-b").await.is_some());
+
+        // Renaming the rule id unloads the old one
+        std::fs::write(&a, json_rule("rule-c", "C")).unwrap();
+        std::fs::remove_file(&b).unwrap();
+        let mut changes = manager.reload_paths(&[a, b]).await.unwrap();
+        changes.removed.sort();
+        assert_eq!(changes.updated, vec!["rule-c".to_string()]);
+        assert_eq!(
+            changes.removed,
+            vec!["rule-a".to_string(), "rule-b".to_string()]
+        );
+        assert_eq!(manager.list_rules().await, vec!["rule-c".to_string()]);
+    }
+
+    #[tokio::test]
+    async fn test_reload_paths_keeps_renamed_file() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let a = temp_dir.path().join("a.json");
+        let b = temp_dir.path().join("b.json");
+        std::fs::write(&a, json_rule("rule-a", "A")).unwrap();
+
+        let manager = RuleManager::new(RuleManagerConfig {
+            rules_dir: temp_dir.path().to_path_buf(),
+            ..Default::default()
+        });
+        manager.load_all().await.unwrap();
+
+        // A polling watcher reports the new path before the deleted one
+        std::fs::rename(&a, &b).unwrap();
+        let changes = manager.reload_paths(&[b.clone(), a.clone()]).await.unwrap();
+        assert_eq!(changes.updated, vec!["rule-a".to_string()]);
+        assert!(changes.removed.is_empty());
+        assert!(manager.get_rule("rule-a").await.is_some());
+
+        // Two files defining the same rule: deleting one keeps the rule
+        std::fs::write(&a, json_rule("rule-a", "A")).unwrap();
+        manager.reload_paths(&[a.clone()]).await.unwrap();
+        std::fs::remove_file(&b).unwrap();
+        assert!(manager.reload_paths(&[b]).await.unwrap().is_empty());
+        assert!(manager.get_rule("rule-a").await.is_some());
+
+        std::fs::remove_file(&a).unwrap();
+        let changes = manager.reload_paths(&[a]).await.unwrap();
+        assert_eq!(changes.removed, vec!["rule-a".to_string()]);
+        assert!(manager.get_rule("rule-a").await.is_none());
+    }
+
+    #[tokio::test]
+    async fn test_hashes_persist_across_restarts() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        std::fs::write(temp_dir.path().join("a.json"), json_rule("rule-a", "A")).unwrap();
+        std::fs::write(temp_dir.path().join("b.eql"), "process where true").unwrap();
+        let config = RuleManagerConfig {
+            rules_dir: temp_dir.path().to_path_buf(),
+            ..Default::default()
+        };
+
+        let stats = RuleManager::new(config.clone()).load_all().await.unwrap();
+        assert_eq!((stats.loaded, stats.failed, stats.changed), (2, 0, 2));
+        assert!(temp_dir.path().join(RULE_HASHES_FILE).exists());
+
+        // Unchanged files are restored from the persisted metadata unparsed
+        let hashes = temp_dir.path().join(RULE_HASHES_FILE);
+        let mut persisted: serde_json::Value =
+            serde_json::from_slice(&std::fs::read(&hashes).unwrap()).unwrap();
+        persisted["a.json"]["metadata"]["name"] = "Cached".into();
+        std::fs::write(&hashes, persisted.to_string()).unwrap();
+
+        let manager = RuleManager::new(config.clone());
+        let stats = manager.load_all().await.unwrap();
+        assert_eq!((stats.loaded, stats.failed, stats.changed), (2, 0, 0));
+        assert_eq!(
+            manager.get_rule("rule-a").await.unwrap().metadata.name,
+            "Cached"
+        );
+
+        std::fs::write(temp_dir.path().join("b.eql"), "process where false").unwrap();
+        let stats = RuleManager::new(config).load_all().await.unwrap();
+        assert_eq!((stats.loaded, stats.failed, stats.changed), (2, 0, 1));
+    }
+
+    #[tokio::test]
+    async fn test_watch_reloads_written_file() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let manager = Arc::new(RuleManager::new(RuleManagerConfig {
+            rules_dir: temp_dir.path().to_path_buf(),
+            ..Default::default()
+        }));
+        manager.load_all().await.unwrap();
+        let mut rx = manager.watch().unwrap();
+
+        std::fs::write(
+            temp_dir.path().join("new.json"),
+            json_rule("rule-new", "New"),
+        )
+        .unwrap();
+        let changes = tokio::time::timeout(std::time::Duration::from_secs(10), rx.recv())
+            .await
+            .expect("no rule change")
+            .unwrap();
+        assert_eq!(changes.updated, vec!["rule-new".to_string()]);
+        assert!(manager.get_rule("rule-new").await.is_some());
     }
 }
@@ -15,6 +15,10 @@ use wasmtime::{
     Module, Store,
 };
 
+mod regex_set;
+
+pub use regex_set::{EvaluationId, FieldRegex, FieldRegexSets};
+
 use kestrel_event::Event;
 use kestrel_schema::{
     AlertRecord, EvalResult, FieldId, GlobId, RegexId, RuleCapabilities, RuleManifest, RuleMetadata,
@@ -90,6 +94,8 @@ pub struct WasmEngine {
     pub instance_pool: Arc<RwLock<AHashMap<String, InstancePool>>>,
     pub regex_cache: Arc<RwLock<AHashMap<RegexId, regex::Regex>>>,
     pub glob_cache: Arc<RwLock<AHashMap<GlobId, glob::Pattern>>>,
+    /// Per-field regex sets of the loaded rule pack
+    pub regex_sets: Arc<std::sync::RwLock<FieldRegexSets>>,
     pub next_regex_id: Arc<std::sync::atomic::AtomicU32>,
     pub next_glob_id: Arc<std::sync::atomic::AtomicU32>,
     pub pool_metrics: Arc<PoolMetrics>,
@@ -101,6 +107,94 @@ struct CompiledModule {
     module: Module,
     instance_pre: InstancePre<WasmContext>,
     metadata: RuleMetadata,
+    tables: PredicateTables,
+}
+
+/// Ad-hoc predicate compiled and linked once by `prepare_predicate`
+///
+/// Each evaluation only instantiates it, so Cranelift never runs on the
+/// event path. Clones share the compiled code.
+#[derive(Clone)]
+pub struct PreparedPredicate {
+    instance_pre: InstancePre<WasmContext>,
+}
+
+impl std::fmt::Debug for PreparedPredicate {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("PreparedPredicate").finish_non_exhaustive()
+    }
+}
+
+/// Host-side tables a module references by index
+#[derive(Debug, Clone)]
+pub struct PredicateTables {
+    /// Literal sets backing large `in` lists
+    pub literal_sets: Arc<[LiteralSetTable]>,
+    /// Regexes matched through the per-field regex sets
+    pub field_regexes: Arc<[FieldRegex]>,
+}
+
+impl Default for PredicateTables {
+    fn default() -> Self {
+        Self {
+            literal_sets: Vec::new().into(),
+            field_regexes: Vec::new().into(),
+        }
+    }
+}
+
+/// Host-side literal set backing a large `in` list
+///
+/// Tables are registered per module at load time and referenced from Wasm
+/// by module-local index through `set_contains_i64` / `set_contains_str`,
+/// so a lookup costs one host call instead of one comparison per literal.
+#[derive(Debug, Clone)]
+pub enum LiteralSetTable {
+    /// Sorted integers, binary searched
+    Int(Box<[i64]>),
+    /// Hashed strings
+    String(ahash::AHashSet<Box<str>>),
+}
+
+impl LiteralSetTable {
+    /// Build an integer table
+    pub fn from_ints(values: impl IntoIterator<Item = i64>) -> Self {
+        let mut ints: Vec<i64> = values.into_iter().collect();
+        ints.sort_unstable();
+        ints.dedup();
+        LiteralSetTable::Int(ints.into_boxed_slice())
+    }
+
+    /// Build a string table
+    pub fn from_strings<S: Into<Box<str>>>(values: impl IntoIterator<Item = S>) -> Self {
+        LiteralSetTable::String(values.into_iter().map(Into::into).collect())
+    }
+
+    pub fn contains_i64(&self, value: i64) -> bool {
+        match self {
+            LiteralSetTable::Int(ints) => ints.binary_search(&value).is_ok(),
+            LiteralSetTable::String(_) => false,
+        }
+    }
+
+    pub fn contains_str(&self, value: &str) -> bool {
+        match self {
+            LiteralSetTable::String(strings) => strings.contains(value),
+            LiteralSetTable::Int(_) => false,
+        }
+    }
+
+    /// Number of distinct values
+    pub fn len(&self) -> usize {
+        match self {
+            LiteralSetTable::Int(ints) => ints.len(),
+            LiteralSetTable::String(strings) => strings.len(),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
 }
 
 /// Pool metrics for tracking instance pool utilization
@@ -221,6 +315,11 @@ pub struct WasmContext {
     pub regex_cache: Arc<RwLock<AHashMap<RegexId, regex::Regex>>>,
     pub glob_cache: Arc<RwLock<AHashMap<GlobId, glob::Pattern>>>,
     pub rule_metadata: RuleMetadata,
+    pub regex_sets: Arc<std::sync::RwLock<FieldRegexSets>>,
+    /// Tables of the loaded module
+    pub tables: PredicateTables,
+    /// Evaluation the current event belongs to
+    pub evaluation: EvaluationId,
 }
 
 /// Wasm predicate
@@ -255,6 +354,9 @@ impl WasmPredicate {
                 regex_cache: self.engine.regex_cache.clone(),
                 glob_cache: self.engine.glob_cache.clone(),
                 rule_metadata: compiled.metadata.clone(),
+                regex_sets: self.engine.regex_sets.clone(),
+                tables: compiled.tables.clone(),
+                evaluation: EvaluationId::next(),
             },
         );
 
@@ -359,6 +461,7 @@ impl WasmEngine {
             instance_pool: Arc::new(RwLock::new(AHashMap::new())),
             regex_cache: Arc::new(RwLock::new(AHashMap::new())),
             glob_cache: Arc::new(RwLock::new(AHashMap::new())),
+            regex_sets: Arc::new(std::sync::RwLock::new(FieldRegexSets::default())),
             next_regex_id: Arc::new(std::sync::atomic::AtomicU32::new(1)),
             next_glob_id: Arc::new(std::sync::atomic::AtomicU32::new(1)),
             pool_metrics: Arc::new(PoolMetrics::new()),
@@ -559,6 +662,32 @@ impl WasmEngine {
             )
             .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
 
+        // Regex matching on an event field through the field's regex set
+        linker
+            .func_wrap(
+                "kestrel",
+                "re_match_field",
+                |caller: Caller<'_, WasmContext>, regex_idx: u32| -> i32 {
+                    let ctx = caller.data();
+                    let regex = match ctx.tables.field_regexes.get(regex_idx as usize) {
+                        Some(r) => r,
+                        None => return 0,
+                    };
+                    let value = match ctx
+                        .event
+                        .as_ref()
+                        .and_then(|e| e.get_field(regex.field_id()))
+                    {
+                        Some(TypedValue::String(s)) => s.as_str(),
+                        _ => return 0,
+                    };
+
+                    let sets = ctx.regex_sets.read().unwrap_or_else(|e| e.into_inner());
+                    regex.is_match(&sets, ctx.evaluation, value) as i32
+                },
+            )
+            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+
         // Glob matching
         linker
             .func_wrap(
@@ -597,6 +726,92 @@ impl WasmEngine {
             )
             .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
 
+        // String predicates on an event field
+        Self::register_str_predicate(linker, "str_contains", |value, needle| {
+            value.contains(needle)
+        })?;
+        Self::register_str_predicate(linker, "str_starts_with", |value, needle| {
+            value.starts_with(needle)
+        })?;
+        Self::register_str_predicate(linker, "str_ends_with", |value, needle| {
+            value.ends_with(needle)
+        })?;
+        Self::register_str_predicate(linker, "str_equals", |value, needle| value == needle)?;
+        Self::register_str_predicate(linker, "str_equals_ci", |value, needle| {
+            value
+                .chars()
+                .flat_map(char::to_lowercase)
+                .eq(needle.chars().flat_map(char::to_lowercase))
+        })?;
+
+        // Literal set membership (large `in` lists)
+        linker
+            .func_wrap(
+                "kestrel",
+                "set_contains_i64",
+                |caller: Caller<'_, WasmContext>, set_idx: u32, value: i64| -> i32 {
+                    match caller.data().tables.literal_sets.get(set_idx as usize) {
+                        Some(table) if table.contains_i64(value) => 1,
+                        _ => 0,
+                    }
+                },
+            )
+            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+
+        linker
+            .func_wrap(
+                "kestrel",
+                "set_contains_str",
+                |mut caller: Caller<'_, WasmContext>, set_idx: u32, ptr: u32, len: u32| -> i32 {
+                    let mem = match caller.get_export("memory") {
+                        Some(Extern::Memory(m)) => m,
+                        _ => return 0,
+                    };
+
+                    // Borrow guest memory directly; no copy, no lock
+                    let (data, ctx) = mem.data_and_store_mut(&mut caller);
+                    let table = match ctx.tables.literal_sets.get(set_idx as usize) {
+                        Some(t) => t,
+                        None => return 0,
+                    };
+                    let start = ptr as usize;
+                    let bytes = match data.get(start..start.saturating_add(len as usize)) {
+                        Some(b) => b,
+                        None => return 0,
+                    };
+
+                    match std::str::from_utf8(bytes) {
+                        Ok(s) if table.contains_str(s) => 1,
+                        _ => 0,
+                    }
+                },
+            )
+            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+
+        // Full-length lookup for string fields that may not fit the guest's
+        // scratch buffer
+        linker
+            .func_wrap(
+                "kestrel",
+                "set_contains_field_str",
+                |caller: Caller<'_, WasmContext>,
+                 set_idx: u32,
+                 _event_handle: u32,
+                 field_id: u32|
+                 -> i32 {
+                    let ctx = caller.data();
+                    let table = match ctx.tables.literal_sets.get(set_idx as usize) {
+                        Some(t) => t,
+                        None => return 0,
+                    };
+                    match ctx.event.as_ref().and_then(|e| e.get_field(field_id)) {
+                        Some(TypedValue::String(s)) if table.contains_str(s) => 1,
+                        _ => 0,
+                    }
+                },
+            )
+            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+
         // Alert emission with field capture
         linker
             .func_wrap(
@@ -699,6 +914,48 @@ impl WasmEngine {
         Ok(())
     }
 
+    /// Register `name(field_id, needle_ptr, needle_len)`, which applies
+    /// `predicate` to a string field of the current event and a needle in
+    /// guest memory
+    fn register_str_predicate(
+        linker: &mut Linker<WasmContext>,
+        name: &str,
+        predicate: fn(&str, &str) -> bool,
+    ) -> Result<(), WasmRuntimeError> {
+        linker
+            .func_wrap(
+                "kestrel",
+                name,
+                move |mut caller: Caller<'_, WasmContext>,
+                      field_id: u32,
+                      needle_ptr: u32,
+                      needle_len: u32|
+                      -> i32 {
+                    let mem = match caller.get_export("memory") {
+                        Some(Extern::Memory(m)) => m,
+                        _ => return 0,
+                    };
+
+                    let (data, ctx) = mem.data_and_store_mut(&mut caller);
+                    let start = needle_ptr as usize;
+                    let needle = match data
+                        .get(start..start.saturating_add(needle_len as usize))
+                        .map(std::str::from_utf8)
+                    {
+                        Some(Ok(n)) => n,
+                        _ => return 0,
+                    };
+
+                    match ctx.event.as_ref().and_then(|e| e.get_field(field_id)) {
+                        Some(TypedValue::String(value)) => predicate(value, needle) as i32,
+                        _ => 0,
+                    }
+                },
+            )
+            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+        Ok(())
+    }
+
     /// Compile a Wasm rule and extract metadata
     pub async fn compile_rule(
         &self,
@@ -727,6 +984,22 @@ impl WasmEngine {
         &self,
         manifest: RuleManifest,
         wasm_bytes: Vec<u8>,
+    ) -> Result<String, WasmRuntimeError> {
+        self.load_module_with_tables(manifest, wasm_bytes, PredicateTables::default())
+            .await
+    }
+
+    /// Load a Wasm module together with its host-side tables
+    ///
+    /// `tables.literal_sets[i]` backs set index `i` and
+    /// `tables.field_regexes[i]` regex index `i` in the module (the order of
+    /// `IrRule::literal_sets` and `IrRule::field_regex_patterns` for
+    /// EQL-generated modules).
+    pub async fn load_module_with_tables(
+        &self,
+        manifest: RuleManifest,
+        wasm_bytes: Vec<u8>,
+        tables: PredicateTables,
     ) -> Result<String, WasmRuntimeError> {
         let rule_id = manifest.metadata.rule_id.clone();
 
@@ -749,6 +1022,7 @@ impl WasmEngine {
             module,
             instance_pre,
             metadata: manifest.metadata,
+            tables,
         };
 
         // Pre-populate the instance pool
@@ -767,6 +1041,9 @@ impl WasmEngine {
                     regex_cache: self.regex_cache.clone(),
                     glob_cache: self.glob_cache.clone(),
                     rule_metadata: compiled.metadata.clone(),
+                    regex_sets: self.regex_sets.clone(),
+                    tables: compiled.tables.clone(),
+                    evaluation: EvaluationId::next(),
                 },
             );
 
@@ -811,11 +1088,56 @@ impl WasmEngine {
         wasm_bytes: &[u8],
         event: &Event,
     ) -> Result<bool, WasmRuntimeError> {
-        use wasmtime::{Instance, Module, Store};
+        let tables = PredicateTables::default();
+        self.eval_adhoc_predicate_with_tables(wasm_bytes, &tables, EvaluationId::next(), event)
+            .await
+    }
+
+    /// Compile and run an ad-hoc Wasm predicate backed by host-side tables
+    ///
+    /// Compiles the module on every call; predicates evaluated repeatedly
+    /// should go through `prepare_predicate` and `eval_prepared_predicate`.
+    pub async fn eval_adhoc_predicate_with_tables(
+        &self,
+        wasm_bytes: &[u8],
+        tables: &PredicateTables,
+        evaluation: EvaluationId,
+        event: &Event,
+    ) -> Result<bool, WasmRuntimeError> {
+        let predicate = self.prepare_predicate(wasm_bytes)?;
+        self.eval_prepared_predicate(&predicate, tables, evaluation, event)
+            .await
+    }
 
+    /// Compile an ad-hoc predicate and link it against the host API
+    ///
+    /// Safe to call from any thread; rule compile workers prepare their
+    /// predicates in parallel.
+    pub fn prepare_predicate(
+        &self,
+        wasm_bytes: &[u8],
+    ) -> Result<PreparedPredicate, WasmRuntimeError> {
         let module = Module::from_binary(&self.engine, wasm_bytes)
             .map_err(|e| WasmRuntimeError::CompilationError(e.to_string()))?;
+        Ok(PreparedPredicate {
+            instance_pre: self.instance_pre(&module)?,
+        })
+    }
 
+    /// Run a predicate prepared by `prepare_predicate`
+    ///
+    /// `tables` has the same layout as for `load_module_with_tables`.
+    /// Predicates evaluated against the same event should share one
+    /// `evaluation`, so per-field regex sets scan each field only once.
+    /// EQL modules export `pred_eval(predicate_id, event_handle)`; a
+    /// single-event rule has only its `main` predicate, at index 0.
+    pub async fn eval_prepared_predicate(
+        &self,
+        predicate: &PreparedPredicate,
+        tables: &PredicateTables,
+        evaluation: EvaluationId,
+        event: &Event,
+    ) -> Result<bool, WasmRuntimeError> {
         let mut store = Store::new(
             &self.engine,
             WasmContext {
@@ -825,19 +1147,26 @@ impl WasmEngine {
                 regex_cache: self.regex_cache.clone(),
                 glob_cache: self.glob_cache.clone(),
                 rule_metadata: RuleMetadata::new("adhoc", "Ad-hoc Predicate"),
+                regex_sets: self.regex_sets.clone(),
+                tables: tables.clone(),
+                evaluation,
             },
         );
 
-        let instance = Instance::new(&mut store, &module, &[])
+        // Linked against the host API when prepared
+        let instance = predicate
+            .instance_pre
+            .instantiate(&mut store)
             .map_err(|e| WasmRuntimeError::InstantiationError(e.to_string()))?;
 
-        let pred_eval = instance
-            .get_typed_func::<(), i32>(&mut store, "pred_eval")
-            .map_err(|_| WasmRuntimeError::FunctionNotFound("pred_eval".to_string()))?;
-
-        let result = pred_eval
-            .call(&mut store, ())
-            .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
+        let result = match instance.get_typed_func::<(i32, i32), i32>(&mut store, "pred_eval") {
+            Ok(pred_eval) => pred_eval.call(&mut store, (0, 0)),
+            Err(_) => instance
+                .get_typed_func::<(), i32>(&mut store, "pred_eval")
+                .map_err(|_| WasmRuntimeError::FunctionNotFound("pred_eval".to_string()))?
+                .call(&mut store, ()),
+        }
+        .map_err(|e| WasmRuntimeError::ExecutionError(e.to_string()))?;
 
         Ok(result == 1)
     }
@@ -871,6 +1200,28 @@ impl WasmEngine {
         Ok(id)
     }
 
+    /// Replace the per-field regex sets with those of a new rule pack
+    ///
+    /// Patterns are grouped by field and compiled into one `RegexSet` per
+    /// field, so each field is scanned once per event however many rules
+    /// apply regexes to it.
+    pub fn register_field_regexes(
+        &self,
+        patterns: impl IntoIterator<Item = (FieldId, String)>,
+    ) -> Result<usize, WasmRuntimeError> {
+        let sets = FieldRegexSets::build(patterns)
+            .map_err(|e| WasmRuntimeError::CompilationError(e.to_string()))?;
+        let field_count = sets.field_count();
+
+        info!(
+            fields = field_count,
+            patterns = sets.pattern_count(),
+            "Registered field regex sets"
+        );
+        *self.regex_sets.write().unwrap_or_else(|e| e.into_inner()) = sets;
+        Ok(field_count)
+    }
+
     /// Register a compiled glob pattern
     pub async fn register_glob(&self, pattern: &str) -> Result<GlobId, WasmRuntimeError> {
         let glob = glob::Pattern::new(pattern)
@@ -913,6 +1264,7 @@ impl Clone for WasmEngine {
             instance_pool: self.instance_pool.clone(),
             regex_cache: self.regex_cache.clone(),
             glob_cache: self.glob_cache.clone(),
+            regex_sets: self.regex_sets.clone(),
             next_regex_id: self.next_regex_id.clone(),
             next_glob_id: self.next_glob_id.clone(),
             pool_metrics: self.pool_metrics.clone(),
@@ -1082,4 +1434,19 @@ mod tests {
         metrics.record_miss();
         assert_eq!(metrics.cache_hit_rate_pct(), 0.0); // 0 hits out of 1 acquire
     }
+
+    #[test]
+    fn test_literal_set_tables() {
+        let ports = LiteralSetTable::from_ints([443, 80, 8080, 80]);
+        assert_eq!(ports.len(), 3);
+        assert!(ports.contains_i64(8080));
+        assert!(!ports.contains_i64(22));
+        assert!(!ports.contains_str("80"));
+
+        let hashes = LiteralSetTable::from_strings((0..5000).map(|i| format!("{:064x}", i)));
+        assert_eq!(hashes.len(), 5000);
+        assert!(hashes.contains_str(&format!("{:064x}", 4999)));
+        assert!(!hashes.contains_str("deadbeef"));
+        assert!(!hashes.contains_i64(1));
+    }
 }
